@@ -0,0 +1,489 @@
+/*  reacTIVision tangible interaction framework
+	Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// The pipeline benchmark replays a recorded PGM/PPM frame sequence or camera recording through the production
+// processing chain (thresholder, FidtrackFinder and TuioServer) without any display, as fast
+// as possible. It reports the frame rate and the time spent in each stage, as well as a digest
+// of the decoded TUIO events, which allows comparing the tracking results of two builds.
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <pthread.h>
+
+#include "Main.h"
+#include "CameraTool.h"
+#include "FrameThresholderBR.h"
+#include "FrameThresholder.h"
+#include "FidtrackFinder.h"
+#include "TuioServer.h"
+#include "UdpSender.h"
+#include "TuioBenchClient.h"
+
+struct stage_time {
+	double total;
+	double max;
+};
+
+struct pipeline_result {
+	long frames;
+	unsigned long packets;
+	unsigned long bytes;
+	unsigned long added[3];
+	unsigned long updated[3];
+	unsigned long removed[3];
+	unsigned long long digest;
+	stage_time camera, threshold, tracking, encoding;
+	double seconds;
+};
+
+static long getMicroseconds() {
+	TuioTime now = TuioTime::getSystemTime();
+	return now.getSeconds()*1000000 + now.getMicroseconds();
+}
+
+static void addTime(stage_time *stage, long time) {
+	stage->total += time;
+	if (time>stage->max) stage->max = time;
+}
+
+// a user interface without any output, which is required by the frame processors
+class HeadlessInterface : public UserInterface {
+public:
+	HeadlessInterface() { setDisplayMode(NO_DISPLAY); };
+
+	bool openDisplay(VisionEngine *engine) { return true; };
+	void updateDisplay() {};
+	void closeDisplay() {};
+
+	void setHelpText(std::vector<std::string> hlp) {};
+	void setBuffers(unsigned char *src, unsigned char *dest, int width, int height, int format) {};
+	void processEvents() {};
+
+	void printMessage(std::string message) {};
+	void displayMessage(const char *message) {};
+	void displayControl(const char *title, int min, int max, int value) {};
+	void displayError(const char *message) { std::cerr << message << std::endl; };
+	void drawText(int xpos, int ypos, const char *text) {};
+
+	void setColor(unsigned char r, unsigned char g, unsigned char b) {};
+	void drawPoint(int x,int y) {};
+	void drawLine(int x1,int y1, int x2, int y2) {};
+	void drawRect(int x,int y, int w, int h) {};
+	void drawRect(int x,int y, int w, int h, float r) {};
+	void fillRect(int x,int y, int w, int h) {};
+	void drawEllipse(int x,int y, int w, int h) {};
+	void drawEllipse(int x,int y, int w, int h, float r) {};
+	void fillEllipse(int x,int y, int w, int h) {};
+};
+
+// collects the encoded packets of a frame, which are decoded after the timed section,
+// the TuioServer delivers them from its own thread until the end of the frame
+class CaptureSender : public OscSender {
+public:
+	CaptureSender():frame_count(0) {
+		local = true;
+		buffer_size = MAX_UDP_SIZE;
+		pthread_mutex_init(&capture_mutex, NULL);
+		pthread_cond_init(&capture_cond, NULL);
+	};
+
+	~CaptureSender() {
+		pthread_cond_destroy(&capture_cond);
+		pthread_mutex_destroy(&capture_mutex);
+	};
+
+	bool sendOscData(const char *data, unsigned int size) {
+		pthread_mutex_lock(&capture_mutex);
+		captured_data.insert(captured_data.end(), data, data+size);
+		captured_size.push_back(size);
+		pthread_mutex_unlock(&capture_mutex);
+		return true;
+	};
+
+	void flushOscData() {
+		pthread_mutex_lock(&capture_mutex);
+		frame_count++;
+		pthread_cond_signal(&capture_cond);
+		pthread_mutex_unlock(&capture_mutex);
+	};
+
+	// waits until the given number of frames has been delivered, and takes their packets
+	void waitFrames(unsigned long frames) {
+		pthread_mutex_lock(&capture_mutex);
+		while (frame_count<frames) pthread_cond_wait(&capture_cond, &capture_mutex);
+		packet_data.swap(captured_data);
+		packet_size.swap(captured_size);
+		captured_data.clear();
+		captured_size.clear();
+		pthread_mutex_unlock(&capture_mutex);
+	};
+
+	bool isConnected() { return true; };
+	const char* tuio_type() { return "TUIO/CAPTURE"; };
+
+	std::vector<char> packet_data;
+	std::vector<unsigned int> packet_size;
+
+private:
+	std::vector<char> captured_data;
+	std::vector<unsigned int> captured_size;
+	unsigned long frame_count;
+	pthread_mutex_t capture_mutex;
+	pthread_cond_t capture_cond;
+};
+
+// the TuioServer calls refresh() right before the frame is encoded
+class StageListener : public TuioListener {
+public:
+	StageListener():refresh_time(0) {};
+
+	void addTuioObject(TuioObject *tobj) {};
+	void updateTuioObject(TuioObject *tobj) {};
+	void removeTuioObject(TuioObject *tobj) {};
+	void addTuioCursor(TuioCursor *tcur) {};
+	void updateTuioCursor(TuioCursor *tcur) {};
+	void removeTuioCursor(TuioCursor *tcur) {};
+	void addTuioBlob(TuioBlob *tblb) {};
+	void updateTuioBlob(TuioBlob *tblb) {};
+	void removeTuioBlob(TuioBlob *tblb) {};
+
+	void refresh(TuioTime ftime) { refresh_time = getMicroseconds(); };
+
+	long refresh_time;
+};
+
+// computes a FNV-1a digest of the decoded events, the positions are quantized to 1/10000
+// so that the digest only depends on the tracking results and not on the frame timing
+class DigestListener : public TuioListener {
+public:
+	DigestListener(pipeline_result *result):result(result) {
+		result->digest = 14695981039346656037ULL;
+	};
+
+	void addTuioObject(TuioObject *tobj) {
+		result->added[0]++;
+		digestEvent('a', tobj->getSessionID(), tobj->getSymbolID(), tobj->getX(), tobj->getY(), tobj->getAngle());
+	};
+	void updateTuioObject(TuioObject *tobj) {
+		result->updated[0]++;
+		digestEvent('u', tobj->getSessionID(), tobj->getSymbolID(), tobj->getX(), tobj->getY(), tobj->getAngle());
+	};
+	void removeTuioObject(TuioObject *tobj) {
+		result->removed[0]++;
+		digestEvent('r', tobj->getSessionID(), tobj->getSymbolID(), 0, 0, 0);
+	};
+	void addTuioCursor(TuioCursor *tcur) {
+		result->added[1]++;
+		digestEvent('A', tcur->getSessionID(), tcur->getCursorID(), tcur->getX(), tcur->getY(), 0);
+	};
+	void updateTuioCursor(TuioCursor *tcur) {
+		result->updated[1]++;
+		digestEvent('U', tcur->getSessionID(), tcur->getCursorID(), tcur->getX(), tcur->getY(), 0);
+	};
+	void removeTuioCursor(TuioCursor *tcur) {
+		result->removed[1]++;
+		digestEvent('R', tcur->getSessionID(), tcur->getCursorID(), 0, 0, 0);
+	};
+	void addTuioBlob(TuioBlob *tblb) {
+		result->added[2]++;
+		digestEvent('b', tblb->getSessionID(), tblb->getBlobID(), tblb->getX(), tblb->getY(), tblb->getAngle());
+		digestValues(tblb->getWidth(), tblb->getHeight(), tblb->getArea());
+	};
+	void updateTuioBlob(TuioBlob *tblb) {
+		result->updated[2]++;
+		digestEvent('v', tblb->getSessionID(), tblb->getBlobID(), tblb->getX(), tblb->getY(), tblb->getAngle());
+		digestValues(tblb->getWidth(), tblb->getHeight(), tblb->getArea());
+	};
+	void removeTuioBlob(TuioBlob *tblb) {
+		result->removed[2]++;
+		digestEvent('s', tblb->getSessionID(), tblb->getBlobID(), 0, 0, 0);
+	};
+
+	void refresh(TuioTime ftime) { digestValue('f'); };
+
+private:
+	void digestValue(long long value) {
+		for (int i=0;i<8;i++) {
+			result->digest ^= (unsigned char)(value>>(i*8));
+			result->digest *= 1099511628211ULL;
+		}
+	};
+
+	void digestValues(float x, float y, float z) {
+		digestValue((long long)floor(x*10000.0f+0.5f));
+		digestValue((long long)floor(y*10000.0f+0.5f));
+		digestValue((long long)floor(z*10000.0f+0.5f));
+	};
+
+	void digestEvent(char type, long s_id, int id, float x, float y, float a) {
+		digestValue(type);
+		digestValue(s_id);
+		digestValue(id);
+		digestValues(x, y, a);
+	};
+
+	pipeline_result *result;
+};
+
+static bool runPipeline(application_settings *config, const char *source, long frames, bool verbose, int version, pipeline_result *result) {
+
+	CameraConfig cam_cfg;
+	CameraTool::initCameraConfig(&cam_cfg);
+	struct stat info;
+	if (stat(source,&info)!=0) {
+		std::cerr << "could not open " << source << std::endl;
+		return false;
+	}
+	cam_cfg.driver = S_ISDIR(info.st_mode) ? DRIVER_FOLDER : DRIVER_FILE;
+	if (!S_ISDIR(info.st_mode)) {
+		// recordings of the VisionEngine are replayed by their own driver
+		char magic[8] = "";
+		FILE *file = fopen(source,"rb");
+		if (file!=NULL) {
+			if ((fread(magic,1,8,file)==8) && (memcmp(magic,RECORDING_MAGIC,8)==0)) cam_cfg.driver = DRIVER_REPLAY;
+			fclose(file);
+		}
+	}
+	snprintf(cam_cfg.src,256,"%s",source);
+	cam_cfg.color = false;
+	cam_cfg.frame = false;
+	cam_cfg.cam_fps = 0;
+
+	CameraEngine *camera = CameraTool::getCamera(&cam_cfg);
+	if ((camera==NULL) || !camera->initCamera()) {
+		std::cerr << "could not read the frames from " << source << std::endl;
+		if (camera) delete camera;
+		return false;
+	}
+	camera->startCamera();
+
+	// without a frame count each recorded frame is replayed once
+	if (frames<=0) {
+		if (cam_cfg.driver==DRIVER_FOLDER) frames = ((FolderCamera*)camera)->getFrameCount();
+		else if (cam_cfg.driver==DRIVER_REPLAY) frames = ((ReplayCamera*)camera)->getFrameCount();
+		else frames = 1;
+	}
+
+	int width = camera->getWidth();
+	int height = camera->getHeight();
+	int format = camera->getFormat();
+	int size = width*height*format;
+
+	CaptureSender *sender = new CaptureSender();
+	sender->setTuioVersion(version);
+	TuioServer *server = new TuioServer(sender);
+	server->setSourceName(config->tuio_source);
+	server->setInversion(config->invert_x, config->invert_y, config->invert_a);
+	StageListener *stage = new StageListener();
+	server->addTuioListener(stage);
+
+	TuioBenchClient *client = new TuioBenchClient();
+	DigestListener *digest = new DigestListener(result);
+	client->addTuioListener(digest);
+
+	FrameProcessor *thresholder = NULL;
+	if (strcmp(config->threshold_type, "br") == 0)
+		thresholder = new FrameThresholderBR(config->threshold_size, config->threshold_gradient / 100.0f, config->threshold_contrast, config->thread_count);
+	else
+		thresholder = new FrameThresholder(config->threshold_gradient, config->threshold_size, config->thread_count);
+	FrameProcessor *fiducialfinder = new FidtrackFinder(server, config);
+
+	HeadlessInterface *uiface = new HeadlessInterface();
+	bool success = thresholder->init(width, height, format, format) && fiducialfinder->init(width, height, format, format);
+	thresholder->addUserInterface(uiface);
+	fiducialfinder->addUserInterface(uiface);
+
+	unsigned char *source_buffer = new unsigned char[size];
+	unsigned char *dest_buffer = new unsigned char[size];
+
+	printf("%s  %dx%d %s, %s threshold, %d threads, TUIO %s\n", source, width, height, (format==FORMAT_GRAY) ? "gray" : "rgb", config->threshold_type, config->thread_count, (version==TUIO_VERSION_20) ? "2.0" : "1.1");
+
+	long start = getMicroseconds();
+	for (long i=0;(i<frames) && success;i++) {
+
+		// the frame is copied as the VisionEngine does from its ring buffer
+		long camera_start = getMicroseconds();
+		unsigned char *frame = camera->getFrame();
+		if (frame==NULL) break;
+		memcpy(source_buffer, frame, size);
+		if (camera->sharesFrames()) camera->releaseFrame(frame);
+
+		long threshold_start = getMicroseconds();
+		thresholder->process(source_buffer, dest_buffer);
+		long tracking_start = getMicroseconds();
+		fiducialfinder->process(source_buffer, dest_buffer);
+		// the encoding includes the delivery of the frame, which follows the empty initial frame of the server
+		sender->waitFrames(i+2);
+		long frame_end = getMicroseconds();
+
+		addTime(&result->camera, threshold_start-camera_start);
+		addTime(&result->threshold, tracking_start-threshold_start);
+		addTime(&result->tracking, stage->refresh_time-tracking_start);
+		addTime(&result->encoding, frame_end-stage->refresh_time);
+		result->frames++;
+
+		unsigned int offset = 0;
+		for (unsigned int j=0;j<sender->packet_size.size();j++) {
+			client->processPacket(&sender->packet_data[offset], sender->packet_size[j]);
+			offset += sender->packet_size[j];
+			result->bytes += sender->packet_size[j];
+			result->packets++;
+		}
+
+		if (verbose) printf("frame %ld  %d obj %d cur %d blb  digest %016llx\n", i, (int)server->getTuioObjects().size(), (int)server->getTuioCursors().size(), (int)server->getTuioBlobs().size(), result->digest);
+	}
+	result->seconds = (getMicroseconds()-start)/1000000.0;
+
+	camera->stopCamera();
+	camera->closeCamera();
+	delete camera;
+
+	delete thresholder;
+	delete fiducialfinder;
+	delete server;
+	delete stage;
+	delete client;
+	delete digest;
+	delete uiface;
+	delete[] source_buffer;
+	delete[] dest_buffer;
+	return success;
+}
+
+static void printStage(const char *name, stage_time *stage, long frames) {
+	printf("  %-9s %.3f ms/frame, max %.3f ms\n", name, stage->total/frames/1000.0, stage->max/1000.0);
+}
+
+static void printResult(pipeline_result *result) {
+
+	if (result->frames==0) return;
+	double pipeline = (result->camera.total+result->threshold.total+result->tracking.total+result->encoding.total)/1000000.0;
+
+	printf("  frames    %ld, %.1f fps pipeline, %.1f fps including decoding\n", result->frames, result->frames/pipeline, result->frames/result->seconds);
+	printStage("camera", &result->camera, result->frames);
+	printStage("threshold", &result->threshold, result->frames);
+	printStage("tracking", &result->tracking, result->frames);
+	printStage("encoding", &result->encoding, result->frames);
+	printf("  packets   %lu, %.1f kB\n", result->packets, result->bytes/1024.0);
+	printf("  objects   %lu added, %lu updated, %lu removed\n", result->added[0], result->updated[0], result->removed[0]);
+	printf("  cursors   %lu added, %lu updated, %lu removed\n", result->added[1], result->updated[1], result->removed[1]);
+	printf("  blobs     %lu added, %lu updated, %lu removed\n", result->added[2], result->updated[2], result->removed[2]);
+	printf("  digest    %016llx\n", result->digest);
+}
+
+static void printUsage() {
+	std::cout << "usage: pipelinebench [options] source" << std::endl;
+	std::cout << "\tsource\t\t\ta folder of PGM/PPM frames, a single frame or a recording" << std::endl;
+	std::cout << "\t-n frames\t\tnumber of replayed frames, defaults to one pass" << std::endl;
+	std::cout << "\t-t br|tb\t\tBradley-Roth or tiled Bernsen threshold" << std::endl;
+	std::cout << "\t-g gradient\t\tthreshold gradient or bias" << std::endl;
+	std::cout << "\t-s size\t\t\tthreshold tile or window size" << std::endl;
+	std::cout << "\t-k contrast\t\tthreshold minimum contrast" << std::endl;
+	std::cout << "\t-j threads\t\tthreshold threads" << std::endl;
+	std::cout << "\t-a trees\t\tamoeba tree set, default, small, mini or a .trees file" << std::endl;
+	std::cout << "\t-f size\t\t\tfinger size, 0 disables the finger tracking" << std::endl;
+	std::cout << "\t-b size\t\t\tmaximum blob size, 0 disables the blob tracking" << std::endl;
+	std::cout << "\t-m id\t\t\tmaximum fiducial ID, 0 disables the limit" << std::endl;
+	std::cout << "\t-y\t\t\tdetect yamaarashi fiducials" << std::endl;
+	std::cout << "\t-2\t\t\tencode TUIO 2.0 instead of TUIO 1.1" << std::endl;
+	std::cout << "\t-v\t\t\tprint the digest of each frame" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+	// the same defaults as the reacTIVision configuration, without a fiducial ID limit
+	application_settings config;
+	snprintf(config.file,1024,"%s","none");
+	snprintf(config.tuio_source,1024,"%s","rtv");
+	snprintf(config.tree_config,1024,"%s","default");
+	snprintf(config.grid_config,1024,"%s","none");
+	snprintf(config.camera_config,1024,"%s","default");
+	config.invert_x = false;
+	config.invert_y = false;
+	config.invert_a = false;
+	config.yamaarashi = false;
+	config.yama_flip = false;
+	config.max_fid = 0;
+	config.roi_search = false;
+	config.obj_filter = false;
+	config.cur_filter = false;
+	config.blb_filter = false;
+	config.motion_filter = false;
+	config.background = false;
+	config.fullscreen = false;
+	config.headless = true;
+	config.finger_size = 0;
+	config.finger_sensitivity = 100;
+	config.finger_contrast = 16;
+	config.max_blob_size = 0;
+	config.min_blob_size = 0;
+	config.object_blobs = false;
+	config.cursor_blobs = false;
+	config.threshold_gradient = 32;
+	config.threshold_size = 10;
+	config.threshold_contrast = 20;
+	config.thread_count = 1;
+	snprintf(config.threshold_type, 4, "br");
+	config.display_mode = 0;
+
+	const char *source = NULL;
+	long frames = 0;
+	bool verbose = false;
+	int version = TUIO_VERSION_11;
+
+	for (int i=1;i<argc;i++) {
+		bool value = (i+1<argc);
+		if ((strcmp(argv[i],"-n")==0) && value) frames = atol(argv[++i]);
+		else if ((strcmp(argv[i],"-t")==0) && value) snprintf(config.threshold_type,4,"%s",argv[++i]);
+		else if ((strcmp(argv[i],"-g")==0) && value) config.threshold_gradient = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-s")==0) && value) config.threshold_size = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-k")==0) && value) config.threshold_contrast = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-j")==0) && value) config.thread_count = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-a")==0) && value) snprintf(config.tree_config,1024,"%s",argv[++i]);
+		else if ((strcmp(argv[i],"-f")==0) && value) config.finger_size = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-b")==0) && value) config.max_blob_size = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-m")==0) && value) config.max_fid = atoi(argv[++i]);
+		else if (strcmp(argv[i],"-y")==0) config.yamaarashi = true;
+		else if (strcmp(argv[i],"-2")==0) version = TUIO_VERSION_20;
+		else if (strcmp(argv[i],"-v")==0) verbose = true;
+		else if ((argv[i][0]!='-') && (source==NULL)) source = argv[i];
+		else {
+			printUsage();
+			return 0;
+		}
+	}
+
+	if (source==NULL) {
+		printUsage();
+		return 0;
+	}
+
+	TuioTime::initSession();
+
+	pipeline_result result;
+	memset(&result, 0, sizeof(pipeline_result));
+	if (!runPipeline(&config, source, frames, verbose, version, &result)) return 1;
+	printResult(&result);
+	return 0;
+}
@@ -0,0 +1,522 @@
+/*  reacTIVision tangible interaction framework
+	Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// The TUIO loopback benchmark generates a synthetic scene of moving objects, cursors and blobs,
+// which is encoded by a TuioServer and delivered by one of the OscSender types over the loopback
+// interface to an embedded TuioBenchClient. It reports the packet and byte rates, the encoding
+// and decoding times as well as the end-to-end latency from the frame commit to the decoded frame.
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+
+#include "TuioServer.h"
+#include "TuioBenchClient.h"
+
+#define MAX_BENCH_FRAMES 65536
+#define MAX_BENCH_PACKET 262144
+
+struct bench_settings {
+	char transport[16];
+	int objects;
+	int cursors;
+	int blobs;
+	int fps;
+	int duration;
+	int port;
+	int version;
+	float rate;
+	bool verify;
+};
+
+struct bench_result {
+	long frames;
+	long received;
+	long dropped;
+	unsigned long packets;
+	unsigned long bytes;
+	unsigned long messages;
+	unsigned long malformed;
+	long wrong_time;
+	double encode_time;
+	double decode_time;
+	double seconds;
+	std::vector<double> latency;
+};
+
+static long getMicroseconds(TuioTime time) {
+	return time.getSeconds()*1000000 + time.getMicroseconds();
+}
+
+static long getMicroseconds() {
+	return getMicroseconds(TuioTime::getSystemTime());
+}
+
+// records the arrival time of the last decoded part of each frame, and the time of its TUIO 2.0 frame message
+class BenchListener : public TuioListener {
+public:
+	BenchListener(TuioBenchClient *client, long *receive_time, long *decoded_time):client(client),receive_time(receive_time),decoded_time(decoded_time) {};
+
+	void addTuioObject(TuioObject *tobj) {};
+	void updateTuioObject(TuioObject *tobj) {};
+	void removeTuioObject(TuioObject *tobj) {};
+	void addTuioCursor(TuioCursor *tcur) {};
+	void updateTuioCursor(TuioCursor *tcur) {};
+	void removeTuioCursor(TuioCursor *tcur) {};
+	void addTuioBlob(TuioBlob *tblb) {};
+	void updateTuioBlob(TuioBlob *tblb) {};
+	void removeTuioBlob(TuioBlob *tblb) {};
+
+	void refresh(TuioTime ftime) {
+		long fseq = client->getFrameID();
+		if (fseq>0) {
+			receive_time[fseq%MAX_BENCH_FRAMES] = getMicroseconds();
+			decoded_time[fseq%MAX_BENCH_FRAMES] = getMicroseconds(client->getFrameTimeTag());
+		}
+	};
+
+private:
+	TuioBenchClient *client;
+	long *receive_time;
+	long *decoded_time;
+};
+
+// the receiving end of the loopback connection
+class BenchReceiver {
+public:
+	BenchReceiver(bench_settings *settings, bench_result *result, long *receive_time, long *decoded_time)
+		:settings(settings),result(result),receive_socket(-1),running(false) {
+		client = new TuioBenchClient();
+		listener = new BenchListener(client, receive_time, decoded_time);
+		client->addTuioListener(listener);
+		buffer = new char[MAX_BENCH_PACKET];
+	};
+
+	~BenchReceiver() {
+		stop();
+		delete client;
+		delete listener;
+		delete[] buffer;
+	};
+
+	bool open() {
+		struct sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_port = htons(settings->port);
+		address.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+		if (strcmp(settings->transport,"udp")==0) {
+			receive_socket = socket(AF_INET, SOCK_DGRAM, 0);
+			int size = 4*1024*1024;
+			setsockopt(receive_socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+			if (bind(receive_socket, (struct sockaddr*)&address, sizeof(address))<0) {
+				std::cerr << "could not bind the UDP receiver to port " << settings->port << std::endl;
+				return false;
+			}
+		} else {
+			// the TCP and WebSocket senders are running in host mode
+			receive_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+			if (connect(receive_socket, (struct sockaddr*)&address, sizeof(address))<0) {
+				std::cerr << "could not connect the " << settings->transport << " receiver to port " << settings->port << std::endl;
+				return false;
+			}
+			if ((strcmp(settings->transport,"web")==0) && !webHandshake()) return false;
+		}
+
+		struct timeval timeout;
+		timeout.tv_sec = 0;
+		timeout.tv_usec = 100000;
+		setsockopt(receive_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		running = true;
+		pthread_create(&thread, NULL, ReceiveThreadFunc, this);
+		return true;
+	};
+
+	void stop() {
+		if (running) {
+			running = false;
+			pthread_join(thread, NULL);
+		}
+		if (receive_socket>=0) close(receive_socket);
+		receive_socket = -1;
+	};
+
+private:
+	bool webHandshake() {
+		const char *request = "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+		if (send(receive_socket, request, strlen(request), 0)<0) return false;
+
+		std::string response;
+		while (response.find("\r\n\r\n")==std::string::npos) {
+			int bytes = recv(receive_socket, buffer, MAX_BENCH_PACKET, 0);
+			if (bytes<=0) return false;
+			response.append(buffer, bytes);
+		}
+		if (response.find(" 101 ")==std::string::npos) {
+			std::cerr << "websocket handshake failed" << std::endl;
+			return false;
+		}
+		pending.assign(response, response.find("\r\n\r\n")+4, std::string::npos);
+		return true;
+	};
+
+	void decode(const char *data, int size) {
+		long start = getMicroseconds();
+		if (!client->processPacket(data, size)) result->malformed++;
+		result->decode_time += getMicroseconds()-start;
+		result->packets++;
+	};
+
+	// extracts the OSC packets from the TCP or WebSocket stream
+	void decodeStream() {
+		unsigned int offset = 0;
+		while (offset<pending.size()) {
+			const unsigned char *header = (const unsigned char*)&pending[offset];
+			unsigned int available = (unsigned int)pending.size()-offset;
+			unsigned int header_size = 0;
+			unsigned long long size = 0;
+
+			if (strcmp(settings->transport,"tcp")==0) {
+				if (available<4) break;
+				size = ((unsigned int)header[0]<<24) | ((unsigned int)header[1]<<16) | ((unsigned int)header[2]<<8) | header[3];
+				header_size = 4;
+			} else {
+				if (available<2) break;
+				size = header[1] & 0x7F;
+				header_size = 2;
+				if (size==126) {
+					if (available<4) break;
+					size = (header[2]<<8) | header[3];
+					header_size = 4;
+				} else if (size==127) {
+					if (available<10) break;
+					size = 0;
+					for (int i=2;i<10;i++) size = (size<<8) | header[i];
+					header_size = 10;
+				}
+			}
+
+			if (available<header_size+size) break;
+			decode((const char*)header+header_size, (int)size);
+			offset += header_size+(unsigned int)size;
+		}
+		pending.erase(0, offset);
+	};
+
+	void receive() {
+		while (running) {
+			int bytes = recv(receive_socket, buffer, MAX_BENCH_PACKET, 0);
+			if (bytes<=0) continue;
+			result->bytes += bytes;
+
+			if (strcmp(settings->transport,"udp")==0) decode(buffer, bytes);
+			else {
+				pending.append(buffer, bytes);
+				decodeStream();
+			}
+		}
+		result->messages = client->getMessageCount();
+	};
+
+	static void* ReceiveThreadFunc( void *obj ) {
+		static_cast<BenchReceiver*>(obj)->receive();
+		return 0;
+	};
+
+	bench_settings *settings;
+	bench_result *result;
+	TuioBenchClient *client;
+	BenchListener *listener;
+	int receive_socket;
+	char *buffer;
+	std::string pending;
+	pthread_t thread;
+	volatile bool running;
+};
+
+static OscSender* createSender(bench_settings *settings) {
+
+	OscSender *sender = NULL;
+	try {
+		if (strcmp(settings->transport,"udp")==0) sender = new UdpSender("127.0.0.1", settings->port);
+		else if (strcmp(settings->transport,"tcp")==0) sender = new TcpSender(settings->port);
+		else if (strcmp(settings->transport,"web")==0) sender = new WebSockSender(settings->port);
+	} catch (std::exception &e) { return NULL; }
+
+	if (sender) {
+		sender->setTuioVersion(settings->version);
+		sender->setUpdateRate(settings->rate);
+	}
+	return sender;
+}
+
+static bool runBenchmark(bench_settings *settings, bench_result *result) {
+
+	long *commit_time = new long[MAX_BENCH_FRAMES];
+	long *receive_time = new long[MAX_BENCH_FRAMES];
+	long *frame_time = new long[MAX_BENCH_FRAMES];
+	long *decoded_time = new long[MAX_BENCH_FRAMES];
+	memset(commit_time, 0, MAX_BENCH_FRAMES*sizeof(long));
+	memset(receive_time, 0, MAX_BENCH_FRAMES*sizeof(long));
+	memset(frame_time, 0, MAX_BENCH_FRAMES*sizeof(long));
+	memset(decoded_time, 0, MAX_BENCH_FRAMES*sizeof(long));
+
+	BenchReceiver *receiver = new BenchReceiver(settings, result, receive_time, decoded_time);
+	OscSender *sender = NULL;
+
+	// the datagram receiver needs to be bound before the sender starts, the stream receivers connect to the sender
+	if (strcmp(settings->transport,"udp")==0) {
+		if (receiver->open()) sender = createSender(settings);
+	} else {
+		sender = createSender(settings);
+		if (sender && !receiver->open()) {
+			delete sender;
+			sender = NULL;
+		}
+		for (int i=0;(i<100) && sender && !sender->isConnected();i++) usleep(10000);
+	}
+
+	if (sender==NULL) {
+		delete receiver;
+		delete[] commit_time;
+		delete[] receive_time;
+		delete[] frame_time;
+		delete[] decoded_time;
+		return false;
+	}
+
+	TuioServer *server = new TuioServer(sender);
+	server->setSourceName("tuiobench", "127.0.0.1");
+
+	std::vector<TuioObject*> objects;
+	std::vector<TuioCursor*> cursors;
+	std::vector<TuioBlob*> blobs;
+
+	long frame_interval = (settings->fps>0) ? 1000000/settings->fps : 0;
+	long start = getMicroseconds();
+	long next_frame = start;
+	long end = start + (long)settings->duration*1000000;
+
+	while (getMicroseconds()<end) {
+		float t = (getMicroseconds()-start)/1000000.0f;
+		TuioTime now = TuioTime::getSystemTime();
+		server->initFrame(now);
+		frame_time[server->getFrameID()%MAX_BENCH_FRAMES] = getMicroseconds(now);
+
+		// all components are moving along individual circles
+		for (int i=0;i<settings->objects;i++) {
+			float phase = i*0.7f;
+			float x = 0.5f + 0.4f*cosf(t+phase);
+			float y = 0.5f + 0.4f*sinf(t+phase);
+			float a = fmodf(t+phase, 2.0f*(float)M_PI);
+			if (objects.size()<(unsigned int)settings->objects) objects.push_back(server->addTuioObject(i, x, y, a));
+			else server->updateTuioObject(objects[i], x, y, a);
+		}
+		for (int i=0;i<settings->cursors;i++) {
+			float phase = i*1.3f;
+			float x = 0.5f + 0.3f*cosf(2.0f*t+phase);
+			float y = 0.5f + 0.3f*sinf(2.0f*t+phase);
+			if (cursors.size()<(unsigned int)settings->cursors) cursors.push_back(server->addTuioCursor(x, y));
+			else server->updateTuioCursor(cursors[i], x, y);
+		}
+		for (int i=0;i<settings->blobs;i++) {
+			float phase = i*2.1f;
+			float x = 0.5f + 0.2f*cosf(0.5f*t+phase);
+			float y = 0.5f + 0.2f*sinf(0.5f*t+phase);
+			float a = fmodf(t+phase, 2.0f*(float)M_PI);
+			if (blobs.size()<(unsigned int)settings->blobs) blobs.push_back(server->addTuioBlob(x, y, a, 0.1f, 0.05f, 0.004f));
+			else server->updateTuioBlob(blobs[i], x, y, a, 0.1f, 0.05f, 0.004f);
+		}
+
+		long commit_start = getMicroseconds();
+		commit_time[server->getFrameID()%MAX_BENCH_FRAMES] = commit_start;
+		server->commitFrame();
+		result->encode_time += getMicroseconds()-commit_start;
+		result->frames++;
+
+		if (frame_interval>0) {
+			next_frame += frame_interval;
+			long wait = next_frame-getMicroseconds();
+			if (wait>0) usleep(wait);
+			else next_frame = getMicroseconds();
+		}
+	}
+	result->seconds = (getMicroseconds()-start)/1000000.0;
+
+	// allow the remaining packets to arrive before the receiver is stopped
+	usleep(200000);
+	long last_frame = server->getFrameID();
+	result->dropped = server->getDroppedFrames();
+	delete server;
+	receiver->stop();
+	delete receiver;
+
+	long first_frame = std::max(1L, last_frame-MAX_BENCH_FRAMES+1);
+	for (long fseq=first_frame;fseq<=last_frame;fseq++) {
+		long sent = commit_time[fseq%MAX_BENCH_FRAMES];
+		long received = receive_time[fseq%MAX_BENCH_FRAMES];
+		if ((sent>0) && (received>=sent)) {
+			result->received++;
+			result->latency.push_back((received-sent)/1000.0);
+			// the frame message carries the absolute frame time, within the rounding of the OSC time tag
+			long error = decoded_time[fseq%MAX_BENCH_FRAMES]-frame_time[fseq%MAX_BENCH_FRAMES];
+			if ((settings->version==TUIO_VERSION_20) && ((error<-1) || (error>1))) result->wrong_time++;
+		}
+	}
+
+	delete[] commit_time;
+	delete[] receive_time;
+	delete[] frame_time;
+	delete[] decoded_time;
+	return true;
+}
+
+static double percentile(std::vector<double> &values, double p) {
+	if (values.size()==0) return 0.0;
+	unsigned int index = (unsigned int)(p*(values.size()-1)+0.5);
+	return values[index];
+}
+
+static void printResult(bench_settings *settings, bench_result *result) {
+
+	std::sort(result->latency.begin(), result->latency.end());
+	double seconds = (result->seconds>0) ? result->seconds : 1.0;
+
+	printf("%-4s TUIO %s  %d obj %d cur %d blb\n", settings->transport, (settings->version==TUIO_VERSION_20) ? "2.0" : "1.1", settings->objects, settings->cursors, settings->blobs);
+	printf("  frames    %ld sent, %ld received, %.1f fps\n", result->frames, result->received, result->frames/seconds);
+	printf("  traffic   %.0f packets/s, %.1f kB/s, %.0f messages/s\n", result->packets/seconds, result->bytes/seconds/1024.0, result->messages/seconds);
+	printf("  encode    %.1f us/frame\n", (result->frames>0) ? result->encode_time/result->frames : 0.0);
+	printf("  decode    %.1f us/packet\n", (result->packets>0) ? result->decode_time/result->packets : 0.0);
+	printf("  latency   p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n", percentile(result->latency,0.5), percentile(result->latency,0.9), percentile(result->latency,0.99), percentile(result->latency,1.0));
+	if (result->dropped>0) printf("  dropped   %ld frames by the server\n", result->dropped);
+	if (result->malformed>0) printf("  malformed %lu packets\n", result->malformed);
+	if (result->wrong_time>0) printf("  frm time  %ld frames with a wrong frame time\n", result->wrong_time);
+}
+
+// TUIO clients treat the frame ID 0 as an immediate update, therefore only the following frames are expected,
+// except for the few frames the server drops when its delivery thread is not scheduled in time
+static bool verifyResult(bench_settings *settings, bench_result *result) {
+
+	bool valid = true;
+	long lost = result->frames-1-result->received;
+	if (lost>result->dropped) {
+		printf("  error     %ld frames lost\n", lost-result->dropped);
+		valid = false;
+	}
+	if (result->dropped*10>result->frames) {
+		printf("  error     %ld frames dropped by the server\n", result->dropped);
+		valid = false;
+	}
+	if (result->malformed>0) {
+		printf("  error     %lu malformed packets\n", result->malformed);
+		valid = false;
+	}
+	if (result->wrong_time>0) {
+		printf("  error     %ld frames with a wrong frame time\n", result->wrong_time);
+		valid = false;
+	}
+	return valid;
+}
+
+static void printUsage() {
+	std::cout << "usage: tuiobench [options]" << std::endl;
+	std::cout << "\t-t udp|tcp|web|all\ttransport type, defaults to all" << std::endl;
+	std::cout << "\t-o count\t\tnumber of objects" << std::endl;
+	std::cout << "\t-c count\t\tnumber of cursors" << std::endl;
+	std::cout << "\t-b count\t\tnumber of blobs" << std::endl;
+	std::cout << "\t-f fps\t\t\tframes per second, 0 runs unthrottled" << std::endl;
+	std::cout << "\t-d seconds\t\tduration of each run" << std::endl;
+	std::cout << "\t-p port\t\t\tfirst loopback port" << std::endl;
+	std::cout << "\t-r rate\t\t\tsender update rate limit" << std::endl;
+	std::cout << "\t-2\t\t\tsend TUIO 2.0 instead of TUIO 1.1" << std::endl;
+	std::cout << "\t-v\t\t\tfail unless all frames not dropped by the server are received intact" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+	bench_settings settings;
+	snprintf(settings.transport,16,"%s","all");
+	settings.objects = 20;
+	settings.cursors = 10;
+	settings.blobs = 10;
+	settings.fps = 60;
+	settings.duration = 5;
+	settings.port = 3333;
+	settings.version = TUIO_VERSION_11;
+	settings.rate = 0.0f;
+	settings.verify = false;
+
+	for (int i=1;i<argc;i++) {
+		bool value = (i+1<argc);
+		if ((strcmp(argv[i],"-t")==0) && value) snprintf(settings.transport,16,"%s",argv[++i]);
+		else if ((strcmp(argv[i],"-o")==0) && value) settings.objects = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-c")==0) && value) settings.cursors = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-b")==0) && value) settings.blobs = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-f")==0) && value) settings.fps = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-d")==0) && value) settings.duration = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-p")==0) && value) settings.port = atoi(argv[++i]);
+		else if ((strcmp(argv[i],"-r")==0) && value) settings.rate = (float)atof(argv[++i]);
+		else if (strcmp(argv[i],"-2")==0) settings.version = TUIO_VERSION_20;
+		else if (strcmp(argv[i],"-v")==0) settings.verify = true;
+		else {
+			printUsage();
+			return 0;
+		}
+	}
+
+	const char *transports[] = { "udp", "tcp", "web" };
+	TuioTime::initSession();
+
+	int port = settings.port;
+	int failed = 0;
+	for (int i=0;i<3;i++) {
+		if ((strcmp(settings.transport,"all")!=0) && (strcmp(settings.transport,transports[i])!=0)) continue;
+
+		bench_settings run = settings;
+		snprintf(run.transport,16,"%s",transports[i]);
+		run.port = port++;
+
+		bench_result result;
+		result.frames = result.received = result.dropped = 0;
+		result.packets = result.bytes = result.messages = result.malformed = 0;
+		result.wrong_time = 0;
+		result.encode_time = result.decode_time = result.seconds = 0.0;
+
+		if (runBenchmark(&run, &result)) {
+			printResult(&run, &result);
+			if (run.verify && !verifyResult(&run, &result)) failed++;
+		} else {
+			std::cerr << "could not run the " << run.transport << " benchmark" << std::endl;
+			failed++;
+		}
+	}
+
+	return (failed>0) ? 1 : 0;
+}
@@ -0,0 +1,362 @@
+/*  reacTIVision tangible interaction framework
+	Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "TuioBenchClient.h"
+#include <algorithm>
+#include <cstring>
+
+TuioBenchClient::TuioBenchClient()
+	:currentFrame	(-1)
+	,committedFrame	(-1)
+	,receivedFrame	(-1)
+	,messageCount	(0)
+{
+	frameTime = TuioTime::getSessionTime();
+}
+
+TuioBenchClient::~TuioBenchClient() {
+
+	for (std::list<TuioObject*>::iterator iter=objectList.begin(); iter!=objectList.end(); iter++) delete (*iter);
+	for (std::list<TuioCursor*>::iterator iter=cursorList.begin(); iter!=cursorList.end(); iter++) delete (*iter);
+	for (std::list<TuioBlob*>::iterator iter=blobList.begin(); iter!=blobList.end(); iter++) delete (*iter);
+}
+
+bool TuioBenchClient::processPacket(const char *data, int size) {
+
+	try {
+		osc::ReceivedPacket packet(data, size);
+		if (packet.IsBundle()) processBundle(osc::ReceivedBundle(packet));
+		else processMessage(osc::ReceivedMessage(packet));
+	} catch (osc::Exception &e) {
+		return false;
+	}
+	return true;
+}
+
+void TuioBenchClient::processBundle(const osc::ReceivedBundle &bundle) {
+
+	// batching senders deliver the bundles of a frame within a nested bundle
+	for (osc::ReceivedBundle::const_iterator element=bundle.ElementsBegin(); element!=bundle.ElementsEnd(); element++) {
+		if (element->IsBundle()) processBundle(osc::ReceivedBundle(*element));
+		else processMessage(osc::ReceivedMessage(*element));
+	}
+}
+
+void TuioBenchClient::processMessage(const osc::ReceivedMessage &message) {
+
+	messageCount++;
+	const char *address = message.AddressPattern();
+	if (strcmp(address,"/tuio/2Dobj")==0) processObjectMessage(message);
+	else if (strcmp(address,"/tuio/2Dcur")==0) processCursorMessage(message);
+	else if (strcmp(address,"/tuio/2Dblb")==0) processBlobMessage(message);
+	else if (strcmp(address,"/tuio2/frm")==0) processFrameMessage(message);
+	else if (strcmp(address,"/tuio2/tok")==0) processTokenMessage(message);
+	else if (strcmp(address,"/tuio2/ptr")==0) processPointerMessage(message);
+	else if (strcmp(address,"/tuio2/bnd")==0) processBoundsMessage(message);
+	else if (strcmp(address,"/tuio2/alv")==0) processFrameAliveMessage(message);
+}
+
+bool TuioBenchClient::acceptFrame(long fseq) {
+
+	// the same rules as the TuioClient: repeated frame IDs belong to split bundles,
+	// while older frames are late unless the sequence has been restarted
+	if (fseq>0) {
+		if (fseq>currentFrame) frameTime = TuioTime::getSessionTime();
+		if ((fseq>=currentFrame) || ((currentFrame-fseq)>100)) currentFrame = fseq;
+		else return false;
+	} else frameTime = TuioTime::getSessionTime();
+	committedFrame = fseq;
+	return true;
+}
+
+void TuioBenchClient::readAliveList(const osc::ReceivedMessage &message, bool command, std::vector<long> &aliveList) {
+
+	aliveList.clear();
+	osc::ReceivedMessage::const_iterator arg = message.ArgumentsBegin();
+	if (command) arg++;
+	for (; arg!=message.ArgumentsEnd(); arg++) aliveList.push_back(arg->AsInt32());
+	std::sort(aliveList.begin(),aliveList.end());
+}
+
+void TuioBenchClient::processObjectMessage(const osc::ReceivedMessage &message) {
+
+	osc::ReceivedMessageArgumentStream args = message.ArgumentStream();
+	const char *command;
+	args >> command;
+
+	if (strcmp(command,"set")==0) {
+		osc::int32 s_id, c_id;
+		BenchEntity entity;
+		args >> s_id >> c_id >> entity.x >> entity.y >> entity.a >> entity.xs >> entity.ys >> entity.rs >> entity.ma >> entity.ra >> osc::EndMessage;
+		entity.s_id = s_id;
+		entity.id = c_id;
+		frameObjects.push_back(entity);
+	} else if (strcmp(command,"alive")==0) {
+		readAliveList(message, true, aliveObjects);
+		frameObjects.clear();
+	} else if (strcmp(command,"fseq")==0) {
+		osc::int32 fseq;
+		args >> fseq >> osc::EndMessage;
+		if (acceptFrame(fseq)) {
+			commitObjects(aliveObjects);
+			refresh();
+		} else frameObjects.clear();
+	}
+}
+
+void TuioBenchClient::processCursorMessage(const osc::ReceivedMessage &message) {
+
+	osc::ReceivedMessageArgumentStream args = message.ArgumentStream();
+	const char *command;
+	args >> command;
+
+	if (strcmp(command,"set")==0) {
+		osc::int32 s_id;
+		BenchEntity entity;
+		args >> s_id >> entity.x >> entity.y >> entity.xs >> entity.ys >> entity.ma >> osc::EndMessage;
+		entity.s_id = s_id;
+		entity.id = -1;
+		frameCursors.push_back(entity);
+	} else if (strcmp(command,"alive")==0) {
+		readAliveList(message, true, aliveCursors);
+		frameCursors.clear();
+	} else if (strcmp(command,"fseq")==0) {
+		osc::int32 fseq;
+		args >> fseq >> osc::EndMessage;
+		if (acceptFrame(fseq)) {
+			commitCursors(aliveCursors);
+			refresh();
+		} else frameCursors.clear();
+	}
+}
+
+void TuioBenchClient::processBlobMessage(const osc::ReceivedMessage &message) {
+
+	osc::ReceivedMessageArgumentStream args = message.ArgumentStream();
+	const char *command;
+	args >> command;
+
+	if (strcmp(command,"set")==0) {
+		osc::int32 s_id;
+		BenchEntity entity;
+		args >> s_id >> entity.x >> entity.y >> entity.a >> entity.w >> entity.h >> entity.f >> entity.xs >> entity.ys >> entity.rs >> entity.ma >> entity.ra >> osc::EndMessage;
+		entity.s_id = s_id;
+		entity.id = -1;
+		frameBlobs.push_back(entity);
+	} else if (strcmp(command,"alive")==0) {
+		readAliveList(message, true, aliveBlobs);
+		frameBlobs.clear();
+	} else if (strcmp(command,"fseq")==0) {
+		osc::int32 fseq;
+		args >> fseq >> osc::EndMessage;
+		if (acceptFrame(fseq)) {
+			commitBlobs(aliveBlobs);
+			refresh();
+		} else frameBlobs.clear();
+	}
+}
+
+void TuioBenchClient::processFrameMessage(const osc::ReceivedMessage &message) {
+
+	osc::ReceivedMessageArgumentStream args = message.ArgumentStream();
+	osc::int32 fseq;
+	osc::TimeTag ttag;
+	args >> fseq >> ttag;
+	receivedFrame = fseq;
+
+	// the OSC time tag counts the seconds since 1900 and the fraction of a second in units of 2^-32
+	long seconds = (long)((ttag.value>>32) - 2208988800ULL);
+	long micros = (long)((ttag.value & 0xFFFFFFFFULL)/4294.967296 + 0.5);
+	frameTimeTag = TuioTime(seconds, micros);
+	frameObjects.clear();
+	frameCursors.clear();
+	frameBlobs.clear();
+}
+
+void TuioBenchClient::processTokenMessage(const osc::ReceivedMessage &message) {
+
+	osc::ReceivedMessageArgumentStream args = message.ArgumentStream();
+	osc::int32 s_id, tu_id, c_id;
+	BenchEntity entity;
+	args >> s_id >> tu_id >> c_id >> entity.x >> entity.y >> entity.a >> entity.xs >> entity.ys >> entity.rs >> entity.ma >> entity.ra >> osc::EndMessage;
+	entity.s_id = s_id;
+	entity.id = c_id;
+	frameObjects.push_back(entity);
+}
+
+void TuioBenchClient::processPointerMessage(const osc::ReceivedMessage &message) {
+
+	osc::ReceivedMessageArgumentStream args = message.ArgumentStream();
+	osc::int32 s_id, tu_id, c_id;
+	float shear, radius, press, pspeed, paccel;
+	BenchEntity entity;
+	args >> s_id >> tu_id >> c_id >> entity.x >> entity.y >> entity.a >> shear >> radius >> press >> entity.xs >> entity.ys >> pspeed >> entity.ma >> paccel >> osc::EndMessage;
+	entity.s_id = s_id;
+	entity.id = c_id;
+	frameCursors.push_back(entity);
+}
+
+void TuioBenchClient::processBoundsMessage(const osc::ReceivedMessage &message) {
+
+	osc::ReceivedMessageArgumentStream args = message.ArgumentStream();
+	osc::int32 s_id;
+	BenchEntity entity;
+	args >> s_id >> entity.x >> entity.y >> entity.a >> entity.w >> entity.h >> entity.f >> entity.xs >> entity.ys >> entity.rs >> entity.ma >> entity.ra >> osc::EndMessage;
+	entity.s_id = s_id;
+	entity.id = -1;
+	frameBlobs.push_back(entity);
+}
+
+void TuioBenchClient::processFrameAliveMessage(const osc::ReceivedMessage &message) {
+
+	// the alive list concludes each TUIO 2.0 bundle and is shared by all components
+	if (!acceptFrame(receivedFrame)) {
+		frameObjects.clear();
+		frameCursors.clear();
+		frameBlobs.clear();
+		return;
+	}
+
+	readAliveList(message, false, aliveObjects);
+	commitObjects(aliveObjects);
+	commitCursors(aliveObjects);
+	commitBlobs(aliveObjects);
+	refresh();
+}
+
+void TuioBenchClient::commitObjects(std::vector<long> &aliveList) {
+
+	lockObjectList();
+	for (std::list<TuioObject*>::iterator iter=objectList.begin(); iter!=objectList.end();) {
+		TuioObject *tobj = (*iter);
+		if (std::binary_search(aliveList.begin(),aliveList.end(),tobj->getSessionID())) {
+			iter++;
+			continue;
+		}
+
+		tobj->remove(frameTime);
+		for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+			(*listener)->removeTuioObject(tobj);
+		objectMap.erase(tobj->getSessionID());
+		iter = objectList.erase(iter);
+		delete tobj;
+	}
+
+	for (std::vector<BenchEntity>::iterator entity=frameObjects.begin(); entity!=frameObjects.end(); entity++) {
+		if (!std::binary_search(aliveList.begin(),aliveList.end(),entity->s_id)) continue;
+
+		std::map<long,TuioObject*>::iterator known = objectMap.find(entity->s_id);
+		if (known==objectMap.end()) {
+			TuioObject *tobj = new TuioObject(frameTime, entity->s_id, entity->id, entity->x, entity->y, entity->a);
+			objectList.push_back(tobj);
+			objectMap[entity->s_id] = tobj;
+			for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+				(*listener)->addTuioObject(tobj);
+		} else {
+			TuioObject *tobj = known->second;
+			tobj->update(frameTime, entity->x, entity->y, entity->a, entity->xs, entity->ys, entity->rs, entity->ma, entity->ra);
+			for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+				(*listener)->updateTuioObject(tobj);
+		}
+	}
+	frameObjects.clear();
+	unlockObjectList();
+}
+
+void TuioBenchClient::commitCursors(std::vector<long> &aliveList) {
+
+	lockCursorList();
+	for (std::list<TuioCursor*>::iterator iter=cursorList.begin(); iter!=cursorList.end();) {
+		TuioCursor *tcur = (*iter);
+		if (std::binary_search(aliveList.begin(),aliveList.end(),tcur->getSessionID())) {
+			iter++;
+			continue;
+		}
+
+		tcur->remove(frameTime);
+		for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+			(*listener)->removeTuioCursor(tcur);
+		cursorMap.erase(tcur->getSessionID());
+		iter = cursorList.erase(iter);
+		delete tcur;
+	}
+
+	for (std::vector<BenchEntity>::iterator entity=frameCursors.begin(); entity!=frameCursors.end(); entity++) {
+		if (!std::binary_search(aliveList.begin(),aliveList.end(),entity->s_id)) continue;
+
+		std::map<long,TuioCursor*>::iterator known = cursorMap.find(entity->s_id);
+		if (known==cursorMap.end()) {
+			TuioCursor *tcur = new TuioCursor(frameTime, entity->s_id, (int)cursorList.size(), entity->x, entity->y);
+			cursorList.push_back(tcur);
+			cursorMap[entity->s_id] = tcur;
+			for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+				(*listener)->addTuioCursor(tcur);
+		} else {
+			TuioCursor *tcur = known->second;
+			tcur->update(frameTime, entity->x, entity->y, entity->xs, entity->ys, entity->ma);
+			for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+				(*listener)->updateTuioCursor(tcur);
+		}
+	}
+	frameCursors.clear();
+	unlockCursorList();
+}
+
+void TuioBenchClient::commitBlobs(std::vector<long> &aliveList) {
+
+	lockBlobList();
+	for (std::list<TuioBlob*>::iterator iter=blobList.begin(); iter!=blobList.end();) {
+		TuioBlob *tblb = (*iter);
+		if (std::binary_search(aliveList.begin(),aliveList.end(),tblb->getSessionID())) {
+			iter++;
+			continue;
+		}
+
+		tblb->remove(frameTime);
+		for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+			(*listener)->removeTuioBlob(tblb);
+		blobMap.erase(tblb->getSessionID());
+		iter = blobList.erase(iter);
+		delete tblb;
+	}
+
+	for (std::vector<BenchEntity>::iterator entity=frameBlobs.begin(); entity!=frameBlobs.end(); entity++) {
+		if (!std::binary_search(aliveList.begin(),aliveList.end(),entity->s_id)) continue;
+
+		std::map<long,TuioBlob*>::iterator known = blobMap.find(entity->s_id);
+		if (known==blobMap.end()) {
+			TuioBlob *tblb = new TuioBlob(frameTime, entity->s_id, (int)blobList.size(), entity->x, entity->y, entity->a, entity->w, entity->h, entity->f);
+			blobList.push_back(tblb);
+			blobMap[entity->s_id] = tblb;
+			for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+				(*listener)->addTuioBlob(tblb);
+		} else {
+			TuioBlob *tblb = known->second;
+			tblb->update(frameTime, entity->x, entity->y, entity->a, entity->w, entity->h, entity->f, entity->xs, entity->ys, entity->rs, entity->ma, entity->ra);
+			for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+				(*listener)->updateTuioBlob(tblb);
+		}
+	}
+	frameBlobs.clear();
+	unlockBlobList();
+}
+
+void TuioBenchClient::refresh() {
+	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener!=listenerList.end(); listener++)
+		(*listener)->refresh(frameTime);
+}
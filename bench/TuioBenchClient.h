@@ -0,0 +1,90 @@
+/*  reacTIVision tangible interaction framework
+	Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+	This program is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program; if not, write to the Free Software
+	Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TUIOBENCHCLIENT_H
+#define TUIOBENCHCLIENT_H
+
+#include "TuioDispatcher.h"
+#include "osc/OscReceivedElements.h"
+#include <vector>
+#include <map>
+
+using namespace TUIO;
+
+// the attributes of a single set message, which are applied when the frame is committed
+struct BenchEntity {
+	long s_id;
+	int id;
+	float x, y, a, w, h, f;
+	float xs, ys, rs, ma, ra;
+};
+
+// The TuioBenchClient decodes TUIO 1.1 and TUIO 2.0 bundles and maintains the received
+// TuioObjects, TuioCursors and TuioBlobs in the same way as a regular TUIO client.
+// The packets are provided by the caller, so that any transport can be measured.
+class TuioBenchClient : public TuioDispatcher
+{
+public:
+	TuioBenchClient();
+	~TuioBenchClient();
+
+	// decodes a single OSC packet, returns false if the packet is malformed
+	bool processPacket(const char *data, int size);
+
+	// the frame ID of the last committed bundle, -1 for immediate updates
+	long getFrameID() { return committedFrame; };
+	unsigned long getMessageCount() { return messageCount; };
+	// the absolute time of the last TUIO 2.0 frame message
+	TuioTime getFrameTimeTag() { return frameTimeTag; };
+
+private:
+	void processBundle(const osc::ReceivedBundle &bundle);
+	void processMessage(const osc::ReceivedMessage &message);
+
+	void processObjectMessage(const osc::ReceivedMessage &message);
+	void processCursorMessage(const osc::ReceivedMessage &message);
+	void processBlobMessage(const osc::ReceivedMessage &message);
+	bool acceptFrame(long fseq);
+
+	void processFrameMessage(const osc::ReceivedMessage &message);
+	void processTokenMessage(const osc::ReceivedMessage &message);
+	void processPointerMessage(const osc::ReceivedMessage &message);
+	void processBoundsMessage(const osc::ReceivedMessage &message);
+	void processFrameAliveMessage(const osc::ReceivedMessage &message);
+
+	void readAliveList(const osc::ReceivedMessage &message, bool command, std::vector<long> &aliveList);
+	void commitObjects(std::vector<long> &aliveList);
+	void commitCursors(std::vector<long> &aliveList);
+	void commitBlobs(std::vector<long> &aliveList);
+	void refresh();
+
+	std::vector<BenchEntity> frameObjects, frameCursors, frameBlobs;
+	std::vector<long> aliveObjects, aliveCursors, aliveBlobs;
+	std::map<long,TuioObject*> objectMap;
+	std::map<long,TuioCursor*> cursorMap;
+	std::map<long,TuioBlob*> blobMap;
+
+	long currentFrame;
+	long committedFrame;
+	long receivedFrame;
+	TuioTime frameTime;
+	TuioTime frameTimeTag;
+	unsigned long messageCount;
+};
+
+#endif
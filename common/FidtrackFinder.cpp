@@ -41,6 +41,24 @@ bool FidtrackFinder::init(int w, int h, int sb, int db) {
 	initialize_fidtrackerX( &fidtrackerx, &treeidmap, dmap);
 	initialize_segmenter( &segmenter, width, height, treeidmap.max_adjacencies );
 	BlobObject::setDimensions(width,height);
+	
+	if (roi_src!=NULL) {
+		terminate_segmenter(&roi_segmenter);
+		terminate_bradley_roth_thresholder(&roi_thresholder);
+		delete[] roi_src;
+		delete[] roi_dest;
+		roi_src = roi_dest = NULL;
+	}
+	
+	if (roi_search) {
+		roi_size = MAX_ROI_SIZE;
+		if (roi_size>width) roi_size = width;
+		if (roi_size>height) roi_size = height;
+		initialize_segmenter( &roi_segmenter, roi_size, roi_size, treeidmap.max_adjacencies );
+		initialize_bradley_roth_thresholder( &roi_thresholder, roi_size, roi_size );
+		roi_src = new unsigned char[roi_size*roi_size];
+		roi_dest = new unsigned char[roi_size*roi_size];
+	}
 
 	//average_fiducial_size = height/2;
 	average_fiducial_size = 0.0f;
@@ -53,6 +71,7 @@ bool FidtrackFinder::init(int w, int h, int sb, int db) {
 	rotation_threshold = M_PI/360.0f;	 // half a degree
 	//position_threshold = 1.0f/(width); // one pixel
 	//rotation_threshold = M_PI/180.0f;	 // one degree
+	motion_noise = position_threshold*position_threshold*4.0f; // variance of one pixel
 	
 	setYamarashi = false;
 	setYamaFlip = false;
@@ -578,9 +597,257 @@ float FidtrackFinder::checkFinger(BlobObject *fblob) {
 	return (distance/contourList.size())/sqrt(bw*bh);
 }
 
+int FidtrackFinder::checkContrast(BlobObject *fblob, unsigned char *img) {
+	
+	// compute contrast using actual blob pixels from spanList
+	unsigned char min_val = 255;
+	unsigned char max_val = 0;
+	std::vector<BlobSpan*> spanList = fblob->getSpanList();
+	
+	for (unsigned int row = 0; row < spanList.size(); row += 2) {
+		BlobSpan *row_span = spanList[row];
+		while (row_span) {
+			for (int pixel_idx = row_span->start; pixel_idx <= row_span->end; pixel_idx++) {
+				if (pixel_idx >= 0 && pixel_idx < width * height) {
+					unsigned char val = img[pixel_idx];
+					if (val < min_val) min_val = val;
+					if (val > max_val) max_val = val;
+				}
+			}
+			row_span = row_span->next;
+		}
+	}
+	
+	if (max_val < min_val) return 0;
+	return max_val - min_val;
+}
+
+int FidtrackFinder::segmentRegion(unsigned char *img, int cx, int cy, int size) {
+	
+	int half_size = size/2;
+	if (half_size>roi_size/2) half_size = roi_size/2;
+	
+	int x0 = cx-half_size;
+	int y0 = cy-half_size;
+	int x1 = cx+half_size;
+	int y1 = cy+half_size;
+	
+	if (x0<0) x0 = 0;
+	if (y0<0) y0 = 0;
+	if (x1>width) x1 = width;
+	if (y1>height) y1 = height;
+	
+	int roi_width = x1-x0;
+	int roi_height = y1-y0;
+	if ((roi_width<MIN_ROI_SIZE) || (roi_height<MIN_ROI_SIZE)) return 0;
+	
+	// copy the search window and compute its local mean brightness
+	unsigned int sum = 0;
+	unsigned char *roi_pixel = roi_src;
+	for (int y=y0;y<y1;y++) {
+		unsigned char *src_pixel = img + src_format*(y*width+x0);
+		for (int x=roi_width;x>0;x--) {
+			*roi_pixel = *src_pixel;
+			sum += *roi_pixel++;
+			src_pixel += src_format;
+		}
+	}
+	
+	// adapt the threshold to the local conditions:
+	// lower the brightness gate within darker (shaded or blurred) regions
+	int local_contrast = (int)(sum/(roi_width*roi_height))/2;
+	if (local_contrast>roi_contrast) local_contrast = roi_contrast;
+	
+	int local_window = roi_window;
+	if (local_window>roi_width/4) local_window = roi_width/4;
+	if (local_window>roi_height/4) local_window = roi_height/4;
+	if (local_window<1) local_window = 1;
+	
+	bradley_roth_threshold( &roi_thresholder, roi_dest, roi_src, roi_width, roi_height, roi_height, 0, local_window, roi_bias, local_contrast );
+	
+	// the region buffers are allocated for the maximum window size
+	roi_segmenter.width = roi_width;
+	roi_segmenter.height = roi_height;
+	step_segmenter( &roi_segmenter, roi_dest );
+	
+	// map the window regions back into frame coordinates
+	for( int i=0; i < roi_segmenter.region_count; ++i ) {
+		Region *r = (Region*)(roi_segmenter.regions + (roi_segmenter.sizeof_region * (i)));
+		if (r->flags & FREE_REGION_FLAG) continue;
+		
+		r->left += x0;
+		r->right += x0;
+		r->top += y0;
+		r->bottom += y0;
+		
+		Span *span = r->first_span;
+		while (span) {
+			int offset = (span->start/roi_width+y0)*width + span->start%roi_width + x0 - span->start;
+			span->start += offset;
+			span->end += offset;
+			span = span->next;
+		}
+		
+		r->width = r->right-r->left+1;
+		r->height = r->bottom-r->top+1;
+		r->size = r->width;
+		if (r->height>r->width) r->size = r->height;
+		
+		r->raw_x = r->left+r->width/2.0f;
+		r->raw_y = r->top+r->height/2.0f;
+		r->x = r->raw_x/width;
+		r->y = r->raw_y/height;
+	}
+	
+	return roi_segmenter.region_count;
+}
+
+bool FidtrackFinder::searchFiducialRegion(FiducialObject *fobj, unsigned char *img, TuioTime ftime) {
+	
+	float root_size = fobj->getRootSize();
+	if (root_size<=0) return false;
+	
+	// the search window covers the symbol and its predicted displacement
+	TuioPoint fpos = fobj->predictPosition();
+	float motion = fobj->getScreenDistance(fpos.getX(), fpos.getY(), width, height);
+	int size = (int)(2.0f*(root_size + motion));
+	
+	if (segmentRegion(img, (int)(fpos.getX()*width), (int)(fpos.getY()*height), size)==0) return false;
+	int fid_count = find_fiducialsX( roi_fiducials, MAX_FIDUCIAL_COUNT/16, &fidtrackerx, &roi_segmenter, width, height );
+	
+	float closest = root_size;
+	FiducialX *closest_fid = NULL;
+	for (int i=0;i<fid_count;i++) {
+		if (roi_fiducials[i].id!=fobj->getSymbolID()) continue;
+		
+		float distance = fpos.getScreenDistance(roi_fiducials[i].x/width, roi_fiducials[i].y/height, width, height);
+		if (distance<closest) {
+			closest_fid = &roi_fiducials[i];
+			closest = distance;
+		}
+	}
+	if (closest_fid==NULL) return false;
+	
+	closest_fid->x = closest_fid->x/width;
+	closest_fid->y = closest_fid->y/height;
+	
+	// make sure this symbol is not already tracked by another object
+	std::list<TuioObject*> objectList = tuioManager->getTuioObjects();
+	for (std::list<TuioObject*>::iterator tobj = objectList.begin(); tobj!=objectList.end(); tobj++) {
+		if ((*tobj)==fobj) continue;
+		if (((*tobj)->getSymbolID()==closest_fid->id) && ((*tobj)->getScreenDistance(closest_fid->x, closest_fid->y, width, height)<root_size)) return false;
+	}
+	
+	fobj->setFiducialInfo(closest_fid->root->colour,closest_fid->root->size);
+	fobj->setTrackingState(FIDUCIAL_FOUND);
+	tuioManager->updateTuioObject(fobj,closest_fid->x,closest_fid->y,closest_fid->angle);
+	drawObject(fobj->getSymbolID(),fobj->getX(),fobj->getY(),fobj->getTrackingState());
+	
+	if (send_fiducial_blobs) {
+		BlobObject *fid_blob = NULL;
+		try {
+			fid_blob = new BlobObject(ftime,closest_fid->root,dmap);
+			TuioBlob *existing_blob = tuioManager->getTuioBlob(fobj->getSessionID());
+			if (existing_blob) tuioManager->updateTuioBlob(existing_blob,fid_blob->getX(),fid_blob->getY(),fid_blob->getAngle(),fid_blob->getWidth(),fid_blob->getHeight(),fid_blob->getArea());
+		} catch (std::exception e) {}
+		if (fid_blob) delete fid_blob;
+	}
+	
+	return true;
+}
+
+bool FidtrackFinder::searchFingerRegion(TuioCursor *tcur, unsigned char *img, std::list<TuioObject*> &objectList, std::list<BlobObject*> &fingerBlobs, TuioTime ftime) {
+	
+	if (average_finger_size<=0) return false;
+	
+	// the search window covers the finger and its predicted displacement
+	TuioPoint cpos = tcur->predictPosition();
+	float motion = tcur->getScreenDistance(cpos.getX(), cpos.getY(), width, height);
+	int size = (int)(4.0f*average_finger_size + 2.0f*motion);
+	
+	int reg_count = segmentRegion(img, (int)(cpos.getX()*width), (int)(cpos.getY()*height), size);
+	if (reg_count==0) return false;
+	
+	float min_finger_size = average_finger_size / 2.0f;
+	float max_finger_size = average_finger_size * 2.0f;
+	
+	float closest = average_finger_size*2.0f + motion;
+	Region *closest_region = NULL;
+	for( int i=0; i < reg_count; ++i ) {
+		Region *r = (Region*)(roi_segmenter.regions + (roi_segmenter.sizeof_region * (i)));
+		
+		// ignore regions which are cut by the window border
+		if (r->flags & (FREE_REGION_FLAG | ADJACENT_TO_ROOT_REGION_FLAG)) continue;
+		if ((r->colour!=WHITE) || (r->size<min_finger_size) || (r->size>max_finger_size)) continue;
+		
+		int reg_diff = abs(r->width - r->height);
+		int max_diff = r->width;
+		if (r->height < r->width) max_diff = r->height;
+		if (reg_diff>=max_diff) continue;
+		
+		//ignore noisy blobs with too many adjacencies
+		if (r->adjacent_region_count-1 >= 2*finger_sensitivity) continue;
+		
+		float distance = cpos.getScreenDistance(r->x, r->y, width, height);
+		if (distance<closest) {
+			closest_region = r;
+			closest = distance;
+		}
+	}
+	if (closest_region==NULL) return false;
+	
+	// ignore fingers within and near existing fiducial objects
+	for (std::list<TuioObject*>::iterator tobj = objectList.begin(); tobj!=objectList.end(); tobj++) {
+		FiducialObject *fid = (FiducialObject*)(*tobj);
+		if (fid->getScreenDistance(closest_region->x, closest_region->y, width, height) < fid->getRootSize()/1.5f) return false;
+	}
+	
+	BlobObject *finger_blob = NULL;
+	try {
+		finger_blob = new BlobObject(ftime,closest_region,dmap,true);
+	} catch (std::exception e) {
+		if (finger_blob) delete finger_blob;
+		return false;
+	}
+	
+	bool found = false;
+	if (checkContrast(finger_blob,img) >= finger_contrast) {
+		
+		float finger_match = checkFinger(finger_blob);
+		float adaptive_sensitivity = finger_sensitivity+tcur->getMotionSpeed();
+		if (tcur->getTuioState()==TUIO_ADDED) adaptive_sensitivity = adaptive_sensitivity/3.0f;
+		
+		if (finger_match<adaptive_sensitivity) {
+			
+			tuioManager->updateTuioCursor(tcur,finger_blob->getX(),finger_blob->getY());
+			drawObject(FINGER_ID,tcur->getX(),tcur->getY(),0);
+			ui->setColor(0,255,0);
+			ui->drawEllipse(finger_blob->getX()*width,finger_blob->getY()*height,finger_blob->getWidth()*width,finger_blob->getHeight()*height,finger_blob->getAngle());
+			
+			if (send_finger_blobs) {
+				TuioBlob *existing_blob = tuioManager->getTuioBlob(tcur->getSessionID());
+				if (existing_blob) tuioManager->updateTuioBlob(existing_blob, finger_blob->getX(),finger_blob->getY(), finger_blob->getAngle(), finger_blob->getWidth(), finger_blob->getHeight(), finger_blob->getArea());
+			}
+			
+			// drop the same finger from the full frame candidates
+			for (std::list<BlobObject*>::iterator fblb = fingerBlobs.begin(); fblb!=fingerBlobs.end(); ) {
+				if ((*fblb)->getScreenDistance(finger_blob->getX(),finger_blob->getY(),width,height) < average_finger_size) {
+					delete (*fblb);
+					fblb = fingerBlobs.erase(fblb);
+				} else fblb++;
+			}
+			found = true;
+		}
+	}
+	
+	delete finger_blob;
+	return found;
+}
+
 void FidtrackFinder::process(unsigned char *src, unsigned char *dest) {
 	
-	TuioTime frameTime = TuioTime::getSystemTime();
+	// prefer the capture time reported by the camera
+	TuioTime frameTime = (frame_time>0) ? TuioTime((long)(frame_time/1000000),(long)(frame_time%1000000)) : TuioTime::getSystemTime();
 	tuioManager->initFrame(frameTime);
 	//std::cout << "frame: " << totalframes << std::endl;
 
@@ -803,29 +1070,8 @@ void FidtrackFinder::process(unsigned char *src, unsigned char *dest) {
 			try {
 				finger_blob = new BlobObject(frameTime,regions[i],dmap,true);
 				
-				// Compute contrast using actual blob pixels from spanList
-				unsigned char min_val = 255;
-				unsigned char max_val = 0;
-				std::vector<BlobSpan*> spanList = finger_blob->getSpanList();
-				
-				for (unsigned int row = 0; row < spanList.size(); row += 2) {
-					BlobSpan *row_span = spanList[row];
-					while (row_span) {
-						for (int pixel_idx = row_span->start; pixel_idx <= row_span->end; pixel_idx++) {
-							if (pixel_idx >= 0 && pixel_idx < width * height) {
-								unsigned char val = src[pixel_idx];
-								if (val < min_val) min_val = val;
-								if (val > max_val) max_val = val;
-							}
-						}
-						row_span = row_span->next;
-					}
-				}
-				
-				unsigned char contrast = max_val - min_val;
-				
 				// Reject low-contrast finger blobs (likely hovering hands)
-				if (contrast < finger_contrast) {
+				if (checkContrast(finger_blob,src) < finger_contrast) {
 					delete finger_blob;
 					continue;
 				}
@@ -1082,7 +1328,8 @@ void FidtrackFinder::process(unsigned char *src, unsigned char *dest) {
 		add_object->addAngleThreshold(rotation_threshold);
 
 		if (objFilter) {
-			add_object->addPositionFilter(1.0f,0.25f);
+			if (motionFilter) add_object->addMotionFilter(MOTION_PROCESS_NOISE,motion_noise);
+			else add_object->addPositionFilter(1.0f,0.25f);
 			add_object->addAngleFilter(1.0f,0.25f);
 		}
 		tuioManager->addExternalTuioObject(add_object);
@@ -1103,7 +1350,8 @@ void FidtrackFinder::process(unsigned char *src, unsigned char *dest) {
 				fid_blob->addSizeThreshold(position_threshold*2.0f);
 				
 				if (blbFilter) {
-					fid_blob->addPositionFilter(0.5f,0.15f);
+					if (motionFilter) fid_blob->addMotionFilter(MOTION_PROCESS_NOISE,motion_noise);
+					else fid_blob->addPositionFilter(0.5f,0.15f);
 					fid_blob->addAngleFilter(0.5f,0.15f);
 					fid_blob->addSizeFilter(0.5f,0.15f);
 				}
@@ -1117,6 +1365,9 @@ void FidtrackFinder::process(unsigned char *src, unsigned char *dest) {
 	std::list<TuioObject*> lostObjects = tuioManager->getUntouchedObjects();
 	for(std::list<TuioObject*>::iterator iter = lostObjects.begin(); iter!=lostObjects.end(); iter++) {
 		FiducialObject *tobj = (FiducialObject*)(*iter);
+		// try to re-acquire the lost object around its predicted position
+		if ((roi_search) && (searchFiducialRegion(tobj,src,frameTime))) continue;
+		
 		if (tobj->getTrackingState()!=FIDUCIAL_LOST) {
 			// update lost object with predicted position ... once only before removal
 			TuioPoint fpos = tobj->predictPosition();
@@ -1184,9 +1435,8 @@ void FidtrackFinder::process(unsigned char *src, unsigned char *dest) {
 			delete closest_fblob;
 		}
 		// check for fingers in the predicted region
-		else {
-			//printf("where oh where\n");
-			
+		else if (roi_search) {
+			searchFingerRegion((*tcur),src,objectList,fingerBlobs,frameTime);
 		}
 	}
 
@@ -1198,7 +1448,10 @@ void FidtrackFinder::process(unsigned char *src, unsigned char *dest) {
 		if(finger_match<finger_sensitivity/4.0f) {
 			TuioCursor *add_cursor = tuioManager->addTuioCursor((*fblb)->getX(),(*fblb)->getY());
 			add_cursor->addPositionThreshold(position_threshold*2.0f); //1px
-			if (curFilter) add_cursor->addPositionFilter(1.0f,0.25f);
+			if (curFilter) {
+				if (motionFilter) add_cursor->addMotionFilter(MOTION_PROCESS_NOISE,motion_noise);
+				else add_cursor->addPositionFilter(1.0f,0.25f);
+			}
 			//drawObject(FINGER_ID,add_cursor->getX(),add_cursor->getY(),0);
 			//ui->setColor(0,255,0);
 			//ui->drawEllipse((*fblb)->getX()*width,(*fblb)->getY()*height,(*fblb)->getWidth()*width,(*fblb)->getHeight()*height,(*fblb)->getAngle());
@@ -1208,7 +1461,8 @@ void FidtrackFinder::process(unsigned char *src, unsigned char *dest) {
 				cur_blob->setSessionID(add_cursor->getSessionID());
 				
 				if (blbFilter) {
-					cur_blob->addPositionFilter(0.5f,0.15f);
+					if (motionFilter) cur_blob->addMotionFilter(MOTION_PROCESS_NOISE,motion_noise);
+					else cur_blob->addPositionFilter(0.5f,0.15f);
 					cur_blob->addAngleFilter(0.5f,0.15f);
 					cur_blob->addSizeFilter(0.5f,0.15f);
 				}
@@ -1311,7 +1565,8 @@ if (detect_blobs) {
 			add_blob->addSizeThreshold(position_threshold*2.0f);
 			
 			if (blbFilter) {
-				add_blob->addPositionFilter(0.5f,0.15f);
+				if (motionFilter) add_blob->addMotionFilter(MOTION_PROCESS_NOISE,motion_noise);
+				else add_blob->addPositionFilter(0.5f,0.15f);
 				add_blob->addAngleFilter(0.5f,0.15f);
 				add_blob->addSizeFilter(0.5f,0.15f);
 			}
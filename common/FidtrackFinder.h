@@ -26,9 +26,13 @@
 #include "TuioCursor.h"
 #include "segment.h"
 #include "fidtrackX.h"
+#include "bradley_roth_threshold.h"
 #include <assert.h>
 
 #define MAX_FIDUCIAL_COUNT 1024
+#define MAX_ROI_SIZE 256
+#define MIN_ROI_SIZE 8
+#define MOTION_PROCESS_NOISE 100.0f
 
 using namespace TUIO;
 
@@ -54,6 +58,7 @@ public:
 		
 		position_threshold = 0.0f;
 		rotation_threshold = 0.0f;
+		motion_noise = 0.0f;
 
 		average_finger_size = 0;
 		detect_fingers = true;
@@ -82,6 +87,20 @@ public:
 		objFilter = config->obj_filter;
 		curFilter = config->cur_filter;
 		blbFilter = config->blb_filter;
+		motionFilter = config->motion_filter;
+		
+		roi_search = config->roi_search;
+		if (strcmp(config->threshold_type, "br") == 0) {
+			roi_window = config->threshold_size;
+			roi_bias = config->threshold_gradient/100.0f;
+			roi_contrast = config->threshold_contrast;
+		} else {
+			roi_window = 16;
+			roi_bias = 0.16f;
+			roi_contrast = 32;
+		}
+		roi_src = NULL;
+		roi_dest = NULL;
 	};
 	
 	~FidtrackFinder() {
@@ -90,6 +109,12 @@ public:
 			terminate_treeidmap(&treeidmap);
 			terminate_fidtrackerX(&fidtrackerx);
 		}
+		if (roi_src!=NULL) {
+			terminate_segmenter(&roi_segmenter);
+			terminate_bradley_roth_thresholder(&roi_thresholder);
+			delete[] roi_src;
+			delete[] roi_dest;
+		}
 	};
 	
 	void addUserInterface(UserInterface *uiface) {
@@ -109,6 +134,7 @@ public:
 	bool getFiducialBlob() { return send_fiducial_blobs; };
 	bool getYamaarashi() { return detect_yamaarashi; };
 	bool getYamaFlip() { return invert_yamaarashi; };
+	bool getRegionSearch() { return roi_search; };
 
 	void reset();
 	
@@ -142,17 +168,36 @@ private:
 
 	float position_threshold;
 	float rotation_threshold;
+	float motion_noise;
 	
 	bool setYamarashi, setYamaFlip;
 	bool setFingerSize, setFingerSensitivity, setFingerContrast;
 	bool setBlobSize, setObjectBlob, setFingerBlob;
-	bool objFilter, curFilter, blbFilter;
+	bool objFilter, curFilter, blbFilter, motionFilter;
 	
 	int max_fiducial_id;
 	bool detect_yamaarashi;
 	bool invert_yamaarashi;
 	void decodeYamaarashi(FiducialX *yama, unsigned char *img, TuioTime ftime);
 	float checkFinger(BlobObject *fblob);
+	int checkContrast(BlobObject *fblob, unsigned char *img);
+	
+	// predictive region of interest search for lost objects and fingers
+	bool roi_search;
+	int roi_window;
+	float roi_bias;
+	int roi_contrast;
+	int roi_size;
+	
+	Segmenter roi_segmenter;
+	BradleyRothThresholder roi_thresholder;
+	FiducialX roi_fiducials[ MAX_FIDUCIAL_COUNT/16 ];
+	unsigned char *roi_src;
+	unsigned char *roi_dest;
+	
+	int segmentRegion(unsigned char *img, int cx, int cy, int size);
+	bool searchFiducialRegion(FiducialObject *fobj, unsigned char *img, TuioTime ftime);
+	bool searchFingerRegion(TuioCursor *tcur, unsigned char *img, std::list<TuioObject*> &objectList, std::list<BlobObject*> &fingerBlobs, TuioTime ftime);
 };
 
 #endif
@@ -30,6 +30,8 @@ bool FiducialFinder::init(int w, int h, int sb ,int db) {
 	dmap = new ShortPoint[height*width];
 	computeGrid();
 	
+	tuioManager->setDimension(width,height);
+	
 	return true;
 }
 
@@ -37,20 +37,32 @@
 #include "CalibrationEngine.h"
 
 #include "TuioServer.h"
+#include "TuioAggregator.h"
 
 VisionEngine *engine;
+static volatile bool aggregating = false;
 using namespace tinyxml2;
 
 static void terminate (int param)
 {
 	if (engine!=NULL) engine->stop();
+	aggregating = false;
 }
 
+#ifndef WIN32
+// SIGUSR1 starts or stops a recording of the camera frames, also without any console or display
+static void record (int param)
+{
+	if (engine!=NULL) engine->toggleRecording();
+}
+#endif
+
 void printUsage(const char* app_name) {
 	std::cout << "usage: " << app_name << " -c [config_file]" << std::endl;
 	std::cout << "the default configuration file is " << app_name << ".xml" << std::endl;
 	std::cout << "\t -n starts " << app_name << " without GUI" << std::endl;
 	std::cout << "\t -l lists all available cameras" << std::endl;
+	std::cout << "\t -a merges the TUIO sources of other instances" << std::endl;
 	std::cout << "\t -h shows this help message" << std::endl;
 	std::cout << std::endl;
 }
@@ -61,12 +73,18 @@ void readSettings(application_settings *config) {
 	config->tuio_type[0] = TUIO_UDP;
 	config->tuio_port[0] = 3333;
 	config->tuio_host[0] = "localhost";
+	config->tuio_version[0] = TUIO_VERSION_11;
+	config->tuio_rate[0] = 0.0f;
+	config->tuio_heartbeat[0] = 0.0f;
 	snprintf(config->tuio_source,1024,"%s","rtv");
 
 	for (int i=1;i<32;i++) {
 		config->tuio_type[i] = -1;
 		config->tuio_port[i] = -1;
 		config->tuio_host[i] = "";
+		config->tuio_version[i] = TUIO_VERSION_11;
+		config->tuio_rate[i] = 0.0f;
+		config->tuio_heartbeat[i] = 0.0f;
 	}
 
 	snprintf(config->tree_config,1024,"%s","default");
@@ -78,9 +96,11 @@ void readSettings(application_settings *config) {
 	config->yamaarashi = false;
 	config->yama_flip = false;
 	config->max_fid = UINT_MAX;
+	config->roi_search = false;
 	config->obj_filter = false;
 	config->cur_filter = false;
 	config->blb_filter = false;
+	config->motion_filter = false;
 	config->background = false;
 	config->fullscreen = false;
 	config->headless = false;
@@ -97,6 +117,11 @@ void readSettings(application_settings *config) {
 	config->thread_count = 1;
 	snprintf(config->threshold_type, 4, "br");
 	config->display_mode = 2;
+	config->source_count = 0;
+	config->aggregate_distance = 0.05f;
+	config->aggregate_timeout = 250;
+	config->record_compression = true;
+	config->record_threads = 1;
 	
 	if (strcmp( config->file, "none" ) == 0) {
 #ifdef __APPLE__
@@ -138,12 +163,20 @@ void readSettings(application_settings *config) {
 			else if ((strcmp(tuio_element->Attribute("type"),"tcp")==0) || (strcmp(tuio_element->Attribute("type"),"TCP")==0)) config->tuio_type[tcount] = TUIO_TCP_CLIENT;
 			else if ((strcmp(tuio_element->Attribute("type"),"web")==0) || (strcmp(tuio_element->Attribute("type"),"WEB")==0)) config->tuio_type[tcount] = TUIO_WEB;
 			else if ((strcmp(tuio_element->Attribute("type"),"flc")==0) || (strcmp(tuio_element->Attribute("type"),"FLC")==0)) config->tuio_type[tcount] = TUIO_FLASH;
+			else if ((strcmp(tuio_element->Attribute("type"),"shm")==0) || (strcmp(tuio_element->Attribute("type"),"SHM")==0)) config->tuio_type[tcount] = TUIO_SHM;
+			else if ((strcmp(tuio_element->Attribute("type"),"dlt")==0) || (strcmp(tuio_element->Attribute("type"),"DLT")==0)) config->tuio_type[tcount] = TUIO_DELTA;
 
 			if(tuio_element->Attribute("host")!=NULL) {
 				config->tuio_host[tcount] = tuio_element->Attribute("host");
 				if (config->tuio_host[tcount]=="server") config->tuio_type[tcount] = TUIO_TCP_HOST;
 			}
 			if(tuio_element->Attribute("port")!=NULL) config->tuio_port[tcount] = atoi(tuio_element->Attribute("port"));
+			if(tuio_element->Attribute("name")!=NULL) config->tuio_host[tcount] = tuio_element->Attribute("name");
+			if(tuio_element->Attribute("version")!=NULL) {
+				if (atoi(tuio_element->Attribute("version"))==2) config->tuio_version[tcount] = TUIO_VERSION_20;
+			}
+			if(tuio_element->Attribute("rate")!=NULL) config->tuio_rate[tcount] = (float)atof(tuio_element->Attribute("rate"));
+			if(tuio_element->Attribute("heartbeat")!=NULL) config->tuio_heartbeat[tcount] = (float)atof(tuio_element->Attribute("heartbeat"));
 			tcount++;
 		} else if(tuio_element->Attribute("source")!=NULL) {
 			snprintf(config->tuio_source,1024,"%s",tuio_element->Attribute("source"));
@@ -157,12 +190,20 @@ void readSettings(application_settings *config) {
 				else if ((strcmp(tuio_element->Attribute("type"),"tcp")==0) || (strcmp(tuio_element->Attribute("type"),"TCP")==0)) config->tuio_type[tcount] = TUIO_TCP_CLIENT;
 				else if ((strcmp(tuio_element->Attribute("type"),"web")==0) || (strcmp(tuio_element->Attribute("type"),"WEB")==0)) config->tuio_type[tcount] = TUIO_WEB;
 				else if ((strcmp(tuio_element->Attribute("type"),"flc")==0) || (strcmp(tuio_element->Attribute("type"),"FLC")==0)) config->tuio_type[tcount] = TUIO_FLASH;
+				else if ((strcmp(tuio_element->Attribute("type"),"shm")==0) || (strcmp(tuio_element->Attribute("type"),"SHM")==0)) config->tuio_type[tcount] = TUIO_SHM;
+				else if ((strcmp(tuio_element->Attribute("type"),"dlt")==0) || (strcmp(tuio_element->Attribute("type"),"DLT")==0)) config->tuio_type[tcount] = TUIO_DELTA;
 
 				if(tuio_element->Attribute("host")!=NULL) {
 					config->tuio_host[tcount] = tuio_element->Attribute("host");
 					if (config->tuio_host[tcount]=="server") config->tuio_type[tcount] = TUIO_TCP_HOST;
 				}
 				if(tuio_element->Attribute("port")!=NULL) config->tuio_port[tcount] = atoi(tuio_element->Attribute("port"));
+				if(tuio_element->Attribute("name")!=NULL) config->tuio_host[tcount] = tuio_element->Attribute("name");
+				if(tuio_element->Attribute("version")!=NULL) {
+					if (atoi(tuio_element->Attribute("version"))==2) config->tuio_version[tcount] = TUIO_VERSION_20;
+				}
+				if(tuio_element->Attribute("rate")!=NULL) config->tuio_rate[tcount] = (float)atof(tuio_element->Attribute("rate"));
+				if(tuio_element->Attribute("heartbeat")!=NULL) config->tuio_heartbeat[tcount] = (float)atof(tuio_element->Attribute("heartbeat"));
 				tcount++;
 				if (tcount==32) break;
 			} else if(tuio_element->Attribute("source")!=NULL) {
@@ -255,11 +296,15 @@ void readSettings(application_settings *config) {
 
 		if(fiducial_element->Attribute("max_fid")!=NULL) config->max_fid = atoi(fiducial_element->Attribute("max_fid"));
 
+		if(fiducial_element->Attribute("roi")!=NULL)  {
+			if ((strcmp( fiducial_element->Attribute("roi"), "true" ) == 0) || atoi(fiducial_element->Attribute("roi"))==1) config->roi_search = true;
+		}
+
 		if(fiducial_element->Attribute("amoeba")!=NULL) snprintf(config->tree_config,1024,"%s",fiducial_element->Attribute("amoeba"));
 	}
 	
 	tinyxml2::XMLElement* filter_element = config_root.FirstChildElement("filter").ToElement();
-	if( fiducial_element!=NULL )
+	if( filter_element!=NULL )
 	{
 		if(filter_element->Attribute("fiducial")!=NULL)  {
 			if ((strcmp( filter_element->Attribute("fiducial"), "true" ) == 0) || atoi(filter_element->Attribute("fiducial"))==1) config->obj_filter = true;
@@ -272,6 +317,10 @@ void readSettings(application_settings *config) {
 		if(filter_element->Attribute("blob")!=NULL)  {
 			if ((strcmp( filter_element->Attribute("blob"), "true" ) == 0) || atoi(filter_element->Attribute("blob"))==1) config->blb_filter = true;
 		}
+		
+		if(filter_element->Attribute("model")!=NULL)  {
+			if (strcmp( filter_element->Attribute("model"), "kalman" ) == 0) config->motion_filter = true;
+		}
 	}
 	
 	tinyxml2::XMLElement* blob_element = config_root.FirstChildElement("blob").ToElement();
@@ -300,6 +349,36 @@ void readSettings(application_settings *config) {
 		if(calibration_element->Attribute("grid")!=NULL) snprintf(config->grid_config,1024,"%s",calibration_element->Attribute("grid"));
 	}
 	
+	tinyxml2::XMLElement* aggregator_element = config_root.FirstChildElement("aggregator").ToElement();
+	if( aggregator_element!=NULL )
+	{
+		if(aggregator_element->Attribute("distance")!=NULL) config->aggregate_distance = (float)atof(aggregator_element->Attribute("distance"));
+		if(aggregator_element->Attribute("timeout")!=NULL) config->aggregate_timeout = atoi(aggregator_element->Attribute("timeout"));
+		
+		// each source is the shared memory segment of another instance and its region within the merged surface
+		tinyxml2::XMLElement* source_element = aggregator_element->FirstChildElement("source");
+		while ((source_element!=NULL) && (config->source_count<32)) {
+			int scount = config->source_count;
+			if(source_element->Attribute("name")!=NULL) config->source_name[scount] = source_element->Attribute("name");
+			else config->source_name[scount] = TUIO_SHM_DEFAULT_NAME;
+			config->source_region[scount][0] = source_element->Attribute("x")!=NULL ? (float)atof(source_element->Attribute("x")) : 0.0f;
+			config->source_region[scount][1] = source_element->Attribute("y")!=NULL ? (float)atof(source_element->Attribute("y")) : 0.0f;
+			config->source_region[scount][2] = source_element->Attribute("width")!=NULL ? (float)atof(source_element->Attribute("width")) : 1.0f;
+			config->source_region[scount][3] = source_element->Attribute("height")!=NULL ? (float)atof(source_element->Attribute("height")) : 1.0f;
+			config->source_count++;
+			source_element = source_element->NextSiblingElement("source");
+		}
+	}
+	
+	tinyxml2::XMLElement* recording_element = config_root.FirstChildElement("recording").ToElement();
+	if( recording_element!=NULL )
+	{
+		if(recording_element->Attribute("compression")!=NULL) {
+			config->record_compression = ((strcmp( recording_element->Attribute("compression"), "true" ) == 0) ||  atoi(recording_element->Attribute("compression"))==1);
+		}
+		if(recording_element->Attribute("threads")!=NULL) config->record_threads = atoi(recording_element->Attribute("threads"));
+	}
+	
 }
 
 
@@ -413,6 +492,10 @@ void writeSettings(application_settings *config) {
 			if (config->yama_flip) fiducial_element->SetAttribute("mirror", "true");
 			else fiducial_element->SetAttribute("mirror", "false");
 		}
+		if(fiducial_element->Attribute("roi")!=NULL)  {
+			if (config->roi_search) fiducial_element->SetAttribute("roi", "true");
+			else fiducial_element->SetAttribute("roi", "false");
+		}
 		if(fiducial_element->Attribute("amoeba")!=NULL) fiducial_element->SetAttribute("amoeba",config->tree_config);
 	}
 
@@ -443,6 +526,7 @@ int main(int argc, char* argv[]) {
 	const char *version_no = "1.6";
 
 	bool headless = false;
+	bool aggregate = false;
 
 	std::cout << app_name << " " << version_no << " (" << __DATE__ << ")" << std::endl << std::endl;
 
@@ -458,6 +542,8 @@ int main(int argc, char* argv[]) {
 			}
 		} else if( strcmp( argv[1], "-n" ) == 0 ) {
 			headless = true;
+		} else if( strcmp( argv[1], "-a" ) == 0 ) {
+			aggregate = true;
 		} else if( strcmp( argv[1], "-l" ) == 0 ) {
 			CameraTool::listDevices();
 			return 0;
@@ -473,21 +559,24 @@ int main(int argc, char* argv[]) {
 	signal(SIGHUP,terminate);
 	signal(SIGQUIT,terminate);
 	signal(SIGTERM,terminate);
+	signal(SIGUSR1,record);
 #endif
 
 	readSettings(&config);
 	config.headless = headless;
 
-	engine = new VisionEngine(app_name,&config);
+	if (!aggregate) {
+		engine = new VisionEngine(app_name,&config);
 
-	if (!headless) {
-		UserInterface *uiface = new SDLinterface(app_name,config.fullscreen);
-		switch (config.display_mode) {
-			case 0: uiface->setDisplayMode(NO_DISPLAY); break;
-			case 1: uiface->setDisplayMode(SOURCE_DISPLAY); break;
-			case 2: uiface->setDisplayMode(DEST_DISPLAY); break;
+		if (!headless) {
+			UserInterface *uiface = new SDLinterface(app_name,config.fullscreen);
+			switch (config.display_mode) {
+				case 0: uiface->setDisplayMode(NO_DISPLAY); break;
+				case 1: uiface->setDisplayMode(SOURCE_DISPLAY); break;
+				case 2: uiface->setDisplayMode(DEST_DISPLAY); break;
+			}
+			engine->setInterface(uiface);
 		}
-		engine->setInterface(uiface);
 	}
 
 	TuioServer *server = NULL;
@@ -495,25 +584,81 @@ int main(int argc, char* argv[]) {
 	FrameProcessor *thresholder	= NULL;
 	FrameProcessor *calibrator	= NULL;
 
+	// all UDP destinations with the same output settings share a single sender, which needs to be complete before attaching it
+	std::vector<OscSender*> senderList;
+	std::vector<UdpSender*> udpSenderList;
+	std::vector<FrameSender*> frameSenderList;
+	bool shm_sender = false;
 	for (int i=0;i<config.tuio_count;i++) {
 		OscSender *sender = NULL;
 		try { switch (config.tuio_type[i]) {
-			case TUIO_UDP: sender = new UdpSender(config.tuio_host[i].c_str(),config.tuio_port[i]); break;
+			case TUIO_UDP: {
+				UdpSender *udp_sender = NULL;
+				for (unsigned int j=0;j<udpSenderList.size();j++) {
+					if ((udpSenderList[j]->getTuioVersion()==config.tuio_version[i]) && (udpSenderList[j]->getUpdateRate()==config.tuio_rate[i]) && (udpSenderList[j]->getHeartbeat()==config.tuio_heartbeat[i])) udp_sender = udpSenderList[j];
+				}
+				if (udp_sender) udp_sender->addDestination(config.tuio_host[i].c_str(),config.tuio_port[i]);
+				else {
+					udp_sender = new UdpSender(config.tuio_host[i].c_str(),config.tuio_port[i]);
+					udpSenderList.push_back(udp_sender);
+					sender = udp_sender;
+				}
+				break;
+			}
 			case TUIO_TCP_CLIENT: sender = new TcpSender(config.tuio_host[i].c_str(),config.tuio_port[i]); break;
 			case TUIO_TCP_HOST: sender = new TcpSender(config.tuio_port[i]); break;
 			case TUIO_WEB: sender = new WebSockSender(config.tuio_port[i]); break;
+			case TUIO_SHM:
+				if (shm_sender) break;
+				if ((config.tuio_host[i]=="") || (config.tuio_host[i]=="localhost")) frameSenderList.push_back(new SharedMemorySender(TUIO_SHM_DEFAULT_NAME));
+				else frameSenderList.push_back(new SharedMemorySender(config.tuio_host[i].c_str()));
+				shm_sender = true;
+				break;
+			case TUIO_DELTA: frameSenderList.push_back(new DeltaSender(config.tuio_host[i].c_str(),config.tuio_port[i])); break;
 			default: continue;
 		} } catch (std::exception e) {}
 
 		if (sender) {
-			if(i==0) server = new TuioServer(sender);
-			else server->addOscSender(sender);
+			sender->setTuioVersion(config.tuio_version[i]);
+			sender->setUpdateRate(config.tuio_rate[i]);
+			sender->setHeartbeat(config.tuio_heartbeat[i]);
+			senderList.push_back(sender);
 			pv_sleep(1);
 		}
 	}
+	
+	// a tracker shard may only publish to shared memory, without any OSC sender
+	server = new TuioServer(senderList.size()>0 ? senderList[0] : NULL);
+	for (unsigned int i=1;i<senderList.size();i++)
+		server->addOscSender(senderList[i]);
+	for (unsigned int i=0;i<frameSenderList.size();i++)
+		server->addFrameSender(frameSenderList[i]);
 	server->setSourceName(config.tuio_source);
 	server->setInversion(config.invert_x, config.invert_y, config.invert_a);
 
+	if (aggregate) {
+		// no camera is opened, the published frames of the other instances are merged into a single session
+		if (config.source_count==0) {
+			std::cout << "no TUIO sources configured" << std::endl;
+			delete server;
+			return 0;
+		}
+		
+		TuioAggregator *aggregator = new TuioAggregator(server, config.aggregate_distance, config.aggregate_timeout);
+		for (int i=0;i<config.source_count;i++)
+			aggregator->addSource(config.source_name[i].c_str(), config.source_region[i][0], config.source_region[i][1], config.source_region[i][2], config.source_region[i][3]);
+		std::cout << "merging " << config.source_count << " TUIO sources" << std::endl;
+		
+		aggregating = true;
+		while (aggregating) {
+			if (!aggregator->update()) pv_sleep(1);
+		}
+		
+		delete aggregator;
+		delete server;
+		return 0;
+	}
+
 	if (strcmp(config.threshold_type, "br") == 0)
 		thresholder = new FrameThresholderBR(config.threshold_size, config.threshold_gradient / 100.0f, config.threshold_contrast, config.thread_count);
 	else
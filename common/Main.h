@@ -20,13 +20,16 @@
 #define REACTIVISION_H
 #include <string>
 
-enum TuioType { TUIO_UDP,TUIO_TCP_CLIENT,TUIO_TCP_HOST,TUIO_WEB,TUIO_FLASH };
+enum TuioType { TUIO_UDP,TUIO_TCP_CLIENT,TUIO_TCP_HOST,TUIO_WEB,TUIO_FLASH,TUIO_SHM,TUIO_DELTA };
 
 struct application_settings {
 	char file[1024];
 	int tuio_count;
 	int tuio_type[32];
 	int tuio_port[32];
+	int tuio_version[32];
+	float tuio_rate[32];
+	float tuio_heartbeat[32];
 	char tuio_source[1024];
 	std::string tuio_host[32];
 	char tree_config[1024];
@@ -38,9 +41,11 @@ struct application_settings {
 	bool yamaarashi;
 	bool yama_flip;
 	int max_fid;
+	bool roi_search;
 	bool obj_filter;
 	bool cur_filter;
 	bool blb_filter;
+	bool motion_filter;
 	bool background;
     bool fullscreen;
     bool headless;
@@ -57,6 +62,13 @@ struct application_settings {
 	int thread_count;
 	char threshold_type[4];
 	int display_mode;
+	int source_count;
+	std::string source_name[32];
+	float source_region[32][4];
+	float aggregate_distance;
+	int aggregate_timeout;
+	bool record_compression;
+	int record_threads;
 };
 
 #endif
@@ -19,7 +19,9 @@
 #include "CameraEngine.h"
 #include "CameraTool.h"
 
-const char* dstr[] = { "default","dc1394","ps3eye","raspi","uvccam","","","","","","file","folder"};
+static const ConvertKernels *kernels = getConvertKernels();
+
+const char* dstr[] = { "default","dc1394","ps3eye","raspi","uvccam","","","","","","file","folder","multi","replay"};
 
 const char* fstr[] =  { "unknown", "mono8",  "mono16", "rgb8", "rgb16", "mono16s", "rgb16s", "raw8", "raw16", "rgba", "yuyv", "uyvy", "yuv411", "yuv444", "yuv420p", "yuv410p",  "yvyu", "yuv211", "", "", "jpeg", "mjpeg", "mpeg", "mpeg2", "mpeg4", "h263", "h264", "", "", "", "dvpal", "dvntsc" };
 
@@ -185,285 +187,62 @@ void CameraEngine::showInterface(UserInterface *uiface) {
 }
 
 void CameraEngine::uyvy2gray(int width, int height, unsigned char *src, unsigned char *dest) {
-
-    for (int i=height*width/2;i>0;i--) {
-        src++;
-        *dest++ = *src++;
-        src++;
-        *dest++ = *src++;
-    }
+    kernels->uyvy2gray(src, dest, width*height);
 }
 
 void CameraEngine::crop_uyvy2gray(int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
-
-    if(!cfg->frame) return;
-    int x_off = cfg->frame_xoff;
-    int y_off = cfg->frame_yoff;
-    int frm_w = cfg->frame_width;
-    int frm_h = cfg->frame_height;
-
-    cam_buf += 2*y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
-
-    for (int i=frm_h;i>0;i--) {
-
-        cam_buf += 2*x_off;
-        for (int j=frm_w/2;j>0;j--) {
-            cam_buf++;
-            *frm_buf++ = *cam_buf++;
-            cam_buf++;
-            *frm_buf++ = *cam_buf++;
-        }
-        cam_buf +=  2*x_end;
-    }
+    crop_convert(kernels->uyvy2gray, cam_w, cam_buf, frm_buf, 2, 1);
 }
 
 void CameraEngine::yuyv2gray(int width, int height, unsigned char *src, unsigned char *dest) {
-    for (int i=height*width/2;i>0;i--) {
-        *dest++ = *src++;
-        src++;
-        *dest++ = *src++;
-        src++;
-    }
+    kernels->yuyv2gray(src, dest, width*height);
 }
 
 void CameraEngine::crop_yuyv2gray(int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
-
-    if(!cfg->frame) return;
-    int x_off = cfg->frame_xoff;
-    int y_off = cfg->frame_yoff;
-    int frm_w = cfg->frame_width;
-    int frm_h = cfg->frame_height;
-
-    cam_buf += 2*y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
-
-    for (int i=frm_h;i>0;i--) {
-
-        cam_buf +=  2*x_off;
-        for (int j=frm_w/2;j>0;j--) {
-            *frm_buf++ = *cam_buf++;
-            cam_buf++;
-            *frm_buf++ = *cam_buf++;
-            cam_buf++;
-        }
-        cam_buf +=  2*x_end;
-    }
-}
-
-//void yuv2rgb_conv(int Y1, int Y2, int U, int V, unsigned char *dest) {
-void yuv2rgb_conv(int Y, int U, int V, unsigned char *dest) {
-
-	/*int R = (int)(Y + 1.370705f * V);
-	int G = (int)(Y - 0.698001f * V - 0.337633f * U);
-	int B = (int)(Y + 1.732446f * U);*/
-
-	// integer method is twice as fast
-	int C = 298*(Y - 16);
-	int R = (C + 409*V + 128) >> 8;
-	int G = (C - 100*U - 208*V + 128) >> 8;
-	int B = (C + 516*U + 128) >> 8;
-
-	SAT(R);
-	SAT(G);
-	SAT(B);
-
-	*dest++ = R;
-    *dest++ = G;
-	*dest++ = B;
+    crop_convert(kernels->yuyv2gray, cam_w, cam_buf, frm_buf, 2, 1);
 }
 
 void CameraEngine::uyvy2rgb(int width, int height, unsigned char *src, unsigned char *dest) {
-
-	int Y1,Y2,U,V;
-
-	for(int i=width*height/2;i>0;i--) {
-		// U and V are +-0.5
-        U  = *src++ - 128;
-        Y1 = *src++;
-        V  = *src++ - 128;
-        Y2 = *src++;
-
-        yuv2rgb_conv(Y1,U,V,dest);
-        yuv2rgb_conv(Y2,U,V,dest+=3);
-        dest+=3;
-	}
+    kernels->uyvy2rgb(src, dest, width*height);
 }
 
 void CameraEngine::crop_uyvy2rgb(int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
-
-    if(!cfg->frame) return;
-    int x_off = cfg->frame_xoff;
-    int y_off = cfg->frame_yoff;
-    int frm_w = cfg->frame_width;
-    int frm_h = cfg->frame_height;
-
-    int Y1,Y2,U,V;
-
-    cam_buf += 2*y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
-
-    for (int i=frm_h;i>0;i--) {
-
-        cam_buf +=  2*x_off;
-        for (int j=frm_w/2;j>0;j--) {
-            // U and V are +-0.5
-            U  = *cam_buf++ - 128;
-            Y1 = *cam_buf++;
-            V  = *cam_buf++ - 128;
-            Y2 = *cam_buf++;
-
-            yuv2rgb_conv(Y1,U,V,frm_buf);
-            yuv2rgb_conv(Y2,U,V,frm_buf+=3);
-            frm_buf+=3;
-        }
-        cam_buf += 2*x_end;
-    }
+    crop_convert(kernels->uyvy2rgb, cam_w, cam_buf, frm_buf, 2, 3);
 }
 
 void CameraEngine::yuyv2rgb(int width, int height, unsigned char *src, unsigned char *dest) {
-
-    int Y1,Y2,U,V;
-
-    for(int i=width*height/2;i>0;i--) {
-
-        Y1 = *src++;
-        U  = *src++ - 128;
-        Y2 = *src++;
-        V  = *src++ - 128;
-
-        yuv2rgb_conv(Y1,U,V,dest);
-        yuv2rgb_conv(Y2,U,V,dest+=3);
-        dest+=3;
-    }
+    kernels->yuyv2rgb(src, dest, width*height);
 }
 
 void CameraEngine::crop_yuyv2rgb(int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
-
-    if(!cfg->frame) return;
-    int x_off = cfg->frame_xoff;
-    int y_off = cfg->frame_yoff;
-    int frm_w = cfg->frame_width;
-    int frm_h = cfg->frame_height;
-
-    int Y1,Y2,U,V;
-
-    cam_buf += 2*y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
-
-    for (int i=frm_h;i>0;i--) {
-
-        cam_buf +=  2*x_off;
-        for (int j=frm_w/2;j>0;j--) {
-            // U and V are +-0.5
-            Y1 = *cam_buf++;
-            U  = *cam_buf++ - 128;
-            Y2 = *cam_buf++;
-            V  = *cam_buf++ - 128;
-
-            yuv2rgb_conv(Y1,U,V,frm_buf);
-            yuv2rgb_conv(Y2,U,V,frm_buf+=3);
-            frm_buf+=3;
-        }
-        cam_buf += 2*x_end;
-    }
+    crop_convert(kernels->yuyv2rgb, cam_w, cam_buf, frm_buf, 2, 3);
 }
 
 void CameraEngine::gray2rgb(int width, int height, unsigned char *src, unsigned char *dest) {
-
-    int size = width*height;
-    for (int i=size;i>0;i--) {
-        unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-        }
+    kernels->gray2rgb(src, dest, width*height);
 }
 
 void CameraEngine::crop_gray2rgb(int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
-
-    if(!cfg->frame) return;
-    int x_off = cfg->frame_xoff;
-    int y_off = cfg->frame_yoff;
-    int frm_w = cfg->frame_width;
-    int frm_h = cfg->frame_height;
-
-    cam_buf += y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
-
-    for (int i=frm_h;i>0;i--) {
-
-        cam_buf += x_off;
-        for (int j=frm_w;j>0;j--) {
-            unsigned char pixel = *cam_buf++;
-            *frm_buf++ = pixel;
-            *frm_buf++ = pixel;
-            *frm_buf++ = pixel;
-        }
-        cam_buf +=  x_end;
-    }
+    crop_convert(kernels->gray2rgb, cam_w, cam_buf, frm_buf, 1, 3);
 }
 
 void CameraEngine::grayw2rgb(int width, int height, unsigned char *src, unsigned char *dest) {
-    unsigned short src_pixel;
-    unsigned char dest_pixel;
-	unsigned char pixel;
-
-    for(int i=width*height;i>0;i--) {
-		pixel = *src++ ;
-        src_pixel = pixel | (*src++ << 8);
-        dest_pixel = (unsigned char)(src_pixel/4);
-        *dest++ = dest_pixel;
-        *dest++ = dest_pixel;
-        *dest++ = dest_pixel;        
-    }
+    kernels->grayw2rgb(src, dest, width*height);
 }
 
 void CameraEngine::crop_grayw2rgb(int cam_w, unsigned char *src, unsigned char *dest) {
-
-    if(!cfg->frame) return;
-    int x_off = cfg->frame_xoff;
-    int y_off = cfg->frame_yoff;
-    int frm_w = cfg->frame_width;
-    int frm_h = cfg->frame_height;
-
-    unsigned short src_pixel;
-    unsigned char dest_pixel;
-	unsigned char pixel;
-
-    src += 2*y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
-
-    for (int i=frm_h;i>0;i--) {
-
-        src += 2*x_off;
-        for (int j=frm_w;j>0;j--) {
-			pixel = *src++;
-            src_pixel = pixel | (*src++ << 8);
-            dest_pixel = (unsigned char)(src_pixel/4);
-
-            *dest++ = dest_pixel;
-            *dest++ = dest_pixel;
-            *dest++ = dest_pixel;
-        }
-        src +=  2*x_end;
-    }
-
+    crop_convert(kernels->grayw2rgb, cam_w, src, dest, 2, 3);
 }
 
 void CameraEngine::grayw2gray(int width, int height, unsigned char *src, unsigned char *dest) {
-
-    unsigned short value;
-	unsigned char pixel;
-
-    for(int i=width*height;i>0;i--) {
-		pixel = *src++;
-        value = pixel | (*src++ << 8);
-        *dest++ = (unsigned char)(value/4);
-    }
+    kernels->grayw2gray(src, dest, width*height);
 }
 
 void CameraEngine::crop_grayw2gray(int cam_w, unsigned char *src, unsigned char *dest) {
+    crop_convert(kernels->grayw2gray, cam_w, src, dest, 2, 1);
+}
+
+void CameraEngine::crop_convert(convert_kernel convert, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf, int src_b, int dest_b) {
 
     if(!cfg->frame) return;
     int x_off = cfg->frame_xoff;
@@ -471,21 +250,13 @@ void CameraEngine::crop_grayw2gray(int cam_w, unsigned char *src, unsigned char
     int frm_w = cfg->frame_width;
     int frm_h = cfg->frame_height;
 
-    unsigned short src_pixel;
-	unsigned char pixel;
-
-    src += 2*y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
+    cam_buf += src_b*(y_off*cam_w + x_off);
 
+    // one kernel call per row of the cropped frame
     for (int i=frm_h;i>0;i--) {
-
-        src += 2*x_off;
-        for (int j=frm_w;j>0;j--) {
-			pixel = *src++;
-            src_pixel = pixel | (*src++ << 8);
-            *dest++ = (unsigned char)(src_pixel/4);
-        }
-        src +=  2*x_end;
+        convert(cam_buf, frm_buf, frm_w);
+        cam_buf += src_b*cam_w;
+        frm_buf += dest_b*frm_w;
     }
 }
 
@@ -500,7 +271,7 @@ void CameraEngine::crop(int cam_w, int cam_h, unsigned char *cam_buf, unsigned c
     cam_buf += b*(y_off*cam_w + x_off);
 
     for (int i=frm_h;i>0;i--) {
-        memcpy(frm_buf, cam_buf, b*cam_w);
+        memcpy(frm_buf, cam_buf, b*frm_w);
 
         cam_buf += b*cam_w;
         frm_buf += b*frm_w;
@@ -510,10 +281,7 @@ void CameraEngine::crop(int cam_w, int cam_h, unsigned char *cam_buf, unsigned c
 void CameraEngine::flip(int width, int height, unsigned char *src, unsigned char *dest, int b) {
 
     int size = b*width*height;
-    dest += size-1;
-    for(int i=size;i>0;i--) {
-        *dest-- = *src++;
-    }
+    kernels->reverse(src, dest+size-1, size);
 }
 
 void CameraEngine::flip_crop(int cam_w, int cam_h, unsigned char *cam_buf, unsigned char *frm_buf, int b) {
@@ -524,69 +292,28 @@ void CameraEngine::flip_crop(int cam_w, int cam_h, unsigned char *cam_buf, unsig
     int frm_w = cfg->frame_width;
     int frm_h = cfg->frame_height;
 
-	cam_buf += b*y_off*cam_w;
+	cam_buf += b*(y_off*cam_w + x_off);
 	frm_buf += b*frm_w*frm_h-1;
-    int xend = (cam_w-(frm_w+x_off));
 
     for (int i=frm_h;i>0;i--) {
-
-		cam_buf +=  b*x_off;
-        for (int j=b*frm_w;j>0;j--) {
- 			*frm_buf-- = *cam_buf++;
-	    }
-        cam_buf +=  b*xend;
+        kernels->reverse(cam_buf, frm_buf, b*frm_w);
+        cam_buf += b*cam_w;
+        frm_buf -= b*frm_w;
     }
 }
 
 void CameraEngine::rgb2gray(int width, int height, unsigned char *src, unsigned char *dest) {
-
-    int R,G,B;
-    for (int i=width*height;i>0;i--) {
-
-        R = *src++;
-        G = *src++;
-        B = *src++;
-        *dest++ = HBT(R*77 + G*151 + B*28);
-    }
+    kernels->rgb2gray(src, dest, width*height);
 }
 
 void CameraEngine::flip_rgb2gray(int width, int height, unsigned char *src, unsigned char *dest) {
 
 	int size = width*height;
-	dest += size-1;
-
-    int R,G,B;
-    for (int i=size;i>0;i--) {
-
-        R = *src++;
-        G = *src++;
-        B = *src++;
-        *dest-- = HBT(R*77 + G*151 + B*28);
-    }
+	kernels->rgb2gray_reverse(src, dest+size-1, size);
 }
-void CameraEngine::crop_rgb2gray(int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
-
-    if(!cfg->frame) return;
-    int x_off = cfg->frame_xoff;
-    int y_off = cfg->frame_yoff;
-    int frm_w = cfg->frame_width;
-    int frm_h = cfg->frame_height;
 
-    cam_buf += 3*y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
-
-    int R,G,B;
-    for (int i=frm_h;i>0;i--) {
-
-        cam_buf += 3*x_off;
-        for (int j=frm_w;j>0;j--) {
-            R = *cam_buf++;
-            G = *cam_buf++;
-            B = *cam_buf++;
-            *frm_buf++ = HBT(R*77 + G*151 + B*28);
-        }
-        cam_buf += 3*x_end;
-    }
+void CameraEngine::crop_rgb2gray(int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
+    crop_convert(kernels->rgb2gray, cam_w, cam_buf, frm_buf, 3, 1);
 }
 
 void CameraEngine::flip_crop_rgb2gray(int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
@@ -597,21 +324,13 @@ void CameraEngine::flip_crop_rgb2gray(int cam_w, unsigned char *cam_buf, unsigne
     int frm_w = cfg->frame_width;
     int frm_h = cfg->frame_height;
 
-    cam_buf += 3*y_off*cam_w;
-    int x_end = cam_w-(frm_w+x_off);
+    cam_buf += 3*(y_off*cam_w + x_off);
 	frm_buf += frm_w*frm_h-1;
 
-    int R,G,B;
     for (int i=frm_h;i>0;i--) {
-
-        cam_buf += 3*x_off;
-        for (int j=frm_w;j>0;j--) {
-            R = *cam_buf++;
-            G = *cam_buf++;
-            B = *cam_buf++;
-            *frm_buf-- = HBT(R*77 + G*151 + B*28);
-        }
-        cam_buf += 3*x_end;
+        kernels->rgb2gray_reverse(cam_buf, frm_buf, frm_w);
+        cam_buf += 3*cam_w;
+        frm_buf -= frm_w;
     }
 }
 
@@ -30,6 +30,7 @@
 #include "FrameProcessor.h"
 #include "UserInterface.h"
 #include "tinyxml2.h"
+#include "PixelConvert.h"
 
 #ifdef __APPLE__
 #include <CoreFoundation/CFBundle.h>
@@ -89,6 +90,8 @@ extern const char* dstr[];
 #define DRIVER_UVCCAM   4
 #define DRIVER_FILE    10
 #define DRIVER_FOLDER  11
+#define DRIVER_MULTI   12
+#define DRIVER_REPLAY  13
 
 #define VALUE_INCREASE   79
 #define VALUE_DECREASE   80
@@ -119,12 +122,16 @@ struct CameraConfig {
     int cam_width;
     int cam_height;
     float cam_fps;
+    int decoder_threads;
+    int cam_buffers;
+    bool cam_userptr;
 
     int frame_width;
     int frame_height;
     int frame_xoff;
     int frame_yoff;
     int frame_mode;
+    int frame_scale;
 
     int brightness;
     int contrast;
@@ -170,6 +177,10 @@ public:
         cfg = cam_cfg;
         settingsDialog=false;
 
+        frame_time = 0;
+        frame_sequence = 0;
+        dropped_frames = 0;
+
         if (cfg->color) cfg->buf_format=FORMAT_RGB;
         else cfg->buf_format=FORMAT_GRAY;
     }
@@ -210,6 +221,18 @@ public:
     int getFormat() { return cfg->buf_format; }
     char* getName() { return cfg->name; }
 
+    // capture time in microseconds since the epoch (0 if unknown) and sequence number of the last frame
+    long long getFrameTime() { return frame_time; }
+    unsigned int getFrameSequence() { return frame_sequence; }
+    unsigned int getDroppedFrames() { return dropped_frames; }
+
+    // getFrame() waits for the next frame, so the camera thread does not need to sleep
+    virtual bool waitsForFrame() { return false; }
+
+    // getFrame() returns the capture buffer itself, which stays valid until it is released
+    virtual bool sharesFrames() { return false; }
+    virtual void releaseFrame(unsigned char *frame) {}
+
 protected:
 
     CameraConfig *cfg;
@@ -219,6 +242,10 @@ protected:
 
     int lost_frames, timeout;
 
+    long long frame_time;
+    unsigned int frame_sequence;
+    unsigned int dropped_frames;
+
     bool running;
     bool settingsDialog;
     int currentCameraSetting;
@@ -251,6 +278,8 @@ protected:
     void grayw2gray(int width, int height, unsigned char *src, unsigned char *dest);
     void crop_grayw2gray(int width, unsigned char *src, unsigned char *dest);
 
+    void crop_convert(convert_kernel convert, int width, unsigned char *src, unsigned char *dest, int src_bytes, int dest_bytes);
+
     void resetCameraSettings();
     void applyCameraSettings();
     void applyCameraSetting(int mode, int value);
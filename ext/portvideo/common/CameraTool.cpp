@@ -92,10 +92,10 @@ std::vector<CameraConfig> CameraTool::findDevices() {
 #ifdef LINUX
 	std::vector<CameraConfig> sys_list = V4Linux2Camera::getCameraConfigs();
 		dev_list.insert(dev_list.end(), sys_list.begin(), sys_list.end());
-#else // ps3eye for WIN32 and MACOS
+#endif
+
 	std::vector<CameraConfig> ps3eye_list = PS3EyeCamera::getCameraConfigs();
 	dev_list.insert(dev_list.end(), ps3eye_list.begin(), ps3eye_list.end());
-#endif
 	
 #ifdef WIN32
 	std::vector<CameraConfig> sys_list = videoInputCamera::getCameraConfigs();
@@ -132,7 +132,8 @@ void CameraTool::listDevices() {
 		else  printf("%d system cameras found:\n",dev_count);
 		printConfig(V4Linux2Camera::getCameraConfigs());
 	}
-#else // ps3eye for WIN32 and MACOS
+#endif
+
 	dev_count = PS3EyeCamera::getDeviceCount();
 	if(dev_count == 0) printf("no PS3Eye camera found\n");
 	else {
@@ -140,7 +141,6 @@ void CameraTool::listDevices() {
 		else  printf("%d PS3Eye cameras found:\n", dev_count);
 		printConfig(PS3EyeCamera::getCameraConfigs());
 	}
-#endif
 	
 #ifdef WIN32
 	dev_count = videoInputCamera::getDeviceCount();
@@ -186,7 +186,6 @@ CameraEngine* CameraTool::getCamera(CameraConfig *cam_cfg) {
 	CameraEngine* camera = NULL;
 	int dev_count;
 	
-#ifndef NDEBUG
 	if (cam_cfg->driver==DRIVER_FILE) {
 		camera = FileCamera::getCamera(cam_cfg);
 		if (camera) return camera;
@@ -196,16 +195,23 @@ CameraEngine* CameraTool::getCamera(CameraConfig *cam_cfg) {
 		camera = FolderCamera::getCamera(cam_cfg);
 		if (camera) return camera;
 	}
-#endif
 
-#ifndef LINUX
+	if (cam_cfg->driver==DRIVER_MULTI) {
+		camera = MultiCamera::getCamera(cam_cfg);
+		if (camera) return camera;
+	}
+
+	if (cam_cfg->driver==DRIVER_REPLAY) {
+		camera = ReplayCamera::getCamera(cam_cfg);
+		if (camera) return camera;
+	}
+
 	if(cam_cfg->driver == DRIVER_PS3EYE) {
 		dev_count = PS3EyeCamera::getDeviceCount();
 		if(dev_count == 0) printf("no PS3Eye camera found\n");
 		else camera = PS3EyeCamera::getCamera(cam_cfg);
 		if(camera) return camera;
 	}
-#endif
 
 #ifdef WIN32
 	dev_count = videoInputCamera::getDeviceCount();
@@ -260,6 +266,9 @@ void CameraTool::initCameraConfig(CameraConfig *cfg) {
 	cfg->cam_width = SETTING_MAX;
 	cfg->cam_height = SETTING_MAX;
 	cfg->cam_fps = SETTING_MAX;
+	cfg->decoder_threads = 0;
+	cfg->cam_buffers = 0;
+	cfg->cam_userptr = false;
 	
 	cfg->frame = false;
 	cfg->frame_width = SETTING_MAX;
@@ -267,6 +276,7 @@ void CameraTool::initCameraConfig(CameraConfig *cfg) {
 	cfg->frame_xoff = 0;
 	cfg->frame_yoff = 0;
 	cfg->frame_mode = -1;
+	cfg->frame_scale = 1;
 	
 	cfg->brightness = SETTING_DEFAULT;
 	cfg->contrast = SETTING_DEFAULT;
@@ -319,6 +329,9 @@ void CameraTool::setCameraConfig(CameraConfig *cfg) {
 	cam_cfg.cam_width = cfg->cam_width;
 	cam_cfg.cam_height = cfg->cam_height;
 	cam_cfg.cam_fps = cfg->cam_fps;
+	cam_cfg.decoder_threads = cfg->decoder_threads;
+	cam_cfg.cam_buffers = cfg->cam_buffers;
+	cam_cfg.cam_userptr = cfg->cam_userptr;
 	
 	cam_cfg.frame = cfg->frame;
 	cam_cfg.frame_width = SETTING_MAX;
@@ -326,6 +339,7 @@ void CameraTool::setCameraConfig(CameraConfig *cfg) {
 	cam_cfg.frame_xoff = 0;
 	cam_cfg.frame_yoff = 0;
 	cam_cfg.frame_mode = cfg->frame_mode;
+	cam_cfg.frame_scale = cfg->frame_scale;
 	
 	cam_cfg.force = cfg->force;
 }
@@ -376,122 +390,151 @@ CameraConfig* CameraTool::readSettings(const char* cfgfile) {
 		return &cam_cfg;
 	}
 	
+	readCameraConfig(camera,&cam_cfg,path);
+	
+	return &cam_cfg;
+}
+
+void CameraTool::readCameraConfig(tinyxml2::XMLHandle camera, CameraConfig *cfg, const char *path) {
+	
+	tinyxml2::XMLElement* camera_element = camera.ToElement();
+	if (camera_element==NULL) return;
+	
 	if(camera_element->Attribute("driver")!=NULL) {
-		if (strcmp(camera_element->Attribute("driver"), "dc1394" ) == 0) cam_cfg.driver=DRIVER_DC1394;
-		else if (strcmp(camera_element->Attribute("driver"), "ps3eye" ) == 0) cam_cfg.driver=DRIVER_PS3EYE;
-		else if (strcmp(camera_element->Attribute("driver"), "file" ) == 0) cam_cfg.driver=DRIVER_FILE;
-		else if (strcmp(camera_element->Attribute("driver"), "folder" ) == 0) cam_cfg.driver=DRIVER_FOLDER;
+		if (strcmp(camera_element->Attribute("driver"), "dc1394" ) == 0) cfg->driver=DRIVER_DC1394;
+		else if (strcmp(camera_element->Attribute("driver"), "ps3eye" ) == 0) cfg->driver=DRIVER_PS3EYE;
+		else if (strcmp(camera_element->Attribute("driver"), "file" ) == 0) cfg->driver=DRIVER_FILE;
+		else if (strcmp(camera_element->Attribute("driver"), "folder" ) == 0) cfg->driver=DRIVER_FOLDER;
+		else if (strcmp(camera_element->Attribute("driver"), "multi" ) == 0) cfg->driver=DRIVER_MULTI;
+		else if (strcmp(camera_element->Attribute("driver"), "replay" ) == 0) cfg->driver=DRIVER_REPLAY;
 	}
 	
 	if(camera_element->Attribute("id")!=NULL) {
-		if (strcmp(camera_element->Attribute("id"), "auto" ) == 0) cam_cfg.device=SETTING_AUTO;
-		else cam_cfg.device = atoi(camera_element->Attribute("id"));
+		if (strcmp(camera_element->Attribute("id"), "auto" ) == 0) cfg->device=SETTING_AUTO;
+		else cfg->device = atoi(camera_element->Attribute("id"));
 	}
 	
 	if(camera_element->Attribute("src")!=NULL) {
 #ifdef __APPLE__
-		snprintf(cam_cfg.src,256,"%s/../%s",path,camera_element->Attribute("src"));
+		snprintf(cfg->src,256,"%s/../%s",path,camera_element->Attribute("src"));
 #else
-		snprintf(cam_cfg.src,256,"%s",camera_element->Attribute("src"));
+		snprintf(cfg->src,256,"%s",camera_element->Attribute("src"));
 #endif
 	}
 	
 	tinyxml2::XMLElement* image_element = camera.FirstChildElement("capture").ToElement();
 	
 	if (image_element!=NULL) {
-		if ((image_element->Attribute("color")!=NULL) && ( strcmp( image_element->Attribute("color"), "true" ) == 0 )) cam_cfg.color = true;
+		if ((image_element->Attribute("color")!=NULL) && ( strcmp( image_element->Attribute("color"), "true" ) == 0 )) cfg->color = true;
 		
 		if (image_element->Attribute("format")!=NULL) {
 			for (int i=FORMAT_MAX;i>0;i--) {
-				if (strcmp( image_element->Attribute("format"), fstr[i] ) == 0) cam_cfg.cam_format = i;
+				if (strcmp( image_element->Attribute("format"), fstr[i] ) == 0) cfg->cam_format = i;
 			}
 		}
 		
 		if(image_element->Attribute("width")!=NULL) {
-			if (strcmp( image_element->Attribute("width"), "max" ) == 0) cam_cfg.cam_width = SETTING_MAX;
-			else if (strcmp( image_element->Attribute("width"), "min" ) == 0) cam_cfg.cam_width = SETTING_MIN;
-			else cam_cfg.cam_width = atoi(image_element->Attribute("width"));
+			if (strcmp( image_element->Attribute("width"), "max" ) == 0) cfg->cam_width = SETTING_MAX;
+			else if (strcmp( image_element->Attribute("width"), "min" ) == 0) cfg->cam_width = SETTING_MIN;
+			else cfg->cam_width = atoi(image_element->Attribute("width"));
 		}
 		if(image_element->Attribute("height")!=NULL) {
-			if (strcmp( image_element->Attribute("height"), "max" ) == 0) cam_cfg.cam_height = SETTING_MAX;
-			else if (strcmp( image_element->Attribute("height"), "min" ) == 0) cam_cfg.cam_height = SETTING_MIN;
-			else cam_cfg.cam_height = atoi(image_element->Attribute("height"));
+			if (strcmp( image_element->Attribute("height"), "max" ) == 0) cfg->cam_height = SETTING_MAX;
+			else if (strcmp( image_element->Attribute("height"), "min" ) == 0) cfg->cam_height = SETTING_MIN;
+			else cfg->cam_height = atoi(image_element->Attribute("height"));
 		}
 		if(image_element->Attribute("fps")!=NULL) {
-			if (strcmp( image_element->Attribute("fps"), "max" ) == 0) cam_cfg.cam_fps = SETTING_MAX;
-			else if (strcmp( image_element->Attribute("fps"), "min" ) == 0) cam_cfg.cam_fps = SETTING_MIN;
-			else cam_cfg.cam_fps = atof(image_element->Attribute("fps"));
+			if (strcmp( image_element->Attribute("fps"), "max" ) == 0) cfg->cam_fps = SETTING_MAX;
+			else if (strcmp( image_element->Attribute("fps"), "min" ) == 0) cfg->cam_fps = SETTING_MIN;
+			else cfg->cam_fps = atof(image_element->Attribute("fps"));
 		}
-		if ((image_element->Attribute("force")!=NULL) && ( strcmp( image_element->Attribute("force"), "true" ) == 0 )) cam_cfg.force = true;
+		// decoder threads for compressed formats
+		if(image_element->Attribute("threads")!=NULL) {
+			if (strcmp( image_element->Attribute("threads"), "auto" ) == 0) cfg->decoder_threads = SETTING_AUTO;
+			else cfg->decoder_threads = atoi(image_element->Attribute("threads"));
+		}
+		// number of capture buffers and their allocation
+		if(image_element->Attribute("buffers")!=NULL) cfg->cam_buffers = atoi(image_element->Attribute("buffers"));
+		if ((image_element->Attribute("memory")!=NULL) && ( strcmp( image_element->Attribute("memory"), "userptr" ) == 0 )) cfg->cam_userptr = true;
+		// no device of the pipeline exports its frame buffers, so there is nothing to import as DMABUF
+		if ((image_element->Attribute("memory")!=NULL) && ( strcmp( image_element->Attribute("memory"), "dmabuf" ) == 0 )) {
+			printf("DMABUF capture is not supported, using user pointer buffers\n");
+			cfg->cam_userptr = true;
+		}
+		if ((image_element->Attribute("force")!=NULL) && ( strcmp( image_element->Attribute("force"), "true" ) == 0 )) cfg->force = true;
 	}
 	
 	tinyxml2::XMLElement* frame_element = camera.FirstChildElement("frame").ToElement();
 	if (frame_element!=NULL) {
-		cam_cfg.frame = true;
+		cfg->frame = true;
 		
 		if(frame_element->Attribute("width")!=NULL) {
-			if (strcmp( frame_element->Attribute("width"), "max" ) == 0) cam_cfg.frame_width = SETTING_MAX;
-			else if (strcmp( frame_element->Attribute("width"), "min" ) == 0) cam_cfg.frame_width = 0;
-			else cam_cfg.frame_width = atoi(frame_element->Attribute("width"));
+			if (strcmp( frame_element->Attribute("width"), "max" ) == 0) cfg->frame_width = SETTING_MAX;
+			else if (strcmp( frame_element->Attribute("width"), "min" ) == 0) cfg->frame_width = 0;
+			else cfg->frame_width = atoi(frame_element->Attribute("width"));
 		}
 		
 		if(frame_element->Attribute("height")!=NULL) {
-			if (strcmp( frame_element->Attribute("height"), "max" ) == 0) cam_cfg.frame_height = SETTING_MAX;
-			else if (strcmp( frame_element->Attribute("height"), "min" ) == 0) cam_cfg.frame_height = 0;
-			else cam_cfg.frame_height = atoi(frame_element->Attribute("height"));
+			if (strcmp( frame_element->Attribute("height"), "max" ) == 0) cfg->frame_height = SETTING_MAX;
+			else if (strcmp( frame_element->Attribute("height"), "min" ) == 0) cfg->frame_height = 0;
+			else cfg->frame_height = atoi(frame_element->Attribute("height"));
 		}
 		
 		if(frame_element->Attribute("xoff")!=NULL) {
-			if (strcmp( frame_element->Attribute("xoff"), "max" ) == 0) cam_cfg.frame_xoff = SETTING_MAX;
-			else if (strcmp( frame_element->Attribute("xoff"), "min" ) == 0) cam_cfg.frame_xoff = 0;
-			else cam_cfg.frame_xoff = atoi(frame_element->Attribute("xoff"));
+			if (strcmp( frame_element->Attribute("xoff"), "max" ) == 0) cfg->frame_xoff = SETTING_MAX;
+			else if (strcmp( frame_element->Attribute("xoff"), "min" ) == 0) cfg->frame_xoff = 0;
+			else cfg->frame_xoff = atoi(frame_element->Attribute("xoff"));
 		}
 		
 		if(frame_element->Attribute("yoff")!=NULL) {
-			if (strcmp( frame_element->Attribute("yoff"), "max" ) == 0) cam_cfg.frame_yoff = SETTING_MAX;
-			else if (strcmp( frame_element->Attribute("yoff"), "min" ) == 0) cam_cfg.frame_yoff = 0;
-			else cam_cfg.frame_yoff = atoi(frame_element->Attribute("yoff"));
+			if (strcmp( frame_element->Attribute("yoff"), "max" ) == 0) cfg->frame_yoff = SETTING_MAX;
+			else if (strcmp( frame_element->Attribute("yoff"), "min" ) == 0) cfg->frame_yoff = 0;
+			else cfg->frame_yoff = atoi(frame_element->Attribute("yoff"));
 		}
 		
 		if(frame_element->Attribute("mode")!=NULL) {
-			if (strcmp( frame_element->Attribute("mode"), "max" ) == 0) cam_cfg.frame_mode = SETTING_MAX;
-			else if (strcmp( frame_element->Attribute("mode"), "min" ) == 0) cam_cfg.frame_mode = 0;
-			else cam_cfg.frame_mode = atoi(frame_element->Attribute("mode"));
+			if (strcmp( frame_element->Attribute("mode"), "max" ) == 0) cfg->frame_mode = SETTING_MAX;
+			else if (strcmp( frame_element->Attribute("mode"), "min" ) == 0) cfg->frame_mode = 0;
+			else cfg->frame_mode = atoi(frame_element->Attribute("mode"));
+		}
+		
+		// DCT scaling of compressed frames: 1, 2, 4 or 8
+		if(frame_element->Attribute("scale")!=NULL) {
+			cfg->frame_scale = atoi(frame_element->Attribute("scale"));
+			if ((cfg->frame_scale!=2) && (cfg->frame_scale!=4) && (cfg->frame_scale!=8)) cfg->frame_scale = 1;
 		}
 	}
 	
 	tinyxml2::XMLElement* settings_element = camera.FirstChildElement("settings").ToElement();
 	if (settings_element!=NULL) {
 		
-		cam_cfg.brightness = readAttribute(settings_element, "brightness");
-		cam_cfg.contrast = readAttribute(settings_element, "contrast");
-		cam_cfg.sharpness = readAttribute(settings_element, "sharpness");
-		cam_cfg.gain = readAttribute(settings_element, "gain");
+		cfg->brightness = readAttribute(settings_element, "brightness");
+		cfg->contrast = readAttribute(settings_element, "contrast");
+		cfg->sharpness = readAttribute(settings_element, "sharpness");
+		cfg->gain = readAttribute(settings_element, "gain");
 		
-		cam_cfg.exposure = readAttribute(settings_element, "exposure");
-		cam_cfg.shutter = readAttribute(settings_element, "shutter");
-		cam_cfg.focus = readAttribute(settings_element, "focus");
-		cam_cfg.white = readAttribute(settings_element, "white");
-		cam_cfg.powerline = readAttribute(settings_element, "powerline");
-		cam_cfg.backlight = readAttribute(settings_element, "backlight");
-		cam_cfg.gamma = readAttribute(settings_element, "gamma");
+		cfg->exposure = readAttribute(settings_element, "exposure");
+		cfg->shutter = readAttribute(settings_element, "shutter");
+		cfg->focus = readAttribute(settings_element, "focus");
+		cfg->white = readAttribute(settings_element, "white");
+		cfg->powerline = readAttribute(settings_element, "powerline");
+		cfg->backlight = readAttribute(settings_element, "backlight");
+		cfg->gamma = readAttribute(settings_element, "gamma");
 		
-		if (cam_cfg.color) {
-			cam_cfg.saturation= readAttribute(settings_element, "saturation");
-			cam_cfg.hue = readAttribute(settings_element, "hue");
-			cam_cfg.red = readAttribute(settings_element, "red");
-			cam_cfg.green = readAttribute(settings_element, "green");
-			cam_cfg.blue = readAttribute(settings_element, "blue");
+		if (cfg->color) {
+			cfg->saturation= readAttribute(settings_element, "saturation");
+			cfg->hue = readAttribute(settings_element, "hue");
+			cfg->red = readAttribute(settings_element, "red");
+			cfg->green = readAttribute(settings_element, "green");
+			cfg->blue = readAttribute(settings_element, "blue");
 		} else {
-			cam_cfg.saturation = SETTING_OFF;
-			cam_cfg.hue = SETTING_OFF;
-			cam_cfg.red = SETTING_OFF;
-			cam_cfg.green = SETTING_OFF;
-			cam_cfg.blue = SETTING_OFF;
+			cfg->saturation = SETTING_OFF;
+			cfg->hue = SETTING_OFF;
+			cfg->red = SETTING_OFF;
+			cfg->green = SETTING_OFF;
+			cfg->blue = SETTING_OFF;
 		}
 	}
-	
-	return &cam_cfg;
 }
 
 int CameraTool::readAttribute(tinyxml2::XMLElement* settings,const char *attribute) {
@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include "DC1394Camera.h"
 #include "V4Linux2Camera.h"
+#include "PS3EyeCamera.h"
 #endif
 
 #ifdef __APPLE__
@@ -40,10 +41,10 @@
 #include "PS3EyeCamera.h"
 #endif
 
-#ifndef NDEBUG
 #include "FileCamera.h"
 #include "FolderCamera.h"
-#endif
+#include "MultiCamera.h"
+#include "ReplayCamera.h"
 
 #include <iostream>
 #include <vector>
@@ -67,6 +68,7 @@ public:
     
     static void initCameraConfig(CameraConfig *cfg);
 	static void setCameraConfig(CameraConfig *cfg);
+	static void readCameraConfig(tinyxml2::XMLHandle camera, CameraConfig *cfg, const char *path);
     
 private:
     
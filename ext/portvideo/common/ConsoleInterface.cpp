@@ -69,6 +69,9 @@ void ConsoleInterface::processEvents()
 			case 'v':
 				verbose_=!verbose_;
 				break;
+			case 'm':
+				engine_->toggleRecording();
+				break;
 			case 'p':
 				pause_ = true;
 				std::cout << "paused - press any key to continue" << std::endl;
@@ -169,6 +172,7 @@ ConsoleInterface::ConsoleInterface(const char* name)
     help_text.push_back("   v - verbose output");
     help_text.push_back("   h - show help text");
     help_text.push_back("   p - pause processing");
+    help_text.push_back("   m - record camera frames");
 
 }
 
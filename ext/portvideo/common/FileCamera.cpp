@@ -16,7 +16,6 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#ifndef NDEBUG
 #include "FileCamera.h"
 #ifdef WIN32
 #include <windows.h>
@@ -94,20 +93,24 @@ bool FileCamera::initCamera() {
 	fclose(imagefile);
 	if ((int)size!=cfg->cam_width*cfg->cam_height) return false;
 
-	cfg->cam_fps = 1;
+	// a frame rate of zero repeats the image as fast as possible
+	if (cfg->cam_fps==SETTING_MIN) cfg->cam_fps = 15;
+	if (cfg->cam_fps==SETTING_MAX) cfg->cam_fps = 30;
+	if (cfg->cam_fps<0) cfg->cam_fps = 30;
 	setupFrame();
 	return true;
 }
 
 unsigned char* FileCamera::getFrame()
 {
-	if (running) {
+	if (!running) running = true;
+	else if (cfg->cam_fps>0) {
 #ifdef WIN32
-	Sleep(100);
+		Sleep((int)(1000/cfg->cam_fps));
 #else
-	usleep( 10000 ); // do 10fps
+		usleep( (int)(1000000/cfg->cam_fps) );
 #endif
-	} else running = true;
+	}
 	return cam_buffer;
 }
 
@@ -136,5 +139,3 @@ bool FileCamera::closeCamera()
 {
 	return true;
 }
-#endif
-
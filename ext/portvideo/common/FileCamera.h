@@ -16,7 +16,6 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#ifndef NDEBUG
 #ifndef FileCamera_H
 #define FileCamera_H
 
@@ -60,4 +59,3 @@ public:
 };
 
 #endif
-#endif
@@ -16,8 +16,6 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#ifndef NDEBUG
-
 #include "FolderCamera.h"
 #ifdef WIN32
 #include <windows.h>
@@ -26,15 +24,14 @@
 FolderCamera::FolderCamera(CameraConfig *cam_cfg): CameraEngine(cam_cfg)
 {
 	cam_buffer = NULL;
-	file_buffer = NULL;
+	frame_index = 0;
 	snprintf(cfg->name,256,"%s","FolderCamera");
 	running=false;
 }
 
 FolderCamera::~FolderCamera()
 {
-	if (cam_buffer!=NULL) delete cam_buffer;
-	if (file_buffer!=NULL) delete file_buffer;
+	for (unsigned int i=0;i<frame_list.size();i++) delete[] frame_list[i];
 }
 
 CameraEngine* FolderCamera::getCamera(CameraConfig *cam_cfg) {
@@ -50,6 +47,7 @@ bool FolderCamera::initCamera() {
 	char header[32];
 	char file_name[256];
 	char *param;
+	std::list<std::string> image_list;
 	
 #ifdef WIN32
 	WIN32_FIND_DATA results;
@@ -112,19 +110,23 @@ bool FolderCamera::initCamera() {
 	if ((cfg->cam_width==0) || (cfg->cam_height==0) ) return false;
 	//printf("%d %d\n",cfg->cam_width,cfg->cam_height);
 	
+	// all images are decoded once, so that the replay is not limited by the file access
+	for (std::list<std::string>::iterator image=image_list.begin(); image!=image_list.end(); image++) {
+		unsigned char *frame = loadImage(image->c_str());
+		if (frame!=NULL) frame_list.push_back(frame);
+	}
+	if (frame_list.size()==0) return false;
+	frame_index = 0;
 	
-	cam_buffer = new unsigned char[cfg->cam_width*cfg->cam_height*cfg->buf_format];
-	if (cfg->cam_format!=cfg->buf_format) file_buffer = new unsigned char[cfg->cam_width*cfg->cam_height*cfg->cam_format];
-	
-	image_iterator = image_list.begin();
-	
+	// a frame rate of zero replays the images as fast as possible
 	if (cfg->cam_fps==SETTING_MIN) cfg->cam_fps = 15;
 	if (cfg->cam_fps==SETTING_MAX) cfg->cam_fps = 30;
+	if (cfg->cam_fps<0) cfg->cam_fps = 30;
 	setupFrame();
 	return true;
 }
 
-unsigned char* FolderCamera::getFrame()
+unsigned char* FolderCamera::loadImage(const char *file_name)
 {
 	int  max = 0;
 	char header[32];
@@ -132,14 +134,16 @@ unsigned char* FolderCamera::getFrame()
 	
 	int file_width =  0;
 	int file_height = 0;
-
-	FILE* imagefile=fopen(image_iterator->c_str(),"r");
+	
+	FILE* imagefile=fopen(file_name,"rb");
 	if (imagefile==NULL) return NULL;
 	
 	fgets(header,32,imagefile);
 	while (strstr(header,"#")!=NULL) fgets(header,32,imagefile);
-	if ((cfg->cam_format==FORMAT_RGB) && (strstr(header,"P6")==NULL)) return NULL;
-	else if  ((cfg->cam_format==FORMAT_GRAY) && (strstr(header,"P5")==NULL)) return NULL;
+	if (((cfg->cam_format==FORMAT_RGB) && (strstr(header,"P6")==NULL)) || ((cfg->cam_format==FORMAT_GRAY) && (strstr(header,"P5")==NULL))) {
+		fclose(imagefile);
+		return NULL;
+	}
 	
 	fgets(header,32,imagefile);
 	while (strstr(header,"#")!=NULL) fgets(header,32,imagefile);
@@ -147,10 +151,10 @@ unsigned char* FolderCamera::getFrame()
 	param = strtok(NULL," "); if (param) file_height =  atoi(param);
 	param = strtok(NULL," "); if (param) max = atoi(param);
 	
-	if (cfg->cam_height==0) 	{
+	if (file_height==0) 	{
 		fgets(header,32,imagefile);
 		while (strstr(header,"#")!=NULL) fgets(header,32,imagefile);
-		param = strtok(header," "); if (param) cfg->cam_height = atoi(param);
+		param = strtok(header," "); if (param) file_height = atoi(param);
 		param = strtok(NULL," "); if (param) max = atoi(param);
 	}
 	
@@ -159,35 +163,49 @@ unsigned char* FolderCamera::getFrame()
 		while (strstr(header,"#")!=NULL) fgets(header,32,imagefile);
 		param = strtok(header," "); if (param) max = atoi(param);
 	}
-
-	if ((file_width!=cfg->cam_width) || (file_height!=cfg->cam_height) ) return NULL;
+	
+	if ((file_width!=cfg->cam_width) || (file_height!=cfg->cam_height) ) {
+		fclose(imagefile);
+		return NULL;
+	}
 	
 	size_t size;
+	unsigned char *frame = new unsigned char[cfg->cam_width*cfg->cam_height*cfg->buf_format];
 	if (cfg->cam_format!=cfg->buf_format) {
 		unsigned char *file_buffer = new unsigned char[cfg->cam_width*cfg->cam_height*cfg->cam_format];
 		size = fread(file_buffer, cfg->cam_format,cfg->cam_width*cfg->cam_height, imagefile);
 		
-		if (cfg->color) gray2rgb(cfg->cam_width, cfg->cam_height, file_buffer, cam_buffer);
-		else rgb2gray(cfg->cam_width, cfg->cam_height, file_buffer, cam_buffer);
+		if (cfg->color) gray2rgb(cfg->cam_width, cfg->cam_height, file_buffer, frame);
+		else rgb2gray(cfg->cam_width, cfg->cam_height, file_buffer, frame);
 		delete []file_buffer;
 	} else {
-		size = fread(cam_buffer, cfg->cam_format,cfg->cam_width*cfg->cam_height, imagefile);
+		size = fread(frame, cfg->cam_format,cfg->cam_width*cfg->cam_height, imagefile);
 	}
 	
 	fclose(imagefile);
-	if ((int)size!=cfg->cam_width*cfg->cam_height) return NULL;
-
-	image_iterator++;
-	if(image_iterator == image_list.end()) image_iterator=image_list.begin();
+	if ((int)size!=cfg->cam_width*cfg->cam_height) {
+		delete []frame;
+		return NULL;
+	}
 	
+	return frame;
+}
+
+unsigned char* FolderCamera::getFrame()
+{
+	unsigned char *frame = frame_list[frame_index];
+	frame_index++;
+	if (frame_index == frame_list.size()) frame_index = 0;
 	
+	if (cfg->cam_fps>0) {
 #ifdef WIN32
-	Sleep((int)(1000/cfg->cam_fps));
+		Sleep((int)(1000/cfg->cam_fps));
 #else
-	usleep( (int)(1000000/cfg->cam_fps) );
+		usleep( (int)(1000000/cfg->cam_fps) );
 #endif
+	}
 	
-	return cam_buffer;
+	return frame;
 }
 
 bool FolderCamera::startCamera()
@@ -215,5 +233,3 @@ bool FolderCamera::closeCamera()
 {
 	return true;
 }
-#endif
-
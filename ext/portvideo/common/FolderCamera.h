@@ -16,8 +16,6 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#ifndef NDEBUG
-
 #ifndef FOLDERCAMERA_H
 #define FOLDERCAMERA_H
 
@@ -32,6 +30,7 @@
 #include "CameraEngine.h"
 
 #include <list>
+#include <vector>
 #include <string>
 
 class FolderCamera : public CameraEngine
@@ -64,12 +63,14 @@ public:
 	bool showSettingsDialog(bool lock) { return lock; }
 	void control(unsigned char key) {};
 	
+	unsigned int getFrameCount() { return (unsigned int)frame_list.size(); }
+	
 private:
-	std::list<std::string> image_list;
-	std::list<std::string>::iterator image_iterator;
-	unsigned char *file_buffer;
+	unsigned char* loadImage(const char *file_name);
+	
+	std::vector<unsigned char*> frame_list;
+	unsigned int frame_index;
 	
 };
 
 #endif
-#endif
@@ -0,0 +1,344 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "FrameCompressor.h"
+#include <string.h>
+
+// each strip is coded as a sequence of tokens:
+// 00nnnnnn  a run of n+1 unchanged values
+// 01nnnnnn  n+1 pairs of differences within -8..7, packed into one byte per pair
+// 1nnnnnnn  n+1 differences of any size, one byte each
+#define TOKEN_ZERO 0x00
+#define TOKEN_PAIR 0x40
+#define TOKEN_LITERAL 0x80
+
+#define SMALL_RESIDUAL(r) ((unsigned char)((r)+8)<16)
+
+// a run of differences only ends where the following values are cheaper to code on their own,
+// so that every frame stays within one extra byte per 128 values
+static inline bool cheaperToken(const unsigned char *residual, int i, int size) {
+
+	if ((i+3<=size) && ((residual[i]|residual[i+1]|residual[i+2])==0)) return true;
+	if (i+6>size) return false;
+	for (int j=i;j<i+6;j++)
+		if (!SMALL_RESIDUAL(residual[j])) return false;
+	return true;
+}
+
+#ifdef WIN32
+static DWORD WINAPI compressor_thread_function( LPVOID obj )
+#else
+static void* compressor_thread_function( void *obj )
+#endif
+{
+	compressor_data *data = (compressor_data *)obj;
+
+	for (;;) {
+#ifdef WIN32
+		WaitForSingleObject(data->start_event, INFINITE);
+#else
+		pthread_mutex_lock(&data->mutex);
+		while (!data->process && !data->done)
+			pthread_cond_wait(&data->cond, &data->mutex);
+		pthread_mutex_unlock(&data->mutex);
+#endif
+		if (data->done) break;
+
+		data->compressor->processStrips(data->id);
+
+#ifdef WIN32
+		data->process = false;
+		SetEvent(data->done_event);
+#else
+		pthread_mutex_lock(&data->mutex);
+		data->process = false;
+		pthread_cond_signal(&data->cond);
+		pthread_mutex_unlock(&data->mutex);
+#endif
+	}
+
+	return(0);
+}
+
+FrameCompressor::FrameCompressor(int width, int height, int format, int threads, int strips) {
+
+	bytes = format;
+
+	strip_count = strips;
+	if (strip_count>height) strip_count = height;
+	if (strip_count<1) strip_count = 1;
+
+	thread_count = threads;
+	if (thread_count>strip_count) thread_count = strip_count;
+	if (thread_count>MAX_COMPRESSOR_THREADS) thread_count = MAX_COMPRESSOR_THREADS;
+	if (thread_count<1) thread_count = 1;
+
+	strip_offset = new int[strip_count];
+	strip_length = new int[strip_count];
+	int max_length = 0;
+	for (int i=0;i<strip_count;i++) {
+		int first_row = i*height/strip_count;
+		int last_row = (i+1)*height/strip_count;
+		strip_offset[i] = first_row*width*format;
+		strip_length[i] = (last_row-first_row)*width*format;
+		if (strip_length[i]>max_length) max_length = strip_length[i];
+	}
+
+	// even a frame of noise only grows by one literal token per 128 bytes
+	strip_bound = max_length + max_length/128 + 1;
+	max_size = (1+strip_count)*sizeof(uint32_t) + strip_count*strip_bound;
+
+	strip_buffer = new unsigned char[strip_count*strip_bound];
+	strip_src = new unsigned char*[strip_count];
+	strip_size = new unsigned int[strip_count];
+	strip_ok = new bool[strip_count];
+
+	residual = new unsigned char*[thread_count];
+	for (int i=0;i<thread_count;i++) residual[i] = new unsigned char[max_length];
+
+	encoding = key_frame = false;
+	job_frame = job_previous = NULL;
+
+	// the calling thread codes the strips of the first thread itself
+	for (int i=1;i<thread_count;i++) {
+		tdata[i].compressor = this;
+		tdata[i].id = i;
+		tdata[i].process = false;
+		tdata[i].done = false;
+#ifdef WIN32
+		DWORD threadId;
+		tdata[i].start_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+		tdata[i].done_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+		tdata[i].thread = CreateThread( 0, 0, compressor_thread_function, &tdata[i], 0, &threadId );
+#else
+		pthread_mutex_init(&tdata[i].mutex, NULL);
+		pthread_cond_init(&tdata[i].cond, NULL);
+		pthread_create(&tdata[i].thread , NULL, compressor_thread_function, &tdata[i]);
+#endif
+	}
+}
+
+FrameCompressor::~FrameCompressor() {
+
+	for (int i=1;i<thread_count;i++) {
+#ifdef WIN32
+		tdata[i].done = true;
+		SetEvent(tdata[i].start_event);
+		WaitForSingleObject(tdata[i].thread, INFINITE);
+		CloseHandle(tdata[i].thread);
+		CloseHandle(tdata[i].start_event);
+		CloseHandle(tdata[i].done_event);
+#else
+		pthread_mutex_lock(&tdata[i].mutex);
+		tdata[i].done = true;
+		pthread_cond_signal(&tdata[i].cond);
+		pthread_mutex_unlock(&tdata[i].mutex);
+		pthread_join(tdata[i].thread, NULL);
+		pthread_cond_destroy(&tdata[i].cond);
+		pthread_mutex_destroy(&tdata[i].mutex);
+#endif
+	}
+
+	for (int i=0;i<thread_count;i++) delete[] residual[i];
+	delete[] residual;
+	delete[] strip_buffer;
+	delete[] strip_src;
+	delete[] strip_size;
+	delete[] strip_ok;
+	delete[] strip_offset;
+	delete[] strip_length;
+}
+
+void FrameCompressor::runJob() {
+
+	for (int i=1;i<thread_count;i++) {
+#ifdef WIN32
+		tdata[i].process = true;
+		SetEvent(tdata[i].start_event);
+#else
+		pthread_mutex_lock(&tdata[i].mutex);
+		tdata[i].process = true;
+		pthread_cond_signal(&tdata[i].cond);
+		pthread_mutex_unlock(&tdata[i].mutex);
+#endif
+	}
+
+	processStrips(0);
+
+	for (int i=1;i<thread_count;i++) {
+#ifdef WIN32
+		WaitForSingleObject(tdata[i].done_event, INFINITE);
+#else
+		pthread_mutex_lock(&tdata[i].mutex);
+		while (tdata[i].process)
+			pthread_cond_wait(&tdata[i].cond, &tdata[i].mutex);
+		pthread_mutex_unlock(&tdata[i].mutex);
+#endif
+	}
+}
+
+void FrameCompressor::processStrips(int id) {
+
+	for (int i=id;i<strip_count;i+=thread_count) {
+		if (encoding) {
+			unsigned char *previous = key_frame ? NULL : job_previous+strip_offset[i];
+			strip_size[i] = encodeStrip(job_frame+strip_offset[i], previous, residual[id], strip_length[i], bytes, strip_buffer+i*strip_bound);
+		} else strip_ok[i] = decodeStrip(strip_src[i], strip_size[i], job_frame+strip_offset[i], strip_length[i], bytes, key_frame);
+	}
+}
+
+unsigned int FrameCompressor::compress(unsigned char *frame, unsigned char *previous, unsigned char *dest) {
+
+	encoding = true;
+	key_frame = (previous==NULL);
+	job_frame = frame;
+	job_previous = previous;
+	runJob();
+
+	uint32_t *header = (uint32_t*)dest;
+	header[0] = key_frame ? FRAME_KEY : 0;
+
+	unsigned char *data = dest + (1+strip_count)*sizeof(uint32_t);
+	for (int i=0;i<strip_count;i++) {
+		header[1+i] = strip_size[i];
+		memcpy(data, strip_buffer+i*strip_bound, strip_size[i]);
+		data += strip_size[i];
+	}
+
+	return (unsigned int)(data-dest);
+}
+
+bool FrameCompressor::decompress(unsigned char *src, unsigned int size, unsigned char *frame) {
+
+	unsigned int header_size = (1+strip_count)*sizeof(uint32_t);
+	if (size<header_size) return false;
+
+	uint32_t *header = (uint32_t*)src;
+	unsigned char *data = src + header_size;
+	unsigned int data_size = size - header_size;
+	for (int i=0;i<strip_count;i++) {
+		strip_size[i] = header[1+i];
+		if (strip_size[i]>data_size) return false;
+		strip_src[i] = data;
+		data += strip_size[i];
+		data_size -= strip_size[i];
+	}
+
+	encoding = false;
+	key_frame = ((header[0] & FRAME_KEY)!=0);
+	job_frame = frame;
+	runJob();
+
+	for (int i=0;i<strip_count;i++)
+		if (!strip_ok[i]) return false;
+	return true;
+}
+
+unsigned int FrameCompressor::encodeStrip(const unsigned char *src, const unsigned char *previous, unsigned char *residual, int size, int bytes, unsigned char *dest) {
+
+	// key frames are predicted from the previous pixel, all others from the previous frame
+	if (previous!=NULL) {
+		for (int i=0;i<size;i++) residual[i] = src[i]-previous[i];
+	} else {
+		for (int i=0;(i<bytes) && (i<size);i++) residual[i] = src[i];
+		for (int i=bytes;i<size;i++) residual[i] = src[i]-src[i-bytes];
+	}
+
+	unsigned char *out = dest;
+	int i = 0;
+	while (i<size) {
+		if (residual[i]==0) {
+			int end = i+64;
+			if (end>size) end = size;
+			int j = i+1;
+			while ((j<end) && (residual[j]==0)) j++;
+			*out++ = TOKEN_ZERO | (j-i-1);
+			i = j;
+		} else if ((i+1<size) && SMALL_RESIDUAL(residual[i]) && SMALL_RESIDUAL(residual[i+1])) {
+			int end = i+128;
+			if (end>size) end = size;
+			int j = i+2;
+			while ((j+1<end) && SMALL_RESIDUAL(residual[j]) && SMALL_RESIDUAL(residual[j+1])) {
+				// longer runs of unchanged values are cheaper as their own token
+				if (((residual[j]|residual[j+1])==0) && (j+3<size) && ((residual[j+2]|residual[j+3])==0)) break;
+				j += 2;
+			}
+			*out++ = TOKEN_PAIR | ((j-i)/2-1);
+			for (int k=i;k<j;k+=2)
+				*out++ = ((residual[k]+8)&15) | (((residual[k+1]+8)&15)<<4);
+			i = j;
+		} else {
+			int end = i+128;
+			if (end>size) end = size;
+			int j = i+1;
+			while ((j<end) && !cheaperToken(residual, j, size)) j++;
+			*out++ = TOKEN_LITERAL | (j-i-1);
+			memcpy(out, residual+i, j-i);
+			out += j-i;
+			i = j;
+		}
+	}
+
+	return (unsigned int)(out-dest);
+}
+
+// the frame is updated in place, or rebuilt from the previous pixel for key frames
+template <bool key> static inline void applyResidual(unsigned char *frame, int i, int bytes, unsigned char r) {
+	if (key) frame[i] = ((i>=bytes) ? frame[i-bytes] : 0) + r;
+	else frame[i] += r;
+}
+
+template <bool key> static bool decodeResiduals(const unsigned char *src, unsigned int src_size, unsigned char *frame, int size, int bytes) {
+
+	const unsigned char *in = src;
+	const unsigned char *in_end = src+src_size;
+	int i = 0;
+
+	while (i<size) {
+		if (in>=in_end) return false;
+		unsigned char token = *in++;
+
+		if (token<TOKEN_PAIR) {
+			int n = token+1;
+			if (i+n>size) return false;
+			if (key) {
+				for (;n>0;n--,i++) applyResidual<key>(frame, i, bytes, 0);
+			} else i += n;
+		} else if (token<TOKEN_LITERAL) {
+			int n = (token&0x3F)+1;
+			if ((i+2*n>size) || (in+n>in_end)) return false;
+			for (;n>0;n--) {
+				unsigned char pair = *in++;
+				applyResidual<key>(frame, i++, bytes, (pair&15)-8);
+				applyResidual<key>(frame, i++, bytes, (pair>>4)-8);
+			}
+		} else {
+			int n = (token&0x7F)+1;
+			if ((i+n>size) || (in+n>in_end)) return false;
+			for (;n>0;n--) applyResidual<key>(frame, i++, bytes, *in++);
+		}
+	}
+
+	return (in==in_end);
+}
+
+bool FrameCompressor::decodeStrip(const unsigned char *src, unsigned int src_size, unsigned char *frame, int size, int bytes, bool key) {
+
+	if (key) return decodeResiduals<true>(src, src_size, frame, size, bytes);
+	else return decodeResiduals<false>(src, src_size, frame, size, bytes);
+}
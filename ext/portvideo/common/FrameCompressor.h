@@ -0,0 +1,104 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FRAMECOMPRESSOR_H
+#define FRAMECOMPRESSOR_H
+
+#include <stdint.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define COMPRESSION_NONE 0
+#define COMPRESSION_DELTA 1
+
+#define COMPRESSOR_STRIPS 8
+#define MAX_COMPRESSOR_THREADS 16
+
+// a compressed frame starts with its flags and the size of each strip
+#define FRAME_KEY 1
+
+class FrameCompressor;
+
+typedef struct compressor_data {
+	FrameCompressor *compressor;
+	int id;
+	volatile bool process;
+	bool done;
+#ifdef WIN32
+	HANDLE thread;
+	HANDLE start_event;
+	HANDLE done_event;
+#else
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+#endif
+} compressor_data;
+
+// losslessly compresses frames as the difference to the previous frame, which is mostly zero
+// or very small for a static background, within horizontal strips that are coded in parallel
+class FrameCompressor
+{
+public:
+	FrameCompressor(int width, int height, int format, int threads, int strips=COMPRESSOR_STRIPS);
+	~FrameCompressor();
+
+	// the previous frame is NULL for a key frame, which only depends on itself
+	unsigned int compress(unsigned char *frame, unsigned char *previous, unsigned char *dest);
+	// decodes in place, the frame buffer holds the previous frame unless the compressed frame is a key frame
+	bool decompress(unsigned char *src, unsigned int size, unsigned char *frame);
+
+	unsigned int getMaxSize() { return max_size; }
+	int getStripCount() { return strip_count; }
+	int getThreadCount() { return thread_count; }
+
+	static unsigned int encodeStrip(const unsigned char *src, const unsigned char *previous, unsigned char *residual, int size, int bytes, unsigned char *dest);
+	static bool decodeStrip(const unsigned char *src, unsigned int src_size, unsigned char *frame, int size, int bytes, bool key);
+
+	void processStrips(int id);
+
+private:
+	void runJob();
+
+	int bytes;
+	int strip_count;
+	int thread_count;
+	unsigned int max_size;
+
+	int *strip_offset;
+	int *strip_length;
+	unsigned int strip_bound;
+	unsigned char *strip_buffer;
+	unsigned char **residual;
+
+	// the current job, shared by all threads
+	bool encoding;
+	bool key_frame;
+	unsigned char *job_frame;
+	unsigned char *job_previous;
+	unsigned char **strip_src;
+	unsigned int *strip_size;
+	volatile bool *strip_ok;
+
+	compressor_data tdata[MAX_COMPRESSOR_THREADS];
+};
+
+#endif
@@ -40,6 +40,9 @@ public:
 		dest_format = 0;
 		initialized = false;
 		ui = NULL;
+
+		frame_time = 0;
+		frame_sequence = 0;
 	};
 	virtual ~FrameProcessor() {};
 
@@ -55,6 +58,9 @@ public:
 
     virtual void addUserInterface(UserInterface *uiface) { ui=uiface; };
     virtual void process(unsigned char *src, unsigned char *dest) = 0;
+
+    // capture time in microseconds since the epoch (0 if unknown) and sequence number of the next frame
+    void setFrameInfo(long long time, unsigned int sequence) { frame_time = time; frame_sequence = sequence; }
     virtual bool setFlag(unsigned char flag, bool value, bool lock) { return lock; };
     virtual bool toggleFlag(unsigned char flag, bool lock) { return lock; };
 	std::vector<std::string> getOptions() { return help_text; }
@@ -68,6 +74,9 @@ protected:
 	bool initialized;
 	UserInterface *ui;
 
+	long long frame_time;
+	unsigned int frame_sequence;
+
 	std::vector<std::string> help_text;
 };
 
@@ -0,0 +1,324 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "FrameRecorder.h"
+#include <string.h>
+
+// the queue holds two seconds of frames, so that the disk may stall for a while
+#define QUEUE_SECONDS 2
+#define QUEUE_MIN_FRAMES 32
+// compressed recordings start over with a key frame every ten seconds
+#define KEY_SECONDS 10
+
+#ifndef WIN32
+static void* writerThreadFunc( void* obj )
+#else
+static DWORD WINAPI writerThreadFunc( LPVOID obj )
+#endif
+{
+	FrameRecorder *recorder = (FrameRecorder *)obj;
+	if (recorder->isCompressed()) recorder->writeCompressedFrames();
+	else recorder->writeFrames();
+	return 0;
+}
+
+FrameRecorder::FrameRecorder()
+	: file			(NULL)
+	, queue			(NULL)
+	, queue_stride	(0)
+	, queue_size	(0)
+	, queue_start	(0)
+	, queue_count	(0)
+	, compressor	(NULL)
+	, reference		(NULL)
+	, record		(NULL)
+	, key_interval	(0)
+	, key_countdown	(0)
+	, recording		(false)
+	, failed		(false)
+	, frame_count	(0)
+	, dropped_frames(0)
+{
+	memset(&header,0,sizeof(RecordingHeader));
+#ifdef WIN32
+	writerMutex = CreateMutex(NULL,FALSE,NULL);
+	writerEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+#else
+	pthread_mutex_init(&writerMutex,NULL);
+	pthread_cond_init(&writerCond,NULL);
+#endif
+}
+
+FrameRecorder::~FrameRecorder()
+{
+	close();
+#ifdef WIN32
+	CloseHandle(writerEvent);
+	CloseHandle(writerMutex);
+#else
+	pthread_cond_destroy(&writerCond);
+	pthread_mutex_destroy(&writerMutex);
+#endif
+}
+
+unsigned int FrameRecorder::frameStride(int frame_size) {
+
+	unsigned int stride = sizeof(RecordingFrame) + frame_size;
+	return (stride + RECORDING_ALIGNMENT-1) & ~(RECORDING_ALIGNMENT-1);
+}
+
+bool FrameRecorder::open(const char *file_name, int width, int height, int format, int fps, bool compress, int threads) {
+
+	if (recording) return false;
+
+	file = fopen(file_name,"wb");
+	if (file==NULL) return false;
+	// the frames are written in large blocks straight from the queue
+	setvbuf(file, NULL, _IONBF, 0);
+
+	memset(&header,0,sizeof(RecordingHeader));
+	memcpy(header.magic,RECORDING_MAGIC,8);
+	header.version = RECORDING_VERSION;
+	header.header_size = RECORDING_HEADER_SIZE;
+	header.width = width;
+	header.height = height;
+	header.format = format;
+	header.frame_size = width*height*format;
+	header.frame_stride = frameStride(header.frame_size);
+	header.fps = (float)fps;
+
+	if (compress) {
+		compressor = new FrameCompressor(width, height, format, threads);
+		header.compression = COMPRESSION_DELTA;
+		header.strip_count = compressor->getStripCount();
+		header.frame_stride = 0;
+
+		reference = new unsigned char[header.frame_size];
+		record = new unsigned char[frameStride(compressor->getMaxSize())];
+		key_interval = (fps>0) ? KEY_SECONDS*fps : KEY_SECONDS*30;
+		key_countdown = 0;
+	}
+
+	unsigned char page[RECORDING_HEADER_SIZE];
+	memset(page,0,RECORDING_HEADER_SIZE);
+	memcpy(page,&header,sizeof(RecordingHeader));
+	if (fwrite(page,1,RECORDING_HEADER_SIZE,file)!=RECORDING_HEADER_SIZE) {
+		fclose(file);
+		file = NULL;
+		freeBuffers();
+		return false;
+	}
+
+	queue_stride = frameStride(header.frame_size);
+	queue_size = (fps>0) ? QUEUE_SECONDS*fps : 0;
+	if (queue_size<QUEUE_MIN_FRAMES) queue_size = QUEUE_MIN_FRAMES;
+	queue = new unsigned char[(size_t)queue_size*queue_stride];
+	memset(queue,0,(size_t)queue_size*queue_stride);
+	queue_start = queue_count = 0;
+
+	frame_count = dropped_frames = 0;
+	failed = false;
+
+	lock();
+	recording = true;
+	unlock();
+
+#ifdef WIN32
+	DWORD threadId;
+	writerThread = CreateThread( 0, 0, writerThreadFunc, this, 0, &threadId );
+#else
+	pthread_create(&writerThread , NULL, writerThreadFunc, this);
+#endif
+
+	return true;
+}
+
+void FrameRecorder::close() {
+
+	if (!recording) return;
+
+	// no more frames are added once the flag is cleared, and the writer thread finishes the queue before it returns
+	lock();
+	recording = false;
+#ifdef WIN32
+	SetEvent(writerEvent);
+	unlock();
+	WaitForSingleObject(writerThread, INFINITE);
+	CloseHandle(writerThread);
+#else
+	pthread_cond_signal(&writerCond);
+	unlock();
+	pthread_join(writerThread, NULL);
+#endif
+
+	header.frame_count = frame_count;
+	fseek(file,0,SEEK_SET);
+	fwrite(&header,sizeof(RecordingHeader),1,file);
+	fclose(file);
+	file = NULL;
+
+	freeBuffers();
+}
+
+void FrameRecorder::freeBuffers() {
+
+	delete[] queue;
+	delete[] reference;
+	delete[] record;
+	delete compressor;
+	queue = reference = record = NULL;
+	compressor = NULL;
+}
+
+void FrameRecorder::lock() {
+#ifdef WIN32
+	WaitForSingleObject(writerMutex, INFINITE);
+#else
+	pthread_mutex_lock(&writerMutex);
+#endif
+}
+
+void FrameRecorder::unlock() {
+#ifdef WIN32
+	ReleaseMutex(writerMutex);
+#else
+	pthread_mutex_unlock(&writerMutex);
+#endif
+}
+
+bool FrameRecorder::addFrame(unsigned char *frame, long long time, unsigned int sequence) {
+
+	if (!recording) return false;
+
+	// the writer thread only holds the lock while it updates the queue, never while it writes to the disk
+	lock();
+	if (!recording) {
+		unlock();
+		return false;
+	}
+	if (queue_count==queue_size) {
+		dropped_frames++;
+		unlock();
+		return false;
+	}
+
+	unsigned int slot = (queue_start+queue_count)%queue_size;
+	unsigned char *entry = queue + (size_t)slot*queue_stride;
+	RecordingFrame *info = (RecordingFrame*)entry;
+	info->time = time;
+	info->sequence = sequence;
+	info->size = header.frame_size;
+	memcpy(entry+sizeof(RecordingFrame),frame,header.frame_size);
+
+	queue_count++;
+#ifdef WIN32
+	SetEvent(writerEvent);
+#else
+	pthread_cond_signal(&writerCond);
+#endif
+	unlock();
+
+	return true;
+}
+
+void FrameRecorder::writeFrames() {
+
+	for (;;) {
+		lock();
+#ifdef WIN32
+		while ((queue_count==0) && recording) {
+			unlock();
+			WaitForSingleObject(writerEvent, INFINITE);
+			lock();
+		}
+#else
+		while ((queue_count==0) && recording) pthread_cond_wait(&writerCond, &writerMutex);
+#endif
+		if (queue_count==0) {
+			unlock();
+			break;
+		}
+
+		// all queued frames up to the end of the queue are written at once
+		unsigned int start = queue_start;
+		unsigned int count = queue_count;
+		if (start+count > queue_size) count = queue_size-start;
+		unlock();
+
+		if (!failed) {
+			size_t written = fwrite(queue+(size_t)start*queue_stride,queue_stride,count,file);
+			frame_count += (unsigned int)written;
+			if (written!=count) {
+				printf("recording stopped: could not write to disk\n");
+				failed = true;
+			}
+		}
+
+		lock();
+		queue_start = (start+count)%queue_size;
+		queue_count -= count;
+		unlock();
+	}
+}
+
+void FrameRecorder::writeCompressedFrames() {
+
+	for (;;) {
+		lock();
+#ifdef WIN32
+		while ((queue_count==0) && recording) {
+			unlock();
+			WaitForSingleObject(writerEvent, INFINITE);
+			lock();
+		}
+#else
+		while ((queue_count==0) && recording) pthread_cond_wait(&writerCond, &writerMutex);
+#endif
+		if (queue_count==0) {
+			unlock();
+			break;
+		}
+		unsigned char *entry = queue + (size_t)queue_start*queue_stride;
+		unlock();
+
+		// each frame is coded against the previous one, which is kept since its queue entry is reused
+		if (!failed) {
+			unsigned char *frame = entry + sizeof(RecordingFrame);
+			bool key = (key_countdown==0);
+			unsigned int size = compressor->compress(frame, key ? NULL : reference, record+sizeof(RecordingFrame));
+			key_countdown = key ? key_interval-1 : key_countdown-1;
+
+			memcpy(record, entry, sizeof(RecordingFrame));
+			((RecordingFrame*)record)->size = size;
+			unsigned int stride = frameStride(size);
+			memset(record+sizeof(RecordingFrame)+size, 0, stride-sizeof(RecordingFrame)-size);
+
+			if (fwrite(record,stride,1,file)==1) frame_count++;
+			else {
+				printf("recording stopped: could not write to disk\n");
+				failed = true;
+			}
+			memcpy(reference, frame, header.frame_size);
+		}
+
+		lock();
+		queue_start = (queue_start+1)%queue_size;
+		queue_count--;
+		unlock();
+	}
+}
@@ -0,0 +1,120 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FRAMERECORDER_H
+#define FRAMERECORDER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#include "FrameCompressor.h"
+
+#define RECORDING_MAGIC "PVRECORD"
+#define RECORDING_VERSION 1
+#define RECORDING_HEADER_SIZE 4096
+#define RECORDING_ALIGNMENT 64
+
+// the recording starts with a page sized header
+struct RecordingHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t header_size;
+	uint32_t width;
+	uint32_t height;
+	uint32_t format;
+	uint32_t frame_size;
+	uint32_t frame_stride;
+	float fps;
+	uint64_t frame_count;
+	uint32_t compression;
+	uint32_t strip_count;
+};
+
+// followed by the frames at a fixed stride, each preceded by its capture time and sequence number,
+// or by compressed frames of their own size, aligned to the same boundary and with a stride of zero
+struct RecordingFrame {
+	int64_t time;
+	uint32_t sequence;
+	uint32_t size;
+};
+
+// writes camera frames into a single file, without ever blocking the camera thread on the disk
+class FrameRecorder
+{
+public:
+	FrameRecorder();
+	~FrameRecorder();
+
+	// compressed recordings are coded by the writer thread, using the given number of threads in turn
+	bool open(const char *file_name, int width, int height, int format, int fps, bool compress=false, int threads=1);
+	void close();
+
+	// copies the frame into the queue of the writer thread, or drops it if the queue is full
+	bool addFrame(unsigned char *frame, long long time, unsigned int sequence);
+
+	bool isRecording() { return recording; }
+	bool isCompressed() { return (compressor!=NULL); }
+	unsigned int getFrameCount() { return frame_count; }
+	unsigned int getDroppedFrames() { return dropped_frames; }
+
+	static unsigned int frameStride(int frame_size);
+
+	void writeFrames();
+	void writeCompressedFrames();
+
+private:
+	FILE *file;
+	RecordingHeader header;
+
+	unsigned char *queue;
+	unsigned int queue_stride;
+	unsigned int queue_size;
+	unsigned int queue_start;
+	unsigned int queue_count;
+
+	FrameCompressor *compressor;
+	unsigned char *reference;
+	unsigned char *record;
+	unsigned int key_interval;
+	unsigned int key_countdown;
+
+	volatile bool recording;
+	bool failed;
+	unsigned int frame_count;
+	unsigned int dropped_frames;
+
+#ifdef WIN32
+	HANDLE writerThread;
+	HANDLE writerMutex;
+	HANDLE writerEvent;
+#else
+	pthread_t writerThread;
+	pthread_mutex_t writerMutex;
+	pthread_cond_t writerCond;
+#endif
+
+	void lock();
+	void unlock();
+	void freeBuffers();
+};
+
+#endif
@@ -0,0 +1,393 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MultiCamera.h"
+#include "CameraTool.h"
+
+static long long currentMicroSeconds() {
+#ifdef WIN32
+	FILETIME ft;
+	GetSystemTimeAsFileTime(&ft);
+	unsigned long long tt = ft.dwHighDateTime;
+	tt <<=32;
+	tt |= ft.dwLowDateTime;
+	tt /=10;
+	return (long long)(tt - 11644473600000000ULL);
+#else
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return ((long long)tv.tv_sec*1000000)+tv.tv_usec;
+#endif
+}
+
+#ifndef WIN32
+static void* captureTile( void* obj )
+#else
+static DWORD WINAPI captureTile( LPVOID obj )
+#endif
+{
+	CameraTile *tile = (CameraTile *)obj;
+
+	while(tile->running) {
+		unsigned char *frame = tile->camera->getFrame();
+		if (frame==NULL) {
+			if (!tile->camera->stillRunning()) tile->running = false;
+			else pv_sleep();
+			continue;
+		}
+
+		unsigned char *tile_buffer = tile->buffer->getNextBufferToWrite();
+		if (tile_buffer!=NULL) {
+			memcpy(tile_buffer,frame,tile->buffer->size());
+			// frames without a driver timestamp are synchronised by their arrival
+			long long frame_time = tile->camera->getFrameTime();
+			if (frame_time==0) frame_time = currentMicroSeconds();
+			tile->buffer->writeFinished(frame_time,tile->camera->getFrameSequence());
+		}
+
+		if (tile->camera->sharesFrames()) tile->camera->releaseFrame(frame);
+		if (!tile->camera->waitsForFrame()) pv_sleep();
+	}
+	return(0);
+}
+
+MultiCamera::MultiCamera(CameraConfig *cam_cfg): CameraEngine(cam_cfg)
+{
+	cam_buffer = NULL;
+	frm_buffer = NULL;
+	frame_period = 0;
+	max_skew = 0;
+	snprintf(cfg->name,256,"%s","MultiCamera");
+	running=false;
+}
+
+MultiCamera::~MultiCamera()
+{
+	freeTiles();
+	if (cam_buffer!=NULL) delete []cam_buffer;
+}
+
+CameraEngine* MultiCamera::getCamera(CameraConfig *cam_cfg) {
+
+	MultiCamera *camera = new MultiCamera(cam_cfg);
+	if (!camera->readTiles()) {
+		delete camera;
+		return NULL;
+	}
+	return camera;
+}
+
+bool MultiCamera::readTiles() {
+
+	tinyxml2::XMLDocument xml_settings;
+	xml_settings.LoadFile(cfg->path);
+	if( xml_settings.Error() ) return false;
+
+	// relative sources of the tiles are found next to the configuration file
+	char path[256];
+	snprintf(path,256,"%s",cfg->path);
+	char *separator = strrchr(path,'/');
+	if (separator==NULL) separator = strrchr(path,'\\');
+	if (separator!=NULL) *separator = '\0';
+	else snprintf(path,256,"%s",".");
+
+	tinyxml2::XMLHandle docHandle( &xml_settings );
+	tinyxml2::XMLElement* tile_element = docHandle.FirstChildElement("portvideo").FirstChildElement("camera").FirstChildElement("tile").ToElement();
+
+	while (tile_element!=NULL) {
+
+		CameraTile *tile = new CameraTile();
+		tile->cfg = new CameraConfig();
+		CameraTool::initCameraConfig(tile->cfg);
+		snprintf(tile->cfg->path,256,"%s",cfg->path);
+		CameraTool::readCameraConfig(tinyxml2::XMLHandle(tile_element),tile->cfg,path);
+
+		// all tiles deliver the format of the combined frame
+		tile->cfg->color = cfg->color;
+		if (tile->cfg->driver==DRIVER_MULTI) tile->cfg->driver = DRIVER_DEFAULT;
+
+		if(tile_element->Attribute("x")!=NULL) tile->xpos = atoi(tile_element->Attribute("x"));
+		if(tile_element->Attribute("y")!=NULL) tile->ypos = atoi(tile_element->Attribute("y"));
+		if (tile->xpos<0) tile->xpos = 0;
+		if (tile->ypos<0) tile->ypos = 0;
+
+		tiles.push_back(tile);
+		tile_element = tile_element->NextSiblingElement("tile");
+	}
+
+	if (tiles.size()==0) {
+		printf("no camera tiles configured\n");
+		return false;
+	}
+
+	return true;
+}
+
+void MultiCamera::freeTiles() {
+
+	for (unsigned int i=0;i<tiles.size();i++) {
+		if (tiles[i]->camera!=NULL) delete tiles[i]->camera;
+		if (tiles[i]->buffer!=NULL) delete tiles[i]->buffer;
+		delete tiles[i]->cfg;
+		delete tiles[i];
+	}
+	tiles.clear();
+}
+
+bool MultiCamera::initCamera() {
+
+	int width = 0;
+	int height = 0;
+	float fps = 0;
+
+	for (unsigned int i=0;i<tiles.size();i++) {
+		CameraTile *tile = tiles[i];
+
+		tile->camera = CameraTool::getCamera(tile->cfg);
+		if (tile->camera==NULL) {
+			printf("no camera found for tile %d\n",i);
+			return false;
+		}
+
+		if (!tile->camera->initCamera()) {
+			printf("could not initialize camera for tile %d\n",i);
+			return false;
+		}
+
+		if (tile->camera->getFormat()!=cfg->buf_format) {
+			printf("camera format of tile %d does not match\n",i);
+			return false;
+		}
+
+		printf("tile %d: %s %dx%d at %d,%d\n",i,tile->camera->getName(),tile->camera->getWidth(),tile->camera->getHeight(),tile->xpos,tile->ypos);
+		tile->buffer = new RingBuffer(tile->camera->getWidth()*tile->camera->getHeight()*tile->camera->getFormat());
+
+		if (tile->xpos+tile->camera->getWidth()>width) width = tile->xpos+tile->camera->getWidth();
+		if (tile->ypos+tile->camera->getHeight()>height) height = tile->ypos+tile->camera->getHeight();
+		if ((fps==0) || (tile->cfg->cam_fps<fps)) fps = tile->cfg->cam_fps;
+	}
+
+	// the combined frame spans all tiles, the gaps between them stay black
+	cfg->cam_width = cfg->frame_width = width;
+	cfg->cam_height = cfg->frame_height = height;
+	cfg->frame_xoff = cfg->frame_yoff = 0;
+	cfg->frame = false;
+	cfg->cam_format = cfg->buf_format;
+	cfg->cam_fps = fps;
+
+	// frames of the tiles are matched if they are less than half a frame apart
+	if (fps<=0) fps = 30;
+	frame_period = (long long)(1000000/fps);
+	max_skew = frame_period/2;
+
+	cam_buffer = new unsigned char[cfg->cam_width*cfg->cam_height*cfg->buf_format];
+	memset(cam_buffer,0,cfg->cam_width*cfg->cam_height*cfg->buf_format);
+	return true;
+}
+
+bool MultiCamera::startCamera() {
+
+	for (unsigned int i=0;i<tiles.size();i++) {
+		CameraTile *tile = tiles[i];
+		if (!tile->camera->startCamera()) {
+			printf("could not start camera for tile %d\n",i);
+			return false;
+		}
+
+		// stale frames from a previous run
+		while (tile->buffer->getNextBufferToRead()!=NULL) tile->buffer->readFinished();
+		tile->frame_time = 0;
+
+		tile->running = true;
+#ifndef WIN32
+		pthread_create(&tile->thread , NULL, captureTile, tile);
+#else
+		DWORD threadId;
+		tile->thread = CreateThread( 0, 0, captureTile, tile, 0, &threadId );
+#endif
+	}
+
+	frame_sequence = 0;
+	running = true;
+	return true;
+}
+
+void MultiCamera::stitchTile(CameraTile *tile, unsigned char *src) {
+
+	int bytes = cfg->buf_format;
+	int tile_width = tile->camera->getWidth();
+	int tile_height = tile->camera->getHeight();
+
+	unsigned char *dest = cam_buffer + (tile->ypos*cfg->cam_width + tile->xpos)*bytes;
+	for (int y=0;y<tile_height;y++) {
+		memcpy(dest,src,tile_width*bytes);
+		dest += cfg->cam_width*bytes;
+		src += tile_width*bytes;
+	}
+}
+
+unsigned char* MultiCamera::getFrame()
+{
+	if (!running) return NULL;
+
+	// wait until all tiles delivered a new frame, but stitch the others if one falls behind
+	unsigned int ready = 0;
+	long long start_time = currentMicroSeconds();
+	for (;;) {
+		ready = 0;
+		for (unsigned int i=0;i<tiles.size();i++) {
+			if (tiles[i]->buffer->getNextBufferToRead()!=NULL) ready++;
+		}
+		if (ready==tiles.size()) break;
+		if (!stillRunning()) return NULL;
+		if (currentMicroSeconds()-start_time > 2*frame_period) {
+			if (ready==0) return NULL;
+			break;
+		}
+		pv_sleep();
+	}
+
+	// the newest of the oldest pending frames is the reference time for all tiles
+	long long reference_time = 0;
+	for (unsigned int i=0;i<tiles.size();i++) {
+		if (tiles[i]->buffer->getNextBufferToRead()==NULL) continue;
+		long long frame_time = tiles[i]->buffer->getFrameTime();
+		if (frame_time>reference_time) reference_time = frame_time;
+	}
+
+	// each tile uses its latest frame that is not ahead of the reference time
+	for (unsigned int i=0;i<tiles.size();i++) {
+		CameraTile *tile = tiles[i];
+		unsigned char *tile_frame = NULL;
+		unsigned char *next_frame = NULL;
+
+		while ((next_frame = tile->buffer->getNextBufferToRead())!=NULL) {
+			long long frame_time = tile->buffer->getFrameTime();
+			if ((tile_frame!=NULL) && (frame_time>reference_time+max_skew)) break;
+			tile_frame = next_frame;
+			tile->frame_time = frame_time;
+			// the slot that was read last is not overwritten until the next one is finished
+			tile->buffer->readFinished();
+		}
+
+		if (tile_frame!=NULL) stitchTile(tile,tile_frame);
+	}
+
+	frame_time = reference_time;
+	frame_sequence++;
+	return cam_buffer;
+}
+
+bool MultiCamera::stopCamera()
+{
+	running = false;
+
+	for (unsigned int i=0;i<tiles.size();i++) {
+		CameraTile *tile = tiles[i];
+		if (tile->camera==NULL) continue;
+
+		if (tile->thread) {
+			tile->running = false;
+#ifdef WIN32
+			WaitForSingleObject(tile->thread,INFINITE);
+			CloseHandle(tile->thread);
+#else
+			pthread_join(tile->thread,NULL);
+#endif
+			tile->thread = 0;
+		}
+		tile->camera->stopCamera();
+	}
+	return true;
+}
+
+bool MultiCamera::stillRunning() {
+
+	for (unsigned int i=0;i<tiles.size();i++) {
+		if (!tiles[i]->running) return false;
+	}
+	return running;
+}
+
+bool MultiCamera::resetCamera()
+{
+	return (stopCamera() && startCamera());
+}
+
+bool MultiCamera::closeCamera()
+{
+	for (unsigned int i=0;i<tiles.size();i++) {
+		if (tiles[i]->camera==NULL) continue;
+		tiles[i]->camera->closeCamera();
+		delete tiles[i]->camera;
+		tiles[i]->camera = NULL;
+	}
+	return true;
+}
+
+// camera settings are read from the first tile and applied to all of them
+
+int MultiCamera::getCameraSettingStep(int mode) {
+	return tiles[0]->camera->getCameraSettingStep(mode);
+}
+
+bool MultiCamera::setCameraSettingAuto(int mode, bool flag) {
+	bool result = tiles[0]->camera->setCameraSettingAuto(mode,flag);
+	for (unsigned int i=1;i<tiles.size();i++) tiles[i]->camera->setCameraSettingAuto(mode,flag);
+	return result;
+}
+
+bool MultiCamera::getCameraSettingAuto(int mode) {
+	return tiles[0]->camera->getCameraSettingAuto(mode);
+}
+
+bool MultiCamera::setCameraSetting(int mode, int value) {
+	bool result = tiles[0]->camera->setCameraSetting(mode,value);
+	for (unsigned int i=1;i<tiles.size();i++) tiles[i]->camera->setCameraSetting(mode,value);
+	return result;
+}
+
+int MultiCamera::getCameraSetting(int mode) {
+	return tiles[0]->camera->getCameraSetting(mode);
+}
+
+int MultiCamera::getMaxCameraSetting(int mode) {
+	return tiles[0]->camera->getMaxCameraSetting(mode);
+}
+
+int MultiCamera::getMinCameraSetting(int mode) {
+	return tiles[0]->camera->getMinCameraSetting(mode);
+}
+
+bool MultiCamera::setDefaultCameraSetting(int mode) {
+	bool result = tiles[0]->camera->setDefaultCameraSetting(mode);
+	for (unsigned int i=1;i<tiles.size();i++) tiles[i]->camera->setDefaultCameraSetting(mode);
+	return result;
+}
+
+int MultiCamera::getDefaultCameraSetting(int mode) {
+	return tiles[0]->camera->getDefaultCameraSetting(mode);
+}
+
+bool MultiCamera::hasCameraSetting(int mode) {
+	return tiles[0]->camera->hasCameraSetting(mode);
+}
+
+bool MultiCamera::hasCameraSettingAuto(int mode) {
+	return tiles[0]->camera->hasCameraSettingAuto(mode);
+}
@@ -0,0 +1,91 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTICAMERA_H
+#define MULTICAMERA_H
+
+#include <stdio.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+#endif
+#include "CameraEngine.h"
+#include "RingBuffer.h"
+
+#include <vector>
+
+// a camera tile captured in its own thread
+struct CameraTile {
+	CameraConfig *cfg;
+	CameraEngine *camera;
+	RingBuffer *buffer;
+	int xpos, ypos;
+	long long frame_time;
+	volatile bool running;
+#ifndef WIN32
+	pthread_t thread;
+#else
+	HANDLE thread;
+#endif
+};
+
+// combines several cameras into one frame, each tile placed at its configured position
+class MultiCamera : public CameraEngine
+{
+public:
+	MultiCamera(CameraConfig *cam_cfg);
+	~MultiCamera();
+	
+	static CameraEngine* getCamera(CameraConfig *cam_cfg);
+	bool initCamera();
+	bool startCamera();
+	unsigned char* getFrame();
+	bool stopCamera();
+	bool stillRunning();
+	bool resetCamera();
+	bool closeCamera();
+	
+	int getCameraSettingStep(int mode);
+	bool setCameraSettingAuto(int mode, bool flag);
+	bool getCameraSettingAuto(int mode);
+	bool setCameraSetting(int mode, int value);
+	int getCameraSetting(int mode);
+	int getMaxCameraSetting(int mode);
+	int getMinCameraSetting(int mode);
+	bool setDefaultCameraSetting(int mode);
+	int getDefaultCameraSetting(int mode);
+	bool hasCameraSetting(int mode);
+	bool hasCameraSettingAuto(int mode);
+	
+	bool waitsForFrame() { return true; }
+	
+private:
+	std::vector<CameraTile*> tiles;
+	
+	bool readTiles();
+	void stitchTile(CameraTile *tile, unsigned char *src);
+	void freeTiles();
+	
+	long long frame_period;
+	long long max_skew;
+};
+
+#endif
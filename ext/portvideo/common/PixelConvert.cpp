@@ -0,0 +1,720 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PixelConvert.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP>=2))
+#define PV_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define PV_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define PV_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PV_NEON
+#include <arm_neon.h>
+#endif
+
+#define SAT(c) \
+if (c & (~255)) { if (c < 0) c = 0; else c = 255; }
+#define HBT(x) (unsigned char)((x)>>8)
+
+// the scalar kernels are the reference for all vectorised versions
+
+static inline void yuv2rgb_conv(int Y, int U, int V, unsigned char *dest) {
+
+	// integer method is twice as fast
+	int C = 298*(Y - 16);
+	int R = (C + 409*V + 128) >> 8;
+	int G = (C - 100*U - 208*V + 128) >> 8;
+	int B = (C + 516*U + 128) >> 8;
+
+	SAT(R);
+	SAT(G);
+	SAT(B);
+
+	*dest++ = R;
+	*dest++ = G;
+	*dest++ = B;
+}
+
+static void scalar_yuyv2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	for (int i=pixels/2;i>0;i--) {
+		*dest++ = *src++;
+		src++;
+		*dest++ = *src++;
+		src++;
+	}
+}
+
+static void scalar_uyvy2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	for (int i=pixels/2;i>0;i--) {
+		src++;
+		*dest++ = *src++;
+		src++;
+		*dest++ = *src++;
+	}
+}
+
+static void scalar_grayw2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	for (int i=pixels;i>0;i--) {
+		unsigned short value = src[0] | (src[1] << 8);
+		*dest++ = (unsigned char)(value/4);
+		src+=2;
+	}
+}
+
+static void scalar_rgb2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	for (int i=pixels;i>0;i--) {
+		*dest++ = HBT(src[0]*77 + src[1]*151 + src[2]*28);
+		src+=3;
+	}
+}
+
+static void scalar_rgb2gray_reverse(const unsigned char *src, unsigned char *dest, int pixels) {
+	for (int i=pixels;i>0;i--) {
+		*dest-- = HBT(src[0]*77 + src[1]*151 + src[2]*28);
+		src+=3;
+	}
+}
+
+static void scalar_gray2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	for (int i=pixels;i>0;i--) {
+		unsigned char pixel = *src++;
+		*dest++ = pixel;
+		*dest++ = pixel;
+		*dest++ = pixel;
+	}
+}
+
+static void scalar_grayw2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	for (int i=pixels;i>0;i--) {
+		unsigned short value = src[0] | (src[1] << 8);
+		unsigned char pixel = (unsigned char)(value/4);
+		*dest++ = pixel;
+		*dest++ = pixel;
+		*dest++ = pixel;
+		src+=2;
+	}
+}
+
+static void scalar_yuyv2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	int Y1,Y2,U,V;
+	for (int i=pixels/2;i>0;i--) {
+		// U and V are +-0.5
+		Y1 = *src++;
+		U  = *src++ - 128;
+		Y2 = *src++;
+		V  = *src++ - 128;
+
+		yuv2rgb_conv(Y1,U,V,dest);
+		yuv2rgb_conv(Y2,U,V,dest+3);
+		dest+=6;
+	}
+}
+
+static void scalar_uyvy2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	int Y1,Y2,U,V;
+	for (int i=pixels/2;i>0;i--) {
+		// U and V are +-0.5
+		U  = *src++ - 128;
+		Y1 = *src++;
+		V  = *src++ - 128;
+		Y2 = *src++;
+
+		yuv2rgb_conv(Y1,U,V,dest);
+		yuv2rgb_conv(Y2,U,V,dest+3);
+		dest+=6;
+	}
+}
+
+// the reverse kernel counts bytes instead of pixels
+static void scalar_reverse(const unsigned char *src, unsigned char *dest, int bytes) {
+	for (int i=bytes;i>0;i--) *dest-- = *src++;
+}
+
+static const ConvertKernels scalar_kernels = {
+	"scalar",
+	scalar_yuyv2gray, scalar_uyvy2gray, scalar_grayw2gray, scalar_rgb2gray, scalar_rgb2gray_reverse,
+	scalar_gray2rgb, scalar_grayw2rgb, scalar_yuyv2rgb, scalar_uyvy2rgb,
+	scalar_reverse
+};
+
+#ifdef PV_SSE2
+
+static void sse2_yuyv2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	const __m128i mask = _mm_set1_epi16(0x00FF);
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		__m128i a = _mm_loadu_si128((const __m128i*)src);
+		__m128i b = _mm_loadu_si128((const __m128i*)(src+16));
+		_mm_storeu_si128((__m128i*)dest, _mm_packus_epi16(_mm_and_si128(a,mask), _mm_and_si128(b,mask)));
+		src+=32;
+		dest+=16;
+	}
+	scalar_yuyv2gray(src, dest, pixels-blocks*16);
+}
+
+static void sse2_uyvy2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		__m128i a = _mm_loadu_si128((const __m128i*)src);
+		__m128i b = _mm_loadu_si128((const __m128i*)(src+16));
+		_mm_storeu_si128((__m128i*)dest, _mm_packus_epi16(_mm_srli_epi16(a,8), _mm_srli_epi16(b,8)));
+		src+=32;
+		dest+=16;
+	}
+	scalar_uyvy2gray(src, dest, pixels-blocks*16);
+}
+
+static inline __m128i sse2_grayw16(const unsigned char *src) {
+	const __m128i mask = _mm_set1_epi16(0x00FF);
+	__m128i a = _mm_loadu_si128((const __m128i*)src);
+	__m128i b = _mm_loadu_si128((const __m128i*)(src+16));
+	return _mm_packus_epi16(_mm_and_si128(_mm_srli_epi16(a,2),mask), _mm_and_si128(_mm_srli_epi16(b,2),mask));
+}
+
+static void sse2_grayw2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		_mm_storeu_si128((__m128i*)dest, sse2_grayw16(src));
+		src+=32;
+		dest+=16;
+	}
+	scalar_grayw2gray(src, dest, pixels-blocks*16);
+}
+
+static inline __m128i sse2_reverse16(__m128i v) {
+	v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0,1,2,3));
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2,3,0,1));
+	return _mm_or_si128(_mm_slli_epi16(v,8), _mm_srli_epi16(v,8));
+}
+
+static void sse2_reverse(const unsigned char *src, unsigned char *dest, int bytes) {
+	int blocks = bytes/16;
+	for (int i=blocks;i>0;i--) {
+		__m128i v = _mm_loadu_si128((const __m128i*)src);
+		_mm_storeu_si128((__m128i*)(dest-15), sse2_reverse16(v));
+		src+=16;
+		dest-=16;
+	}
+	scalar_reverse(src, dest, bytes-blocks*16);
+}
+
+// splits eight YUYV or UYVY pixels into luma and the chroma of each pixel
+static inline void sse2_split_yuv(__m128i v, bool yuyv, __m128i *Y, __m128i *U, __m128i *V) {
+	const __m128i mask = _mm_set1_epi16(0x00FF);
+	__m128i chroma;
+	if (yuyv) {
+		*Y = _mm_and_si128(v, mask);
+		chroma = _mm_srli_epi16(v, 8);
+	} else {
+		*Y = _mm_srli_epi16(v, 8);
+		chroma = _mm_and_si128(v, mask);
+	}
+	*U = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chroma, _MM_SHUFFLE(2,2,0,0)), _MM_SHUFFLE(2,2,0,0));
+	*V = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chroma, _MM_SHUFFLE(3,3,1,1)), _MM_SHUFFLE(3,3,1,1));
+}
+
+// the same integer arithmetic as yuv2rgb_conv for eight pixels, the results are in the lower half
+static inline void sse2_yuv2rgb8(__m128i Y, __m128i U, __m128i V, __m128i *R, __m128i *G, __m128i *B) {
+	const __m128i round = _mm_set1_epi32(128);
+	const __m128i r_coeff = _mm_set_epi16(409,298,409,298,409,298,409,298);
+	const __m128i g_coeff = _mm_set_epi16(-100,298,-100,298,-100,298,-100,298);
+	const __m128i v_coeff = _mm_set1_epi16(-104);
+	const __m128i b_coeff = _mm_set_epi16(516,298,516,298,516,298,516,298);
+
+	Y = _mm_sub_epi16(Y, _mm_set1_epi16(16));
+	U = _mm_sub_epi16(U, _mm_set1_epi16(128));
+	V = _mm_sub_epi16(V, _mm_set1_epi16(128));
+
+	__m128i yv_lo = _mm_unpacklo_epi16(Y, V);
+	__m128i yv_hi = _mm_unpackhi_epi16(Y, V);
+	__m128i yu_lo = _mm_unpacklo_epi16(Y, U);
+	__m128i yu_hi = _mm_unpackhi_epi16(Y, U);
+	__m128i vv_lo = _mm_unpacklo_epi16(V, V);
+	__m128i vv_hi = _mm_unpackhi_epi16(V, V);
+
+	__m128i r_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yv_lo, r_coeff), round), 8);
+	__m128i r_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yv_hi, r_coeff), round), 8);
+	__m128i g_lo = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yu_lo, g_coeff), _mm_madd_epi16(vv_lo, v_coeff)), round), 8);
+	__m128i g_hi = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yu_hi, g_coeff), _mm_madd_epi16(vv_hi, v_coeff)), round), 8);
+	__m128i b_lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_lo, b_coeff), round), 8);
+	__m128i b_hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_hi, b_coeff), round), 8);
+
+	// the unsigned saturation equals SAT()
+	__m128i r16 = _mm_packs_epi32(r_lo, r_hi);
+	__m128i g16 = _mm_packs_epi32(g_lo, g_hi);
+	__m128i b16 = _mm_packs_epi32(b_lo, b_hi);
+	*R = _mm_packus_epi16(r16, r16);
+	*G = _mm_packus_epi16(g16, g16);
+	*B = _mm_packus_epi16(b16, b16);
+}
+
+static void sse2_yuv2rgb(const unsigned char *src, unsigned char *dest, int pixels, bool yuyv) {
+	unsigned char r[16], g[16], b[16];
+	int blocks = pixels/8;
+	for (int i=blocks;i>0;i--) {
+		__m128i Y,U,V,R,G,B;
+		sse2_split_yuv(_mm_loadu_si128((const __m128i*)src), yuyv, &Y, &U, &V);
+		sse2_yuv2rgb8(Y, U, V, &R, &G, &B);
+		_mm_storel_epi64((__m128i*)r, R);
+		_mm_storel_epi64((__m128i*)g, G);
+		_mm_storel_epi64((__m128i*)b, B);
+		for (int j=0;j<8;j++) {
+			*dest++ = r[j];
+			*dest++ = g[j];
+			*dest++ = b[j];
+		}
+		src+=16;
+	}
+	if (yuyv) scalar_yuyv2rgb(src, dest, pixels-blocks*8);
+	else scalar_uyvy2rgb(src, dest, pixels-blocks*8);
+}
+
+static void sse2_yuyv2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	sse2_yuv2rgb(src, dest, pixels, true);
+}
+
+static void sse2_uyvy2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	sse2_yuv2rgb(src, dest, pixels, false);
+}
+
+// SSE2 has no byte shuffle, so the three channel kernels remain scalar at this level
+static const ConvertKernels sse2_kernels = {
+	"sse2",
+	sse2_yuyv2gray, sse2_uyvy2gray, sse2_grayw2gray, scalar_rgb2gray, scalar_rgb2gray_reverse,
+	scalar_gray2rgb, scalar_grayw2rgb, sse2_yuyv2rgb, sse2_uyvy2rgb,
+	sse2_reverse
+};
+
+#ifdef PV_AVX2
+
+// the byte shuffle masks for the RGB (de)interleaving, a negative index clears the byte
+static unsigned char rgb_split_mask[3][3][16];
+static unsigned char rgb_merge_mask[3][16];
+static unsigned char rgb8_merge_mask[2][2][16];
+static unsigned char reverse_mask[16];
+
+static void initShuffleMasks() {
+	for (int i=0;i<16;i++) {
+		// gather channel c of 16 pixels from the three source registers k
+		for (int c=0;c<3;c++) {
+			for (int k=0;k<3;k++) {
+				int index = 3*i+c-16*k;
+				rgb_split_mask[c][k][i] = ((index>=0) && (index<16)) ? (unsigned char)index : 0x80;
+			}
+		}
+		// replicate 16 gray pixels into the three destination registers k
+		for (int k=0;k<3;k++) rgb_merge_mask[k][i] = (unsigned char)((16*k+i)/3);
+		// interleave 8 pixels from an R|G register and a B register
+		for (int k=0;k<2;k++) {
+			int pixel = (16*k+i)/3;
+			int channel = (16*k+i)%3;
+			bool valid = (pixel<8);
+			rgb8_merge_mask[k][0][i] = (valid && (channel<2)) ? (unsigned char)(8*channel+pixel) : 0x80;
+			rgb8_merge_mask[k][1][i] = (valid && (channel==2)) ? (unsigned char)pixel : 0x80;
+		}
+		reverse_mask[i] = (unsigned char)(15-i);
+	}
+}
+
+static inline __m128i loadMask(const unsigned char *mask) {
+	return _mm_loadu_si128((const __m128i*)mask);
+}
+
+PV_AVX2 static void avx2_yuyv2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	const __m256i mask = _mm256_set1_epi16(0x00FF);
+	int blocks = pixels/32;
+	for (int i=blocks;i>0;i--) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)src);
+		__m256i b = _mm256_loadu_si256((const __m256i*)(src+32));
+		__m256i gray = _mm256_packus_epi16(_mm256_and_si256(a,mask), _mm256_and_si256(b,mask));
+		_mm256_storeu_si256((__m256i*)dest, _mm256_permute4x64_epi64(gray, _MM_SHUFFLE(3,1,2,0)));
+		src+=64;
+		dest+=32;
+	}
+	sse2_yuyv2gray(src, dest, pixels-blocks*32);
+}
+
+PV_AVX2 static void avx2_uyvy2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/32;
+	for (int i=blocks;i>0;i--) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)src);
+		__m256i b = _mm256_loadu_si256((const __m256i*)(src+32));
+		__m256i gray = _mm256_packus_epi16(_mm256_srli_epi16(a,8), _mm256_srli_epi16(b,8));
+		_mm256_storeu_si256((__m256i*)dest, _mm256_permute4x64_epi64(gray, _MM_SHUFFLE(3,1,2,0)));
+		src+=64;
+		dest+=32;
+	}
+	sse2_uyvy2gray(src, dest, pixels-blocks*32);
+}
+
+PV_AVX2 static void avx2_grayw2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	const __m256i mask = _mm256_set1_epi16(0x00FF);
+	int blocks = pixels/32;
+	for (int i=blocks;i>0;i--) {
+		__m256i a = _mm256_and_si256(_mm256_srli_epi16(_mm256_loadu_si256((const __m256i*)src),2), mask);
+		__m256i b = _mm256_and_si256(_mm256_srli_epi16(_mm256_loadu_si256((const __m256i*)(src+32)),2), mask);
+		_mm256_storeu_si256((__m256i*)dest, _mm256_permute4x64_epi64(_mm256_packus_epi16(a,b), _MM_SHUFFLE(3,1,2,0)));
+		src+=64;
+		dest+=32;
+	}
+	sse2_grayw2gray(src, dest, pixels-blocks*32);
+}
+
+PV_AVX2 static void avx2_reverse(const unsigned char *src, unsigned char *dest, int bytes) {
+	const __m256i mask = _mm256_broadcastsi128_si256(loadMask(reverse_mask));
+	int blocks = bytes/32;
+	for (int i=blocks;i>0;i--) {
+		__m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)src), mask);
+		_mm256_storeu_si256((__m256i*)(dest-31), _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1,0,3,2)));
+		src+=32;
+		dest-=32;
+	}
+	sse2_reverse(src, dest, bytes-blocks*32);
+}
+
+// converts 16 RGB pixels into 16 gray pixels
+PV_AVX2 static inline __m128i avx2_rgb2gray16(const unsigned char *src) {
+	__m128i c0 = _mm_loadu_si128((const __m128i*)src);
+	__m128i c1 = _mm_loadu_si128((const __m128i*)(src+16));
+	__m128i c2 = _mm_loadu_si128((const __m128i*)(src+32));
+
+	__m128i r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, loadMask(rgb_split_mask[0][0])), _mm_shuffle_epi8(c1, loadMask(rgb_split_mask[0][1]))), _mm_shuffle_epi8(c2, loadMask(rgb_split_mask[0][2])));
+	__m128i g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, loadMask(rgb_split_mask[1][0])), _mm_shuffle_epi8(c1, loadMask(rgb_split_mask[1][1]))), _mm_shuffle_epi8(c2, loadMask(rgb_split_mask[1][2])));
+	__m128i b = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, loadMask(rgb_split_mask[2][0])), _mm_shuffle_epi8(c1, loadMask(rgb_split_mask[2][1]))), _mm_shuffle_epi8(c2, loadMask(rgb_split_mask[2][2])));
+
+	// the weighted sum fits into 16 bits, so that the logical shift equals HBT()
+	__m256i sum = _mm256_mullo_epi16(_mm256_cvtepu8_epi16(r), _mm256_set1_epi16(77));
+	sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(g), _mm256_set1_epi16(151)));
+	sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(b), _mm256_set1_epi16(28)));
+	sum = _mm256_srli_epi16(sum, 8);
+	return _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+}
+
+PV_AVX2 static void avx2_rgb2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		_mm_storeu_si128((__m128i*)dest, avx2_rgb2gray16(src));
+		src+=48;
+		dest+=16;
+	}
+	scalar_rgb2gray(src, dest, pixels-blocks*16);
+}
+
+PV_AVX2 static void avx2_rgb2gray_reverse(const unsigned char *src, unsigned char *dest, int pixels) {
+	const __m128i mask = loadMask(reverse_mask);
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		_mm_storeu_si128((__m128i*)(dest-15), _mm_shuffle_epi8(avx2_rgb2gray16(src), mask));
+		src+=48;
+		dest-=16;
+	}
+	scalar_rgb2gray_reverse(src, dest, pixels-blocks*16);
+}
+
+PV_AVX2 static inline void avx2_gray2rgb16(__m128i gray, unsigned char *dest) {
+	_mm_storeu_si128((__m128i*)dest, _mm_shuffle_epi8(gray, loadMask(rgb_merge_mask[0])));
+	_mm_storeu_si128((__m128i*)(dest+16), _mm_shuffle_epi8(gray, loadMask(rgb_merge_mask[1])));
+	_mm_storeu_si128((__m128i*)(dest+32), _mm_shuffle_epi8(gray, loadMask(rgb_merge_mask[2])));
+}
+
+PV_AVX2 static void avx2_gray2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		avx2_gray2rgb16(_mm_loadu_si128((const __m128i*)src), dest);
+		src+=16;
+		dest+=48;
+	}
+	scalar_gray2rgb(src, dest, pixels-blocks*16);
+}
+
+PV_AVX2 static void avx2_grayw2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		avx2_gray2rgb16(sse2_grayw16(src), dest);
+		src+=32;
+		dest+=48;
+	}
+	scalar_grayw2rgb(src, dest, pixels-blocks*16);
+}
+
+PV_AVX2 static void avx2_yuv2rgb(const unsigned char *src, unsigned char *dest, int pixels, bool yuyv) {
+	const __m128i rg_mask0 = loadMask(rgb8_merge_mask[0][0]);
+	const __m128i b_mask0 = loadMask(rgb8_merge_mask[0][1]);
+	const __m128i rg_mask1 = loadMask(rgb8_merge_mask[1][0]);
+	const __m128i b_mask1 = loadMask(rgb8_merge_mask[1][1]);
+	int blocks = pixels/8;
+	for (int i=blocks;i>0;i--) {
+		__m128i Y,U,V,R,G,B;
+		sse2_split_yuv(_mm_loadu_si128((const __m128i*)src), yuyv, &Y, &U, &V);
+		sse2_yuv2rgb8(Y, U, V, &R, &G, &B);
+		__m128i RG = _mm_unpacklo_epi64(R, G);
+		_mm_storeu_si128((__m128i*)dest, _mm_or_si128(_mm_shuffle_epi8(RG, rg_mask0), _mm_shuffle_epi8(B, b_mask0)));
+		_mm_storel_epi64((__m128i*)(dest+16), _mm_or_si128(_mm_shuffle_epi8(RG, rg_mask1), _mm_shuffle_epi8(B, b_mask1)));
+		src+=16;
+		dest+=24;
+	}
+	if (yuyv) scalar_yuyv2rgb(src, dest, pixels-blocks*8);
+	else scalar_uyvy2rgb(src, dest, pixels-blocks*8);
+}
+
+PV_AVX2 static void avx2_yuyv2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	avx2_yuv2rgb(src, dest, pixels, true);
+}
+
+PV_AVX2 static void avx2_uyvy2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	avx2_yuv2rgb(src, dest, pixels, false);
+}
+
+static const ConvertKernels avx2_kernels = {
+	"avx2",
+	avx2_yuyv2gray, avx2_uyvy2gray, avx2_grayw2gray, avx2_rgb2gray, avx2_rgb2gray_reverse,
+	avx2_gray2rgb, avx2_grayw2rgb, avx2_yuyv2rgb, avx2_uyvy2rgb,
+	avx2_reverse
+};
+
+static bool cpuHasAVX2() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0]<7) return false;
+	// the OS also needs to preserve the AVX registers
+	__cpuid(info, 1);
+	if ((info[2] & (1<<27))==0 || (info[2] & (1<<28))==0) return false;
+	if ((_xgetbv(0) & 6)!=6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1<<5))!=0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2")!=0;
+#endif
+}
+
+#endif
+#endif
+
+#ifdef PV_NEON
+
+static inline uint8x16_t neon_reverse16(uint8x16_t v) {
+	v = vrev64q_u8(v);
+	return vcombine_u8(vget_high_u8(v), vget_low_u8(v));
+}
+
+static void neon_yuyv2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		vst1q_u8(dest, vld2q_u8(src).val[0]);
+		src+=32;
+		dest+=16;
+	}
+	scalar_yuyv2gray(src, dest, pixels-blocks*16);
+}
+
+static void neon_uyvy2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		vst1q_u8(dest, vld2q_u8(src).val[1]);
+		src+=32;
+		dest+=16;
+	}
+	scalar_uyvy2gray(src, dest, pixels-blocks*16);
+}
+
+// the lower eight bits of value/4
+static inline uint8x16_t neon_grayw16(const unsigned char *src) {
+	uint8x16x2_t v = vld2q_u8(src);
+	return vorrq_u8(vshrq_n_u8(v.val[0],2), vshlq_n_u8(v.val[1],6));
+}
+
+static void neon_grayw2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		vst1q_u8(dest, neon_grayw16(src));
+		src+=32;
+		dest+=16;
+	}
+	scalar_grayw2gray(src, dest, pixels-blocks*16);
+}
+
+static inline uint8x16_t neon_rgb2gray16(const unsigned char *src) {
+	uint8x16x3_t v = vld3q_u8(src);
+	uint16x8_t lo = vmull_u8(vget_low_u8(v.val[0]), vdup_n_u8(77));
+	lo = vmlal_u8(lo, vget_low_u8(v.val[1]), vdup_n_u8(151));
+	lo = vmlal_u8(lo, vget_low_u8(v.val[2]), vdup_n_u8(28));
+	uint16x8_t hi = vmull_u8(vget_high_u8(v.val[0]), vdup_n_u8(77));
+	hi = vmlal_u8(hi, vget_high_u8(v.val[1]), vdup_n_u8(151));
+	hi = vmlal_u8(hi, vget_high_u8(v.val[2]), vdup_n_u8(28));
+	return vcombine_u8(vshrn_n_u16(lo,8), vshrn_n_u16(hi,8));
+}
+
+static void neon_rgb2gray(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		vst1q_u8(dest, neon_rgb2gray16(src));
+		src+=48;
+		dest+=16;
+	}
+	scalar_rgb2gray(src, dest, pixels-blocks*16);
+}
+
+static void neon_rgb2gray_reverse(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		vst1q_u8(dest-15, neon_reverse16(neon_rgb2gray16(src)));
+		src+=48;
+		dest-=16;
+	}
+	scalar_rgb2gray_reverse(src, dest, pixels-blocks*16);
+}
+
+static void neon_gray2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		uint8x16x3_t v;
+		v.val[0] = v.val[1] = v.val[2] = vld1q_u8(src);
+		vst3q_u8(dest, v);
+		src+=16;
+		dest+=48;
+	}
+	scalar_gray2rgb(src, dest, pixels-blocks*16);
+}
+
+static void neon_grayw2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		uint8x16x3_t v;
+		v.val[0] = v.val[1] = v.val[2] = neon_grayw16(src);
+		vst3q_u8(dest, v);
+		src+=32;
+		dest+=48;
+	}
+	scalar_grayw2rgb(src, dest, pixels-blocks*16);
+}
+
+static inline uint8x8_t neon_narrow(int32x4_t lo, int32x4_t hi) {
+	// the unsigned saturation equals SAT()
+	return vqmovun_s16(vcombine_s16(vqmovn_s32(vshrq_n_s32(lo,8)), vqmovn_s32(vshrq_n_s32(hi,8))));
+}
+
+// the same integer arithmetic as yuv2rgb_conv for eight pixels
+static inline void neon_yuv2rgb8(uint8x8_t Y, uint8x8_t U, uint8x8_t V, uint8x8_t *R, uint8x8_t *G, uint8x8_t *B) {
+	const int32x4_t round = vdupq_n_s32(128);
+	int16x8_t y = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(Y)), vdupq_n_s16(16));
+	int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(U)), vdupq_n_s16(128));
+	int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(V)), vdupq_n_s16(128));
+
+	int32x4_t c_lo = vaddq_s32(vmull_n_s16(vget_low_s16(y), 298), round);
+	int32x4_t c_hi = vaddq_s32(vmull_n_s16(vget_high_s16(y), 298), round);
+
+	*R = neon_narrow(vmlal_n_s16(c_lo, vget_low_s16(v), 409), vmlal_n_s16(c_hi, vget_high_s16(v), 409));
+	*G = neon_narrow(vmlal_n_s16(vmlal_n_s16(c_lo, vget_low_s16(u), -100), vget_low_s16(v), -208),
+					 vmlal_n_s16(vmlal_n_s16(c_hi, vget_high_s16(u), -100), vget_high_s16(v), -208));
+	*B = neon_narrow(vmlal_n_s16(c_lo, vget_low_s16(u), 516), vmlal_n_s16(c_hi, vget_high_s16(u), 516));
+}
+
+static void neon_yuv2rgb(const unsigned char *src, unsigned char *dest, int pixels, bool yuyv) {
+	int blocks = pixels/16;
+	for (int i=blocks;i>0;i--) {
+		// eight pixel pairs, which share their chroma values
+		uint8x8x4_t p = vld4_u8(src);
+		uint8x8_t Y1 = yuyv ? p.val[0] : p.val[1];
+		uint8x8_t U  = yuyv ? p.val[1] : p.val[0];
+		uint8x8_t Y2 = yuyv ? p.val[2] : p.val[3];
+		uint8x8_t V  = yuyv ? p.val[3] : p.val[2];
+
+		uint8x8_t R1,G1,B1,R2,G2,B2;
+		neon_yuv2rgb8(Y1, U, V, &R1, &G1, &B1);
+		neon_yuv2rgb8(Y2, U, V, &R2, &G2, &B2);
+
+		uint8x8x2_t r = vzip_u8(R1, R2);
+		uint8x8x2_t g = vzip_u8(G1, G2);
+		uint8x8x2_t b = vzip_u8(B1, B2);
+		uint8x16x3_t rgb;
+		rgb.val[0] = vcombine_u8(r.val[0], r.val[1]);
+		rgb.val[1] = vcombine_u8(g.val[0], g.val[1]);
+		rgb.val[2] = vcombine_u8(b.val[0], b.val[1]);
+		vst3q_u8(dest, rgb);
+		src+=32;
+		dest+=48;
+	}
+	if (yuyv) scalar_yuyv2rgb(src, dest, pixels-blocks*16);
+	else scalar_uyvy2rgb(src, dest, pixels-blocks*16);
+}
+
+static void neon_yuyv2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	neon_yuv2rgb(src, dest, pixels, true);
+}
+
+static void neon_uyvy2rgb(const unsigned char *src, unsigned char *dest, int pixels) {
+	neon_yuv2rgb(src, dest, pixels, false);
+}
+
+static void neon_reverse(const unsigned char *src, unsigned char *dest, int bytes) {
+	int blocks = bytes/16;
+	for (int i=blocks;i>0;i--) {
+		vst1q_u8(dest-15, neon_reverse16(vld1q_u8(src)));
+		src+=16;
+		dest-=16;
+	}
+	scalar_reverse(src, dest, bytes-blocks*16);
+}
+
+static const ConvertKernels neon_kernels = {
+	"neon",
+	neon_yuyv2gray, neon_uyvy2gray, neon_grayw2gray, neon_rgb2gray, neon_rgb2gray_reverse,
+	neon_gray2rgb, neon_grayw2rgb, neon_yuyv2rgb, neon_uyvy2rgb,
+	neon_reverse
+};
+
+#endif
+
+static const ConvertKernels* selectKernels() {
+#if defined(PV_NEON)
+	return &neon_kernels;
+#elif defined(PV_SSE2)
+#ifdef PV_AVX2
+	if (cpuHasAVX2()) {
+		initShuffleMasks();
+		return &avx2_kernels;
+	}
+#endif
+	return &sse2_kernels;
+#else
+	return &scalar_kernels;
+#endif
+}
+
+const ConvertKernels* getConvertKernels() {
+	static const ConvertKernels *kernels = selectKernels();
+	return kernels;
+}
+
+const ConvertKernels* getScalarKernels() {
+	return &scalar_kernels;
+}
@@ -0,0 +1,46 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PIXELCONVERT_H
+#define PIXELCONVERT_H
+
+// converts a contiguous run of pixels, the reverse kernels write backwards starting at the last destination byte
+typedef void (*convert_kernel)(const unsigned char *src, unsigned char *dest, int pixels);
+
+struct ConvertKernels {
+	const char *name;
+
+	convert_kernel yuyv2gray;
+	convert_kernel uyvy2gray;
+	convert_kernel grayw2gray;
+	convert_kernel rgb2gray;
+	convert_kernel rgb2gray_reverse;
+
+	convert_kernel gray2rgb;
+	convert_kernel grayw2rgb;
+	convert_kernel yuyv2rgb;
+	convert_kernel uyvy2rgb;
+
+	convert_kernel reverse;
+};
+
+// the fastest kernels supported by the CPU, which produce the same output as the scalar kernels
+const ConvertKernels* getConvertKernels();
+const ConvertKernels* getScalarKernels();
+
+#endif
@@ -0,0 +1,460 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ReplayCamera.h"
+#include "CameraTool.h"
+
+static long long currentMicroSeconds() {
+#ifdef WIN32
+	FILETIME ft;
+	GetSystemTimeAsFileTime(&ft);
+	unsigned long long tt = ft.dwHighDateTime;
+	tt <<=32;
+	tt |= ft.dwLowDateTime;
+	tt /=10;
+	return (long long)(tt - 11644473600000000ULL);
+#else
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return ((long long)tv.tv_sec*1000000)+tv.tv_usec;
+#endif
+}
+
+#ifndef WIN32
+static void* decoderThreadFunc( void* obj )
+#else
+static DWORD WINAPI decoderThreadFunc( LPVOID obj )
+#endif
+{
+	ReplayCamera *camera = (ReplayCamera *)obj;
+	camera->decodeFrames();
+	return 0;
+}
+
+ReplayCamera::ReplayCamera(CameraConfig *cam_cfg): CameraEngine(cam_cfg)
+{
+	recording = NULL;
+	recording_size = 0;
+#ifdef WIN32
+	file_handle = INVALID_HANDLE_VALUE;
+	map_handle = NULL;
+#endif
+	header = NULL;
+	frame_count = frame_index = 0;
+	original_timing = false;
+	convert = false;
+
+	compressed = false;
+	decompressor = NULL;
+	decoded_frame = NULL;
+	decoded_frames = NULL;
+	decoding = false;
+
+	replay_start = time_offset = 0;
+	sequence_offset = frames_served = 0;
+
+	for (int i=0;i<REPLAY_FRAMES;i++) {
+		frame_buffer[i] = NULL;
+		frame_slot[i] = NULL;
+		frame_held[i] = false;
+	}
+
+	cam_buffer = NULL;
+	snprintf(cfg->name,256,"%s","ReplayCamera");
+	running=false;
+}
+
+ReplayCamera::~ReplayCamera()
+{
+	stopDecoder();
+	for (int i=0;i<REPLAY_FRAMES;i++) delete[] frame_buffer[i];
+	delete decompressor;
+	delete decoded_frames;
+	delete[] decoded_frame;
+	unmapFile();
+}
+
+CameraEngine* ReplayCamera::getCamera(CameraConfig *cam_cfg) {
+
+	struct stat info;
+	if (stat(cam_cfg->src,&info)!=0) return NULL;
+	return new ReplayCamera(cam_cfg);
+}
+
+bool ReplayCamera::mapFile() {
+
+#ifdef WIN32
+	file_handle = CreateFile(cfg->src, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file_handle==INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle, &file_size) || (file_size.QuadPart < RECORDING_HEADER_SIZE)) {
+		unmapFile();
+		return false;
+	}
+	recording_size = (size_t)file_size.QuadPart;
+
+	// a copy-on-write view, so that the frame processors may still alter their source frame
+	map_handle = CreateFileMapping(file_handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (map_handle==NULL) {
+		unmapFile();
+		return false;
+	}
+	recording = (unsigned char*)MapViewOfFile(map_handle, FILE_MAP_COPY, 0, 0, 0);
+	if (recording==NULL) {
+		unmapFile();
+		return false;
+	}
+#else
+	int fd = open(cfg->src, O_RDONLY);
+	if (fd<0) return false;
+
+	struct stat info;
+	if ((fstat(fd, &info)!=0) || (info.st_size < RECORDING_HEADER_SIZE)) {
+		close(fd);
+		return false;
+	}
+	recording_size = (size_t)info.st_size;
+
+	// a private mapping, so that the frame processors may still alter their source frame
+	void *map = mmap(NULL, recording_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map==MAP_FAILED) return false;
+	recording = (unsigned char*)map;
+	madvise(recording, recording_size, MADV_SEQUENTIAL);
+#endif
+
+	header = (RecordingHeader*)recording;
+	return true;
+}
+
+void ReplayCamera::unmapFile() {
+
+#ifdef WIN32
+	if (recording!=NULL) UnmapViewOfFile(recording);
+	if (map_handle!=NULL) CloseHandle(map_handle);
+	if (file_handle!=INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+	map_handle = NULL;
+	file_handle = INVALID_HANDLE_VALUE;
+#else
+	if (recording!=NULL) munmap(recording, recording_size);
+#endif
+	recording = NULL;
+	recording_size = 0;
+	header = NULL;
+}
+
+bool ReplayCamera::initCamera() {
+
+	if (!mapFile()) return false;
+
+	if ((memcmp(header->magic,RECORDING_MAGIC,8)!=0) || (header->version!=RECORDING_VERSION) || (header->header_size<sizeof(RecordingHeader))) {
+		printf("%s is not a valid recording\n",cfg->src);
+		unmapFile();
+		return false;
+	}
+
+	compressed = (header->compression==COMPRESSION_DELTA);
+	if (((header->format!=FORMAT_GRAY) && (header->format!=FORMAT_RGB)) || (header->frame_size!=header->width*header->height*header->format) || ((header->compression!=COMPRESSION_NONE) && !compressed) || (!compressed && (header->frame_stride<sizeof(RecordingFrame)+header->frame_size))) {
+		printf("unsupported recording format\n");
+		unmapFile();
+		return false;
+	}
+
+	if (compressed) {
+		int threads = cfg->decoder_threads;
+		if (threads==SETTING_AUTO) {
+#ifdef WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			threads = info.dwNumberOfProcessors-1;
+#else
+			threads = sysconf(_SC_NPROCESSORS_ONLN)-1;
+#endif
+		}
+		decompressor = new FrameCompressor(header->width, header->height, header->format, threads);
+		if ((unsigned int)decompressor->getStripCount()!=header->strip_count) {
+			printf("unsupported recording format\n");
+			unmapFile();
+			return false;
+		}
+	}
+
+	// the frame count is only written when the recording is closed
+	if (compressed) frame_count = indexFrames() ? (unsigned int)record_offset.size() : 0;
+	else frame_count = (unsigned int)((recording_size-header->header_size)/header->frame_stride);
+	if ((header->frame_count>0) && (header->frame_count<frame_count)) frame_count = (unsigned int)header->frame_count;
+	if (frame_count==0) {
+		printf("recording %s contains no frames\n",cfg->src);
+		unmapFile();
+		return false;
+	}
+
+	cfg->cam_width = header->width;
+	cfg->cam_height = header->height;
+	cfg->cam_format = header->format;
+
+	// a frame rate of zero replays the frames as fast as they are processed,
+	// and the recorded frame rate (or none at all) follows the recorded capture times
+	if ((cfg->cam_fps<0) || ((cfg->cam_fps>0) && (cfg->cam_fps==header->fps))) {
+		original_timing = true;
+		cfg->cam_fps = header->fps;
+	} else original_timing = false;
+
+	setupFrame();
+
+	// cropped or converted frames can not be served from the file
+	convert = (cfg->frame || (cfg->cam_format!=cfg->buf_format));
+	if (convert || compressed) {
+		for (int i=0;i<REPLAY_FRAMES;i++)
+			frame_buffer[i] = new unsigned char[cfg->frame_width*cfg->frame_height*cfg->buf_format];
+	}
+
+	if (compressed) {
+		decoded_frame = new unsigned char[header->frame_size];
+		decoded_frames = new RingBuffer(header->frame_size);
+	}
+
+	return true;
+}
+
+bool ReplayCamera::indexFrames() {
+
+	record_offset.clear();
+
+	// a recording that was not closed properly ends with the last complete frame
+	size_t offset = header->header_size;
+	unsigned int max_size = decompressor->getMaxSize();
+	while (offset+sizeof(RecordingFrame) <= recording_size) {
+		RecordingFrame *info = (RecordingFrame*)(recording+offset);
+		if ((info->size>max_size) || (offset+sizeof(RecordingFrame)+info->size > recording_size)) break;
+		record_offset.push_back(offset);
+		offset += FrameRecorder::frameStride(info->size);
+	}
+
+	// the replay starts over with the first frame, which has to be a key frame
+	if (record_offset.size()==0) return false;
+	RecordingFrame *first = (RecordingFrame*)(recording+record_offset[0]);
+	uint32_t flags = *(uint32_t*)(recording+record_offset[0]+sizeof(RecordingFrame));
+	return ((first->size>=sizeof(uint32_t)) && (flags & FRAME_KEY));
+}
+
+unsigned char* ReplayCamera::frameRecord(unsigned int index) {
+
+	if (compressed) return recording + record_offset[index];
+	else return recording + header->header_size + (size_t)index*header->frame_stride;
+}
+
+void ReplayCamera::decodeFrames() {
+
+	unsigned int index = 0;
+	while (decoding) {
+		unsigned char *buffer = decoded_frames->getNextBufferToWrite();
+		if (buffer==NULL) {
+			pv_sleep();
+			continue;
+		}
+
+		// each frame is decoded on top of the previous one, in the same order as they are served
+		unsigned char *record = frameRecord(index);
+		RecordingFrame *info = (RecordingFrame*)record;
+		if (!decompressor->decompress(record+sizeof(RecordingFrame), info->size, decoded_frame))
+			printf("corrupt frame %d in recording\n",index);
+		memcpy(buffer, decoded_frame, header->frame_size);
+		decoded_frames->writeFinished(info->time, info->sequence);
+
+		index++;
+		if (index==frame_count) index = 0;
+	}
+}
+
+void ReplayCamera::startDecoder() {
+
+	if (!compressed || decoding) return;
+
+	// frames decoded ahead during a previous run
+	while (decoded_frames->getNextBufferToRead()!=NULL) decoded_frames->readFinished();
+
+	decoding = true;
+#ifndef WIN32
+	pthread_create(&decoder_thread , NULL, decoderThreadFunc, this);
+#else
+	DWORD threadId;
+	decoder_thread = CreateThread( 0, 0, decoderThreadFunc, this, 0, &threadId );
+#endif
+}
+
+void ReplayCamera::stopDecoder() {
+
+	if (!decoding) return;
+
+	decoding = false;
+#ifdef WIN32
+	WaitForSingleObject(decoder_thread,INFINITE);
+	CloseHandle(decoder_thread);
+#else
+	pthread_join(decoder_thread,NULL);
+#endif
+}
+
+int ReplayCamera::heldFrames() {
+
+	int count = 0;
+	for (int i=0;i<REPLAY_FRAMES;i++)
+		if (frame_held[i]) count++;
+	return count;
+}
+
+void ReplayCamera::releaseFrame(unsigned char *frame) {
+
+	for (int i=0;i<REPLAY_FRAMES;i++) {
+		if (frame_held[i] && (frame_slot[i]==frame)) {
+			frame_held[i] = false;
+			return;
+		}
+	}
+}
+
+void ReplayCamera::waitUntil(long long time) {
+
+	long long delay = time - currentMicroSeconds();
+	if (delay<=0) return;
+#ifdef WIN32
+	Sleep((int)(delay/1000));
+#else
+	usleep((useconds_t)delay);
+#endif
+}
+
+unsigned char* ReplayCamera::getFrame()
+{
+	if (!running) return NULL;
+
+	// without a frame rate the next frame is only read once the ring buffer can take it,
+	// which is the case while no more than one frame is being processed or waiting
+	if (!original_timing && (cfg->cam_fps==0)) {
+		while (running && (heldFrames()>=REPLAY_FRAMES-1)) pv_sleep();
+	}
+
+	int slot = -1;
+	while (running) {
+		for (int i=0;i<REPLAY_FRAMES;i++) {
+			if (!frame_held[i]) {
+				slot = i;
+				break;
+			}
+		}
+		if (slot>=0) break;
+		pv_sleep();
+	}
+	if (!running) return NULL;
+
+	unsigned char *record = frameRecord(frame_index);
+	RecordingFrame *first_info = (RecordingFrame*)frameRecord(0);
+	RecordingFrame *info = (RecordingFrame*)record;
+
+	// the recorded capture times and sequence numbers continue across each loop
+	long long elapsed = info->time - first_info->time + time_offset;
+	if (original_timing) {
+		frame_time = replay_start + elapsed;
+		waitUntil(frame_time);
+	} else if (cfg->cam_fps>0) {
+		frame_time = replay_start + (long long)(frames_served*1000000.0/cfg->cam_fps);
+		waitUntil(frame_time);
+	} else frame_time = replay_start + elapsed;
+	frame_sequence = info->sequence + sequence_offset;
+	frames_served++;
+
+	unsigned char *frame = record + sizeof(RecordingFrame);
+	if (compressed) {
+		unsigned char *decoded = NULL;
+		while (running && ((decoded=decoded_frames->getNextBufferToRead())==NULL)) pv_sleep();
+		if (!running) return NULL;
+
+		// the decoded frame is copied, since the decoder already continues with the next one
+		if (!convert) memcpy(frame_buffer[slot], decoded, header->frame_size);
+		frame = decoded;
+	}
+
+	if (convert) {
+		unsigned char *buffer = frame_buffer[slot];
+		if (cfg->cam_format==cfg->buf_format) crop(cfg->cam_width, cfg->cam_height, frame, buffer, cfg->buf_format);
+		else if (cfg->buf_format==FORMAT_GRAY) {
+			if (cfg->frame) crop_rgb2gray(cfg->cam_width, frame, buffer);
+			else rgb2gray(cfg->cam_width, cfg->cam_height, frame, buffer);
+		} else {
+			if (cfg->frame) crop_gray2rgb(cfg->cam_width, frame, buffer);
+			else gray2rgb(cfg->cam_width, cfg->cam_height, frame, buffer);
+		}
+		frame = buffer;
+	}
+	if (compressed) {
+		decoded_frames->readFinished();
+		frame = frame_buffer[slot];
+	}
+
+	frame_index++;
+	if (frame_index==frame_count) {
+		RecordingFrame *last_info = info;
+		float fps = header->fps>0 ? header->fps : 30;
+		time_offset += last_info->time - first_info->time + (long long)(1000000/fps);
+		sequence_offset += last_info->sequence - first_info->sequence + 1;
+		frame_index = 0;
+	}
+
+	frame_slot[slot] = frame;
+	frame_held[slot] = true;
+	return frame;
+}
+
+bool ReplayCamera::startCamera()
+{
+	frame_index = 0;
+	frames_served = 0;
+	time_offset = 0;
+	sequence_offset = 0;
+	for (int i=0;i<REPLAY_FRAMES;i++) frame_held[i] = false;
+
+	startDecoder();
+	replay_start = currentMicroSeconds();
+	running = true;
+	return true;
+}
+
+bool ReplayCamera::stopCamera()
+{
+	running = false;
+	stopDecoder();
+	return true;
+}
+
+bool ReplayCamera::stillRunning() {
+	return running;
+}
+
+bool ReplayCamera::resetCamera()
+{
+	return (stopCamera() && startCamera());
+}
+
+bool ReplayCamera::closeCamera()
+{
+	stopDecoder();
+	unmapFile();
+	return true;
+}
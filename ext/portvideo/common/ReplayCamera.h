@@ -0,0 +1,128 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLAYCAMERA_H
+#define REPLAYCAMERA_H
+
+#include <stdio.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <vector>
+#include "CameraEngine.h"
+#include "FrameRecorder.h"
+#include "FrameCompressor.h"
+#include "RingBuffer.h"
+
+// one frame in processing, one waiting in the ring buffer and one on its way
+#define REPLAY_FRAMES 3
+
+// replays a FrameRecorder file, serving the frames straight from the mapped file,
+// while compressed recordings are decoded ahead of time on a thread of their own
+class ReplayCamera : public CameraEngine
+{
+public:
+	ReplayCamera(CameraConfig *cam_cfg);
+	~ReplayCamera();
+
+	static CameraEngine* getCamera(CameraConfig *cam_cfg);
+	bool initCamera();
+	bool startCamera();
+	unsigned char* getFrame();
+	bool stopCamera();
+	bool stillRunning();
+	bool resetCamera();
+	bool closeCamera();
+
+	int getCameraSettingStep(int mode) { return 0; }
+	bool setCameraSettingAuto(int mode, bool flag) { return false; }
+	bool getCameraSettingAuto(int mode) { return false; }
+	bool setCameraSetting(int mode, int value) { return false; }
+	int getCameraSetting(int mode) { return 0; }
+	int getMaxCameraSetting(int mode) { return 0; }
+	int getMinCameraSetting(int mode) { return 0; }
+	bool setDefaultCameraSetting(int mode) { return false; }
+	int getDefaultCameraSetting(int mode) { return 0; }
+	bool hasCameraSetting(int mode) { return false; }
+	bool hasCameraSettingAuto(int mode) { return false; }
+
+	bool showSettingsDialog(bool lock) { return lock; }
+	void control(unsigned char key) {};
+
+	unsigned int getFrameCount() { return frame_count; }
+
+	bool waitsForFrame() { return true; }
+	bool sharesFrames() { return true; }
+	void releaseFrame(unsigned char *frame);
+
+	void decodeFrames();
+
+private:
+	bool mapFile();
+	void unmapFile();
+	bool indexFrames();
+	unsigned char* frameRecord(unsigned int index);
+	int heldFrames();
+	void waitUntil(long long time);
+	void startDecoder();
+	void stopDecoder();
+
+	unsigned char *recording;
+	size_t recording_size;
+#ifdef WIN32
+	HANDLE file_handle;
+	HANDLE map_handle;
+#endif
+
+	RecordingHeader *header;
+	unsigned int frame_count;
+	unsigned int frame_index;
+	bool original_timing;
+	bool convert;
+
+	// the offset of each compressed frame, which only the key frames can be decoded from
+	bool compressed;
+	std::vector<size_t> record_offset;
+	FrameCompressor *decompressor;
+	unsigned char *decoded_frame;
+	RingBuffer *decoded_frames;
+	volatile bool decoding;
+#ifdef WIN32
+	HANDLE decoder_thread;
+#else
+	pthread_t decoder_thread;
+#endif
+
+	// frames handed out to the engine, which are either within the mapped file or converted into their own buffer
+	unsigned char *frame_buffer[REPLAY_FRAMES];
+	unsigned char *frame_slot[REPLAY_FRAMES];
+	volatile bool frame_held[REPLAY_FRAMES];
+
+	long long replay_start;
+	long long time_offset;
+	unsigned int sequence_offset;
+	unsigned int frames_served;
+};
+
+#endif
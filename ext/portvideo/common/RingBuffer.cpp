@@ -26,6 +26,12 @@ RingBuffer::RingBuffer(int size) {
 	buffer[0] = new unsigned char[bufferSize];
 	buffer[1] = new unsigned char[bufferSize];
 	buffer[2] = new unsigned char[bufferSize];
+
+	for (int i=0;i<3;i++) {
+		frame[i] = buffer[i];
+		frameTime[i] = 0;
+		frameSequence[i] = 0;
+	}
 }
 
 
@@ -52,12 +58,27 @@ unsigned char* RingBuffer::getNextBufferToWrite() {
 	if( nextWriteIndex == readIndex ){
 		return NULL;
 	}else{
+		frame[ nextWriteIndex ] = buffer[ nextWriteIndex ];
 		return buffer[ nextWriteIndex ];
 	}
 }
 
-void RingBuffer::writeFinished() {
-	writeIndex = nextIndex( writeIndex );
+bool RingBuffer::writeShared(unsigned char* shared_frame, long long frame_time, unsigned int frame_sequence) {
+	int nextWriteIndex = nextIndex( writeIndex );
+	if( nextWriteIndex == readIndex ){
+		return false;
+	}else{
+		frame[ nextWriteIndex ] = shared_frame;
+		writeFinished( frame_time, frame_sequence );
+		return true;
+	}
+}
+
+void RingBuffer::writeFinished(long long frame_time, unsigned int frame_sequence) {
+	int nextWriteIndex = nextIndex( writeIndex );
+	frameTime[ nextWriteIndex ] = frame_time;
+	frameSequence[ nextWriteIndex ] = frame_sequence;
+	writeIndex = nextWriteIndex;
 }
 
 
@@ -66,10 +87,18 @@ unsigned char* RingBuffer::getNextBufferToRead() {
 		return NULL;
 	}else{
 		int nextReadIndex = nextIndex( readIndex );
-		return buffer[ nextReadIndex ];
+		return frame[ nextReadIndex ];
 	}
 }
 
 void RingBuffer::readFinished() {
 	readIndex = nextIndex( readIndex );
 }
+
+long long RingBuffer::getFrameTime() {
+	return frameTime[ nextIndex( readIndex ) ];
+}
+
+unsigned int RingBuffer::getFrameSequence() {
+	return frameSequence[ nextIndex( readIndex ) ];
+}
@@ -35,15 +35,24 @@ public:
 	int size();
 	
 	unsigned char* getNextBufferToWrite();
-	void writeFinished();
+	void writeFinished(long long frame_time=0, unsigned int frame_sequence=0);
+	// passes an external frame to the reader instead of copying it, false if the buffer is full
+	bool writeShared(unsigned char* shared_frame, long long frame_time=0, unsigned int frame_sequence=0);
 	unsigned char* getNextBufferToRead();
 	void readFinished();
 
+	// capture time and sequence number of the buffer returned by getNextBufferToRead()
+	long long getFrameTime();
+	unsigned int getFrameSequence();
+
 private:
 	int nextIndex( int index );
 	int bufferSize;
 	
 	unsigned char* buffer[3];
+	unsigned char* frame[3];
+	long long frameTime[3];
+	unsigned int frameSequence[3];
 	volatile char readIndex;
 	volatile char writeIndex;
 };
@@ -38,15 +38,29 @@ static DWORD WINAPI getFrameFromCamera( LPVOID obj )
             //long start_time = VisionEngine::currentMicroSeconds();
             cameraBuffer = engine->camera_->getFrame();
             if (cameraBuffer!=NULL) {
-                cameraWriteBuffer = engine->ringBuffer->getNextBufferToWrite();
-                if (cameraWriteBuffer!=NULL) {
-                    memcpy(cameraWriteBuffer,cameraBuffer,engine->ringBuffer->size());
-                    engine->framenumber_++;
-                    engine->ringBuffer->writeFinished();
-                    //long driver_time = VisionEngine::currentMicroSeconds() - start_time;
-                    //std::cout << "camera latency: " << driver_time/1000.0f << "ms" << std::endl;
+                if (engine->recorder_->isRecording()) {
+                    long long frame_time = engine->camera_->getFrameTime();
+                    if (frame_time==0) frame_time = VisionEngine::currentMicroSeconds();
+                    unsigned int frame_sequence = engine->camera_->getFrameSequence();
+                    if (frame_sequence==0) frame_sequence = engine->framenumber_;
+                    engine->recorder_->addFrame(cameraBuffer,frame_time,frame_sequence);
                 }
-				pv_sleep();
+                if (engine->camera_->sharesFrames()) {
+                    // the capture buffer itself is handed over, or goes back if nobody takes it
+                    if (engine->ringBuffer->writeShared(cameraBuffer,engine->camera_->getFrameTime(),engine->camera_->getFrameSequence()))
+                        engine->framenumber_++;
+                    else engine->camera_->releaseFrame(cameraBuffer);
+                } else {
+                    cameraWriteBuffer = engine->ringBuffer->getNextBufferToWrite();
+                    if (cameraWriteBuffer!=NULL) {
+                        memcpy(cameraWriteBuffer,cameraBuffer,engine->ringBuffer->size());
+                        engine->framenumber_++;
+                        engine->ringBuffer->writeFinished(engine->camera_->getFrameTime(),engine->camera_->getFrameSequence());
+                        //long driver_time = VisionEngine::currentMicroSeconds() - start_time;
+                        //std::cout << "camera latency: " << driver_time/1000.0f << "ms" << std::endl;
+                    }
+                }
+				if (!engine->camera_->waitsForFrame()) pv_sleep();
             } else {
                 if ((!engine->pause_) && (!engine->camera_->stillRunning())) {
                     engine->running_=false;
@@ -58,11 +72,8 @@ static DWORD WINAPI getFrameFromCamera( LPVOID obj )
     return(0);
 }
 
-#ifndef NDEBUG
-void VisionEngine::saveBuffer(unsigned char* buffer, int bytes) {
-	
-	const char *file_ext = "pgm";
-	if (bytes==3) file_ext = "ppm";
+// the recording folder is created next to the application if necessary
+std::string VisionEngine::recordingFolder() {
 	
     struct stat info;
 #ifdef WIN32
@@ -71,6 +82,7 @@ void VisionEngine::saveBuffer(unsigned char* buffer, int bytes) {
         LPSECURITY_ATTRIBUTES attr = NULL;
         CreateDirectory(dir.c_str(),attr);
     }
+    return std::string(".\\recording\\");
 #elif defined __APPLE__
     char path[1024];
     char full_path[1024];
@@ -82,9 +94,42 @@ void VisionEngine::saveBuffer(unsigned char* buffer, int bytes) {
     CFRelease( cfStringRef);
     snprintf(full_path,1024,"%s/../recording",path);
     if (stat(full_path,&info)!=0) mkdir(full_path,0777);
+    return std::string(full_path) + "/";
 #else
     if (stat("./recording",&info)!=0) mkdir("./recording",0777);
+    return std::string("./recording/");
 #endif
+}
+
+void VisionEngine::startRecording() {
+    
+    if (camera_==NULL) return;
+    
+    char time_string[32];
+    time_t now = time(NULL);
+    strftime(time_string,32,"%Y%m%d-%H%M%S",localtime(&now));
+    std::string file_name = recordingFolder() + time_string + ".rec";
+    
+    if (recorder_->open(file_name.c_str(),width_,height_,format_,fps_,app_config_->record_compression,app_config_->record_threads))
+        std::cout << "recording camera frames to " << file_name << std::endl;
+    else std::cout << "could not open " << file_name << std::endl;
+}
+
+void VisionEngine::stopRecording() {
+    
+    if (!recorder_->isRecording()) return;
+    
+    recorder_->close();
+    std::cout << "recorded " << recorder_->getFrameCount() << " frames";
+    if (recorder_->getDroppedFrames()>0) std::cout << ", " << recorder_->getDroppedFrames() << " frames dropped";
+    std::cout << std::endl;
+}
+
+#ifndef NDEBUG
+void VisionEngine::saveBuffer(unsigned char* buffer, int bytes) {
+	
+	const char *file_ext = "pgm";
+	if (bytes==3) file_ext = "ppm";
     
     int zerosize = 16-(int)floor(log10((float)framenumber_));
     if (zerosize<0) zerosize = 0;
@@ -93,13 +138,7 @@ void VisionEngine::saveBuffer(unsigned char* buffer, int bytes) {
     for (int i=0;i<(zerosize);i++) zero[i]=48;
     
     char fileName[256];
-#ifdef WIN32
-    snprintf(fileName,256,".\\recording\\%s%ld.%s",zero,framenumber_,file_ext);
-#elif defined __APPLE__
-    snprintf(fileName,256,"%s/../recording/%s%ld.%s",path,zero,framenumber_,file_ext);
-#else
-    snprintf(fileName,256,"./recording/%s%ld.%s",zero,framenumber_,file_ext);
-#endif
+    snprintf(fileName,256,"%s%s%ld.%s",recordingFolder().c_str(),zero,framenumber_,file_ext);
 
     FILE*  imagefile=fopen(fileName, "w");
     if (bytes==3) fprintf(imagefile,"P6\n%u %u 255\n", width_, height_);
@@ -152,6 +191,7 @@ void VisionEngine::pause(bool pause) {
 void VisionEngine::resetCamera(CameraConfig *cam_cfg) {
 
 	//teardownCamera();
+	stopRecording();
 	freeBuffers();
 	if (cam_cfg!=NULL) CameraTool::setCameraConfig(cam_cfg);
 	setupCamera();
@@ -196,6 +236,12 @@ void VisionEngine::mainLoop()
     
     while(running_) {
         
+        if (record_toggle_) {
+            record_toggle_ = false;
+            if (recorder_->isRecording()) stopRecording();
+            else startRecording();
+        }
+        
         // do nothing if paused
         if (pause_){
             interface_->processEvents();
@@ -219,21 +265,17 @@ void VisionEngine::mainLoop()
         //long camera_time = currentMicroSeconds()-start_time;
 
         // do the actual image processing job
-        for (frame = processorList.begin(); frame!=processorList.end(); frame++)
+        for (frame = processorList.begin(); frame!=processorList.end(); frame++) {
+            (*frame)->setFrameInfo(ringBuffer->getFrameTime(),ringBuffer->getFrameSequence());
             (*frame)->process(cameraReadBuffer,destBuffer_);
+        }
         //long processing_time = currentMicroSeconds()-start_time;
   
         if (interface_->getDisplayMode()==SOURCE_DISPLAY)
             memcpy(sourceBuffer_,cameraReadBuffer,ringBuffer->size());
+        // the slot is freed first, so that a released frame always finds room in the ring buffer
         ringBuffer->readFinished();
-        
-#ifndef NDEBUG
-        if (recording_) {
-			if (interface_->getDisplayMode()==SOURCE_DISPLAY)
-				saveBuffer(sourceBuffer_,format_);
-			else saveBuffer(destBuffer_,format_);
-        }
-#endif
+        if (camera_->sharesFrames()) camera_->releaseFrame(cameraReadBuffer);
 
         if (running_) {
 			if (camera_) camera_->showInterface(interface_);
@@ -278,10 +320,11 @@ void VisionEngine::event(int key)
     if( key == KEY_O ){
         display_lock_ = camera_->showSettingsDialog(display_lock_);
     }
-#ifndef NDEBUG
     else if( key == KEY_M ){
-        recording_ = !recording_;
-    } else if( key == KEY_L ){
+        toggleRecording();
+    }
+#ifndef NDEBUG
+    else if( key == KEY_L ){
 		if (interface_->getDisplayMode()==SOURCE_DISPLAY)
 			saveBuffer(sourceBuffer_,format_);
 		else saveBuffer(destBuffer_,format_);
@@ -385,6 +428,7 @@ void VisionEngine::setupCamera() {
 
 void VisionEngine::teardownCamera()
 {
+    stopRecording();
     if (camera_!=NULL) {
 		pause_ = true;
         CameraTool::saveSettings();
@@ -410,10 +454,9 @@ VisionEngine::VisionEngine(const char* name, application_settings *config)
 , display_lock_( false )
 , current_fps_( 0 )
 , camera_ (NULL)
+, recorder_ ( new FrameRecorder() )
 , framenumber_( 0 )
-#ifndef NDEBUG
-, recording_( false )
-#endif
+, record_toggle_( false )
 , interface_ ( NULL )
 , frames_( 0 )
 , width_( WIDTH )
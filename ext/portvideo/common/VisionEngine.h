@@ -40,6 +40,7 @@
 #include "Main.h"
 #include "CameraTool.h"
 #include "RingBuffer.h"
+#include "FrameRecorder.h"
 #include "UserInterface.h"
 
 class VisionEngine
@@ -49,6 +50,7 @@ public:
 	VisionEngine(const char* name, application_settings *config);
 	~VisionEngine() {
         if (camera_) delete camera_;
+        delete recorder_;
         if (interface_) {
             app_config_->display_mode=interface_->getDisplayMode();
             delete interface_;
@@ -59,6 +61,10 @@ public:
 	void stop();
     void event(int key);
     void pause(bool pause);
+
+    // may be called from a signal handler, the recording is started or stopped by the main loop
+    void toggleRecording() { record_toggle_ = true; }
+    bool isRecording() { return recorder_->isRecording(); }
 	
 	void setupCamera();
 	void teardownCamera();
@@ -74,6 +80,7 @@ public:
 
     CameraEngine *camera_;
 	RingBuffer *ringBuffer;
+	FrameRecorder *recorder_;
 
     void setInterface (UserInterface *uiface);
 	void addFrameProcessor(FrameProcessor *fp);
@@ -113,13 +120,17 @@ protected:
 	void mainLoop();
     void startThread();
     void stopThread();
+
+    void startRecording();
+    void stopRecording();
+    static std::string recordingFolder();
     
 
     
 #ifndef NDEBUG
     void saveBuffer(unsigned char* buffer, int bytes);
-    bool recording_;
 #endif
+    volatile bool record_toggle_;
 
     UserInterface *interface_;
 
@@ -419,23 +419,6 @@ void SDLinterface::processEvents()
 				}
 				
 #ifndef NDEBUG
-				else if( event.key.keysym.sym == SDLK_m )
-				{
-					if (recording_)
-					{
-						recording_ = false;
-						char caption[24] = "";
-						snprintf(caption,24,"%s - %d FPS",app_name_.c_str(),current_fps_);
-						SDL_SetWindowTitle( window_, caption);
-					}
-					else
-					{
-						recording_ = true;
-						char caption[24] = "";
-						snprintf(caption,24,"recording - %d FPS",current_fps_);
-						SDL_SetWindowTitle( window_, caption);
-					}
-				}
 				else help_ = false;
 #endif
 				if (!select_) engine_->event(event.key.keysym.scancode);
@@ -525,9 +508,7 @@ void SDLinterface::showFrameRate()
 		
 		char caption[24] = "";
 		snprintf(caption,24,"%s - %d FPS",app_name_.c_str(),current_fps_);
-#ifndef NDEBUG
-		if (recording_) snprintf(caption,24,"recording - %d FPS",current_fps_);
-#endif
+		if (engine_->isRecording()) snprintf(caption,24,"recording - %d FPS",current_fps_);
 		SDL_SetWindowTitle( window_, caption);
 		
 		lastTime_ = currentTime_;
@@ -787,7 +768,6 @@ SDLinterface::SDLinterface(const char* name, bool fullscreen)
 , help_( false )
 , select_( false )
 #ifndef NDEBUG
-, recording_(false )
 #endif
 , frames_( 0 )
 , current_fps_( 0 )
@@ -807,6 +787,7 @@ SDLinterface::SDLinterface(const char* name, bool fullscreen)
 	help_text.push_back("camera:");
 	help_text.push_back("   o - camera options");
 	help_text.push_back("   k - select camera");
+	help_text.push_back("   m - record camera frames");
 	help_text.push_back("display:");
 	help_text.push_back("   n - no image");
 	help_text.push_back("   s - source image");
@@ -824,7 +805,6 @@ SDLinterface::SDLinterface(const char* name, bool fullscreen)
 	help_text.push_back("");
 	help_text.push_back("debug options:");
 	help_text.push_back("   l - save buffer as PGM image");
-	help_text.push_back("   m - save buffer as PGM sequence");
 #endif
 }
 
@@ -114,9 +114,6 @@ private:
     bool pause_;
     bool help_;
 	bool select_;
-#ifndef NDEBUG
-    bool recording_;
-#endif
     bool fullscreen_;
 
 	long frames_;
@@ -0,0 +1,133 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MJPEGDecoder.h"
+#include <string.h>
+
+MJPEGDecoder::MJPEGDecoder() {
+
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = errorExit;
+	jerr.pub.output_message = outputMessage;
+	jpeg_create_decompress(&cinfo);
+
+	region_xoff = region_yoff = 0;
+	region_width = region_height = 0;
+	region_scale = 1;
+
+	row_buffer = NULL;
+	row_size = 0;
+}
+
+MJPEGDecoder::~MJPEGDecoder() {
+	jpeg_destroy_decompress(&cinfo);
+	if (row_buffer!=NULL) delete []row_buffer;
+}
+
+void MJPEGDecoder::errorExit(j_common_ptr cinfo) {
+	ErrorManager *err = (ErrorManager*)cinfo->err;
+	longjmp(err->jump, 1);
+}
+
+void MJPEGDecoder::outputMessage(j_common_ptr cinfo) {
+	// corrupt MJPEG frames are common, so the warnings are not printed
+}
+
+void MJPEGDecoder::setRegion(int xoff, int yoff, int width, int height, int scale) {
+
+	if ((scale!=2) && (scale!=4) && (scale!=8)) scale = 1;
+
+	region_xoff = xoff;
+	region_yoff = yoff;
+	region_width = width;
+	region_height = height;
+	region_scale = scale;
+}
+
+bool MJPEGDecoder::decode(const unsigned char *src, unsigned long size, unsigned char *dest, bool color) {
+
+	if (setjmp(jerr.jump)) {
+		jpeg_abort_decompress(&cinfo);
+		return false;
+	}
+
+	jpeg_mem_src(&cinfo, (unsigned char*)src, size);
+	if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK) {
+		jpeg_abort_decompress(&cinfo);
+		return false;
+	}
+
+	// a grayscale output skips the chroma IDCT, upsampling and color conversion
+	cinfo.out_color_space = color ? JCS_RGB : JCS_GRAYSCALE;
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = region_scale;
+	cinfo.dct_method = JDCT_IFAST;
+	jpeg_start_decompress(&cinfo);
+
+	int bytes = cinfo.output_components;
+	int x = region_xoff/region_scale;
+	int y = region_yoff/region_scale;
+	int width = getWidth();
+	int height = getHeight();
+
+	// limit the region to the actual frame size
+	if (x+width > (int)cinfo.output_width) x = (int)cinfo.output_width - width;
+	if (y+height > (int)cinfo.output_height) y = (int)cinfo.output_height - height;
+	if (x<0) { x = 0; width = cinfo.output_width; }
+	if (y<0) { y = 0; height = cinfo.output_height; }
+
+	// only the iMCU columns covering the region are decoded, with a margin
+	// so that the chroma upsampling at the region border sees its neighbours
+	int margin = color ? 16 : 0;
+	int crop_left = (x > margin) ? x-margin : 0;
+	int crop_right = (x+width+margin < (int)cinfo.output_width) ? x+width+margin : (int)cinfo.output_width;
+	JDIMENSION crop_x = crop_left;
+	JDIMENSION crop_width = crop_right-crop_left;
+	if (crop_width < cinfo.output_width) jpeg_crop_scanline(&cinfo, &crop_x, &crop_width);
+	int row_offset = (x-(int)crop_x)*bytes;
+
+	// the rows above the region are entropy decoded only
+	if (y>0) jpeg_skip_scanlines(&cinfo, y);
+
+	int dest_size = getWidth()*bytes;
+	if ((row_offset>0) || ((int)cinfo.output_width!=getWidth())) {
+
+		if (row_size < (int)cinfo.output_width*bytes) {
+			if (row_buffer!=NULL) delete []row_buffer;
+			row_size = cinfo.output_width*bytes;
+			row_buffer = new unsigned char[row_size];
+		}
+
+		for (int i=0;i<height;i++) {
+			JSAMPROW row = row_buffer;
+			jpeg_read_scanlines(&cinfo, &row, 1);
+			memcpy(dest, row_buffer+row_offset, width*bytes);
+			dest += dest_size;
+		}
+	} else {
+		for (int i=0;i<height;i++) {
+			JSAMPROW row = dest;
+			jpeg_read_scanlines(&cinfo, &row, 1);
+			dest += dest_size;
+		}
+	}
+
+	// the rows below the region are not decoded at all
+	jpeg_abort_decompress(&cinfo);
+	return true;
+}
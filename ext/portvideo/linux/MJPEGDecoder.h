@@ -0,0 +1,60 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MJPEGDECODER_H
+#define MJPEGDECODER_H
+
+#include <stdio.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+
+// decodes a region of (M)JPEG frames with libjpeg-turbo, grayscale output only runs the luma IDCT
+class MJPEGDecoder
+{
+public:
+	MJPEGDecoder();
+	~MJPEGDecoder();
+
+	// the region is given in full resolution pixels, the scale is the DCT scaling denominator 1, 2, 4 or 8
+	void setRegion(int xoff, int yoff, int width, int height, int scale);
+	int getWidth() { return region_width/region_scale; }
+	int getHeight() { return region_height/region_scale; }
+
+	// writes the scaled region with getWidth()*bytes per row into dest
+	bool decode(const unsigned char *src, unsigned long size, unsigned char *dest, bool color);
+
+private:
+	struct ErrorManager {
+		struct jpeg_error_mgr pub;
+		jmp_buf jump;
+	};
+	static void errorExit(j_common_ptr cinfo);
+	static void outputMessage(j_common_ptr cinfo);
+
+	struct jpeg_decompress_struct cinfo;
+	struct ErrorManager jerr;
+
+	int region_xoff, region_yoff;
+	int region_width, region_height;
+	int region_scale;
+
+	unsigned char *row_buffer;
+	int row_size;
+};
+
+#endif
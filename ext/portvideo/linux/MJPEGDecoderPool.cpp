@@ -0,0 +1,194 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "MJPEGDecoderPool.h"
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+
+MJPEGDecoderPool::MJPEGDecoderPool(int threads, int xoff, int yoff, int width, int height, int scale, bool color) {
+
+	thread_count = threads;
+	if (thread_count<1) thread_count = 1;
+	else if (thread_count>MAX_DECODER_THREADS) thread_count = MAX_DECODER_THREADS;
+
+	this->color = color;
+	running = true;
+	submit_index = 0;
+	deliver_index = 0;
+
+	event_fd = eventfd(0, EFD_NONBLOCK);
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+
+	int frame_size = 0;
+	for (int i=0;i<thread_count;i++) {
+		this->threads[i].pool = this;
+		this->threads[i].decoder = new MJPEGDecoder();
+		this->threads[i].decoder->setRegion(xoff, yoff, width, height, scale);
+		frame_size = this->threads[i].decoder->getWidth()*this->threads[i].decoder->getHeight()*(color?3:1);
+	}
+
+	slots.resize(thread_count+1);
+	for (unsigned int i=0;i<slots.size();i++) {
+		slots[i].size = 0;
+		slots[i].time = 0;
+		slots[i].sequence = 0;
+		slots[i].dest = new unsigned char[frame_size];
+		memset(slots[i].dest, 0, frame_size);
+		slots[i].state = SLOT_EMPTY;
+	}
+
+	for (int i=0;i<thread_count;i++)
+		pthread_create(&this->threads[i].thread, NULL, decoderThreadFunction, &this->threads[i]);
+}
+
+MJPEGDecoderPool::~MJPEGDecoderPool() {
+
+	pthread_mutex_lock(&mutex);
+	running = false;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+
+	for (int i=0;i<thread_count;i++) {
+		pthread_join(threads[i].thread, NULL);
+		delete threads[i].decoder;
+	}
+
+	for (unsigned int i=0;i<slots.size();i++) delete []slots[i].dest;
+
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+	if (event_fd>=0) close(event_fd);
+}
+
+void* MJPEGDecoderPool::decoderThreadFunction(void *obj) {
+
+	DecoderThread *data = (DecoderThread*)obj;
+	MJPEGDecoderPool *pool = data->pool;
+
+	DecoderSlot *job;
+	while ((job = pool->nextJob())!=NULL) {
+
+		bool decoded = data->decoder->decode(&job->src[0], job->size, job->dest, pool->color);
+
+		pthread_mutex_lock(&pool->mutex);
+		job->state = decoded ? SLOT_DONE : SLOT_FAILED;
+		pthread_mutex_unlock(&pool->mutex);
+
+		uint64_t value = 1;
+		if (write(pool->event_fd, &value, sizeof(value))<0) {}
+	}
+
+	return NULL;
+}
+
+MJPEGDecoderPool::DecoderSlot* MJPEGDecoderPool::nextJob() {
+
+	pthread_mutex_lock(&mutex);
+	for (;;) {
+		if (!running) {
+			pthread_mutex_unlock(&mutex);
+			return NULL;
+		}
+
+		// the oldest pending frame first
+		for (unsigned int i=deliver_index;i!=submit_index;i++) {
+			DecoderSlot *slot = &slots[i%slots.size()];
+			if (slot->state==SLOT_PENDING) {
+				slot->state = SLOT_DECODING;
+				pthread_mutex_unlock(&mutex);
+				return slot;
+			}
+		}
+
+		pthread_cond_wait(&cond, &mutex);
+	}
+}
+
+bool MJPEGDecoderPool::canSubmit() {
+	return (submit_index-deliver_index < slots.size());
+}
+
+void MJPEGDecoderPool::submit(const unsigned char *src, unsigned long size, long long time, unsigned int sequence) {
+
+	if (!canSubmit()) return;
+	DecoderSlot *slot = &slots[submit_index%slots.size()];
+
+	// the slot is empty, so no decoder thread is accessing it
+	if (slot->src.size() < size) slot->src.resize(size);
+	memcpy(&slot->src[0], src, size);
+	slot->size = size;
+	slot->time = time;
+	slot->sequence = sequence;
+
+	pthread_mutex_lock(&mutex);
+	slot->state = SLOT_PENDING;
+	submit_index++;
+	pthread_cond_signal(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+unsigned char* MJPEGDecoderPool::getFrame() {
+
+	unsigned char *frame = NULL;
+	pthread_mutex_lock(&mutex);
+	while (deliver_index!=submit_index) {
+		DecoderSlot *slot = &slots[deliver_index%slots.size()];
+
+		// a corrupt frame still holds the pixels of an earlier frame, so it is never delivered
+		if (slot->state==SLOT_FAILED) {
+			slot->state = SLOT_EMPTY;
+			deliver_index++;
+			continue;
+		}
+
+		if (slot->state==SLOT_DONE) slot->state = SLOT_DELIVERED;
+		if (slot->state==SLOT_DELIVERED) frame = slot->dest;
+		break;
+	}
+	pthread_mutex_unlock(&mutex);
+	return frame;
+}
+
+void MJPEGDecoderPool::releaseFrame() {
+
+	if (deliver_index==submit_index) return;
+	DecoderSlot *slot = &slots[deliver_index%slots.size()];
+
+	pthread_mutex_lock(&mutex);
+	if (slot->state==SLOT_DELIVERED) {
+		slot->state = SLOT_EMPTY;
+		deliver_index++;
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+long long MJPEGDecoderPool::getFrameTime() {
+	return slots[deliver_index%slots.size()].time;
+}
+
+unsigned int MJPEGDecoderPool::getFrameSequence() {
+	return slots[deliver_index%slots.size()].sequence;
+}
+
+void MJPEGDecoderPool::clearEvent() {
+	uint64_t value;
+	if (read(event_fd, &value, sizeof(value))<0) {}
+}
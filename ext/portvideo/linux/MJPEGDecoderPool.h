@@ -0,0 +1,92 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MJPEGDECODERPOOL_H
+#define MJPEGDECODERPOOL_H
+
+#include <vector>
+#include <pthread.h>
+#include "MJPEGDecoder.h"
+
+#define MAX_DECODER_THREADS 16
+
+// decodes (M)JPEG frames on several threads and delivers them in submission order
+class MJPEGDecoderPool
+{
+public:
+	MJPEGDecoderPool(int threads, int xoff, int yoff, int width, int height, int scale, bool color);
+	~MJPEGDecoderPool();
+
+	// a slot for another compressed frame is available
+	bool canSubmit();
+	// copies the compressed frame, so that its source buffer can be reused right away
+	void submit(const unsigned char *src, unsigned long size, long long time=0, unsigned int sequence=0);
+
+	// the oldest submitted frame once it has been decoded, or NULL, frames which could not be decoded are skipped
+	unsigned char* getFrame();
+	// returns the frame obtained by getFrame() to the pool
+	void releaseFrame();
+
+	// capture time and sequence number of the frame obtained by getFrame()
+	long long getFrameTime();
+	unsigned int getFrameSequence();
+
+	// an eventfd that becomes readable whenever a frame has been decoded
+	int getEventHandle() { return event_fd; }
+	void clearEvent();
+
+	int getThreadCount() { return thread_count; }
+
+private:
+	enum SlotState { SLOT_EMPTY, SLOT_PENDING, SLOT_DECODING, SLOT_DONE, SLOT_FAILED, SLOT_DELIVERED };
+
+	struct DecoderSlot {
+		std::vector<unsigned char> src;
+		unsigned long size;
+		unsigned char *dest;
+		long long time;
+		unsigned int sequence;
+		SlotState state;
+	};
+
+	struct DecoderThread {
+		MJPEGDecoderPool *pool;
+		MJPEGDecoder *decoder;
+		pthread_t thread;
+	};
+
+	static void* decoderThreadFunction(void *obj);
+	DecoderSlot* nextJob();
+
+	int thread_count;
+	DecoderThread threads[MAX_DECODER_THREADS];
+
+	// a frame can be delivered while all threads are decoding the following ones
+	std::vector<DecoderSlot> slots;
+	unsigned int submit_index;
+	unsigned int deliver_index;
+
+	bool color;
+	bool running;
+	int event_fd;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+#endif
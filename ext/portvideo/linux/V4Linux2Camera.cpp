@@ -30,6 +30,13 @@ V4Linux2Camera::V4Linux2Camera(CameraConfig *cam_cfg) : CameraEngine(cam_cfg)
     frm_buffer = NULL;
     running = false;
     buffers_initialized = false;
+    buffer_memory = V4L2_MEMORY_MMAP;
+    share_frames = false;
+    pthread_mutex_init(&buffer_mutex,NULL);
+    jpeg_decoder = NULL;
+    decoder_pool = NULL;
+    sequence_started = false;
+    last_sequence = 0;
 
     cam_cfg->driver = DRIVER_DEFAULT;
 }
@@ -37,11 +44,15 @@ V4Linux2Camera::V4Linux2Camera(CameraConfig *cam_cfg) : CameraEngine(cam_cfg)
 V4Linux2Camera::~V4Linux2Camera(void)
 {
     CameraTool::saveSettings();
-    if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG)) tjDestroy(_jpegDecompressor);
+    if (decoder_pool!=NULL) delete decoder_pool;
+    decoder_pool = NULL;
+    if (jpeg_decoder!=NULL) delete jpeg_decoder;
+    jpeg_decoder = NULL;
     if (cam_buffer!=NULL) delete []cam_buffer;
     cam_buffer = NULL;
     if (frm_buffer!=NULL) delete []frm_buffer;
     frm_buffer = NULL;
+    pthread_mutex_destroy(&buffer_mutex);
 }
 
 int v4lfilter(const struct dirent *dir)
@@ -55,6 +66,28 @@ int v4lfilter(const struct dirent *dir)
     return 0;
 }
 
+// a PS3Eye bound to the gspca kernel driver is listed by the ps3eye driver instead,
+// which detaches the kernel driver and provides the higher frame rates over libusb
+static bool isPS3Eye(const char *name) {
+
+	char sysfs_path[256];
+	unsigned int vendor = 0, product = 0;
+
+	sprintf(sysfs_path,"/sys/class/video4linux/%s/device/../idVendor",name);
+	FILE *sysfs_file = fopen(sysfs_path,"r");
+	if (sysfs_file==NULL) return false;
+	if (fscanf(sysfs_file,"%x",&vendor)!=1) vendor = 0;
+	fclose(sysfs_file);
+
+	sprintf(sysfs_path,"/sys/class/video4linux/%s/device/../idProduct",name);
+	sysfs_file = fopen(sysfs_path,"r");
+	if (sysfs_file==NULL) return false;
+	if (fscanf(sysfs_file,"%x",&product)!=1) product = 0;
+	fclose(sysfs_file);
+
+	return ((vendor==0x1415) && (product==0x2000));
+}
+
 int V4Linux2Camera::getDeviceCount() {
 
 	char v4l2_device[128];
@@ -68,6 +101,7 @@ int V4Linux2Camera::getDeviceCount() {
 	int cam_count = 0;
 
 	for (int i=0;i<dev_count;i++) {
+		if (isPS3Eye(v4l2_devices[i]->d_name)) continue;
         	sprintf(v4l2_device,"/dev/%s",v4l2_devices[i]->d_name);
 
         	int fd = open(v4l2_device, O_RDONLY);
@@ -105,6 +139,7 @@ std::vector<CameraConfig> V4Linux2Camera::getCameraConfigs(int dev_id) {
 		int cam_id;
 		sscanf(v4l2_devices[i]->d_name,"%*[^0-9]%d",&cam_id);
 		if ((dev_id>=0) && (dev_id!=cam_id)) continue;
+		if ((dev_id<0) && isPS3Eye(v4l2_devices[i]->d_name)) continue;
         	sprintf(v4l2_device,"/dev/%s",v4l2_devices[i]->d_name);
 
         	int fd = open(v4l2_device, O_RDONLY);
@@ -348,7 +383,35 @@ bool V4Linux2Camera::initCamera() {
     cfg->cam_height = v4l2_form.fmt.pix.height;
     cfg->cam_fps = roundf((v4l2_parm.parm.capture.timeperframe.denominator/(float)v4l2_parm.parm.capture.timeperframe.numerator)*10)/10.0f;
 
-    if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG)) _jpegDecompressor = tjInitDecompress();
+    setupFrame();
+    if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG)) {
+
+        // the decoder writes the (scaled) frame region straight into the frame buffer
+        if (jpeg_decoder!=NULL) delete jpeg_decoder;
+        jpeg_decoder = new MJPEGDecoder();
+        if (cfg->frame) jpeg_decoder->setRegion(cfg->frame_xoff, cfg->frame_yoff, cfg->frame_width, cfg->frame_height, cfg->frame_scale);
+        else jpeg_decoder->setRegion(0, 0, cfg->cam_width, cfg->cam_height, cfg->frame_scale);
+
+        if (cfg->frame_scale>1) {
+            cfg->frame = true;
+            cfg->frame_width = jpeg_decoder->getWidth();
+            cfg->frame_height = jpeg_decoder->getHeight();
+        }
+
+        // optionally decode on several threads, leaving the camera thread for capture only
+        int threads = cfg->decoder_threads;
+        if (threads==SETTING_AUTO) threads = sysconf(_SC_NPROCESSORS_ONLN)-1;
+        if (decoder_pool!=NULL) delete decoder_pool;
+        decoder_pool = NULL;
+        if (threads>0) {
+            if (cfg->frame) decoder_pool = new MJPEGDecoderPool(threads, cfg->frame_xoff, cfg->frame_yoff, cfg->frame_width*cfg->frame_scale, cfg->frame_height*cfg->frame_scale, cfg->frame_scale, cfg->color);
+            else decoder_pool = new MJPEGDecoderPool(threads, 0, 0, cfg->cam_width, cfg->cam_height, cfg->frame_scale, cfg->color);
+            printf("decoder threads: %d\n", decoder_pool->getThreadCount());
+        }
+    }
+
+    // raw frames are handed to the pipeline without a copy
+    share_frames = ((!cfg->color) && (!cfg->frame) && (pixelformat==V4L2_PIX_FMT_GREY));
 
     if (!requestBuffers()) {
         printf("Error requesting buffers.\n");
@@ -356,11 +419,10 @@ bool V4Linux2Camera::initCamera() {
     }
 
     if (!mapBuffers()) {
-        printf("Unable to mmap buffers.\n");
+        printf("Unable to map buffers.\n");
         return false;
     }
 
-    setupFrame();
     if (cfg->frame) frm_buffer = new unsigned char[cfg->frame_width*cfg->frame_height*cfg->buf_format];
     cam_buffer = new unsigned char[cfg->cam_width*cfg->cam_height*cfg->buf_format];
     buffers_initialized = true;
@@ -369,17 +431,20 @@ bool V4Linux2Camera::initCamera() {
 
 bool V4Linux2Camera::startCamera() {
 
-    for(unsigned int i = 0; i < v4l2_reqbuffers.count; ++i) {
-        memset(&v4l2_buf, 0, sizeof(v4l2_buf));
-        v4l2_buf.type        = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        v4l2_buf.memory      = V4L2_MEMORY_MMAP;
-        v4l2_buf.index       = i;
-
-        if (-1 == ioctl (dev_handle, VIDIOC_QBUF, &v4l2_buf)) {
+    // frames still held by the pipeline are queued again along with all others
+    pthread_mutex_lock(&buffer_mutex);
+    for(unsigned int i = 0; i < buffers.size(); ++i) {
+        buffers[i].held = false;
+        if (!queueBuffer(i)) {
             printf("Error queuing buffer: %s\n",  strerror(errno));
             exit(0);
         }
     }
+    pthread_mutex_unlock(&buffer_mutex);
+
+    memset(&v4l2_buf, 0, sizeof(v4l2_buf));
+    v4l2_buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    v4l2_buf.memory = buffer_memory;
 
     enum v4l2_buf_type type;
     memset(&type, 0, sizeof(v4l2_buf_type));
@@ -389,23 +454,59 @@ bool V4Linux2Camera::startCamera() {
         return false;
     }
 
+    // the driver restarts the sequence numbers with every stream
+    sequence_started = false;
+
     applyCameraSettings();
     running = true;
     return true;
 }
 
+void V4Linux2Camera::readFrameInfo(long long *time, unsigned int *sequence) {
+
+    // the kernel capture time of the dequeued buffer in the system time domain
+    *time = v4l2_buf.timestamp.tv_sec*1000000LL + v4l2_buf.timestamp.tv_usec;
+#ifdef V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC
+    if ((v4l2_buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        struct timespec real_time, mono_time;
+        clock_gettime(CLOCK_REALTIME, &real_time);
+        clock_gettime(CLOCK_MONOTONIC, &mono_time);
+        *time += (real_time.tv_sec-mono_time.tv_sec)*1000000LL + (real_time.tv_nsec-mono_time.tv_nsec)/1000;
+    }
+#endif
+
+    // gaps in the sequence numbers are frames the driver had to drop
+    *sequence = v4l2_buf.sequence;
+    if ((sequence_started) && (*sequence > last_sequence+1)) dropped_frames += *sequence-last_sequence-1;
+    last_sequence = *sequence;
+    sequence_started = true;
+}
+
 unsigned char* V4Linux2Camera::getFrame()  {
 
     if (dev_handle<0) return NULL;
+    if (decoder_pool!=NULL) return getDecodedFrame();
+
+    // wait for the next frame, a timeout lets the camera thread check its state
+    struct pollfd fds;
+    fds.fd = dev_handle;
+    fds.events = POLLIN;
+    int ret = poll(&fds, 1, 1000);
+    if (ret<0) {
+        if (errno!=EINTR) running = false;
+        return NULL;
+    } else if (ret==0) return NULL;
 
     if (ioctl(dev_handle, VIDIOC_DQBUF, &v4l2_buf)<0) {
         running = false;
         return NULL;
     }
+    readFrameInfo(&frame_time, &frame_sequence);
 
     unsigned char *raw_buffer = (unsigned char*)buffers[v4l2_buf.index].start;
     if (raw_buffer==NULL) return NULL;
 
+    bool decoded = true;
     if(cfg->color) {
         if (cfg->frame) {
          if (pixelformat==V4L2_PIX_FMT_YUYV)
@@ -418,12 +519,8 @@ unsigned char* V4Linux2Camera::getFrame()  {
             crop_gray2rgb(cfg->cam_width,raw_buffer,frm_buffer);
          else if (pixelformat==V4L2_PIX_FMT_Y16)
             crop_grayw2rgb(cfg->cam_width,raw_buffer,frm_buffer);
-         else if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG)) {
-                int jpegSubsamp;
-                tjDecompressHeader2(_jpegDecompressor, raw_buffer, v4l2_buf.bytesused, &cfg->cam_width, &cfg->cam_height, &jpegSubsamp);
-                tjDecompress2(_jpegDecompressor, raw_buffer, v4l2_buf.bytesused, cam_buffer, cfg->cam_width, 0, cfg->cam_height, TJPF_RGB, TJFLAG_FASTDCT);
-                crop(cfg->cam_width, cfg->cam_height,cam_buffer,frm_buffer,3);
-         }
+         else if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG))
+            decoded = jpeg_decoder->decode(raw_buffer, v4l2_buf.bytesused, frm_buffer, true);
 
         } else {
          if (pixelformat==V4L2_PIX_FMT_YUYV)
@@ -436,11 +533,8 @@ unsigned char* V4Linux2Camera::getFrame()  {
             gray2rgb(cfg->cam_width,cfg->cam_height,raw_buffer,cam_buffer);
          else if (pixelformat==V4L2_PIX_FMT_Y16)
             grayw2rgb(cfg->cam_width,cfg->cam_height,raw_buffer,cam_buffer);
-         else if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG)) {
-                int jpegSubsamp;
-                tjDecompressHeader2(_jpegDecompressor, raw_buffer, v4l2_buf.bytesused, &cfg->cam_width, &cfg->cam_height, &jpegSubsamp);
-                tjDecompress2(_jpegDecompressor, raw_buffer, v4l2_buf.bytesused, cam_buffer, cfg->cam_width, 0, cfg->cam_height, TJPF_RGB, TJFLAG_FASTDCT);
-         }
+         else if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG))
+            decoded = jpeg_decoder->decode(raw_buffer, v4l2_buf.bytesused, cam_buffer, true);
 
         }
 
@@ -458,13 +552,8 @@ unsigned char* V4Linux2Camera::getFrame()  {
                 crop(cfg->cam_width, cfg->cam_height,raw_buffer,frm_buffer,1);
             else if (pixelformat==V4L2_PIX_FMT_Y16)
                 crop_grayw2gray(cfg->cam_width,raw_buffer,frm_buffer);
-            else if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG)) {
-
-                int jpegSubsamp;
-                tjDecompressHeader2(_jpegDecompressor, raw_buffer, v4l2_buf.bytesused, &cfg->cam_width, &cfg->cam_height, &jpegSubsamp);
-                tjDecompress2(_jpegDecompressor, raw_buffer, v4l2_buf.bytesused, cam_buffer, cfg->cam_width, 0, cfg->cam_height, TJPF_GRAY, TJFLAG_FASTDCT);
-                crop(cfg->cam_width, cfg->cam_height,cam_buffer,frm_buffer,1);
-            }
+            else if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG))
+                decoded = jpeg_decoder->decode(raw_buffer, v4l2_buf.bytesused, frm_buffer, false);
         } else {
             if (pixelformat==V4L2_PIX_FMT_YUYV) yuyv2gray(cfg->cam_width,cfg->cam_height,raw_buffer,cam_buffer);
             else if (pixelformat==V4L2_PIX_FMT_UYVY) uyvy2gray(cfg->cam_width, cfg->cam_height,raw_buffer,cam_buffer);
@@ -472,25 +561,115 @@ unsigned char* V4Linux2Camera::getFrame()  {
             else if (pixelformat==V4L2_PIX_FMT_YUV410) memcpy(cam_buffer,raw_buffer,cfg->cam_width*cfg->cam_height);
             //else if (pixelformat==V4L2_PIX_FMT_GREY) memcpy(cam_buffer,raw_buffer,cam_width*cam_height);
             else if (pixelformat==V4L2_PIX_FMT_Y16) grayw2gray(cfg->cam_width,cfg->cam_height,raw_buffer,cam_buffer);
-            else if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG)) {
-
-                int jpegSubsamp;
-                tjDecompressHeader2(_jpegDecompressor, raw_buffer, v4l2_buf.bytesused, &cfg->cam_width, &cfg->cam_height, &jpegSubsamp);
-                tjDecompress2(_jpegDecompressor, raw_buffer, v4l2_buf.bytesused, cam_buffer, cfg->cam_width, 0, cfg->cam_height, TJPF_GRAY, TJFLAG_FASTDCT);
-            }
+            else if ((pixelformat == V4L2_PIX_FMT_MJPEG) || (pixelformat == V4L2_PIX_FMT_JPEG))
+                decoded = jpeg_decoder->decode(raw_buffer, v4l2_buf.bytesused, cam_buffer, false);
         }
     }
 
-    if (-1 == ioctl (dev_handle, VIDIOC_QBUF, &v4l2_buf)) {
+    // a corrupt compressed frame is skipped instead of delivering the previous pixels
+    if (!decoded) {
+        if (!queueBuffer(v4l2_buf.index)) printf("cannot unqueue buffer: %s\n", strerror(errno));
+        return NULL;
+    }
+
+    if (share_frames) {
+        // the buffer is queued again once the pipeline releases it
+        pthread_mutex_lock(&buffer_mutex);
+        buffers[v4l2_buf.index].held = true;
+        pthread_mutex_unlock(&buffer_mutex);
+        return raw_buffer;
+    }
+
+    if (!queueBuffer(v4l2_buf.index)) {
         printf("cannot unqueue buffer: %s\n", strerror(errno));
         return NULL;
     }
 
     if (cfg->frame) return frm_buffer;
-    else if ((!cfg->color) && (pixelformat==V4L2_PIX_FMT_GREY)) return raw_buffer;
     else return cam_buffer;
 }
 
+unsigned char* V4Linux2Camera::getDecodedFrame()  {
+
+    decoder_pool->releaseFrame();
+
+    // keep the decoder threads busy with new frames until the oldest one is decoded
+    unsigned char *frame = decoder_pool->getFrame();
+    while (frame==NULL) {
+
+        struct pollfd fds[2];
+        fds[0].fd = decoder_pool->getEventHandle();
+        fds[0].events = POLLIN;
+        fds[1].fd = dev_handle;
+        fds[1].events = POLLIN;
+        int nfds = decoder_pool->canSubmit() ? 2 : 1;
+
+        int ret = poll(fds, nfds, 1000);
+        if (ret<0) {
+            if (errno==EINTR) continue;
+            running = false;
+            return NULL;
+        } else if (ret==0) return NULL;
+
+        if (fds[0].revents & POLLIN) decoder_pool->clearEvent();
+        if ((nfds==2) && (fds[1].revents & (POLLIN|POLLERR))) {
+
+            if (ioctl(dev_handle, VIDIOC_DQBUF, &v4l2_buf)<0) {
+                running = false;
+                return NULL;
+            }
+
+            long long time;
+            unsigned int sequence;
+            readFrameInfo(&time, &sequence);
+
+            unsigned char *raw_buffer = (unsigned char*)buffers[v4l2_buf.index].start;
+            if (raw_buffer!=NULL) decoder_pool->submit(raw_buffer, v4l2_buf.bytesused, time, sequence);
+
+            // the compressed data has been copied, so the buffer goes straight back to the driver
+            if (!queueBuffer(v4l2_buf.index)) {
+                printf("cannot unqueue buffer: %s\n", strerror(errno));
+                return NULL;
+            }
+        }
+
+        frame = decoder_pool->getFrame();
+    }
+
+    frame_time = decoder_pool->getFrameTime();
+    frame_sequence = decoder_pool->getFrameSequence();
+    return frame;
+}
+
+bool V4Linux2Camera::queueBuffer(unsigned int index) {
+
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = buffer_memory;
+    buf.index = index;
+    if (buffer_memory == V4L2_MEMORY_USERPTR) {
+        buf.m.userptr = (unsigned long)buffers[index].start;
+        buf.length = buffers[index].length;
+    }
+
+    return (ioctl(dev_handle, VIDIOC_QBUF, &buf) != -1);
+}
+
+void V4Linux2Camera::releaseFrame(unsigned char *frame) {
+
+    pthread_mutex_lock(&buffer_mutex);
+    for (unsigned int i=0;i<buffers.size();i++) {
+        if ((buffers[i].start == frame) && (buffers[i].held)) {
+            buffers[i].held = false;
+            // after stopping, startCamera() queues all buffers again
+            if ((running) && (!queueBuffer(i))) printf("cannot unqueue buffer: %s\n", strerror(errno));
+            break;
+        }
+    }
+    pthread_mutex_unlock(&buffer_mutex);
+}
+
 bool V4Linux2Camera::stopCamera() {
     enum v4l2_buf_type type;
     type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -517,6 +696,7 @@ bool V4Linux2Camera::closeCamera() {
 
     if (dev_handle >= 0) {
 	updateSettings();
+        if (dropped_frames>0) printf("dropped frames: %u\n", dropped_frames);
         if (buffers_initialized) unmapBuffers();
         close(dev_handle);
 
@@ -526,15 +706,32 @@ bool V4Linux2Camera::closeCamera() {
 }
 
 bool V4Linux2Camera::requestBuffers() {
-    // Request mmap buffers
+
+    // shared frames stay with the pipeline for a while, so the driver needs some more
+    int count = cfg->cam_buffers;
+    if (count<=0) count = share_frames ? nr_of_shared_buffers : nr_of_buffers;
+    if (count>max_buffers) count = max_buffers;
+
+    // user pointer buffers are allocated here, otherwise the driver memory is mapped
+    buffer_memory = cfg->cam_userptr ? V4L2_MEMORY_USERPTR : V4L2_MEMORY_MMAP;
+
     memset (&v4l2_reqbuffers, 0, sizeof (v4l2_reqbuffers));
     v4l2_reqbuffers.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    v4l2_reqbuffers.memory = V4L2_MEMORY_MMAP;
-    v4l2_reqbuffers.count = nr_of_buffers;
+    v4l2_reqbuffers.memory = buffer_memory;
+    v4l2_reqbuffers.count = count;
+
+    int result = ioctl (dev_handle, VIDIOC_REQBUFS, &v4l2_reqbuffers);
+    if ((-1 == result) && (errno == EINVAL) && (buffer_memory == V4L2_MEMORY_USERPTR)) {
+        printf ("user pointer streaming is not supported, using mmap\n");
+        buffer_memory = V4L2_MEMORY_MMAP;
+        v4l2_reqbuffers.memory = buffer_memory;
+        v4l2_reqbuffers.count = count;
+        result = ioctl (dev_handle, VIDIOC_REQBUFS, &v4l2_reqbuffers);
+    }
 
-    if (-1 == ioctl (dev_handle, VIDIOC_REQBUFS, &v4l2_reqbuffers)) {
+    if (-1 == result) {
         if (errno == EINVAL)
-            printf ("video capturing or mmap-streaming is not supported\n");
+            printf ("video capturing or streaming is not supported\n");
         else
             perror ("VIDIOC_REQBUFS");
 
@@ -552,7 +749,27 @@ bool V4Linux2Camera::requestBuffers() {
 
 bool V4Linux2Camera::mapBuffers() {
 
-    for(unsigned int i=0; i<v4l2_reqbuffers.count; i++) {
+    buffers.clear();
+    buffers.resize(v4l2_reqbuffers.count);
+
+    if (buffer_memory == V4L2_MEMORY_USERPTR) {
+        // page aligned frame buffers owned by the application
+        size_t page_size = sysconf(_SC_PAGESIZE);
+        size_t length = (v4l2_form.fmt.pix.sizeimage + page_size - 1) & ~(page_size - 1);
+
+        for(unsigned int i=0; i<buffers.size(); i++) {
+            if (posix_memalign(&buffers[i].start, page_size, length) != 0) {
+                printf("Unable to allocate buffer %d.\n",  i);
+                buffers.resize(i);
+                return false;
+            }
+            buffers[i].length = length;
+        }
+
+        return true;
+    }
+
+    for(unsigned int i=0; i<buffers.size(); i++) {
 
         memset (&v4l2_buf, 0, sizeof (v4l2_buf));
         v4l2_buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -574,6 +791,7 @@ bool V4Linux2Camera::mapBuffers() {
             /* If you do not exit here you should unmap() and free()
              the buffers mapped so far. */
             printf("Unable to map buffer %d.\n",  i);
+            buffers.resize(i);
             return false;
         }
     }
@@ -582,13 +800,17 @@ bool V4Linux2Camera::mapBuffers() {
 }
 
 bool V4Linux2Camera::unmapBuffers() {
-    for(unsigned int i=0; i<v4l2_reqbuffers.count; i++) {
-        if (-1 == munmap(buffers[i].start, buffers[i].length)) {
+
+    bool success = true;
+    for(unsigned int i=0; i<buffers.size(); i++) {
+        if (buffer_memory == V4L2_MEMORY_USERPTR) free(buffers[i].start);
+        else if (-1 == munmap(buffers[i].start, buffers[i].length)) {
             printf("Error unmapping buffer %d.\n", i);
-            return false;
+            success = false;
         }
     }
-    return true;
+    buffers.clear();
+    return success;
 }
 
 bool V4Linux2Camera::hasCameraSettingAuto(int mode) {
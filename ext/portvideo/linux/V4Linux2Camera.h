@@ -31,8 +31,12 @@
 #include <sys/mman.h>
 #include <linux/types.h>
 #include <linux/videodev2.h>
-#include <turbojpeg.h>
+#include "MJPEGDecoderPool.h"
+#include <poll.h>
+#include <time.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <vector>
 
 extern unsigned int codec_table[];
 
@@ -66,10 +70,17 @@ public:
 	bool hasCameraSetting(int mode);
 	bool hasCameraSettingAuto(int mode);
 
+	bool waitsForFrame() { return true; }
+	bool sharesFrames() { return share_frames; }
+	void releaseFrame(unsigned char *frame);
+
 protected:
     bool requestBuffers();
     bool mapBuffers();
     bool unmapBuffers();
+    bool queueBuffer(unsigned int index);
+    unsigned char* getDecodedFrame();
+    void readFrameInfo(long long *time, unsigned int *sequence);
 
 private:
     v4l2_buffer v4l2_buf;
@@ -83,14 +94,26 @@ private:
     struct Buffers {
       void *start;
       size_t length;
+      bool held;
     };
 
     static const int nr_of_buffers = 3;
-    Buffers buffers[nr_of_buffers];
+    static const int nr_of_shared_buffers = 5;
+    static const int max_buffers = 32;
+    std::vector<Buffers> buffers;
+    unsigned int buffer_memory;
     bool buffers_initialized;
+
+    // raw frames are passed to the pipeline and queued again when released
+    bool share_frames;
+    pthread_mutex_t buffer_mutex;
     unsigned int pixelformat;
 
-	tjhandle _jpegDecompressor;
+    bool sequence_started;
+    unsigned int last_sequence;
+
+	MJPEGDecoder *jpeg_decoder;
+	MJPEGDecoderPool *decoder_pool;
 };
 
 #endif
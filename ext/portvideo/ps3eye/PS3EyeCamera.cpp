@@ -23,6 +23,7 @@ PS3EyeCamera::PS3EyeCamera(CameraConfig* cam_cfg):CameraEngine(cam_cfg) {
 	cam_buffer = NULL;
 	cam_cfg->driver = DRIVER_PS3EYE;
 	raw_buffer = NULL;
+	queue_dropped = 0;
 }
 
 PS3EyeCamera::~PS3EyeCamera() {
@@ -182,8 +183,10 @@ bool PS3EyeCamera::initCamera() {
 	PS3EYECam::EOutputFormat eye_fmt = PS3EYECam::EOutputFormat::Gray;
 	if(cfg->color) eye_fmt = PS3EYECam::EOutputFormat::RGB;
     eye->init( cfg->cam_width, cfg->cam_height, cfg->cam_fps, eye_fmt);
+	if (cfg->cam_buffers>0) eye->setTransferCount(cfg->cam_buffers);
 
-	raw_buffer = new uint8_t[eye->getWidth() * eye->getHeight() * eye->getOutputBytesPerPixel()];
+	// gray frames are converted directly into the camera buffer
+	if (cfg->color) raw_buffer = new uint8_t[eye->getWidth() * eye->getHeight() * eye->getOutputBytesPerPixel()];
 
     cfg->cam_width = eye->getWidth();
     cfg->cam_height = eye->getHeight();
@@ -221,20 +224,35 @@ bool PS3EyeCamera::resetCamera() {
 }
 
 bool PS3EyeCamera::closeCamera() {
+    if (dropped_frames>0) printf("dropped frames: %u\n", dropped_frames);
     return true;
 }
 
 unsigned char*  PS3EyeCamera::getFrame() {
 
 	if (!eye->isStreaming()) return NULL;
-	eye->getFrame(raw_buffer);
-	if (!eye->isStreaming()) return NULL;
 
-	if(cfg->frame) {
-		crop(cfg->cam_width, cfg->cam_height, (unsigned char *)raw_buffer, cam_buffer, cfg->buf_format);
-		return cam_buffer;
-	} else return raw_buffer;
+	if (!cfg->color) {
+		// the Bayer frame is converted directly into the cropped gray frame
+		bool success;
+		if (cfg->frame) success = eye->getFrame(cam_buffer, cfg->frame_xoff, cfg->frame_yoff, cfg->frame_width, cfg->frame_height);
+		else success = eye->getFrame(cam_buffer);
+		if (!success) return NULL;
+	} else {
+		if (!eye->getFrame(raw_buffer)) return NULL;
+		if (cfg->frame) crop(cfg->cam_width, cfg->cam_height, (unsigned char *)raw_buffer, cam_buffer, cfg->buf_format);
+	}
+
+	// frames overwritten in the transfer queue are counted as gaps in the sequence
+	unsigned int dropped = eye->getDroppedFrames();
+	if (dropped<queue_dropped) queue_dropped = 0;
+	frame_sequence += 1 + dropped - queue_dropped;
+	dropped_frames += dropped - queue_dropped;
+	queue_dropped = dropped;
+	frame_time = eye->getFrameTime();
 
+	if (cfg->color && !cfg->frame) return raw_buffer;
+	return cam_buffer;
 }
 
 int PS3EyeCamera::getCameraSettingStep(int mode) {
@@ -56,9 +56,12 @@ public:
     bool hasCameraSetting(int mode);
     bool hasCameraSettingAuto(int mode);
 
+    bool waitsForFrame() { return true; }
+
 private:
     ps3eye::PS3EYECam::PS3EYERef eye;
 	uint8_t* raw_buffer;
+	unsigned int queue_dropped;
 };
 
 #endif
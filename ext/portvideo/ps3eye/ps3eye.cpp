@@ -5,6 +5,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <algorithm>
 
 #if defined WIN32 || defined _WIN32 || defined WINCE
 	#include <windows.h>
@@ -73,7 +75,8 @@
 namespace ps3eye {
 
 #define TRANSFER_SIZE		65536
-#define NUM_TRANSFERS		5
+#define DEFAULT_TRANSFERS	8
+#define MAX_TRANSFERS		32
 
 #define OV534_REG_ADDRESS	0xf1	/* sensor address */
 #define OV534_REG_SUBADDR	0xf2
@@ -405,6 +408,7 @@ int USBMgr::listDevices( std::vector<PS3EYECam::PS3EYERef>& list )
 
 	if (cnt < 0) {
 		debug("Error Device scan\n");
+		return 0;
 	}
 
     cnt = 0;
@@ -437,12 +441,15 @@ class FrameQueue
 public:
 	FrameQueue(uint32_t frame_size) :
 		disconnected		(false),
+		dropped				(0),
 		frame_size			(frame_size),
 		num_frames			(2),
 		frame_buffer		((uint8_t*)malloc(frame_size * num_frames)),
+		frame_time			(num_frames, 0),
 		head				(0),
 		tail				(0),
-		available			(0)
+		available			(0),
+		stopped				(false)
 	{
 	}
 
@@ -457,8 +464,8 @@ public:
 	}
 
 	void stop() {
-		//printf("stopped\n");
-		available=INT_MAX;
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = true;
 		empty_condition.notify_one();
 	}
 	
@@ -468,6 +475,10 @@ public:
 
 		std::lock_guard<std::mutex> lock(mutex);
 
+		// The completed frame is stamped with the arrival time of its last packet
+		frame_time[head] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		if (stopped) return frame_buffer + head * frame_size;
+
 		// Unlike traditional producer/consumer, we don't block the producer if the buffer is full (ie. the consumer is not reading data fast enough).
 		// Instead, if the buffer is full, we simply return the current frame pointer, causing the producer to overwrite the previous frame.
 		// This allows performance to degrade gracefully: if the consumer is not fast enough (< Camera FPS), it will miss frames, but if it is fast enough (>= Camera FPS), it will see everything.
@@ -476,6 +487,7 @@ public:
 		// otherwise the producer could overwrite the frame the consumer is currently reading (in case of a slow consumer)
 		if (available >= num_frames - 1)
 		{
+			dropped++;
 			return frame_buffer + head * frame_size;
 		}
 
@@ -493,22 +505,31 @@ public:
 		return new_frame;
 	}
 
-	void Dequeue(uint8_t* new_frame, int frame_width, int frame_height, PS3EYECam::EOutputFormat outputFormat)
-	{		
-		std::unique_lock<std::mutex> lock(mutex);
-
-		// If there is no data in the buffer, wait until data becomes available
-		empty_condition.wait(lock, [this] () {
-			if(available==INT_MAX) disconnected = true;
-			return available != 0;
-		}); if (disconnected) return;
+	bool Dequeue(uint8_t* new_frame, int frame_width, int frame_height, PS3EYECam::EOutputFormat outputFormat, int x, int y, int width, int height, int64_t* time)
+	{
+		uint8_t* source = NULL;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			// If there is no data in the buffer, wait until data becomes available
+			empty_condition.wait(lock, [this] () {
+				return stopped || available != 0;
+			});
+			if (stopped) {
+				disconnected = true;
+				return false;
+			}
 
-		// Copy from internal buffer
-		uint8_t* source = frame_buffer + frame_size * tail;
+			source = frame_buffer + frame_size * tail;
+			*time = frame_time[tail];
+		}
 
+		// The producer never writes into the tail frame while it is available,
+		// so the conversion runs without the lock and does not stall the transfer thread
 		if (outputFormat == PS3EYECam::EOutputFormat::Bayer)
 		{
-			memcpy(new_frame, source, frame_size);
+			for (int row = 0; row < height; ++row)
+				memcpy(new_frame + row * width, source + (y + row) * frame_width + x, width);
 		}
 		else if (outputFormat == PS3EYECam::EOutputFormat::BGR ||
 				 outputFormat == PS3EYECam::EOutputFormat::RGB)
@@ -517,14 +538,17 @@ public:
 		}		
 		else if (outputFormat == PS3EYECam::EOutputFormat::Gray)
 		{
-			DebayerGray(frame_width, frame_height, source, new_frame);
+			DebayerGray(frame_width, frame_height, source, new_frame, x, y, width, height);
 		}
+
 		// Update tail and available count
+		std::lock_guard<std::mutex> lock(mutex);
 		tail = (tail + 1) % num_frames;
 		available--;
+		return true;
 	}
 	
-	void DebayerGray(int frame_width, int frame_height, const uint8_t* inBayer, uint8_t* outBuffer)
+	void DebayerGray(int frame_width, int frame_height, const uint8_t* inBayer, uint8_t* outBuffer, int x, int y, int width, int height)
 	{
 		// PSMove output is in the following Bayer format (GRBG):
 		//
@@ -534,96 +558,79 @@ public:
 		// B G B G B G
 		//
 		// This is the normal Bayer pattern shifted left one place.
-		
-		int				source_stride	= frame_width;
-		const uint8_t*	source_row		= inBayer;						// Start at first bayer pixel
-		int				dest_stride		= frame_width;
-		uint8_t*		dest_row		= outBuffer + dest_stride + 1; 	// We start outputting at the second pixel of the second row's G component
-		uint32_t R,G,B;
-		
-		// Fill rows 1 to height-1 of the destination buffer. First and last row are filled separately (they are copied from the second row and second-to-last rows respectively)
-		for (int y = 0; y < frame_height-1; source_row += source_stride, dest_row += dest_stride, ++y)
-		{
-			const uint8_t* source		= source_row;
-			const uint8_t* source_end	= source + (source_stride-2);								// -2 to deal with the fact that we're starting at the second pixel of the row and should end at the second-to-last pixel of the row (first and last are filled separately)
-			uint8_t* dest				= dest_row;
-			
-			// Row starting with Green
-			if (y % 2 == 0)
-			{
-				// Fill first pixel (green)
-				B = (source[source_stride] + source[source_stride + 2] + 1) >> 1;
-				G = source[source_stride + 1];
-				R = (source[1] + source[source_stride * 2 + 1] + 1) >> 1;
-				*dest = (uint8_t)((R*77 + G*151 + B*28)>>8);
-				
-				source++;
-				dest++;
-				
-				// Fill remaining pixel
-				for (; source <= source_end - 2; source += 2, dest += 2)
-				{
-					// Blue pixel
-					B = source[source_stride + 1];
-					G = (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;
-					R = (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;
-					dest[0] = (uint8_t)((R*77 + G*151 + B*28)>>8);
+		//
+		// Each gray pixel is interpolated from the 3x3 neighbourhood of its Bayer pixel. The first and last
+		// rows and columns repeat their inner neighbours, which allows to convert any region of the frame
+		// directly into the destination buffer.
 
-					//  Green pixel
-					B = (source[source_stride + 1] + source[source_stride + 3] + 1) >> 1;
-					G = source[source_stride + 2];
-					R = (source[2] + source[source_stride * 2 + 2] + 1) >> 1;
-					dest[1] = (uint8_t)((R*77 + G*151 + B*28)>>8);
+		uint8_t* dest	= outBuffer;
+		int end			= x + width;
+		int inner_end	= (std::min)(end, frame_width - 1);
 
-				}
+		for (int row = y; row < y + height; ++row)
+		{
+			int sy = (std::min)((std::max)(row, 1), frame_height - 2);
+			const uint8_t* above	= inBayer + (sy - 1) * frame_width;
+			const uint8_t* center	= above + frame_width;
+			const uint8_t* below	= center + frame_width;
+			bool green_row			= (sy % 2 == 0);	// G R G R, otherwise B G B G
+
+			int col = x;
+			if (col == 0) {
+				*dest++ = GrayPixel(above, center, below, 1, green_row);
+				col++;
 			}
-			else
-			{
-				for (; source <= source_end - 2; source += 2, dest += 2)
-				{
-					// Red pixel
-					B = (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;;
-					G = (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;;
-					R = source[source_stride + 1];
-					dest[0] = (uint8_t)((R*77 + G*151 + B*28)>>8);
 
-					// Green pixel
-					B = (source[2] + source[source_stride * 2 + 2] + 1) >> 1;
-					G = source[source_stride + 2];
-					R = (source[source_stride + 1] + source[source_stride + 3] + 1) >> 1;
-					dest[1] = (uint8_t)((R*77 + G*151 + B*28)>>8);
+			// Inner pixels are converted in pairs of a green and a red or blue pixel
+			if (col < inner_end && ((col % 2 == 0) != green_row)) {
+				*dest++ = GrayPixel(above, center, below, col, green_row);
+				col++;
+			}
+			if (green_row) {
+				for (; col + 1 < inner_end; col += 2, dest += 2) {
+					dest[0] = GrayGreen(above, center, below, col, true);
+					dest[1] = GrayRedBlue(above, center, below, col + 1, true);
+				}
+			} else {
+				for (; col + 1 < inner_end; col += 2, dest += 2) {
+					dest[0] = GrayGreen(above, center, below, col, false);
+					dest[1] = GrayRedBlue(above, center, below, col + 1, false);
 				}
 			}
-			
-			if (source < source_end)
-			{
-				B = source[source_stride + 1];
-				G = (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;
-				R = (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;;
-				dest[0] = (uint8_t)((R*77 + G*151 + B*28)>>8);
-
-				source++;
-				dest++;
+			if (col < inner_end) {
+				*dest++ = GrayGreen(above, center, below, col, green_row);
+				col++;
 			}
-			
-			// Fill first pixel of row (copy second pixel)
-			uint8_t* first_pixel	= dest_row-1;
-			first_pixel[0]			= dest_row[0];
-			
-			// Fill last pixel of row (copy second-to-last pixel). Note: dest row starts at the *second* pixel of the row, so dest_row + (width-2) * num_output_channels puts us at the last pixel of the row
-			uint8_t* last_pixel				= dest_row + (frame_width - 2);
-			uint8_t* second_to_last_pixel	= last_pixel - 1;
-			last_pixel[0]					= second_to_last_pixel[0];
-		}
-		
-		// Fill first & last row
-		for (int i = 0; i < dest_stride; i++)
-		{
-			outBuffer[i]									= outBuffer[i + dest_stride];
-			outBuffer[i + (frame_height - 1)*dest_stride]	= outBuffer[i + (frame_height - 2)*dest_stride];
+
+			if (col < end) *dest++ = GrayPixel(above, center, below, frame_width - 2, green_row);
 		}
 	}
 
+	static inline uint8_t GrayGreen(const uint8_t* above, const uint8_t* center, const uint8_t* below, int x, bool green_row)
+	{
+		// Red neighbours on the sides of G R rows and blue ones on B G rows
+		uint32_t side		= (center[x - 1] + center[x + 1] + 1) >> 1;
+		uint32_t vertical	= (above[x] + below[x] + 1) >> 1;
+		uint32_t R = green_row ? side : vertical;
+		uint32_t B = green_row ? vertical : side;
+		return (uint8_t)((R*77 + center[x]*151 + B*28)>>8);
+	}
+
+	static inline uint8_t GrayRedBlue(const uint8_t* above, const uint8_t* center, const uint8_t* below, int x, bool green_row)
+	{
+		uint32_t G			= (center[x - 1] + center[x + 1] + above[x] + below[x] + 2) >> 2;
+		uint32_t diagonal	= (above[x - 1] + above[x + 1] + below[x - 1] + below[x + 1] + 2) >> 2;
+		uint32_t R = green_row ? center[x] : diagonal;
+		uint32_t B = green_row ? diagonal : center[x];
+		return (uint8_t)((R*77 + G*151 + B*28)>>8);
+	}
+
+	static inline uint8_t GrayPixel(const uint8_t* above, const uint8_t* center, const uint8_t* below, int x, bool green_row)
+	{
+		if ((x % 2 == 0) == green_row) return GrayGreen(above, center, below, x, green_row);
+		else return GrayRedBlue(above, center, below, x, green_row);
+	}
+
 	void DebayerRGB(int frame_width, int frame_height, const uint8_t* inBayer, uint8_t* outBuffer, bool inBGR)
 	{
 		// PSMove output is in the following Bayer format (GRBG):
@@ -727,15 +734,18 @@ public:
 		}
 	}
 	bool disconnected;
+	uint32_t dropped;
 
 private:
 	uint32_t				frame_size;
 	uint32_t				num_frames;
 
 	uint8_t*				frame_buffer;
+	std::vector<int64_t>	frame_time;
 	uint32_t				head;
 	uint32_t				tail;
 	uint32_t				available;
+	bool					stopped;
 
 	std::mutex				mutex;
 	std::condition_variable	empty_condition;
@@ -748,6 +758,7 @@ class URBDesc
 public:
 	URBDesc() : 
 		num_active_transfers			(0),
+		num_transfers			(0),
 		last_packet_type		(DISCARD_PACKET), 
 		last_pts				(0), 
 		last_fid				(0), 
@@ -765,7 +776,7 @@ public:
 		close_transfers();
 	}
 
-	bool start_transfers(libusb_device_handle *handle, uint32_t curr_frame_size)
+	bool start_transfers(libusb_device_handle *handle, uint32_t curr_frame_size, int transfer_count)
 	{
 		// Initialize the frame queue
         frame_size = curr_frame_size;
@@ -779,12 +790,13 @@ public:
 		uint8_t bulk_endpoint = find_ep(libusb_get_device(handle));
 		libusb_clear_halt(handle, bulk_endpoint);
 
-		// Allocate the transfer buffer
-		transfer_buffer = (uint8_t*)malloc(TRANSFER_SIZE * NUM_TRANSFERS);
-		memset(transfer_buffer, 0, TRANSFER_SIZE * NUM_TRANSFERS);
+		// Allocate the transfer buffer, more transfers in flight bridge longer scheduling delays at high frame rates
+		num_transfers = transfer_count;
+		transfer_buffer = (uint8_t*)malloc(TRANSFER_SIZE * num_transfers);
+		memset(transfer_buffer, 0, TRANSFER_SIZE * num_transfers);
 
 		int res = 0;
-		for (int index = 0; index < NUM_TRANSFERS; ++index)
+		for (int index = 0; index < num_transfers; ++index)
 		{
 			// Create & submit the transfer
 			xfr[index] = libusb_alloc_transfer(0);
@@ -810,7 +822,7 @@ public:
 			return;
 
 		// Cancel any pending transfers
-		for (int index = 0; index < NUM_TRANSFERS; ++index)
+		for (int index = 0; index < num_transfers; ++index)
 		{
 			libusb_cancel_transfer(xfr[index]);
 		}
@@ -956,13 +968,14 @@ public:
 	}
 
 	uint8_t					num_active_transfers;
+	int						num_transfers;
 	std::mutex				num_active_transfers_mutex;
 	std::condition_variable	num_active_transfers_condition;
 
 	enum gspca_packet_type	last_packet_type;
 	uint32_t				last_pts;
 	uint16_t				last_fid;
-	libusb_transfer*		xfr[NUM_TRANSFERS];
+	libusb_transfer*		xfr[MAX_TRANSFERS];
 
 	uint8_t*				transfer_buffer;
     uint8_t*				cur_frame_start;
@@ -1042,6 +1055,8 @@ PS3EYECam::PS3EYECam(libusb_device *device)
 	handle_ = NULL;
 
 	is_streaming = false;
+	transfer_count = DEFAULT_TRANSFERS;
+	frame_time = 0;
 
 	device_ = device;
 	mgrPtr = USBMgr::instance();
@@ -1176,7 +1191,7 @@ void PS3EYECam::start()
 	ov534_reg_write(0xe0, 0x00); // start stream
 
 	// init and start urb
-	urb->start_transfers(handle_, frame_width*frame_height);
+	urb->start_transfers(handle_, frame_width*frame_height, transfer_count);
     is_streaming = true;
 }
 
@@ -1254,9 +1269,29 @@ uint32_t PS3EYECam::getOutputBytesPerPixel() const
 	return 0;
 }
 
-void PS3EYECam::getFrame(uint8_t* frame)
+void PS3EYECam::setTransferCount(int count)
+{
+	if (count < 1) count = DEFAULT_TRANSFERS;
+	else if (count > MAX_TRANSFERS) count = MAX_TRANSFERS;
+	transfer_count = count;
+}
+
+uint32_t PS3EYECam::getDroppedFrames() const
 {
-	urb->frame_queue->Dequeue(frame, frame_width, frame_height, frame_output_format);
+	if (urb->frame_queue == NULL) return 0;
+	return urb->frame_queue->dropped;
+}
+
+bool PS3EYECam::getFrame(uint8_t* frame)
+{
+	return urb->frame_queue->Dequeue(frame, frame_width, frame_height, frame_output_format, 0, 0, frame_width, frame_height, &frame_time);
+}
+
+bool PS3EYECam::getFrame(uint8_t* frame, int x, int y, int width, int height)
+{
+	if (frame_output_format == EOutputFormat::BGR || frame_output_format == EOutputFormat::RGB) return false;
+	if (x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > (int)frame_width || y + height > (int)frame_height) return false;
+	return urb->frame_queue->Dequeue(frame, frame_width, frame_height, frame_output_format, x, y, width, height, &frame_time);
 }
 
 bool PS3EYECam::open_usb()
@@ -1270,6 +1305,11 @@ bool PS3EYECam::open_usb()
 
 	//libusb_set_configuration(handle_, 0);
 
+#ifdef __linux__
+	// the kernel gspca driver claims the camera by default
+	libusb_set_auto_detach_kernel_driver(handle_, 1);
+#endif
+
 	res = libusb_claim_interface(handle_, 0);
 	if(res != 0) {
 		debug("device claim interface error: %d\n", res);
@@ -170,7 +170,21 @@ public:
 	// Get a frame from the camera. Notes:
 	// - If there is no frame available, this function will block until one is
 	// - The output buffer must be sized correctly, depending out the output format. See EOutputFormat.
-	void getFrame(uint8_t* frame);
+	// - Returns false if the camera has been disconnected or stopped
+	bool getFrame(uint8_t* frame);
+
+	// Get a region of the frame from the camera, converted directly into the output buffer of width * height bytes.
+	// Only available for Bayer and Gray output.
+	bool getFrame(uint8_t* frame, int x, int y, int width, int height);
+
+	// Arrival time of the last frame in microseconds since the epoch
+	int64_t getFrameTime() const { return frame_time; }
+	// Frames which have been overwritten before they could be read
+	uint32_t getDroppedFrames() const;
+
+	// Number of bulk transfers kept in flight, must be set before start()
+	void setTransferCount(int count);
+	int getTransferCount() const { return transfer_count; }
 
 	uint32_t getWidth() const { return frame_width; }
 	uint32_t getHeight() const { return frame_height; }
@@ -219,6 +233,8 @@ private:
     bool flip_v;
 	//
     bool is_streaming;
+	int transfer_count;
+	int64_t frame_time;
 
 	std::shared_ptr<class USBMgr> mgrPtr;
 
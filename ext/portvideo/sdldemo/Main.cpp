@@ -51,6 +51,8 @@ void readSettings(application_settings *config) {
 	config->fullscreen = false;
 	config->headless = false;
 	config->display_mode = 2;
+	config->record_compression = true;
+	config->record_threads = 1;
 
 	if (strcmp( config->file, "none" ) == 0) {
 #ifdef __APPLE__
@@ -104,6 +106,15 @@ void readSettings(application_settings *config) {
             if ((strcmp( image_element->Attribute("fullscreen"), "true" ) == 0) ||  atoi(image_element->Attribute("fullscreen"))==1) config->fullscreen = true;
         }
 	}
+
+	tinyxml2::XMLElement* recording_element = config_root.FirstChildElement("recording").ToElement();
+	if(recording_element!=NULL)
+	{
+		if(recording_element->Attribute("compression")!=NULL) {
+			config->record_compression = ((strcmp( recording_element->Attribute("compression"), "true" ) == 0) ||  atoi(recording_element->Attribute("compression"))==1);
+		}
+		if(recording_element->Attribute("threads")!=NULL) config->record_threads = atoi(recording_element->Attribute("threads"));
+	}
 }
 
 void writeSettings(application_settings *config) {
@@ -27,6 +27,8 @@ struct application_settings {
     bool fullscreen;
     bool headless;
 	int display_mode;
+	bool record_compression;
+	int record_threads;
 };
 
 #endif
@@ -0,0 +1,211 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "DeltaDecoder.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+using namespace TUIO;
+
+static inline unsigned int readUInt32(const unsigned char *p) {
+	return ((unsigned int)p[0]<<24) | ((unsigned int)p[1]<<16) | ((unsigned int)p[2]<<8) | (unsigned int)p[3];
+}
+
+static inline unsigned int readUInt16(const unsigned char *p) {
+	return ((unsigned int)p[0]<<8) | (unsigned int)p[1];
+}
+
+DeltaDecoder::DeltaDecoder()
+	:has_key			(false)
+	,key_id				(0)
+	,has_pending		(false)
+	,pending_keyframe	(false)
+	,pending_frame		(0)
+	,pending_key		(0)
+	,pending_count		(0)
+	,pending_sec		(0)
+	,pending_usec		(0)
+	,has_sequence		(false)
+	,last_sequence		(0)
+	,has_last			(false)
+	,last_frame			(0)
+	,lost_packets		(0)
+	,dropped_frames		(0)
+	,frame_id			(-1)
+	,frame_sec			(0)
+	,frame_usec			(0)
+{
+}
+
+bool DeltaDecoder::decodePacket(const char *data, int size) {
+	
+	if (size<TUIO_DELTA_HEADER_SIZE) return false;
+	const unsigned char *header = (const unsigned char*)data;
+	if (readUInt32(header)!=TUIO_DELTA_MAGIC) return false;
+	
+	unsigned int sequence = readUInt32(header+4);
+	unsigned int frame = readUInt32(header+8);
+	unsigned int key = readUInt32(header+12);
+	unsigned int part = readUInt16(header+24);
+	unsigned int parts = readUInt16(header+26);
+	unsigned int count = readUInt16(header+28);
+	bool keyframe = (readUInt16(header+30) & TUIO_DELTA_KEYFRAME)!=0;
+	if ((parts==0) || (part>=parts)) return false;
+	
+	// the sequence numbers only serve for the loss statistics, the frames are reassembled by their ID
+	if (has_sequence && (sequence!=last_sequence+1)) lost_packets += (int)(sequence-last_sequence-1)>0 ? sequence-last_sequence-1 : 1;
+	if (!has_sequence || ((int)(sequence-last_sequence)>0)) last_sequence = sequence;
+	has_sequence = true;
+	
+	// ignore late packets of completed or abandoned frames
+	if (has_last && ((int)(frame-last_frame)<=0)) return false;
+	
+	if (has_pending && (frame!=pending_frame)) {
+		if ((int)(frame-pending_frame)<0) return false;
+		has_pending = false;
+		dropped_frames++;
+	}
+	
+	if (!has_pending) {
+		// delta frames are useless without their keyframe
+		if (!keyframe && (!has_key || (key!=key_id))) {
+			has_last = true;
+			last_frame = frame;
+			dropped_frames++;
+			return false;
+		}
+		
+		has_pending = true;
+		pending_keyframe = keyframe;
+		pending_frame = frame;
+		pending_key = key;
+		pending_count = 0;
+		pending_sec = readUInt32(header+16);
+		pending_usec = readUInt32(header+20);
+		pendingParts.assign(parts, false);
+		pendingState.clear();
+	}
+	
+	if ((parts!=pendingParts.size()) || pendingParts[part]) return false;
+	
+	if (!decodeRecords(header+TUIO_DELTA_HEADER_SIZE, size-TUIO_DELTA_HEADER_SIZE, count, keyframe)) {
+		has_pending = false;
+		has_last = true;
+		last_frame = frame;
+		dropped_frames++;
+		return false;
+	}
+	
+	pendingParts[part] = true;
+	pending_count++;
+	if (pending_count<parts) return false;
+	
+	completeFrame();
+	return true;
+}
+
+bool DeltaDecoder::decodeRecords(const unsigned char *data, int size, unsigned int count, bool keyframe) {
+	
+	const unsigned char *end = data+size;
+	unsigned int session_id = 0;
+	
+	for (unsigned int i=0;i<count;i++) {
+		
+		unsigned int offset = 0;
+		int shift = 0;
+		while (true) {
+			if ((data>=end) || (shift>28)) return false;
+			unsigned char b = *data++;
+			offset |= (unsigned int)(b & 0x7F) << shift;
+			if ((b & 0x80)==0) break;
+			shift += 7;
+		}
+		session_id += offset;
+		
+		if (data>=end) return false;
+		unsigned char mask = *data++;
+		
+		DeltaEntity entity;
+		entity.session_id = session_id;
+		
+		if (mask & DELTA_ABSOLUTE) {
+			if (data+2*DELTA_FIELDS>end) return false;
+			for (int f=0;f<DELTA_FIELDS;f++) {
+				entity.value[f] = (unsigned short)readUInt16(data);
+				data += 2;
+			}
+		} else {
+			if (keyframe) return false;
+			std::vector<DeltaEntity>::const_iterator base = std::lower_bound(keyState.begin(), keyState.end(), entity);
+			if ((base==keyState.end()) || (base->session_id!=session_id)) return false;
+			
+			for (int f=0;f<DELTA_FIELDS;f++) {
+				entity.value[f] = base->value[f];
+				if ((mask & (1<<f))==0) continue;
+				if (mask & DELTA_SMALL) {
+					if (data+1>end) return false;
+					entity.value[f] = (unsigned short)(entity.value[f] + (signed char)data[0]);
+					data += 1;
+				} else {
+					if (data+2>end) return false;
+					entity.value[f] = (unsigned short)(entity.value[f] + (short)readUInt16(data));
+					data += 2;
+				}
+			}
+		}
+		
+		pendingState.push_back(entity);
+	}
+	
+	return true;
+}
+
+void DeltaDecoder::completeFrame() {
+	
+	has_pending = false;
+	std::sort(pendingState.begin(), pendingState.end());
+	
+	if (pending_keyframe) {
+		keyState = pendingState;
+		key_id = pending_key;
+		has_key = true;
+	}
+	
+	has_last = true;
+	last_frame = pending_frame;
+	frame_id = pending_frame;
+	frame_sec = pending_sec;
+	frame_usec = pending_usec;
+	
+	blobs.resize(pendingState.size());
+	for (unsigned int i=0;i<pendingState.size();i++) {
+		const DeltaEntity &entity = pendingState[i];
+		DeltaBlob &blob = blobs[i];
+		blob.session_id = entity.session_id;
+		blob.x = entity.value[0]/65535.0f;
+		blob.y = entity.value[1]/65535.0f;
+		blob.angle = entity.value[2]/65536.0f*2.0f*(float)M_PI;
+		blob.width = entity.value[3]/65535.0f;
+		blob.height = entity.value[4]/65535.0f;
+		blob.area = entity.value[5]/65535.0f;
+	}
+}
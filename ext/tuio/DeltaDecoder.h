@@ -0,0 +1,163 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_DELTADECODER_H
+#define INCLUDED_DELTADECODER_H
+
+#include "LibExport.h"
+#include <vector>
+
+/*
+ The delta stream consists of UDP packets with a 32 byte header in network byte order:
+ magic, packet sequence, frame id, keyframe id, seconds, micro seconds (all uint32),
+ part, parts, record count and flags (all uint16).
+ Each record starts with the varint encoded difference to the previous session id within the packet,
+ followed by a field mask and the values of the fields present in the mask.
+ Keyframe records are absolute and carry all six fields as uint16, all other records are deltas
+ against the last keyframe as int16 or int8 values. Each frame lists all alive blobs,
+ unchanged blobs are sent with an empty mask, missing blobs have been removed.
+*/
+
+#define TUIO_DELTA_MAGIC 0x544C4454
+#define TUIO_DELTA_HEADER_SIZE 32
+#define TUIO_DELTA_PACKET_SIZE 1400
+#define TUIO_DELTA_KEYFRAME 0x0001
+
+#define DELTA_X 0x01
+#define DELTA_Y 0x02
+#define DELTA_ANGLE 0x04
+#define DELTA_WIDTH 0x08
+#define DELTA_HEIGHT 0x10
+#define DELTA_AREA 0x20
+#define DELTA_SMALL 0x40
+#define DELTA_ABSOLUTE 0x80
+#define DELTA_FIELDS 6
+
+namespace TUIO {
+	
+	/**
+	 * The quantized state of a single blob within the delta stream
+	 */
+	struct DeltaEntity {
+		unsigned int session_id;
+		unsigned short value[DELTA_FIELDS];
+		
+		bool operator<(const DeltaEntity &other) const { return session_id < other.session_id; }
+	};
+	
+	/**
+	 * The dequantized state of a single blob within the delta stream
+	 */
+	struct DeltaBlob {
+		unsigned int session_id;
+		float x, y, angle, width, height, area;
+	};
+	
+	/**
+	 * The DeltaDecoder reconstructs the blob state from the packets of the compact delta stream sent by the DeltaSender.
+	 * Frames are only applied once all their parts have been received and the keyframe they refer to is known,
+	 * lost packets therefore only drop the affected frame, or all frames until the next keyframe if the keyframe was lost.
+	 * The decoder does not receive any data itself, the packets are provided by the client application.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */ 
+	class LIBDECL DeltaDecoder {
+		
+	public:
+		/**
+		 * The default constructor creates an empty DeltaDecoder
+		 */
+		DeltaDecoder();
+		
+		/**
+		 * This method decodes a single received packet
+		 *
+		 * @param  data  the packet data
+		 * @param  size  the packet size in bytes
+		 * @return true if a new frame has been completed
+		 */
+		bool decodePacket(const char *data, int size);
+		
+		/**
+		 * Returns the blobs of the last completed frame
+		 *
+		 * @return the blobs of the last completed frame
+		 */
+		const std::vector<DeltaBlob>& getBlobs() const { return blobs; }
+		
+		/**
+		 * Returns the ID of the last completed frame
+		 *
+		 * @return the frame ID of the last completed frame
+		 */
+		long getFrameID() const { return frame_id; }
+		
+		/**
+		 * Returns the time of the last completed frame
+		 *
+		 * @param  seconds  returns the seconds of the frame time
+		 * @param  micro_seconds  returns the micro seconds of the frame time
+		 */
+		void getFrameTime(long &seconds, long &micro_seconds) const { seconds = frame_sec; micro_seconds = frame_usec; }
+		
+		/**
+		 * Returns the number of packets which have been lost or were received out of order
+		 *
+		 * @return the number of lost packets
+		 */
+		unsigned int getLostPackets() const { return lost_packets; }
+		
+		/**
+		 * Returns the number of frames which could not be completed
+		 *
+		 * @return the number of dropped frames
+		 */
+		unsigned int getDroppedFrames() const { return dropped_frames; }
+		
+	private:
+		bool decodeRecords(const unsigned char *data, int size, unsigned int count, bool keyframe);
+		void completeFrame();
+		
+		std::vector<DeltaEntity> keyState;
+		std::vector<DeltaEntity> pendingState;
+		std::vector<bool> pendingParts;
+		std::vector<DeltaBlob> blobs;
+		
+		bool has_key;
+		unsigned int key_id;
+		
+		bool has_pending;
+		bool pending_keyframe;
+		unsigned int pending_frame;
+		unsigned int pending_key;
+		unsigned int pending_count;
+		unsigned int pending_sec, pending_usec;
+		
+		bool has_sequence;
+		unsigned int last_sequence;
+		bool has_last;
+		unsigned int last_frame;
+		unsigned int lost_packets;
+		unsigned int dropped_frames;
+		
+		long frame_id;
+		long frame_sec, frame_usec;
+	};
+}
+#endif /* INCLUDED_DELTADECODER_H */
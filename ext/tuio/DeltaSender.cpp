@@ -0,0 +1,255 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "DeltaSender.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifndef WIN32
+#include <fcntl.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// the largest record consists of a five byte session offset, the mask and six absolute values
+#define MAX_RECORD_SIZE 18
+
+using namespace TUIO;
+
+static inline void writeUInt32(unsigned char *p, unsigned int v) {
+	p[0] = (unsigned char)(v>>24);
+	p[1] = (unsigned char)(v>>16);
+	p[2] = (unsigned char)(v>>8);
+	p[3] = (unsigned char)v;
+}
+
+static inline void writeUInt16(unsigned char *p, unsigned int v) {
+	p[0] = (unsigned char)(v>>8);
+	p[1] = (unsigned char)v;
+}
+
+static inline unsigned short quantize(float v) {
+	if (v<=0.0f) return 0;
+	if (v>=1.0f) return 65535;
+	return (unsigned short)(v*65535.0f+0.5f);
+}
+
+static inline unsigned short quantizeAngle(float a) {
+	// the angle wraps around, therefore 2PI corresponds to 65536
+	float t = a/(2.0f*(float)M_PI);
+	t -= floorf(t);
+	return (unsigned short)((unsigned int)(t*65536.0f+0.5f) & 0xFFFF);
+}
+
+DeltaSender::DeltaSender(const char *host, int port, int interval)
+	:packet_start		(0)
+	,packet_count		(0)
+	,last_session		(0)
+	,keyframe_interval	(interval)
+	,keyframe_countdown	(0)
+	,keyframe			(false)
+	,key_id				(0)
+	,frame_id			(0)
+	,frame_sec			(0)
+	,frame_usec			(0)
+	,sequence			(0)
+{
+	if (keyframe_interval<1) keyframe_interval = 1;
+	
+	unsigned long ip = GetHostByName(host);
+	if ((ip==0) || (ip==INADDR_NONE)) {
+		std::cout << "unknown host name: " << host << std::endl;
+		throw std::exception();
+	}
+	
+	memset(&destination, 0, sizeof(destination));
+	destination.sin_family = AF_INET;
+	destination.sin_addr.s_addr = htonl(ip);
+	destination.sin_port = htons(port);
+	
+	udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (udp_socket < 0) {
+		std::cout << "could not create UDP socket" << std::endl;
+		throw std::exception();
+	}
+	
+	// the tracking thread must never wait for a congested wireless link
+#ifdef WIN32
+	u_long nonblocking = 1;
+	ioctlsocket(udp_socket, FIONBIO, &nonblocking);
+#else
+	fcntl(udp_socket, F_SETFL, fcntl(udp_socket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+	
+	std::cout << tuio_type() << " messages to " << host << "@" << port << std::endl;
+}
+
+DeltaSender::~DeltaSender() {
+#ifdef WIN32
+	closesocket(udp_socket);
+#else
+	close(udp_socket);
+#endif
+}
+
+void DeltaSender::startFrame(long fid, TuioTime ttime) {
+	frame_id = (unsigned int)fid;
+	frame_sec = (unsigned int)ttime.getSeconds();
+	frame_usec = (unsigned int)ttime.getMicroseconds();
+	frameState.clear();
+}
+
+bool DeltaSender::addBlob(int session_id, int blob_id, float x, float y, float a, float w, float h, float f, float X, float Y, float A, float m, float r) {
+	
+	DeltaEntity entity;
+	entity.session_id = (unsigned int)session_id;
+	entity.value[0] = quantize(x);
+	entity.value[1] = quantize(y);
+	entity.value[2] = quantizeAngle(a);
+	entity.value[3] = quantize(w);
+	entity.value[4] = quantize(h);
+	entity.value[5] = quantize(f);
+	frameState.push_back(entity);
+	return true;
+}
+
+void DeltaSender::commitFrame() {
+	
+	std::sort(frameState.begin(), frameState.end());
+	
+	keyframe = (keyframe_countdown<=0);
+	if (keyframe) {
+		keyState = frameState;
+		key_id = frame_id;
+		keyframe_countdown = keyframe_interval;
+	}
+	keyframe_countdown--;
+	
+	frame_buffer.clear();
+	packet_offset.clear();
+	beginPacket();
+	
+	// both lists are sorted by session ID, so the keyframe state is merged in a single pass
+	unsigned int k = 0;
+	for (unsigned int i=0;i<frameState.size();i++) {
+		const DeltaEntity &entity = frameState[i];
+		const DeltaEntity *base = NULL;
+		if (!keyframe) {
+			while ((k<keyState.size()) && (keyState[k].session_id<entity.session_id)) k++;
+			if ((k<keyState.size()) && (keyState[k].session_id==entity.session_id)) base = &keyState[k];
+		}
+		
+		if (frame_buffer.size()+MAX_RECORD_SIZE > packet_start+TUIO_DELTA_PACKET_SIZE) {
+			endPacket();
+			beginPacket();
+		}
+		encodeRecord(entity, base);
+	}
+	
+	endPacket();
+	sendPackets();
+}
+
+void DeltaSender::beginPacket() {
+	packet_start = (unsigned int)frame_buffer.size();
+	packet_offset.push_back(packet_start);
+	frame_buffer.resize(packet_start+TUIO_DELTA_HEADER_SIZE);
+	packet_count = 0;
+	last_session = 0;
+}
+
+void DeltaSender::endPacket() {
+	unsigned char *header = &frame_buffer[packet_start];
+	writeUInt32(header, TUIO_DELTA_MAGIC);
+	writeUInt32(header+8, frame_id);
+	writeUInt32(header+12, key_id);
+	writeUInt32(header+16, frame_sec);
+	writeUInt32(header+20, frame_usec);
+	writeUInt16(header+24, (unsigned int)packet_offset.size()-1);
+	writeUInt16(header+28, packet_count);
+	writeUInt16(header+30, keyframe ? TUIO_DELTA_KEYFRAME : 0);
+}
+
+void DeltaSender::encodeRecord(const DeltaEntity &entity, const DeltaEntity *base) {
+	
+	unsigned char record[MAX_RECORD_SIZE];
+	unsigned int size = 0;
+	
+	// the session IDs are encoded as varint offsets within each packet
+	unsigned int offset = entity.session_id - last_session;
+	last_session = entity.session_id;
+	while (offset>=0x80) {
+		record[size++] = (unsigned char)(offset | 0x80);
+		offset >>= 7;
+	}
+	record[size++] = (unsigned char)offset;
+	
+	if (base==NULL) {
+		record[size++] = DELTA_ABSOLUTE;
+		for (int f=0;f<DELTA_FIELDS;f++) {
+			writeUInt16(&record[size], entity.value[f]);
+			size += 2;
+		}
+	} else {
+		// the differences wrap around, so any change can be represented as a 16 bit delta
+		short delta[DELTA_FIELDS];
+		unsigned char mask = 0;
+		bool compact = true;
+		for (int f=0;f<DELTA_FIELDS;f++) {
+			delta[f] = (short)(unsigned short)(entity.value[f] - base->value[f]);
+			if (delta[f]==0) continue;
+			mask |= (1<<f);
+			if ((delta[f]<-128) || (delta[f]>127)) compact = false;
+		}
+		if (mask && compact) mask |= DELTA_SMALL;
+		record[size++] = mask;
+		
+		for (int f=0;f<DELTA_FIELDS;f++) {
+			if (delta[f]==0) continue;
+			if (compact) record[size++] = (unsigned char)(signed char)delta[f];
+			else {
+				writeUInt16(&record[size], (unsigned short)delta[f]);
+				size += 2;
+			}
+		}
+	}
+	
+	frame_buffer.insert(frame_buffer.end(), record, record+size);
+	packet_count++;
+}
+
+void DeltaSender::sendPackets() {
+	
+	unsigned int parts = (unsigned int)packet_offset.size();
+	for (unsigned int i=0;i<parts;i++) {
+		unsigned int start = packet_offset[i];
+		unsigned int end = (i+1<parts) ? packet_offset[i+1] : (unsigned int)frame_buffer.size();
+		unsigned char *packet = &frame_buffer[start];
+		writeUInt32(packet+4, sequence++);
+		writeUInt16(packet+26, parts);
+		sendto(udp_socket, (const char*)packet, end-start, 0, (struct sockaddr*)&destination, sizeof(struct sockaddr_in));
+	}
+}
+
+bool DeltaSender::isConnected() {
+	if (udp_socket<0) return false;
+	return true;
+}
@@ -0,0 +1,130 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_DELTASENDER_H
+#define INCLUDED_DELTASENDER_H
+
+#include "FrameSender.h"
+#include "DeltaDecoder.h"
+#include "ip/NetworkingUtils.h"
+
+#ifdef WIN32
+#include <winsock.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#include <iostream>
+#include <vector>
+
+#define DEFAULT_KEYFRAME_INTERVAL 30
+
+namespace TUIO {
+	
+	/**
+	 * The DeltaSender implements a compact binary UDP transport for large numbers of blobs on lossy wireless links.
+	 * The blob state is quantized to 16 bit and a keyframe with the absolute state of all blobs is sent periodically,
+	 * all other frames only contain the changes against the last keyframe. Since no frame depends on its predecessor,
+	 * a lost packet only affects its own frame, the DeltaDecoder class reconstructs the blob state on the client side.
+	 * The packets are sent from the tracking thread on a non-blocking socket, packets which can not be sent are dropped.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */ 
+	class LIBDECL DeltaSender : public FrameSender {
+		
+	public:
+		/**
+		 * This constructor creates a DeltaSender that sends to the provided port on the the given host
+		 *
+		 * @param  host  the receiving host name
+		 * @param  port  the outgoing UDP port number
+		 * @param  interval  the number of frames between two keyframes
+		 */
+		DeltaSender(const char *host, int port, int interval=DEFAULT_KEYFRAME_INTERVAL);
+		
+		/**
+		 * The destructor closes the socket
+		 */
+		virtual ~DeltaSender();
+		
+		/**
+		 * This method starts a new frame
+		 *
+		 * @param  frame_id  the frame ID
+		 * @param  ttime  the frame time
+		 */
+		void startFrame(long frame_id, TuioTime ttime);
+		
+		/**
+		 * This method adds a blob to the current frame
+		 * @return false if the blob could not be added
+		 */
+		bool addBlob(int session_id, int blob_id, float x, float y, float a, float w, float h, float f, float X, float Y, float A, float m, float r);
+		
+		/**
+		 * This method encodes and sends the current frame
+		 */
+		void commitFrame();
+		
+		/**
+		 * This method returns the connection state
+		 *
+		 * @return true if the connection is alive
+		 */
+		bool isConnected ();
+		
+		const char* tuio_type() { return "TUIO/DLT"; }
+		
+	private:
+		void encodeRecord(const DeltaEntity &entity, const DeltaEntity *base);
+		void beginPacket();
+		void endPacket();
+		void sendPackets();
+		
+		NetworkInitializer networkInitializer;
+#ifdef WIN32
+		SOCKET udp_socket;
+#else
+		int udp_socket;
+#endif
+		struct sockaddr_in destination;
+		
+		std::vector<DeltaEntity> frameState;
+		std::vector<DeltaEntity> keyState;
+		
+		std::vector<unsigned char> frame_buffer;
+		std::vector<unsigned int> packet_offset;
+		unsigned int packet_start;
+		unsigned int packet_count;
+		unsigned int last_session;
+		
+		int keyframe_interval;
+		int keyframe_countdown;
+		bool keyframe;
+		unsigned int key_id;
+		unsigned int frame_id;
+		unsigned int frame_sec, frame_usec;
+		unsigned int sequence;
+	};
+}
+#endif /* INCLUDED_DELTASENDER_H */
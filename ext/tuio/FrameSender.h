@@ -0,0 +1,84 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_FRAMESENDER_H
+#define INCLUDED_FRAMESENDER_H
+
+#include "LibExport.h"
+#include "TuioTime.h"
+
+namespace TUIO {
+	
+	/**
+	 * The FrameSender class is the base class for transport methods which receive the tracked state
+	 * of each committed frame directly, instead of the encoded OSC bundles of the OscSender implementations.
+	 * All methods are called from the tracking thread and therefore must not block.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */ 
+	class LIBDECL FrameSender {
+		
+	public:
+		/**
+		 * The destructor is doing nothing in particular. 
+		 */
+		virtual ~FrameSender() {}
+		
+		/**
+		 * This method starts a new frame
+		 *
+		 * @param  frame_id  the frame ID
+		 * @param  ttime  the frame time
+		 */
+		virtual void startFrame(long frame_id, TuioTime ttime) = 0;
+		
+		/**
+		 * This method adds an object to the current frame
+		 * @return false if the object could not be added
+		 */
+		virtual bool addObject(int session_id, int symbol_id, float x, float y, float a, float X, float Y, float A, float m, float r) { return true; };
+		
+		/**
+		 * This method adds a cursor to the current frame
+		 * @return false if the cursor could not be added
+		 */
+		virtual bool addCursor(int session_id, int cursor_id, float x, float y, float X, float Y, float m) { return true; };
+		
+		/**
+		 * This method adds a blob to the current frame
+		 * @return false if the blob could not be added
+		 */
+		virtual bool addBlob(int session_id, int blob_id, float x, float y, float a, float w, float h, float f, float X, float Y, float A, float m, float r) { return true; };
+		
+		/**
+		 * This method delivers the current frame
+		 */
+		virtual void commitFrame() = 0;
+		
+		/**
+		 * This method returns the connection state
+		 *
+		 * @return true if the connection is alive
+		 */
+		virtual bool isConnected () = 0;
+		
+		virtual const char* tuio_type() = 0;
+	};
+}
+#endif /* INCLUDED_FRAMESENDER_H */
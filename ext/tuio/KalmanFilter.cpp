@@ -0,0 +1,132 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "KalmanFilter.h"
+
+using namespace TUIO;
+
+std::vector<KalmanState> KalmanFilter::states;
+std::vector<int> KalmanFilter::freeSlots;
+
+int KalmanFilter::allocate(float xp, float yp, float process_noise, float measurement_noise) {
+
+	int slot;
+	if (freeSlots.size()>0) {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	} else {
+		slot = (int)states.size();
+		states.push_back(KalmanState());
+	}
+
+	states[slot].process_noise = process_noise;
+	states[slot].measurement_noise = measurement_noise;
+	reset(slot,xp,yp);
+	return slot;
+}
+
+void KalmanFilter::release(int slot) {
+	if ((slot<0) || (slot>=(int)states.size())) return;
+	freeSlots.push_back(slot);
+}
+
+void KalmanFilter::reset(int slot, float xp, float yp) {
+
+	KalmanState *s = &states[slot];
+	s->x = xp;
+	s->y = yp;
+	s->x_speed = s->y_speed = 0.0f;
+	s->x_accel = s->y_accel = 0.0f;
+
+	// the initial position is known, speed and acceleration are not
+	s->p00 = s->measurement_noise;
+	s->p01 = s->p02 = s->p12 = 0.0f;
+	s->p11 = 1.0f;
+	s->p22 = 100.0f;
+}
+
+void KalmanFilter::filter(int slot, float &xp, float &yp, float dt) {
+
+	KalmanState *s = &states[slot];
+
+	if (dt>0.0f) {
+		float dt2 = dt*dt;
+		float h = 0.5f*dt2;
+
+		// predict the state: constant acceleration
+		s->x += s->x_speed*dt + s->x_accel*h;
+		s->x_speed += s->x_accel*dt;
+		s->y += s->y_speed*dt + s->y_accel*h;
+		s->y_speed += s->y_accel*dt;
+
+		// predict the covariance: P = F*P*F' + Q
+		float r00 = s->p00 + dt*s->p01 + h*s->p02;
+		float r01 = s->p01 + dt*s->p11 + h*s->p12;
+		float r02 = s->p02 + dt*s->p12 + h*s->p22;
+		float r11 = s->p11 + dt*s->p12;
+		float r12 = s->p12 + dt*s->p22;
+
+		// discrete white noise jerk model
+		float q = s->process_noise;
+		float dt3 = dt2*dt;
+		s->p00 = r00 + dt*r01 + h*r02 + q*dt3*dt2/20.0f;
+		s->p01 = r01 + dt*r02 + q*dt2*dt2/8.0f;
+		s->p02 = r02 + q*dt3/6.0f;
+		s->p11 = r11 + dt*r12 + q*dt3/3.0f;
+		s->p12 = r12 + q*h;
+		s->p22 = s->p22 + q*dt;
+	}
+
+	// correct the state with the measured position
+	float gain = 1.0f/(s->p00 + s->measurement_noise);
+	float k0 = s->p00*gain;
+	float k1 = s->p01*gain;
+	float k2 = s->p02*gain;
+
+	float dx = xp - s->x;
+	float dy = yp - s->y;
+
+	s->x += k0*dx;
+	s->x_speed += k1*dx;
+	s->x_accel += k2*dx;
+	s->y += k0*dy;
+	s->y_speed += k1*dy;
+	s->y_accel += k2*dy;
+
+	// P = (I-K*H)*P
+	float p00 = s->p00;
+	float p01 = s->p01;
+	float p02 = s->p02;
+	s->p00 -= k0*p00;
+	s->p01 -= k0*p01;
+	s->p02 -= k0*p02;
+	s->p11 -= k1*p01;
+	s->p12 -= k1*p02;
+	s->p22 -= k2*p02;
+
+	xp = s->x;
+	yp = s->y;
+}
+
+void KalmanFilter::predict(int slot, float dt, float &xp, float &yp) {
+
+	const KalmanState *s = &states[slot];
+	float h = 0.5f*dt*dt;
+	xp = s->x + s->x_speed*dt + s->x_accel*h;
+	yp = s->y + s->y_speed*dt + s->y_accel*h;
+}
@@ -0,0 +1,121 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_KALMANFILTER_H
+#define INCLUDED_KALMANFILTER_H
+
+#include "LibExport.h"
+#include <vector>
+
+#define NO_MOTION_FILTER -1
+
+namespace TUIO {
+
+	/**
+	 * The state of a constant acceleration motion model for a single tracked component.
+	 * Both axes share the same noise model and time steps, therefore a single
+	 * symmetric covariance matrix (p00 ... p22) applies to the X and Y state.
+	 * The structure is padded to 64 bytes in order to occupy a single cache line.
+	 */
+	struct KalmanState {
+		float x, x_speed, x_accel;
+		float y, y_speed, y_accel;
+		float p00, p01, p02, p11, p12, p22;
+		float process_noise;
+		float measurement_noise;
+		float padding[2];
+	};
+
+	/**
+	 * The KalmanFilter class implements a constant acceleration Kalman filter for 2D positions.
+	 * The filter states of all tracked components are kept within a single contiguous array,
+	 * the components only refer to their state by its slot index. A single filter step provides
+	 * the smoothed position, velocity and acceleration, which are also used for position prediction.
+	 * The state array is shared and therefore not thread safe, all components using the filter
+	 * need to be updated from the same thread.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL KalmanFilter {
+
+	public:
+		/**
+		 * Allocates and initializes a filter state with the provided position and noise parameters.
+		 *
+		 * @param	xp	the initial X coordinate
+		 * @param	yp	the initial Y coordinate
+		 * @param	process_noise	the process (jerk) noise density
+		 * @param	measurement_noise	the measurement noise variance
+		 * @return	the slot index of the allocated filter state
+		 */
+		static int allocate(float xp, float yp, float process_noise, float measurement_noise);
+
+		/**
+		 * Releases the filter state at the provided slot index.
+		 *
+		 * @param	slot	the slot index to release
+		 */
+		static void release(int slot);
+
+		/**
+		 * Resets the filter state at the provided slot index to a resting position.
+		 *
+		 * @param	slot	the slot index to reset
+		 * @param	xp	the X coordinate to assign
+		 * @param	yp	the Y coordinate to assign
+		 */
+		static void reset(int slot, float xp, float yp);
+
+		/**
+		 * Performs a prediction and correction step with the provided measurement.
+		 * The measurement is replaced with the smoothed position.
+		 *
+		 * @param	slot	the slot index of the filter state
+		 * @param	xp	the measured X coordinate, returns the filtered X coordinate
+		 * @param	yp	the measured Y coordinate, returns the filtered Y coordinate
+		 * @param	dt	the time since the last measurement in seconds
+		 */
+		static void filter(int slot, float &xp, float &yp, float dt);
+
+		/**
+		 * Predicts the position after the provided time without modifying the filter state.
+		 *
+		 * @param	slot	the slot index of the filter state
+		 * @param	dt	the prediction time in seconds
+		 * @param	xp	returns the predicted X coordinate
+		 * @param	yp	returns the predicted Y coordinate
+		 */
+		static void predict(int slot, float dt, float &xp, float &yp);
+
+		/**
+		 * Returns the filter state at the provided slot index.
+		 *
+		 * @param	slot	the slot index of the filter state
+		 * @return	the filter state
+		 */
+		static const KalmanState& getState(int slot) {
+			return states[slot];
+		}
+
+	private:
+		static std::vector<KalmanState> states;
+		static std::vector<int> freeSlots;
+	};
+}
+#endif
@@ -0,0 +1,77 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "OscPacketQueue.h"
+
+using namespace TUIO;
+
+static inline void memoryBarrier() {
+#ifdef WIN32
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+OscPacketQueue::OscPacketQueue(unsigned int length)
+	:packetSize	(length)
+	,readIndex	(0)
+	,writeIndex	(0)
+	,pendingIndex	(0)
+{
+	for (int i=0;i<MAX_QUEUED_PACKETS;i++) {
+		packet[i] = new char[packetSize];
+		size[i] = 0;
+		tag[i] = 0;
+	}
+}
+
+OscPacketQueue::~OscPacketQueue() {
+	for (int i=0;i<MAX_QUEUED_PACKETS;i++)
+		delete[] packet[i];
+}
+
+char* OscPacketQueue::getNextPacketToWrite() {
+	if (nextIndex(pendingIndex)==readIndex) return NULL;
+	return packet[pendingIndex];
+}
+
+void OscPacketQueue::writeFinished(unsigned int length, int packetTag) {
+	size[pendingIndex] = length;
+	tag[pendingIndex] = packetTag;
+	pendingIndex = nextIndex(pendingIndex);
+}
+
+void OscPacketQueue::commitPackets() {
+	// the packet content must be visible before the index is advanced
+	memoryBarrier();
+	writeIndex = pendingIndex;
+}
+
+const char* OscPacketQueue::getNextPacketToRead(unsigned int &length, int &packetTag) {
+	if (readIndex==writeIndex) return NULL;
+	memoryBarrier();
+	length = size[readIndex];
+	packetTag = tag[readIndex];
+	return packet[readIndex];
+}
+
+void OscPacketQueue::readFinished() {
+	memoryBarrier();
+	readIndex = nextIndex(readIndex);
+}
@@ -0,0 +1,121 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_OSCPACKETQUEUE_H
+#define INCLUDED_OSCPACKETQUEUE_H
+
+#include "LibExport.h"
+#include <stddef.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#define MAX_QUEUED_PACKETS 32
+
+namespace TUIO {
+	
+	/**
+	 * The OscPacketQueue class is a lock-free single producer, single consumer queue
+	 * of OSC packets with a fixed number of preallocated packet slots.
+	 * The producer and consumer only advance their own index, therefore no locking
+	 * is required as long as a single thread writes and a single thread reads.
+	 * The written packets are only published to the consumer once they are committed,
+ * which allows the producer to queue or discard a sequence of packets as a whole.
+ * If the queue is full no further packet can be written until the consumer caught up.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */ 
+	class LIBDECL OscPacketQueue {
+		
+	public:
+		/**
+		 * This constructor allocates the packet slots of the provided size
+		 *
+		 * @param	size	the maximum packet size in bytes
+		 */
+		OscPacketQueue(unsigned int size);
+		
+		/**
+		 * The destructor releases all packet slots
+		 */
+		~OscPacketQueue();
+		
+		/**
+		 * Returns the maximum packet size in bytes
+		 * @return	the maximum packet size in bytes
+		 */
+		unsigned int getPacketSize() const { return packetSize; };
+		
+		/**
+		 * Returns the next free packet slot or NULL if the queue is full
+		 * @return	the next free packet slot or NULL
+		 */
+		char* getNextPacketToWrite();
+		
+		/**
+		 * Finishes the previously requested packet slot, which is published with the next commit
+		 * @param	size	the actual size of the written packet
+		 * @param	tag	an arbitrary tag which is passed to the consumer
+		 */
+		void writeFinished(unsigned int size, int tag);
+		
+		/**
+		 * Publishes all packets written since the last commit to the consumer
+		 */
+		void commitPackets();
+		
+		/**
+		 * Discards all packets written since the last commit
+		 */
+		void discardPackets() { pendingIndex = writeIndex; };
+		
+		/**
+		 * Returns the next queued packet or NULL if the queue is empty
+		 * @param	size	returns the size of the queued packet
+		 * @param	tag	returns the tag of the queued packet
+		 * @return	the next queued packet or NULL
+		 */
+		const char* getNextPacketToRead(unsigned int &size, int &tag);
+		
+		/**
+		 * Releases the previously read packet slot to the producer
+		 */
+		void readFinished();
+		
+		/**
+		 * Returns true if there are no queued packets
+		 * @return	true if there are no queued packets
+		 */
+		bool isEmpty() const { return readIndex==writeIndex; };
+		
+	private:
+		int nextIndex(int index) const { return (index+1)%MAX_QUEUED_PACKETS; };
+		
+		unsigned int packetSize;
+		char *packet[MAX_QUEUED_PACKETS];
+		unsigned int size[MAX_QUEUED_PACKETS];
+		int tag[MAX_QUEUED_PACKETS];
+		
+		volatile int readIndex;
+		volatile int writeIndex;
+		int pendingIndex;
+	};
+}
+#endif
@@ -26,6 +26,9 @@
 #include <iostream>
 #include <cstring>
 
+#define TUIO_VERSION_11 1
+#define TUIO_VERSION_20 2
+
 namespace TUIO {
 	
 	/**
@@ -41,7 +44,7 @@ namespace TUIO {
 		/**
 		 * The constructor is doing nothing in particular. 
 		 */
-		OscSender (): local(true) {};
+		OscSender (): local(true), tuio_version(TUIO_VERSION_11), update_rate(0.0f), heartbeat(0.0f), full_update(false) {};
 
 		/**
 		 * The destructor is doing nothing in particular. 
@@ -54,7 +57,24 @@ namespace TUIO {
 		 * @param *bundle  the OSC stream to deliver
 		 * @return true if the data was delivered successfully
 		 */
-		virtual bool sendOscPacket (osc::OutboundPacketStream *bundle) = 0;
+		virtual bool sendOscPacket (osc::OutboundPacketStream *bundle) {
+			return sendOscData(bundle->Data(), (unsigned int)bundle->Size());
+		};
+		
+		/**
+		 * This method delivers the provided OSC bundle data
+		 *
+		 * @param *data  the OSC bundle data to deliver
+		 * @param size  the size of the OSC bundle data in bytes
+		 * @return true if the data was delivered successfully
+		 */
+		virtual bool sendOscData (const char *data, unsigned int size) = 0;
+		
+		/**
+		 * This method is called at the end of each frame, senders which
+		 * collect the OSC bundle data of a frame deliver it at this point
+		 */
+		virtual void flushOscData () {};
 		
 		/**
 		 * This method returns the connection state
@@ -76,12 +96,79 @@ namespace TUIO {
 		 * @return the maximum bundle size in bytes
 		 */
 		int getBufferSize () { return buffer_size; };
+		
+		/**
+		 * This method selects the TUIO protocol version which is delivered by this OscSender,
+		 * the version needs to be defined before the sender is attached to the TuioServer
+		 *
+		 * @param version  TUIO_VERSION_11 or TUIO_VERSION_20
+		 */
+		void setTuioVersion (int version) { tuio_version = version; };
+		
+		/**
+		 * This method returns the TUIO protocol version which is delivered by this OscSender
+		 *
+		 * @return TUIO_VERSION_11 or TUIO_VERSION_20
+		 */
+		int getTuioVersion () { return tuio_version; };
+		
+		/**
+		 * This method limits the rate of the TUIO updates which are delivered by this OscSender.
+		 * All changes of the intermediate frames are coalesced into a single full state update,
+		 * the rate needs to be defined before the sender is attached to the TuioServer
+		 *
+		 * @param rate  the maximum number of updates per second, 0 delivers every frame
+		 */
+		void setUpdateRate (float rate) { update_rate = rate; };
+		
+		/**
+		 * This method returns the maximum number of updates per second
+		 *
+		 * @return the maximum update rate, 0 if every frame is delivered
+		 */
+		float getUpdateRate () { return update_rate; };
+		
+		/**
+		 * This method defines the interval of the periodic updates without any changes,
+		 * which overrides the periodic update interval of the TuioServer for this OscSender
+		 *
+		 * @param interval  the heartbeat interval in seconds, 0 uses the TuioServer setting
+		 */
+		void setHeartbeat (float interval) { heartbeat = interval; };
+		
+		/**
+		 * This method returns the heartbeat interval of this OscSender
+		 *
+		 * @return the heartbeat interval in seconds, 0 if the TuioServer setting is used
+		 */
+		float getHeartbeat () { return heartbeat; };
+		
+		/**
+		 * This method requests the full state with the next update of this OscSender,
+		 * after the incremental changes of a dropped frame have been lost
+		 */
+		void requestFullUpdate () { full_update = true; };
+		
+		/**
+		 * This method returns and clears a pending request for the full state
+		 *
+		 * @return true if the full state has been requested
+		 */
+		bool fullUpdateRequested () {
+			if (!full_update) return false;
+			full_update = false;
+			return true;
+		};
 	
 		virtual const char* tuio_type() = 0;
 		
 	protected:
 		unsigned int buffer_size;
 		bool local;
+		int tuio_version;
+		float update_rate;
+		float heartbeat;
+		volatile bool full_update;
 	};
 }
 
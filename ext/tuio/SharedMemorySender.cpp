@@ -0,0 +1,163 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "SharedMemorySender.h"
+
+using namespace TUIO;
+
+SharedMemorySender::SharedMemorySender(const char *name)
+	:shm	(NULL)
+	,frame	(NULL)
+{
+#ifdef WIN32
+	snprintf(shm_name, sizeof(shm_name), "%s", name);
+	mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(TuioShmFrame), shm_name);
+	if (mapping==NULL) {
+		std::cerr << "could not create " << tuio_type() << " segment " << name << std::endl;
+		throw std::exception();
+	}
+	shm = (TuioShmFrame*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TuioShmFrame));
+	if (shm==NULL) {
+		CloseHandle(mapping);
+		std::cerr << "could not map " << tuio_type() << " segment " << name << std::endl;
+		throw std::exception();
+	}
+#else
+	snprintf(shm_name, sizeof(shm_name), "/%s", name);
+	int fd = shm_open(shm_name, O_CREAT|O_RDWR, 0644);
+	if (fd<0) {
+		std::cerr << "could not create " << tuio_type() << " segment " << name << std::endl;
+		throw std::exception();
+	}
+	if (ftruncate(fd, sizeof(TuioShmFrame))<0) {
+		close(fd);
+		shm_unlink(shm_name);
+		std::cerr << "could not resize " << tuio_type() << " segment " << name << std::endl;
+		throw std::exception();
+	}
+	void *map = mmap(NULL, sizeof(TuioShmFrame), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map==MAP_FAILED) {
+		shm_unlink(shm_name);
+		std::cerr << "could not map " << tuio_type() << " segment " << name << std::endl;
+		throw std::exception();
+	}
+	shm = (TuioShmFrame*)map;
+#endif
+
+	// the frame is built locally, so readers only wait for the final copy
+	frame = new TuioShmFrame();
+	memset(frame, 0, sizeof(TuioShmFrame));
+	
+	memset(shm, 0, offsetof(TuioShmFrame, objects));
+	shm->version = TUIO_SHM_VERSION;
+	shm->sequence = 0;
+	tuio_shm_barrier();
+	shm->magic = TUIO_SHM_MAGIC;
+	
+	std::cout << tuio_type() << " frames to segment " << name << std::endl;
+}
+
+SharedMemorySender::~SharedMemorySender() {
+#ifdef WIN32
+	UnmapViewOfFile(shm);
+	CloseHandle(mapping);
+#else
+	munmap(shm, sizeof(TuioShmFrame));
+	shm_unlink(shm_name);
+#endif
+	delete frame;
+}
+
+void SharedMemorySender::startFrame(long frame_id, TuioTime ttime) {
+	frame->frame_id = (int32_t)frame_id;
+	frame->seconds = (int32_t)ttime.getSeconds();
+	frame->micro_seconds = (int32_t)ttime.getMicroseconds();
+	frame->object_count = 0;
+	frame->cursor_count = 0;
+	frame->blob_count = 0;
+}
+
+bool SharedMemorySender::addObject(int session_id, int symbol_id, float x, float y, float a, float X, float Y, float A, float m, float r) {
+	if (frame->object_count>=TUIO_SHM_MAX_OBJECTS) return false;
+	TuioShmObject *tobj = &frame->objects[frame->object_count++];
+	tobj->session_id = session_id;
+	tobj->symbol_id = symbol_id;
+	tobj->x = x;
+	tobj->y = y;
+	tobj->angle = a;
+	tobj->x_speed = X;
+	tobj->y_speed = Y;
+	tobj->rotation_speed = A;
+	tobj->motion_accel = m;
+	tobj->rotation_accel = r;
+	return true;
+}
+
+bool SharedMemorySender::addCursor(int session_id, int cursor_id, float x, float y, float X, float Y, float m) {
+	if (frame->cursor_count>=TUIO_SHM_MAX_CURSORS) return false;
+	TuioShmCursor *tcur = &frame->cursors[frame->cursor_count++];
+	tcur->session_id = session_id;
+	tcur->cursor_id = cursor_id;
+	tcur->x = x;
+	tcur->y = y;
+	tcur->x_speed = X;
+	tcur->y_speed = Y;
+	tcur->motion_accel = m;
+	return true;
+}
+
+bool SharedMemorySender::addBlob(int session_id, int blob_id, float x, float y, float a, float w, float h, float f, float X, float Y, float A, float m, float r) {
+	if (frame->blob_count>=TUIO_SHM_MAX_BLOBS) return false;
+	TuioShmBlob *tblb = &frame->blobs[frame->blob_count++];
+	tblb->session_id = session_id;
+	tblb->blob_id = blob_id;
+	tblb->x = x;
+	tblb->y = y;
+	tblb->angle = a;
+	tblb->width = w;
+	tblb->height = h;
+	tblb->area = f;
+	tblb->x_speed = X;
+	tblb->y_speed = Y;
+	tblb->rotation_speed = A;
+	tblb->motion_accel = m;
+	tblb->rotation_accel = r;
+	return true;
+}
+
+void SharedMemorySender::commitFrame() {
+
+	// an odd sequence number marks the frame as inconsistent while it is copied
+	uint32_t sequence = shm->sequence;
+	shm->sequence = sequence+1;
+	tuio_shm_barrier();
+	
+	shm->frame_id = frame->frame_id;
+	shm->seconds = frame->seconds;
+	shm->micro_seconds = frame->micro_seconds;
+	shm->object_count = frame->object_count;
+	shm->cursor_count = frame->cursor_count;
+	shm->blob_count = frame->blob_count;
+	memcpy(shm->objects, frame->objects, frame->object_count*sizeof(TuioShmObject));
+	memcpy(shm->cursors, frame->cursors, frame->cursor_count*sizeof(TuioShmCursor));
+	memcpy(shm->blobs, frame->blobs, frame->blob_count*sizeof(TuioShmBlob));
+	
+	tuio_shm_barrier();
+	shm->sequence = sequence+2;
+}
@@ -0,0 +1,100 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_SHAREDMEMORYSENDER_H
+#define INCLUDED_SHAREDMEMORYSENDER_H
+
+#include "FrameSender.h"
+#include "TuioSharedMemory.h"
+#include <iostream>
+
+namespace TUIO {
+	
+	/**
+	 * The SharedMemorySender publishes the tracked state of each frame within a named shared memory segment.
+	 * It does not serialize any OSC data, local clients map the segment
+	 * and read the latest frame with the reader functions provided in TuioSharedMemory.h.
+	 * All methods need to be called from the tracking thread, which is the single writer of the segment.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */ 
+	class LIBDECL SharedMemorySender : public FrameSender {
+		
+	public:
+		/**
+		 * This constructor creates the named shared memory segment
+		 *
+		 * @param  name  the name of the shared memory segment
+		 */
+		SharedMemorySender(const char *name);
+		
+		/**
+		 * The destructor unmaps and removes the shared memory segment
+		 */
+		virtual ~SharedMemorySender();
+		
+		/**
+		 * This method starts a new frame, the previous frame remains readable until the frame is committed
+		 *
+		 * @param  frame_id  the frame ID
+		 * @param  ttime  the frame time
+		 */
+		void startFrame(long frame_id, TuioTime ttime);
+		
+		/**
+		 * This method adds an object to the current frame
+		 * @return false if the maximum object count has been reached
+		 */
+		bool addObject(int session_id, int symbol_id, float x, float y, float a, float X, float Y, float A, float m, float r);
+		
+		/**
+		 * This method adds a cursor to the current frame
+		 * @return false if the maximum cursor count has been reached
+		 */
+		bool addCursor(int session_id, int cursor_id, float x, float y, float X, float Y, float m);
+		
+		/**
+		 * This method adds a blob to the current frame
+		 * @return false if the maximum blob count has been reached
+		 */
+		bool addBlob(int session_id, int blob_id, float x, float y, float a, float w, float h, float f, float X, float Y, float A, float m, float r);
+		
+		/**
+		 * This method publishes the current frame to all readers
+		 */
+		void commitFrame();
+		
+		/**
+		 * This method returns true if the shared memory segment is available
+		 * @return true if the shared memory segment is available
+		 */
+		bool isConnected() { return (shm!=NULL); };
+		
+		const char* tuio_type() { return "TUIO/SHM"; }
+		
+	private:
+		TuioShmFrame *shm;
+		TuioShmFrame *frame;
+		char shm_name[256];
+#ifdef WIN32
+		HANDLE mapping;
+#endif
+	};
+}
+#endif /* INCLUDED_SHAREDMEMORYSENDER_H */
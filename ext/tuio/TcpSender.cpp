@@ -17,83 +17,55 @@
 */
 
 #include "TcpSender.h"
+#ifndef WIN32
+#include <fcntl.h>
+#include <errno.h>
+#endif
+#ifdef LINUX
+#include <sys/epoll.h>
+#define MAX_EVENTS 64
+#endif
 using namespace TUIO;
 
-#ifdef  WIN32
-static DWORD WINAPI ClientThreadFunc( LPVOID obj )
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
 #else
-static void* ClientThreadFunc( void* obj )
+#define SEND_FLAGS 0
 #endif
-{
-	TcpSender *sender = static_cast<TcpSender*>(obj);
-	char buf[16];
-			
+
+static bool wouldBlock() {
 #ifdef WIN32
-	SOCKET client = sender->tcp_client_list.back();
+	return (WSAGetLastError()==WSAEWOULDBLOCK);
 #else
-	int client = sender->tcp_client_list.back();
+	return ((errno==EAGAIN) || (errno==EWOULDBLOCK) || (errno==EINTR));
 #endif
-	
-	size_t connected = 1;
-	while (connected) {
-		connected = recv(client, buf, sizeof(buf),0);
-	}
-		
-	sender->tcp_client_list.remove(client);
-	std::cout << sender->tuio_type() << " connection closed"<< std::endl;
-	if (sender->tcp_client_list.size()==0) sender->connected=false;
-	//std::cout << sender->tcp_client_list.size() << " clients left"<< std::endl;	
-
-	return 0;
-};
+}
 
-#ifdef  WIN32
-static DWORD WINAPI ServerThreadFunc( LPVOID obj )
-#else
-static void* ServerThreadFunc( void* obj )
-#endif
-{
-	TcpSender *sender = static_cast<TcpSender*>(obj);
-	struct sockaddr_in client_addr;
-	socklen_t len = sizeof(client_addr);
-	
-	std::cout << sender->tuio_type() << " socket created on port " << sender->port_no << std::endl;
-	while (sender->tcp_socket) {
+static void setNonBlocking( tcp_socket_t socket ) {
 #ifdef WIN32
-		SOCKET tcp_client = -1;
+	u_long mode = 1;
+	ioctlsocket(socket, FIONBIO, &mode);
 #else
-		int tcp_client = -1;
+	fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+	int optval = 1;
+	setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, (const void *)&optval, sizeof(int));
 #endif
-		
-		tcp_client = accept(sender->tcp_socket, (struct sockaddr*)&client_addr, &len);
-#ifdef WIN32
-		 //win32 workaround on exit
-		if (!client_addr.sin_addr.S_un.S_addr && !client_addr.sin_port) return 0;
-		if ((client_addr.sin_addr.S_un.S_addr==3435973836) && (client_addr.sin_port==52428)) return 0;
 #endif
+}
 
-		if (tcp_client>0) { 
-			std::cout << sender->tuio_type() << " client connected from " << inet_ntoa(client_addr.sin_addr) << "@" << client_addr.sin_port << std::endl;
-			sender->tcp_client_list.push_back(tcp_client);
-			sender->connected=true;
-			sender->newClient(tcp_client);
-			//std::cout << sender->tcp_client_list.size() << " clients connected"<< std::endl;	
+static void closeSocket( tcp_socket_t socket ) {
 #ifdef WIN32
-			DWORD ClientThreadId;
-			HANDLE client_thread = CreateThread( 0, 0, ClientThreadFunc, obj, 0, &ClientThreadId );
+	closesocket(socket);
 #else
-			pthread_t client_thread;
-			pthread_create(&client_thread , NULL, ClientThreadFunc,obj);
+	close(socket);
 #endif
-		} else break;
-	}
-	
-	return 0;
-};
+}
 
 TcpSender::TcpSender()
 	:connected (false)
 {
+	initialize();
 	local = true;
 	buffer_size = MAX_TCP_SIZE;
 	
@@ -118,15 +90,8 @@ TcpSender::TcpSender()
 		return;
 	} else {
 		std::cout << tuio_type() << " connection opened to 127.0.0.1:3333" << std::endl;
-		tcp_client_list.push_back(tcp_socket);
-		connected = true;
-		
-#ifdef WIN32
-		HANDLE server_thread = CreateThread( 0, 0, ClientThreadFunc, this, 0, &ServerThreadId );
-#else
-		pthread_create(&server_thread , NULL, ClientThreadFunc,this);
-#endif
-
+		addClient(tcp_socket);
+		startEventLoop();
 	}
 
 }
@@ -134,6 +99,7 @@ TcpSender::TcpSender()
 TcpSender::TcpSender(const char *host, int port) 
 	:connected (false)
 {	
+	initialize();
 	if ((strcmp(host,"127.0.0.1")==0) || (strcmp(host,"localhost")==0)) {
 		local = true;
 	} else local = false;
@@ -164,30 +130,34 @@ TcpSender::TcpSender(const char *host, int port)
 
 	int ret = connect(tcp_socket,(struct sockaddr*)&tcp_server,sizeof(tcp_server));
 	if (ret<0) {
-#ifdef WIN32
-		closesocket(tcp_socket);
-#else
-		close(tcp_socket);
-#endif	
+		closeSocket(tcp_socket);
 		std::cerr << "could not open " << tuio_type() << " connection to " << host << ":"<< port << std::endl;
 		throw std::exception();
 	} else {
 		std::cout << tuio_type() << " connection opened to " << host << ":"<< port << std::endl;
-		tcp_client_list.push_back(tcp_socket);
-		connected = true;
-		
-#ifdef WIN32
-		HANDLE server_thread = CreateThread( 0, 0, ClientThreadFunc, this, 0, &ServerThreadId );
-#else
-		pthread_create(&server_thread , NULL, ClientThreadFunc,this);
-#endif
-
+		addClient(tcp_socket);
+		startEventLoop();
 	}
 }
 
 TcpSender::TcpSender(int port)
 	:connected (false)
 {
+	initialize();
+	openServerSocket(port);
+	startEventLoop();
+}
+
+TcpSender::TcpSender(int port, bool start)
+	:connected (false)
+{
+	initialize();
+	openServerSocket(port);
+	if (start) startEventLoop();
+}
+
+void TcpSender::openServerSocket(int port) {
+
 	local = false;
 	buffer_size = MAX_TCP_SIZE;
 	port_no = port;
@@ -223,81 +193,523 @@ TcpSender::TcpSender(int port)
 		throw std::exception();
 	}
 	
-	ret =  listen(tcp_socket, 1);
+	ret =  listen(tcp_socket, SOMAXCONN);
 	if (ret < 0) {
 		std::cerr << "could not start listening to TUIO/TCP socket" << std::endl;
+		closeSocket(tcp_socket);
+		throw std::exception();
+	}
+	
+	setNonBlocking(tcp_socket);
+	listening = true;
+}
+
+void TcpSender::initialize() {
+
+	listening = false;
+	running = false;
+	port_no = 0;
+	// the handshake response is the only packet outside of any frame
+	frame_count = 1;
+	
 #ifdef WIN32
-		closesocket(tcp_socket);
+	clientMutex = CreateMutex(NULL,FALSE,NULL);
+	event_thread = NULL;
 #else
-		close(tcp_socket);
+	pthread_mutex_init(&clientMutex,NULL);
+	wake_pipe[0] = wake_pipe[1] = -1;
+	if (pipe(wake_pipe)==0) {
+		fcntl(wake_pipe[0], F_SETFL, fcntl(wake_pipe[0], F_GETFL, 0) | O_NONBLOCK);
+		fcntl(wake_pipe[1], F_SETFL, fcntl(wake_pipe[1], F_GETFL, 0) | O_NONBLOCK);
+	}
 #endif
-		throw std::exception();
+
+#ifdef LINUX
+	epoll_fd = epoll_create(MAX_EVENTS);
+	if (wake_pipe[0]>=0) {
+		struct epoll_event event;
+		memset(&event,0,sizeof(event));
+		event.events = EPOLLIN;
+		event.data.fd = wake_pipe[0];
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_pipe[0], &event);
 	}
-				
+#endif
+}
+
+void TcpSender::startEventLoop() {
+
+#ifdef LINUX
+	if (listening) {
+		struct epoll_event event;
+		memset(&event,0,sizeof(event));
+		event.events = EPOLLIN;
+		event.data.fd = tcp_socket;
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, tcp_socket, &event);
+	}
+#endif
+
+	running = true;
 #ifdef WIN32
-	DWORD ServerThreadId;
-	server_thread = CreateThread( 0, 0, ServerThreadFunc, this, 0, &ServerThreadId );
+	DWORD threadId;
+	event_thread = CreateThread( 0, 0, EventThreadFunc, this, 0, &threadId );
 #else
-	pthread_create(&server_thread , NULL, ServerThreadFunc, this);
+	pthread_create(&event_thread , NULL, EventThreadFunc, this);
 #endif
 	
+	if (listening) std::cout << tuio_type() << " socket created on port " << port_no << std::endl;
+}
+
+void TcpSender::wakeEventLoop() {
+#ifndef WIN32
+	char wake = 0;
+	if (write(wake_pipe[1], &wake, 1)<0) return;
+#endif
 }
 
 bool TcpSender::isConnected() {
 	return connected;
 }
 
-
 TcpSender::~TcpSender() {
+
+	if (running) {
+		running = false;
+		wakeEventLoop();
+#ifdef WIN32
+		WaitForSingleObject(event_thread, INFINITE);
+		CloseHandle(event_thread);
+#else
+		pthread_join(event_thread, NULL);
+#endif
+	}
+	
+	for (std::map<tcp_socket_t,TcpClient>::iterator client = client_map.begin(); client!=client_map.end(); client++) {
+		closeSocket(client->first);
+	}
+	client_map.clear();
+	if (listening) closeSocket(tcp_socket);
+	tcp_socket = 0;
+	
+#ifdef LINUX
+	close(epoll_fd);
+#endif
+#ifdef WIN32
+	CloseHandle(clientMutex);
+#else
+	if (wake_pipe[0]>=0) close(wake_pipe[0]);
+	if (wake_pipe[1]>=0) close(wake_pipe[1]);
+	pthread_mutex_destroy(&clientMutex);
+#endif		
+}
+
 #ifdef WIN32
+DWORD WINAPI TcpSender::EventThreadFunc( LPVOID obj )
+#else
+void* TcpSender::EventThreadFunc( void *obj )
+#endif
+{
+	static_cast<TcpSender*>(obj)->handleEvents();
+	return 0;
+}
+
+void TcpSender::handleEvents() {
+
+#ifdef LINUX
+	struct epoll_event events[MAX_EVENTS];
+	while (running) {
+		int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+		if (count<0) {
+			if (errno==EINTR) continue;
+			break;
+		}
+		
+		for (int i=0;i<count;i++) {
+			int fd = events[i].data.fd;
+			if (fd==wake_pipe[0]) {
+				char buf[64];
+				while (read(wake_pipe[0], buf, sizeof(buf))>0);
+			} else if (listening && (fd==tcp_socket)) {
+				acceptClients();
+			} else {
+				if (events[i].events & (EPOLLIN|EPOLLHUP|EPOLLERR)) readClient(fd);
+				if (events[i].events & EPOLLOUT) writeClient(fd);
+			}
+		}
+	}
+#else
+	while (running) {
+		fd_set read_set, write_set;
+		FD_ZERO(&read_set);
+		FD_ZERO(&write_set);
+		int max_fd = 0;
+		
+		if (listening) {
+			FD_SET(tcp_socket, &read_set);
+			max_fd = (int)tcp_socket;
+		}
+#ifndef WIN32
+		FD_SET(wake_pipe[0], &read_set);
+		if (wake_pipe[0]>max_fd) max_fd = wake_pipe[0];
+#endif
 
-	for (std::list<SOCKET>::iterator client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++) {
-		closesocket((*client));
+		// the write set only contains the clients with pending data
+		std::vector<tcp_socket_t> client_list;
+#ifdef WIN32
+		WaitForSingleObject(clientMutex, INFINITE);
+#else
+		pthread_mutex_lock(&clientMutex);
+#endif
+		for (std::map<tcp_socket_t,TcpClient>::iterator client = client_map.begin(); client!=client_map.end(); client++) {
+			if ((int)client_list.size()>=FD_SETSIZE-2) break;
+			client_list.push_back(client->first);
+			FD_SET(client->first, &read_set);
+			if (client->second.packets.size()>0) FD_SET(client->first, &write_set);
+			if ((int)client->first>max_fd) max_fd = (int)client->first;
+		}
+#ifdef WIN32
+		ReleaseMutex(clientMutex);
+		// there is no wake up pipe on Windows
+		struct timeval timeout = { 0, 10000 };
+		int count = select(max_fd+1, &read_set, &write_set, NULL, &timeout);
+#else
+		pthread_mutex_unlock(&clientMutex);
+		int count = select(max_fd+1, &read_set, &write_set, NULL, NULL);
+#endif
+		if (count<0) {
+			if (wouldBlock()) continue;
+			break;
+		} else if (count==0) continue;
+		
+#ifndef WIN32
+		if (FD_ISSET(wake_pipe[0], &read_set)) {
+			char buf[64];
+			while (read(wake_pipe[0], buf, sizeof(buf))>0);
+		}
+#endif
+		if (listening && FD_ISSET(tcp_socket, &read_set)) acceptClients();
+		
+		for (unsigned int i=0;i<client_list.size();i++) {
+			if (FD_ISSET(client_list[i], &read_set)) readClient(client_list[i]);
+			if (FD_ISSET(client_list[i], &write_set)) writeClient(client_list[i]);
+		}
 	}
-	closesocket(tcp_socket);
+#endif
+}
 
-	if( server_thread ) CloseHandle( server_thread );
+void TcpSender::acceptClients() {
 
+	struct sockaddr_in client_addr;
+	
+	for (;;) {
+		socklen_t len = sizeof(client_addr);
+		tcp_socket_t tcp_client = accept(tcp_socket, (struct sockaddr*)&client_addr, &len);
+#ifdef WIN32
+		if (tcp_client==INVALID_SOCKET) break;
 #else
-		for (std::list<int>::iterator client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++) {
-		close((*client));
+		if (tcp_client<0) break;
+#endif
+		std::cout << tuio_type() << " client connected from " << inet_ntoa(client_addr.sin_addr) << "@" << client_addr.sin_port << std::endl;
+		addClient(tcp_client);
 	}
-	close(tcp_socket);
-	tcp_socket = 0;
-	server_thread = 0;
-#endif		
 }
 
+void TcpSender::addClient( tcp_socket_t tcp_client ) {
 
-bool TcpSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
-	if (!connected) return false; 
-	if ( bundle->Size() > buffer_size ) return false;
-	if ( bundle->Size() == 0 ) return false;
+	setNonBlocking(tcp_client);
 	
-#ifdef OSC_HOST_LITTLE_ENDIAN             
-	data_size[0] =  bundle->Size()>>24;
-	data_size[1] = (bundle->Size()>>16) & 255;
-	data_size[2] = (bundle->Size()>>8) & 255;
-	data_size[3] = (bundle->Size()) & 255;
+	TcpClient client;
+	client.dropped = 0;
+	client.format = 0;
+	client.ready = false;
+	client.writing = false;
+	client.failed = false;
+	
+	// clients which do not require a handshake are ready immediately
+	std::string response;
+	int state = clientHandshake(client.request, response, client.format);
+	if (state>0) client.ready = true;
+	
+#ifdef WIN32
+	WaitForSingleObject(clientMutex, INFINITE);
 #else
-	*((int32_t*)data_size) = bundle->Size();
+	pthread_mutex_lock(&clientMutex);
 #endif
+	client_map[tcp_client] = client;
+	if (client.ready) connected = true;
+#ifdef LINUX
+	struct epoll_event event;
+	memset(&event,0,sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = tcp_client;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, tcp_client, &event);
+#endif
+#ifdef WIN32
+	ReleaseMutex(clientMutex);
+#else
+	pthread_mutex_unlock(&clientMutex);
+#endif
+}
+
+void TcpSender::removeClient( tcp_socket_t tcp_client ) {
+
+	// the client mutex is already locked
+	std::map<tcp_socket_t,TcpClient>::iterator client = client_map.find(tcp_client);
+	if (client==client_map.end()) return;
+	
+	if (client->second.dropped>0)
+		std::cout << tuio_type() << " client dropped " << client->second.dropped << " frames" << std::endl;
+	std::cout << tuio_type() << " connection closed"<< std::endl;
+	
+	client_map.erase(client);
+#ifdef LINUX
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, tcp_client, NULL);
+#endif
+	closeSocket(tcp_client);
+	
+	connected = false;
+	for (client = client_map.begin(); client!=client_map.end(); client++) {
+		if (client->second.ready) connected = true;
+	}
+}
+
+void TcpSender::readClient( tcp_socket_t tcp_client ) {
+
+#ifdef WIN32
+	WaitForSingleObject(clientMutex, INFINITE);
+#else
+	pthread_mutex_lock(&clientMutex);
+#endif
+
+	std::map<tcp_socket_t,TcpClient>::iterator it = client_map.find(tcp_client);
+	if (it!=client_map.end()) {
+		TcpClient &client = it->second;
+		bool closed = false;
+		
+		// data received from ready clients is ignored
+		char buf[1024];
+		for (;;) {
+			int bytes = recv(tcp_client, buf, sizeof(buf), 0);
+			if (bytes>0) {
+				if (!client.ready) client.request.append(buf,bytes);
+				continue;
+			}
+			if ((bytes<0) && wouldBlock()) break;
+			closed = true;
+			break;
+		}
+		
+		if (!closed && !client.ready) {
+			std::string response;
+			int state = clientHandshake(client.request, response, client.format);
+			if (state<0) closed = true;
+			else if (state>0) {
+				client.ready = true;
+				client.request.clear();
+				connected = true;
+				if (response.size()>0) {
+					client.packets.push_back(TcpPacket());
+					TcpPacket &packet = client.packets.back();
+					packet.data.assign(response.begin(),response.end());
+					packet.offset = 0;
+					packet.frame = 0;
+					if (!flushClient(tcp_client,client)) closed = true;
+					else if (client.packets.size()>0) setWriteInterest(tcp_client,client,true);
+				}
+			}
+		}
+		
+		if (closed) removeClient(tcp_client);
+	}
+
+#ifdef WIN32
+	ReleaseMutex(clientMutex);
+#else
+	pthread_mutex_unlock(&clientMutex);
+#endif
+}
+
+void TcpSender::writeClient( tcp_socket_t tcp_client ) {
 
 #ifdef WIN32
-	std::list<SOCKET>::iterator client;
+	WaitForSingleObject(clientMutex, INFINITE);
 #else
-	std::list<int>::iterator client;
+	pthread_mutex_lock(&clientMutex);
 #endif
+
+	std::map<tcp_socket_t,TcpClient>::iterator it = client_map.find(tcp_client);
+	if (it!=client_map.end()) {
+		if (!flushClient(tcp_client,it->second)) removeClient(tcp_client);
+		else if (it->second.packets.size()==0) setWriteInterest(tcp_client,it->second,false);
+	}
 	
-	for (client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++) {
-		//send((*client), data_size, 4,0);
-		//send((*client), bundle->Data(), bundle->Size(),0);
-		memcpy(&data_buffer[0], &data_size, 4);
-		memcpy(&data_buffer[4], bundle->Data(), bundle->Size());
-		send((*client),data_buffer, 4+bundle->Size(),0);
+#ifdef WIN32
+	ReleaseMutex(clientMutex);
+#else
+	pthread_mutex_unlock(&clientMutex);
+#endif
+}
+
+void TcpSender::setWriteInterest( tcp_socket_t tcp_client, TcpClient &client, bool flag ) {
+
+	if (client.writing==flag) return;
+	client.writing = flag;
+	
+#ifdef LINUX
+	struct epoll_event event;
+	memset(&event,0,sizeof(event));
+	event.events = flag ? (EPOLLIN|EPOLLOUT) : EPOLLIN;
+	event.data.fd = tcp_client;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, tcp_client, &event);
+#else
+	// the write set is rebuilt on the next iteration
+	if (flag) wakeEventLoop();
+#endif
+}
+
+int TcpSender::clientHandshake( const std::string &request, std::string &response, int &format ) {
+	format = 0;
+	return 1;
+}
+
+unsigned int TcpSender::frameOscData (const char *data, unsigned int size) {
+
+#ifdef OSC_HOST_LITTLE_ENDIAN             
+	data_size[0] =  size>>24;
+	data_size[1] = (size>>16) & 255;
+	data_size[2] = (size>>8) & 255;
+	data_size[3] = (size) & 255;
+#else
+	*((int32_t*)data_size) = size;
+#endif
+
+	memcpy(&data_buffer[0], &data_size, 4);
+	memcpy(&data_buffer[4], data, size);
+	return 4+size;
+}
+
+bool TcpSender::flushClient( tcp_socket_t tcp_client, TcpClient &client ) {
+
+	while (client.packets.size()>0) {
+		TcpPacket &packet = client.packets.front();
+		int bytes = send(tcp_client, &packet.data[packet.offset], (int)(packet.data.size()-packet.offset), SEND_FLAGS);
+		if (bytes<0) {
+			if (wouldBlock()) return true;
+			return false;
+		}
+		
+		packet.offset += bytes;
+		if (packet.offset<packet.data.size()) return true;
+		client.packets.pop_front();
+	}
+	
+	return true;
+}
+
+void TcpSender::queuePacket( TcpClient &client, const char *frame, unsigned int length ) {
+
+	// a lagging client drops its oldest complete frames and receives the full state once it caught up,
+	// the handshake, a partially sent packet and the current frame must be completed though
+	if (client.packets.back().frame!=frame_count) {
+		unsigned int frames = 0;
+		unsigned long last = 0;
+		std::list<TcpPacket>::iterator packet;
+		for (packet = client.packets.begin(); packet!=client.packets.end(); packet++) {
+			if (packet->frame!=last) frames++;
+			last = packet->frame;
+		}
+		
+		if (frames>=MAX_CLIENT_QUEUE) {
+			// only the first packet may have been partially sent
+			unsigned long partial = (client.packets.front().offset>0) ? client.packets.front().frame : 0;
+			unsigned long oldest = 0;
+			for (packet = client.packets.begin(); packet!=client.packets.end(); packet++) {
+				if ((packet->frame==0) || (packet->frame==partial)) continue;
+				oldest = packet->frame;
+				break;
+			}
+			
+			if (oldest>0) {
+				for (packet = client.packets.begin(); packet!=client.packets.end();) {
+					if (packet->frame==oldest) packet = client.packets.erase(packet);
+					else packet++;
+				}
+				client.dropped++;
+				requestFullUpdate();
+			}
+		}
 	}
+	
+	client.packets.push_back(TcpPacket());
+	TcpPacket &last = client.packets.back();
+	last.data.assign(frame,frame+length);
+	last.offset = 0;
+	last.frame = frame_count;
+}
 
+bool TcpSender::sendOscData (const char *data, unsigned int size) {
+	if (!connected) return false; 
+	if ( size > buffer_size ) return false;
+	if ( size == 0 ) return false;
+	
+	unsigned int length = frameOscData(data,size);
+	
+	const char *frame[MAX_CLIENT_FORMATS] = { data_buffer, data_buffer };
+	unsigned int frame_length[MAX_CLIENT_FORMATS] = { length, length };
+	deliverFrames(frame,frame_length);
 	return true;
 }
 
-void TcpSender::newClient( int tcp_client ) { }
+void TcpSender::flushOscData () {
+	// all following packets belong to the next frame
+	frame_count++;
+}
+
+void TcpSender::deliverFrames (const char *const *frame, const unsigned int *frame_length) {
+	
+#ifdef WIN32
+	WaitForSingleObject(clientMutex, INFINITE);
+#else
+	pthread_mutex_lock(&clientMutex);
+#endif
+	
+	for (std::map<tcp_socket_t,TcpClient>::iterator it = client_map.begin(); it!=client_map.end(); it++) {
+		TcpClient &client = it->second;
+		if (!client.ready || client.failed) continue;
+		
+		if (!flushClient(it->first,client)) {
+			client.failed = true;
+		} else if (client.packets.size()>0) {
+			queuePacket(client,frame[client.format],frame_length[client.format]);
+		} else {
+			const char *data = frame[client.format];
+			unsigned int length = frame_length[client.format];
+			int bytes = send(it->first,data,length,SEND_FLAGS);
+			if (bytes<0) {
+				if (wouldBlock()) bytes = 0;
+				else client.failed = true;
+			}
+			
+			if ((bytes>=0) && ((unsigned int)bytes<length)) {
+				client.packets.push_back(TcpPacket());
+				TcpPacket &last = client.packets.back();
+				last.data.assign(data,data+length);
+				last.offset = bytes;
+				last.frame = frame_count;
+			}
+		}
+		
+		// the I/O thread flushes the pending data or closes the broken connection
+#ifdef WIN32
+		if (client.failed) shutdown(it->first, 2);
+#else
+		if (client.failed) shutdown(it->first, SHUT_RDWR);
+#endif
+		else if (client.packets.size()>0) setWriteInterest(it->first,client,true);
+	}
+	
+#ifdef WIN32
+	ReleaseMutex(clientMutex);
+#else
+	pthread_mutex_unlock(&clientMutex);
+#endif
+}
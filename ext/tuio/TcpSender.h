@@ -33,15 +33,52 @@ typedef int socklen_t;
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <pthread.h>
 #endif
 
 #include <list>
+#include <map>
+#include <vector>
+#include <string>
 #define MAX_TCP_SIZE 65536
+#define MAX_CLIENT_QUEUE 8
+#define MAX_CLIENT_FORMATS 2
 
 namespace TUIO {
 	
+#ifdef WIN32
+	typedef SOCKET tcp_socket_t;
+#else
+	typedef int tcp_socket_t;
+#endif
+	
 	/**
-	 * The TcpSender implements the TCP transport method for OSC
+	 * A framed packet which could not yet be delivered to a lagging client.
+	 * The frame number groups all packets of a TUIO frame, which are only dropped as a whole.
+	 */
+	struct TcpPacket {
+		std::vector<char> data;
+		unsigned int offset;
+		unsigned long frame;
+	};
+	
+	/**
+	 * The connection state and the bounded queue of pending packets for a single TCP client
+	 */
+	struct TcpClient {
+		std::list<TcpPacket> packets;
+		std::string request;
+		unsigned long dropped;
+		int format;
+		bool ready;
+		bool writing;
+		bool failed;
+	};
+	
+	/**
+	 * The TcpSender implements the TCP transport method for OSC.
+	 * All sockets are non-blocking and served by a single I/O thread, which accepts
+	 * new clients, performs the handshake, detects disconnects and flushes pending data.
 	 *
 	 * @author Martin Kaltenbrunner
 	 * @version 1.1.6
@@ -71,18 +108,23 @@ namespace TUIO {
 		TcpSender(int port);	
 		
 		/**
-		 * The destructor closes the socket. 
+		 * The destructor stops the I/O thread and closes all sockets. 
 		 */
 		virtual ~TcpSender();
 		
 		/**
-		 * This method delivers the provided OSC data
+		 * This method delivers the provided OSC bundle data to all connected clients.
+		 * The data which can not be sent immediately is queued per client and flushed
+		 * by the I/O thread. Lagging clients drop their oldest complete frames,
+		 * and receive the full state with the next frame after a drop.
 		 *
-		 * @param *bundle  the OSC stream to deliver
+		 * @param *data  the OSC bundle data to deliver
+		 * @param size  the size of the OSC bundle data in bytes
 		 * @return true if the data was delivered successfully
 		 */
+		bool sendOscData (const char *data, unsigned int size);
 		
-		bool sendOscPacket (osc::OutboundPacketStream *bundle);
+		void flushOscData ();
 
 		/**
 		 * This method returns the connection state
@@ -91,37 +133,99 @@ namespace TUIO {
 		 */
 		bool isConnected ();
 
-		/**
-		 * This method is called whenever a new client connects
-		 *
-		 * @param tcp_client the socket handle of the new client
-		 */
-		virtual void newClient( int tcp_client );
-
 		int port_no;
 		
 #ifdef WIN32
 		SOCKET tcp_socket;
-		std::list<SOCKET> tcp_client_list;
 #else
 		int tcp_socket;
-		std::list<int> tcp_client_list;
 #endif
 		bool connected;
 		const char* tuio_type() { return "TUIO/TCP"; }
 
 	protected:
+		/**
+		 * This constructor creates a TcpSender that listens to the provided port,
+		 * subclasses start the I/O thread once their construction is complete
+		 *
+		 * @param  port	the incoming TUIO TCP port number
+		 * @param  start	starts the I/O thread if true
+		 */
+		TcpSender(int port, bool start);
+		
+		/**
+		 * This method starts the I/O thread
+		 */
+		void startEventLoop();
+		
+		/**
+		 * This method is called from the I/O thread with the data received from a new client,
+		 * until the client is ready to receive OSC data. TCP clients do not require any handshake.
+		 *
+		 * @param request  the data received from the client so far
+		 * @param response  returns the data to send to the client once the handshake is complete
+		 * @param format  returns the data format negotiated with the client
+		 * @return 1 if the handshake is complete, 0 if more data is required and -1 if it failed
+		 */
+		virtual int clientHandshake( const std::string &request, std::string &response, int &format );
+		
+		/**
+		 * This method writes the transport framing and the provided OSC bundle data to the data buffer
+		 *
+		 * @param *data  the OSC bundle data to frame
+		 * @param size  the size of the OSC bundle data in bytes
+		 * @return the size of the framed data in bytes
+		 */
+		virtual unsigned int frameOscData (const char *data, unsigned int size);
+		
+		/**
+		 * This method delivers framed data to all ready clients, each client receives
+		 * the data of the format which has been negotiated during its handshake
+		 *
+		 * @param frame  the framed data for each client format
+		 * @param length  the size of the framed data in bytes for each client format
+		 */
+		void deliverFrames (const char *const *frame, const unsigned int *length);
+		
 		char data_size[4];
 		char data_buffer[MAX_TCP_SIZE+4];
 		
-
+	private:
+		void initialize();
+		void openServerSocket(int port);
+		void handleEvents();
+		void wakeEventLoop();
 #ifdef WIN32
-		HANDLE server_thread;
-		DWORD ServerThreadId;
+		static DWORD WINAPI EventThreadFunc( LPVOID obj );
 #else
-		pthread_t server_thread;
+		static void* EventThreadFunc( void *obj );
 #endif
 		
+		void acceptClients();
+		void addClient( tcp_socket_t tcp_client );
+		void removeClient( tcp_socket_t tcp_client );
+		void readClient( tcp_socket_t tcp_client );
+		void writeClient( tcp_socket_t tcp_client );
+		bool flushClient( tcp_socket_t tcp_client, TcpClient &client );
+		void setWriteInterest( tcp_socket_t tcp_client, TcpClient &client, bool flag );
+		void queuePacket( TcpClient &client, const char *frame, unsigned int length );
+		
+		std::map<tcp_socket_t,TcpClient> client_map;
+		bool listening;
+		volatile bool running;
+		unsigned long frame_count;
+		
+#ifdef WIN32
+		HANDLE event_thread;
+		HANDLE clientMutex;
+#else
+		pthread_t event_thread;
+		pthread_mutex_t clientMutex;
+		int wake_pipe[2];
+#endif
+#ifdef LINUX
+		int epoll_fd;
+#endif
 	};
 }
 #endif /* INCLUDED_TCPSENDER_H */
@@ -0,0 +1,302 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioAggregator.h"
+#include <math.h>
+
+// sources which have not published a frame within this time are ignored
+#define SOURCE_TIMEOUT 1000
+#define SOURCE_RETRY 1000
+
+using namespace TUIO;
+
+TuioAggregator::TuioAggregator(TuioServer *server, float distance, int timeout)
+	: server			(server)
+	, distance			(distance)
+	, timeout			(timeout)
+	, frame				(0)
+	, now				(0)
+	, orphans			(false)
+	, orphan_expiry		(0)
+{
+}
+
+TuioAggregator::~TuioAggregator() {
+
+	for (unsigned int i=0;i<sourceList.size();i++) {
+		tuio_shm_close(sourceList[i]->shm);
+		delete sourceList[i]->frame;
+		delete sourceList[i];
+	}
+}
+
+bool TuioAggregator::addSource(const char *name, float x, float y, float width, float height) {
+
+	if (sourceList.size()==AGGREGATE_MAX_SOURCES) return false;
+
+	AggregateSource *source = new AggregateSource();
+	source->name = name;
+	source->shm = NULL;
+	source->frame = new TuioShmFrame();
+	source->sequence = 0;
+	source->last_update = 0;
+	source->last_open = -SOURCE_RETRY;
+	source->active = false;
+	source->x = x;
+	source->y = y;
+	source->width = width;
+	source->height = height;
+
+	sourceList.push_back(source);
+	return true;
+}
+
+long long TuioAggregator::currentTime() {
+	return TuioTime::getSystemTime().getTotalMilliseconds();
+}
+
+int TuioAggregator::getActiveSources() {
+
+	int count = 0;
+	for (unsigned int i=0;i<sourceList.size();i++)
+		if (sourceList[i]->active) count++;
+	return count;
+}
+
+bool TuioAggregator::readSource(AggregateSource *source, long long now) {
+
+	// the segment only exists while its tracker is running
+	if (source->shm==NULL) {
+		if (now-source->last_open < SOURCE_RETRY) return false;
+		source->last_open = now;
+		source->shm = tuio_shm_open(source->name.c_str());
+		if (source->shm==NULL) return false;
+		source->sequence = 0;
+		source->last_update = now;
+	}
+
+	uint32_t sequence = tuio_shm_read(source->shm, source->frame);
+	if ((sequence!=0) && (sequence!=source->sequence)) {
+		source->sequence = sequence;
+		source->last_update = now;
+		source->active = true;
+		return true;
+	}
+
+	// a stalled tracker loses its entities, and its segment is mapped again once it restarts
+	if (now-source->last_update > SOURCE_TIMEOUT) {
+		tuio_shm_close(source->shm);
+		source->shm = NULL;
+		if (source->active) {
+			source->active = false;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool TuioAggregator::update() {
+
+	now = currentTime();
+
+	bool updated = false;
+	for (unsigned int i=0;i<sourceList.size();i++) {
+		if (readSource(sourceList[i], now)) updated = true;
+	}
+
+	// entities waiting for their hand-off need to expire even without any new frame,
+	// but there is nothing to merge before the first of them is due
+	if (!updated && !(orphans && (now>=orphan_expiry))) return false;
+
+	mergeSources();
+	return true;
+}
+
+void TuioAggregator::mergeSources() {
+
+	frame++;
+	server->initFrame(TuioTime::getSystemTime());
+
+	for (std::list<AggregateEntity>::iterator entity = entityList.begin(); entity!=entityList.end(); entity++) {
+		entity->added = false;
+		entity->source_mask = 0;
+		entity->weight = entity->best_weight = 0.0f;
+		entity->x = entity->y = 0.0f;
+		entity->width = entity->height = entity->area = 0.0f;
+	}
+
+	for (unsigned int i=0;i<sourceList.size();i++) {
+		AggregateSource *source = sourceList[i];
+		if (!source->active) continue;
+		TuioShmFrame *shm = source->frame;
+
+		for (unsigned int j=0;j<shm->object_count;j++) {
+			TuioShmObject *tobj = &shm->objects[j];
+			mergeEntity(AGGREGATE_OBJECT, i, tobj->session_id, tobj->symbol_id, tobj->x, tobj->y, tobj->angle, 0.0f, 0.0f, 0.0f);
+		}
+
+		for (unsigned int j=0;j<shm->cursor_count;j++) {
+			TuioShmCursor *tcur = &shm->cursors[j];
+			mergeEntity(AGGREGATE_CURSOR, i, tcur->session_id, 0, tcur->x, tcur->y, 0.0f, 0.0f, 0.0f, 0.0f);
+		}
+
+		for (unsigned int j=0;j<shm->blob_count;j++) {
+			TuioShmBlob *tblb = &shm->blobs[j];
+			mergeEntity(AGGREGATE_BLOB, i, tblb->session_id, 0, tblb->x, tblb->y, tblb->angle, tblb->width, tblb->height, tblb->area);
+		}
+	}
+
+	// links of entities which are no longer tracked by their source
+	for (std::map<long long, AggregateLink>::iterator link = linkMap.begin(); link!=linkMap.end();) {
+		if (link->second.frame!=frame) linkMap.erase(link++);
+		else link++;
+	}
+
+	orphans = false;
+	for (std::list<AggregateEntity>::iterator entity = entityList.begin(); entity!=entityList.end();) {
+		if (entity->weight>0.0f) {
+			entity->last_seen = now;
+			updateEntity(&(*entity));
+			entity++;
+		} else if (now-entity->last_seen > timeout) {
+			removeEntity(&(*entity));
+			entity = entityList.erase(entity);
+		} else {
+			long long expiry = entity->last_seen + timeout + 1;
+			if (!orphans || (expiry<orphan_expiry)) orphan_expiry = expiry;
+			orphans = true;
+			entity++;
+		}
+	}
+
+	server->stopUntouchedMovingObjects();
+	server->stopUntouchedMovingCursors();
+	server->stopUntouchedMovingBlobs();
+	server->commitFrame();
+}
+
+AggregateEntity* TuioAggregator::findEntity(int type, int source, int symbol_id, float x, float y) {
+
+	AggregateEntity *closest = NULL;
+	float closest_distance = distance;
+
+	for (std::list<AggregateEntity>::iterator entity = entityList.begin(); entity!=entityList.end(); entity++) {
+		if ((entity->type!=type) || (entity->symbol_id!=symbol_id)) continue;
+		// two entities of the same source are never fused
+		if (entity->source_mask & (1u<<source)) continue;
+
+		// entities already seen within this frame are compared at their new position
+		float ex = entity->container->getX();
+		float ey = entity->container->getY();
+		if (entity->weight>0.0f) {
+			ex = entity->x/entity->weight;
+			ey = entity->y/entity->weight;
+		}
+		
+		float dx = ex - x;
+		float dy = ey - y;
+		float entity_distance = sqrtf(dx*dx + dy*dy);
+		if (entity_distance < closest_distance) {
+			closest = &(*entity);
+			closest_distance = entity_distance;
+		}
+	}
+
+	return closest;
+}
+
+void TuioAggregator::mergeEntity(int type, int source, int session_id, int symbol_id, float x, float y, float angle, float width, float height, float area) {
+
+	AggregateSource *src = sourceList[source];
+
+	// entities close to the border of a region are tracked less reliably than those in its center
+	float weight = x;
+	if (1.0f-x < weight) weight = 1.0f-x;
+	if (y < weight) weight = y;
+	if (1.0f-y < weight) weight = 1.0f-y;
+	if (weight < 0.0f) weight = 0.0f;
+	weight += 0.01f;
+
+	float gx = src->x + x*src->width;
+	float gy = src->y + y*src->height;
+
+	long long key = ((long long)source<<34) | ((long long)type<<32) | (unsigned int)session_id;
+	std::map<long long, AggregateLink>::iterator link = linkMap.find(key);
+
+	AggregateEntity *entity = NULL;
+	if (link!=linkMap.end()) entity = link->second.entity;
+	else {
+		entity = findEntity(type, source, symbol_id, gx, gy);
+		if (entity==NULL) {
+			AggregateEntity new_entity;
+			memset(&new_entity, 0, sizeof(AggregateEntity));
+			new_entity.type = type;
+			new_entity.symbol_id = symbol_id;
+			new_entity.added = true;
+
+			switch (type) {
+				case AGGREGATE_OBJECT: new_entity.container = server->addTuioObject(symbol_id, gx, gy, angle); break;
+				case AGGREGATE_CURSOR: new_entity.container = server->addTuioCursor(gx, gy); break;
+				case AGGREGATE_BLOB: new_entity.container = server->addTuioBlob(gx, gy, angle, width*src->width, height*src->height, area*src->width*src->height); break;
+			}
+
+			entityList.push_back(new_entity);
+			entity = &entityList.back();
+		}
+		linkMap[key].entity = entity;
+	}
+	linkMap[key].frame = frame;
+
+	entity->source_mask |= (1u<<source);
+	entity->weight += weight;
+	entity->x += gx*weight;
+	entity->y += gy*weight;
+	entity->width += width*src->width*weight;
+	entity->height += height*src->height*weight;
+	entity->area += area*src->width*src->height*weight;
+
+	// angles are not averaged, the best view of the entity defines its orientation
+	if (weight > entity->best_weight) {
+		entity->best_weight = weight;
+		entity->angle = angle;
+	}
+}
+
+void TuioAggregator::updateEntity(AggregateEntity *entity) {
+
+	if (entity->added) return;
+
+	float x = entity->x/entity->weight;
+	float y = entity->y/entity->weight;
+
+	switch (entity->type) {
+		case AGGREGATE_OBJECT: server->updateTuioObject((TuioObject*)entity->container, x, y, entity->angle); break;
+		case AGGREGATE_CURSOR: server->updateTuioCursor((TuioCursor*)entity->container, x, y); break;
+		case AGGREGATE_BLOB: server->updateTuioBlob((TuioBlob*)entity->container, x, y, entity->angle, entity->width/entity->weight, entity->height/entity->weight, entity->area/entity->weight); break;
+	}
+}
+
+void TuioAggregator::removeEntity(AggregateEntity *entity) {
+
+	switch (entity->type) {
+		case AGGREGATE_OBJECT: server->removeTuioObject((TuioObject*)entity->container); break;
+		case AGGREGATE_CURSOR: server->removeTuioCursor((TuioCursor*)entity->container); break;
+		case AGGREGATE_BLOB: server->removeTuioBlob((TuioBlob*)entity->container); break;
+	}
+}
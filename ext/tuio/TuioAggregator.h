@@ -0,0 +1,152 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOAGGREGATOR_H
+#define INCLUDED_TUIOAGGREGATOR_H
+
+#include "TuioServer.h"
+#include "TuioSharedMemory.h"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+
+#define AGGREGATE_OBJECT 0
+#define AGGREGATE_CURSOR 1
+#define AGGREGATE_BLOB 2
+#define AGGREGATE_MAX_SOURCES 32
+
+namespace TUIO {
+
+	/**
+	 * A tracker process which publishes its frames within a shared memory segment,
+	 * and the region of the global coordinate space it covers
+	 */
+	struct AggregateSource {
+		std::string name;
+		TuioShmFrame *shm;
+		TuioShmFrame *frame;
+		uint32_t sequence;
+		long long last_update;
+		long long last_open;
+		bool active;
+		float x, y, width, height;
+	};
+
+	/**
+	 * A single entity in the global coordinate space, which may be seen by several sources at the same time
+	 */
+	struct AggregateEntity {
+		int type;
+		int symbol_id;
+		TuioContainer *container;
+		long long last_seen;
+		bool added;
+		unsigned int source_mask;
+		float weight, best_weight;
+		float x, y, angle, width, height, area;
+	};
+
+	/**
+	 * The link between an entity of a single source and the global entity it belongs to
+	 */
+	struct AggregateLink {
+		AggregateEntity *entity;
+		long frame;
+	};
+
+	/**
+	 * The TuioAggregator merges the tracked state of several tracker processes into one TUIO session.
+	 * Each tracker publishes its frames within a named shared memory segment (see SharedMemorySender),
+	 * which is mapped into its own region of the global coordinate space.
+	 * Entities seen by several trackers within overlapping regions are fused into a single entity,
+	 * weighted by their distance to the border of each region. An entity which leaves one region
+	 * keeps its session ID if it appears in another region within the hand-off timeout and distance.
+	 * The merged state is sent by the provided TuioServer with all of its configured senders.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL TuioAggregator {
+
+	public:
+		/**
+		 * This constructor creates a TuioAggregator for the provided TuioServer
+		 *
+		 * @param  server  the TuioServer which sends the merged state
+		 * @param  distance  the maximum distance of fused entities in normalized global coordinates
+		 * @param  timeout  the hand-off timeout in milliseconds
+		 */
+		TuioAggregator(TuioServer *server, float distance=0.05f, int timeout=250);
+
+		/**
+		 * The destructor unmaps all sources, the TuioServer is not deleted
+		 */
+		~TuioAggregator();
+
+		/**
+		 * This method adds a tracker source and its region within the global coordinate space
+		 *
+		 * @param  name  the name of the shared memory segment published by the tracker
+		 * @param  x  the left edge of the region
+		 * @param  y  the top edge of the region
+		 * @param  width  the width of the region
+		 * @param  height  the height of the region
+		 * @return false if the maximum source count has been reached
+		 */
+		bool addSource(const char *name, float x, float y, float width, float height);
+
+		/**
+		 * This method reads the latest frame of all sources, and commits a merged frame
+		 * if any of them has been updated or an entity is waiting for its hand-off
+		 *
+		 * @return true if a frame has been committed
+		 */
+		bool update();
+
+		/**
+		 * Returns the number of sources which are currently publishing frames
+		 *
+		 * @return the number of active sources
+		 */
+		int getActiveSources();
+
+	private:
+		bool readSource(AggregateSource *source, long long now);
+		void mergeSources();
+		void mergeEntity(int type, int source, int session_id, int symbol_id, float x, float y, float angle, float width, float height, float area);
+		AggregateEntity* findEntity(int type, int source, int symbol_id, float x, float y);
+		void updateEntity(AggregateEntity *entity);
+		void removeEntity(AggregateEntity *entity);
+		long long currentTime();
+
+		TuioServer *server;
+		std::vector<AggregateSource*> sourceList;
+		std::list<AggregateEntity> entityList;
+		std::map<long long, AggregateLink> linkMap;
+
+		float distance;
+		int timeout;
+		long frame;
+		long long now;
+		bool orphans;
+		long long orphan_expiry;
+	};
+}
+#endif /* INCLUDED_TUIOAGGREGATOR_H */
@@ -99,10 +99,10 @@ void TuioBlob::update (float xp, float yp, float a, float w, float h, float f, f
 }
 
 void TuioBlob::update (TuioTime ttime, float xp, float yp, float a, float w, float h, float f) {
-	TuioPoint lastPoint = path.back();
+	TuioTime lastTime = path.getTuioTime(path.size()-1);
 	TuioContainer::update(ttime,xp,yp);
 	
-	TuioTime diffTime = currentTime - lastPoint.getTuioTime();
+	TuioTime diffTime = currentTime - lastTime;
 	float dt = diffTime.getTotalMilliseconds()/1000.0f;
 	float last_rotation_speed = rotation_speed;
 	
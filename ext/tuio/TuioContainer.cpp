@@ -24,6 +24,7 @@ TuioContainer::TuioContainer (TuioTime ttime, long si, float xp, float yp):TuioP
 ,source_id(0)
 ,source_name("undefined")
 ,source_addr("localhost")
+,motionFilter(NO_MOTION_FILTER)
 {
 	session_id = si;
 	x_speed = 0.0f;
@@ -32,9 +33,7 @@ TuioContainer::TuioContainer (TuioTime ttime, long si, float xp, float yp):TuioP
 	motion_accel = 0.0f;
 	x_accel = 0.0f;
 	y_accel = 0.0f;
-	TuioPoint p(currentTime,xpos,ypos);
-	path.push_back(p);
-	lastPoint = &path.back();
+	path.add(currentTime,xpos,ypos);
 }
 
 TuioContainer::TuioContainer (long si, float xp, float yp):TuioPoint(xp,yp)
@@ -42,6 +41,7 @@ TuioContainer::TuioContainer (long si, float xp, float yp):TuioPoint(xp,yp)
 ,source_id(0)
 ,source_name("undefined")
 ,source_addr("localhost")
+,motionFilter(NO_MOTION_FILTER)
 {
 	session_id = si;
 	x_speed = 0.0f;
@@ -50,9 +50,7 @@ TuioContainer::TuioContainer (long si, float xp, float yp):TuioPoint(xp,yp)
 	motion_accel = 0.0f;
 	x_accel = 0.0f;
 	y_accel = 0.0f;
-	TuioPoint p(currentTime,xpos,ypos);
-	path.push_back(p);
-	lastPoint = &path.back();
+	path.add(currentTime,xpos,ypos);
 }
 
 TuioContainer::TuioContainer (TuioContainer *tcon):TuioPoint(tcon)
@@ -60,6 +58,7 @@ TuioContainer::TuioContainer (TuioContainer *tcon):TuioPoint(tcon)
 ,source_id(0)
 ,source_name("undefined")
 ,source_addr("localhost")
+,motionFilter(NO_MOTION_FILTER)
 {
 	session_id = tcon->getSessionID();
 	x_speed = 0.0f;
@@ -69,9 +68,47 @@ TuioContainer::TuioContainer (TuioContainer *tcon):TuioPoint(tcon)
 	x_accel = 0.0f;
 	y_accel = 0.0f;
 	
-	TuioPoint p(currentTime,xpos,ypos);
-	path.push_back(p);
-	lastPoint = &path.back();
+	path.add(currentTime,xpos,ypos);
+}
+
+TuioContainer::TuioContainer (const TuioContainer &tcon):TuioPoint(tcon)
+,session_id(tcon.session_id)
+,x_speed(tcon.x_speed)
+,y_speed(tcon.y_speed)
+,motion_speed(tcon.motion_speed)
+,motion_accel(tcon.motion_accel)
+,x_accel(tcon.x_accel)
+,y_accel(tcon.y_accel)
+,path(tcon.path)
+,state(tcon.state)
+,source_id(tcon.source_id)
+,source_name(tcon.source_name)
+,source_addr(tcon.source_addr)
+,motionFilter(NO_MOTION_FILTER)
+{
+}
+
+TuioContainer& TuioContainer::operator= (const TuioContainer &tcon) {
+
+	if (this==&tcon) return *this;
+	TuioPoint::operator=(tcon);
+
+	session_id = tcon.session_id;
+	x_speed = tcon.x_speed;
+	y_speed = tcon.y_speed;
+	motion_speed = tcon.motion_speed;
+	motion_accel = tcon.motion_accel;
+	x_accel = tcon.x_accel;
+	y_accel = tcon.y_accel;
+	path = tcon.path;
+	state = tcon.state;
+	source_id = tcon.source_id;
+	source_name = tcon.source_name;
+	source_addr = tcon.source_addr;
+
+	// the motion filter slot belongs to the assigned TuioContainer
+	removeMotionFilter();
+	return *this;
 }
 
 void TuioContainer::setTuioSource(int src_id, const char *src_name, const char *src_addr) {
@@ -93,28 +130,45 @@ int TuioContainer::getTuioSourceID() const{
 }
 
 void TuioContainer::update (TuioTime ttime, float xp, float yp) {
-	lastPoint = &path.back();
-	TuioPoint::update(ttime,xp, yp);
+	int last = path.size()-1;
+	TuioTime lastTime = path.getTuioTime(last);
+
+	if (motionFilter!=NO_MOTION_FILTER) {
+		TuioTime diffTime = ttime - lastTime;
+		float dt = diffTime.getTotalMilliseconds()/1000.0f;
+		KalmanFilter::filter(motionFilter,xp,yp,dt);
+		TuioPoint::update(ttime,xp, yp);
+
+		const KalmanState &ks = KalmanFilter::getState(motionFilter);
+		float last_motion_speed = motion_speed;
+		x_speed = ks.x_speed;
+		y_speed = ks.y_speed;
+		x_accel = ks.x_accel;
+		y_accel = ks.y_accel;
+		motion_speed = sqrtf(x_speed*x_speed+y_speed*y_speed);
+		if (dt>0.0f) motion_accel = (motion_speed - last_motion_speed)/dt;
+		else motion_accel = 0.0f;
+	} else {
+		TuioPoint::update(ttime,xp, yp);
+
+		TuioTime diffTime = currentTime - lastTime;
+		float dt = diffTime.getTotalMilliseconds()/1000.0f;
+		float dx = xpos - path.getX(last);
+		float dy = ypos - path.getY(last);
+		float dist = sqrt(dx*dx+dy*dy);
+		float last_motion_speed = motion_speed;
+		float last_x_speed = x_speed;
+		float last_y_speed = y_speed;
+
+		x_speed = dx/dt;
+		y_speed = dy/dt;
+		motion_speed = dist/dt;
+		motion_accel = (motion_speed - last_motion_speed)/dt;
+		x_accel = (x_speed - last_x_speed)/dt;
+		y_accel = (y_speed - last_y_speed)/dt;
+	}
 
-	TuioTime diffTime = currentTime - lastPoint->getTuioTime();
-	float dt = diffTime.getTotalMilliseconds()/1000.0f;
-	float dx = xpos - lastPoint->getX();
-	float dy = ypos - lastPoint->getY();
-	float dist = sqrt(dx*dx+dy*dy);
-	float last_motion_speed = motion_speed;
-	float last_x_speed = x_speed;
-	float last_y_speed = y_speed;
-
-	x_speed = dx/dt;
-	y_speed = dy/dt;
-	motion_speed = dist/dt;
-	motion_accel = (motion_speed - last_motion_speed)/dt;
-	x_accel = (x_speed - last_x_speed)/dt;
-	y_accel = (y_speed - last_y_speed)/dt;
-
-	TuioPoint p(currentTime,xpos,ypos);
-	path.push_back(p);
-    if (path.size()>MAX_PATH_SIZE) path.pop_front();
+	path.add(currentTime,xpos,ypos);
 
 	if (motion_accel>0) state = TUIO_ACCELERATING;
 	else if (motion_accel<0) state = TUIO_DECELERATING;
@@ -135,10 +189,7 @@ void TuioContainer::update (TuioTime ttime, float xp, float yp, float xs, float
 	x_accel = ma;
 	y_accel = ma;
 
-	lastPoint = &path.back();
-	TuioPoint p(currentTime,xpos,ypos);
-	path.push_back(p);
-    if (path.size()>MAX_PATH_SIZE) path.pop_front();
+	path.add(currentTime,xpos,ypos);
 
 	if (motion_accel>0) state = TUIO_ACCELERATING;
 	else if (motion_accel<0) state = TUIO_DECELERATING;
@@ -154,10 +205,7 @@ void TuioContainer::update (float xp, float yp, float xs, float ys, float ma) {
 	x_accel = ma;
 	y_accel = ma;
 
-	lastPoint = &path.back();
-	TuioPoint p(currentTime,xpos,ypos);
-	path.push_back(p);
-    if (path.size()>MAX_PATH_SIZE) path.pop_front();
+	path.add(currentTime,xpos,ypos);
 
 	if (motion_accel>0) state = TUIO_ACCELERATING;
 	else if (motion_accel<0) state = TUIO_DECELERATING;
@@ -173,10 +221,7 @@ void TuioContainer::update (TuioContainer *tcon) {
 	x_accel = motion_accel;
 	y_accel = motion_accel;
 
-	lastPoint = &path.back();
-	TuioPoint p(tcon->getTuioTime(),xpos,ypos);
-	path.push_back(p);
-    if (path.size()>MAX_PATH_SIZE) path.pop_front();
+	path.add(tcon->getTuioTime(),xpos,ypos);
 
 	if (motion_accel>0) state = TUIO_ACCELERATING;
 	else if (motion_accel<0) state = TUIO_DECELERATING;
@@ -210,7 +255,7 @@ TuioPoint TuioContainer::getPosition() const{
 }
 
 std::list<TuioPoint> TuioContainer::getPath() const{
-	return path;
+	return path.getPointList();
 }
 
 float TuioContainer::getMotionSpeed() const{
@@ -231,9 +276,16 @@ bool TuioContainer::isMoving() const{
 }
 
 TuioPoint TuioContainer::predictPosition() {
-	TuioTime diffTime = currentTime - lastPoint->getTuioTime();
+	int last = path.size()>1 ? path.size()-2 : 0;
+	TuioTime diffTime = currentTime - path.getTuioTime(last);
 	float dt = diffTime.getTotalMilliseconds()/1000.0f;
 	
+	if (motionFilter!=NO_MOTION_FILTER) {
+		float nx, ny;
+		KalmanFilter::predict(motionFilter,dt,nx,ny);
+		return TuioPoint(nx,ny);
+	}
+	
 	float tx = x_speed * dt;
 	float ty = y_speed * dt;
 	
@@ -248,3 +300,15 @@ TuioPoint TuioContainer::predictPosition() {
 	return TuioPoint(nx,ny);	
 }
 
+void TuioContainer::addMotionFilter(float process_noise, float measurement_noise) {
+	
+	removePositionFilter();
+	if (motionFilter!=NO_MOTION_FILTER) KalmanFilter::release(motionFilter);
+	motionFilter = KalmanFilter::allocate(xpos,ypos,process_noise,measurement_noise);
+}
+
+void TuioContainer::removeMotionFilter() {
+	
+	if (motionFilter!=NO_MOTION_FILTER) KalmanFilter::release(motionFilter);
+	motionFilter = NO_MOTION_FILTER;
+}
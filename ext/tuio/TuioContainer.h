@@ -20,6 +20,8 @@
 #define INCLUDED_TUIOCONTAINER_H
 
 #include "TuioPoint.h"
+#include "TuioPath.h"
+#include "KalmanFilter.h"
 #include <list>
 #include <string>
 
@@ -31,8 +33,6 @@
 #define TUIO_STOPPED 5
 #define TUIO_REMOVED 6
 
-#define MAX_PATH_SIZE 128
-
 namespace TUIO {
 	
 	/**
@@ -44,10 +44,6 @@ namespace TUIO {
 	class LIBDECL TuioContainer: public TuioPoint {
 		
 		
-	private:
-		
-		TuioPoint *lastPoint;
-		
 	protected:
 		/**
 		 * The unique session ID number that is assigned to each TUIO object or cursor.
@@ -72,9 +68,9 @@ namespace TUIO {
 		float x_accel;
 		float y_accel;
 		/**
-		 * A List of TuioPoints containing all the previous positions of the TUIO component.
+		 * A TuioPath containing the most recent positions of the TUIO component.
 		 */ 
-		std::list<TuioPoint> path;
+		TuioPath path;
 		/**
 		 * Reflects the current state of the TuioComponent
 		 */ 
@@ -91,6 +87,10 @@ namespace TUIO {
 		 * The address of the TUIO source
 		 */ 
 		std::string source_addr;
+		/**
+		 * The slot index of the optional motion filter state
+		 */ 
+		int motionFilter;
 	
 	public:
 		using TuioPoint::update;
@@ -123,11 +123,29 @@ namespace TUIO {
 		 * @param	tcon	the TuioContainer to assign
 		 */
 		TuioContainer (TuioContainer *tcon);
+
+		/**
+		 * The copy constructor copies all attributes of the provided TuioContainer
+		 * except for its motion filter state, which is only released by its owner.
+		 *
+		 * @param	tcon	the TuioContainer to copy
+		 */
+		TuioContainer (const TuioContainer &tcon);
+
+		/**
+		 * Assigns all attributes of the provided TuioContainer except for its
+		 * motion filter state, an eventually present motion filter is removed.
+		 *
+		 * @param	tcon	the TuioContainer to assign
+		 */
+		TuioContainer& operator= (const TuioContainer &tcon);
 		
 		/**
-		 * The destructor is doing nothing in particular. 
+		 * The destructor releases the motion filter state if present.
 		 */
-		virtual ~TuioContainer(){};
+		virtual ~TuioContainer(){
+			if (motionFilter!=NO_MOTION_FILTER) KalmanFilter::release(motionFilter);
+		};
 
 		/**
 		 * Sets the ID, name and address of the TUIO source 
@@ -244,11 +262,19 @@ namespace TUIO {
 		virtual TuioPoint getPosition() const;
 		
 		/**
-		 * Returns the path of this TuioContainer.
+		 * Returns a copy of the path of this TuioContainer.
 		 * @return	the path of this TuioContainer
 		 */
 		virtual std::list<TuioPoint> getPath() const;
 		
+		/**
+		 * Returns a reference to the path of this TuioContainer without copying its positions.
+		 * @return	the path of this TuioContainer
+		 */
+		const TuioPath& getPathView() const {
+			return path;
+		};
+		
 		/**
 		 * Returns the motion speed of this TuioContainer.
 		 * @return	the motion speed of this TuioContainer
@@ -273,7 +299,26 @@ namespace TUIO {
 		 */
 		virtual bool isMoving() const;
 
+		/**
+		 * Returns the predicted position of this TuioContainer for the next update.
+		 * @return	the predicted position of this TuioContainer
+		 */
 		virtual TuioPoint predictPosition();
+		
+		/**
+		 * Enables the constant acceleration motion filter, which provides the
+		 * smoothed position, velocity and the predicted position of this TuioContainer.
+		 * The motion filter replaces an eventually present position filter.
+		 *
+		 * @param	process_noise	the process noise density
+		 * @param	measurement_noise	the measurement noise variance
+		 */
+		void addMotionFilter(float process_noise, float measurement_noise);
+		
+		/**
+		 * Disables the motion filter of this TuioContainer.
+		 */
+		void removeMotionFilter();
 	};
 }
 #endif
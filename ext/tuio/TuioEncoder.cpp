@@ -0,0 +1,344 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioEncoder.h"
+#include <cstring>
+
+using namespace TUIO;
+using namespace osc;
+
+static const char *tuio_address[3] = { "/tuio/2Dobj", "/tuio/2Dcur", "/tuio/2Dblb" };
+static const char *tuio_set_types[3] = { ",siiffffffff", ",sifffff", ",sifffffffffff" };
+static const char *tuio2_address[3] = { "/tuio2/tok", "/tuio2/ptr", "/tuio2/bnd" };
+static const char *tuio2_types[3] = { ",iiiffffffff", ",iiifffffffffff", ",ifffffffffff" };
+
+// seconds between the NTP epoch 1900 and the Unix epoch 1970
+#define NTP_UNIX_OFFSET 2208988800UL
+
+TuioEncoder::TuioEncoder(unsigned int length)
+	:buffer		(NULL)
+	,allocated	(0)
+	,capacity	(0)
+	,size		(0)
+	,sourceSize	(0)
+	,frameSourceSize	(4)
+	,dimension	(0)
+{
+	setCapacity(length);
+	
+	// serialize the constant message headers
+	for (int p=0;p<3;p++) {
+		writeString(address[p],tuio_address[p]);
+		
+		unsigned int pos = writeString(setHeader[p],tuio_address[p]);
+		pos += writeString(&setHeader[p][pos],tuio_set_types[p]);
+		pos += writeString(&setHeader[p][pos],"set");
+		setHeaderSize[p] = pos;
+		
+		pos = writeString(fseqHeader[p],tuio_address[p]);
+		pos += writeString(&fseqHeader[p][pos],",si");
+		writeString(&fseqHeader[p][pos],"fseq");
+		
+		writeString(aliveHeader[p],"alive");
+	}
+	
+	for (int c=0;c<3;c++) {
+		unsigned int pos = writeString(componentHeader[c],tuio2_address[c]);
+		pos += writeString(&componentHeader[c][pos],tuio2_types[c]);
+		componentHeaderSize[c] = pos;
+	}
+	
+	unsigned int pos = writeString(frameHeader,"/tuio2/frm");
+	writeString(&frameHeader[pos],",itis");
+	writeString(frameSource,"");
+}
+
+TuioEncoder::~TuioEncoder() {
+	if (buffer) delete[] buffer;
+}
+
+void TuioEncoder::setCapacity(unsigned int length) {
+	
+	if (length>allocated) {
+		char *temp = new char[length];
+		if (buffer) {
+			memcpy(temp,buffer,size);
+			delete[] buffer;
+		}
+		buffer = temp;
+		allocated = length;
+	}
+	capacity = length;
+}
+
+unsigned int TuioEncoder::writeString(char *dest, const char *str) {
+	
+	// OSC strings are null terminated and zero padded to a multiple of four bytes
+	unsigned int length = (unsigned int)strlen(str);
+	unsigned int padded = (length + 4) & ~3;
+	memcpy(dest,str,length);
+	memset(dest+length,0,padded-length);
+	return padded;
+}
+
+void TuioEncoder::setSourceName(const char *name) {
+	
+	if (name==NULL) {
+		sourceSize = 0;
+		frameSourceSize = writeString(frameSource,"");
+		return;
+	}
+	
+	char source[MAX_SOURCE_SIZE];
+	strncpy(source,name,MAX_SOURCE_SIZE-1);
+	source[MAX_SOURCE_SIZE-1] = '\0';
+	
+	for (int p=0;p<3;p++) {
+		unsigned int pos = 4;
+		pos += writeString(&sourceMessage[p][pos],tuio_address[p]);
+		pos += writeString(&sourceMessage[p][pos],",ss");
+		pos += writeString(&sourceMessage[p][pos],"source");
+		pos += writeString(&sourceMessage[p][pos],source);
+		storeInt32(sourceMessage[p],pos-4);
+		sourceSize = pos;
+	}
+	
+	frameSourceSize = writeString(frameSource,source);
+}
+
+char* TuioEncoder::reserve(unsigned int length) {
+	if (size+length>capacity) throw OutOfBufferMemoryException();
+	char *dest = buffer+size;
+	size += length;
+	return dest;
+}
+
+void TuioEncoder::startBundle(int profile) {
+	
+	size = 0;
+	char *dest = reserve(16);
+	memcpy(dest,"#bundle",8);
+	// immediate time tag
+	storeInt32(dest+8,0);
+	storeInt32(dest+12,1);
+	
+	if (sourceSize>0) {
+		dest = reserve(sourceSize);
+		memcpy(dest,sourceMessage[profile],sourceSize);
+	}
+}
+
+void TuioEncoder::addAliveMessage(int profile, const std::vector<int32> &aliveList) {
+	
+	unsigned int count = (unsigned int)aliveList.size();
+	unsigned int types = (count + 6) & ~3;
+	unsigned int length = 12 + types + 8 + 4*count;
+	
+	char *dest = reserve(4+length);
+	storeInt32(dest,length);
+	memcpy(dest+4,address[profile],12);
+	
+	char *tags = dest+16;
+	tags[0] = ',';
+	tags[1] = 's';
+	memset(tags+2,'i',count);
+	memset(tags+2+count,0,types-count-2);
+	
+	char *args = tags+types;
+	memcpy(args,aliveHeader[profile],8);
+	args += 8;
+	for (unsigned int i=0;i<count;i++,args+=4) storeInt32(args,(uint32)aliveList[i]);
+}
+
+void TuioEncoder::addObjectMessage(int32 s_id, int32 sym, float xpos, float ypos, float angle, float xvel, float yvel, float rvel, float maccel, float raccel) {
+	
+	unsigned int header = setHeaderSize[TUIO_2DOBJ];
+	char *dest = reserve(4+header+40);
+	storeInt32(dest,header+40);
+	memcpy(dest+4,setHeader[TUIO_2DOBJ],header);
+	
+	char *args = dest+4+header;
+	storeInt32(args,(uint32)s_id);
+	storeInt32(args+4,(uint32)sym);
+	storeFloat32(args+8,xpos);
+	storeFloat32(args+12,ypos);
+	storeFloat32(args+16,angle);
+	storeFloat32(args+20,xvel);
+	storeFloat32(args+24,yvel);
+	storeFloat32(args+28,rvel);
+	storeFloat32(args+32,maccel);
+	storeFloat32(args+36,raccel);
+}
+
+void TuioEncoder::addCursorMessage(int32 s_id, float xpos, float ypos, float xvel, float yvel, float maccel) {
+	
+	unsigned int header = setHeaderSize[TUIO_2DCUR];
+	char *dest = reserve(4+header+24);
+	storeInt32(dest,header+24);
+	memcpy(dest+4,setHeader[TUIO_2DCUR],header);
+	
+	char *args = dest+4+header;
+	storeInt32(args,(uint32)s_id);
+	storeFloat32(args+4,xpos);
+	storeFloat32(args+8,ypos);
+	storeFloat32(args+12,xvel);
+	storeFloat32(args+16,yvel);
+	storeFloat32(args+20,maccel);
+}
+
+void TuioEncoder::addBlobMessage(int32 s_id, float xpos, float ypos, float angle, float width, float height, float area, float xvel, float yvel, float rvel, float maccel, float raccel) {
+	
+	unsigned int header = setHeaderSize[TUIO_2DBLB];
+	char *dest = reserve(4+header+48);
+	storeInt32(dest,header+48);
+	memcpy(dest+4,setHeader[TUIO_2DBLB],header);
+	
+	char *args = dest+4+header;
+	storeInt32(args,(uint32)s_id);
+	storeFloat32(args+4,xpos);
+	storeFloat32(args+8,ypos);
+	storeFloat32(args+12,angle);
+	storeFloat32(args+16,width);
+	storeFloat32(args+20,height);
+	storeFloat32(args+24,area);
+	storeFloat32(args+28,xvel);
+	storeFloat32(args+32,yvel);
+	storeFloat32(args+36,rvel);
+	storeFloat32(args+40,maccel);
+	storeFloat32(args+44,raccel);
+}
+
+void TuioEncoder::addFseqMessage(int profile, int32 fseq) {
+	
+	char *dest = reserve(4+28);
+	storeInt32(dest,28);
+	memcpy(dest+4,fseqHeader[profile],24);
+	storeInt32(dest+28,(uint32)fseq);
+}
+
+void TuioEncoder::setDimension(int width, int height) {
+	dimension = ((uint32)(width & 0xFFFF) << 16) | (uint32)(height & 0xFFFF);
+}
+
+void TuioEncoder::startFrameBundle(int32 fseq, TuioTime ttime) {
+	
+	size = 0;
+	char *dest = reserve(16);
+	memcpy(dest,"#bundle",8);
+	storeInt32(dest+8,0);
+	storeInt32(dest+12,1);
+	
+	unsigned int length = 20+4+8+4+frameSourceSize;
+	dest = reserve(4+length);
+	storeInt32(dest,length);
+	memcpy(dest+4,frameHeader,20);
+	
+	// the frame time is an OSC time tag with the fraction of a second in units of 2^-32
+	char *args = dest+24;
+	storeInt32(args,(uint32)fseq);
+	storeInt32(args+4,(uint32)(ttime.getSeconds()+NTP_UNIX_OFFSET));
+	storeInt32(args+8,(uint32)(ttime.getMicroseconds()*4294.967296));
+	storeInt32(args+12,dimension);
+	memcpy(args+16,frameSource,frameSourceSize);
+}
+
+void TuioEncoder::addTokenMessage(int32 s_id, int32 tu_id, int32 c_id, float xpos, float ypos, float angle, float xvel, float yvel, float rvel, float maccel, float raccel) {
+	
+	unsigned int header = componentHeaderSize[TUIO2_TOK];
+	char *dest = reserve(4+header+44);
+	storeInt32(dest,header+44);
+	memcpy(dest+4,componentHeader[TUIO2_TOK],header);
+	
+	char *args = dest+4+header;
+	storeInt32(args,(uint32)s_id);
+	storeInt32(args+4,(uint32)tu_id);
+	storeInt32(args+8,(uint32)c_id);
+	storeFloat32(args+12,xpos);
+	storeFloat32(args+16,ypos);
+	storeFloat32(args+20,angle);
+	storeFloat32(args+24,xvel);
+	storeFloat32(args+28,yvel);
+	storeFloat32(args+32,rvel);
+	storeFloat32(args+36,maccel);
+	storeFloat32(args+40,raccel);
+}
+
+void TuioEncoder::addPointerMessage(int32 s_id, int32 tu_id, int32 c_id, float xpos, float ypos, float angle, float shear, float radius, float press, float xvel, float yvel, float pvel, float maccel, float paccel) {
+	
+	unsigned int header = componentHeaderSize[TUIO2_PTR];
+	char *dest = reserve(4+header+56);
+	storeInt32(dest,header+56);
+	memcpy(dest+4,componentHeader[TUIO2_PTR],header);
+	
+	char *args = dest+4+header;
+	storeInt32(args,(uint32)s_id);
+	storeInt32(args+4,(uint32)tu_id);
+	storeInt32(args+8,(uint32)c_id);
+	storeFloat32(args+12,xpos);
+	storeFloat32(args+16,ypos);
+	storeFloat32(args+20,angle);
+	storeFloat32(args+24,shear);
+	storeFloat32(args+28,radius);
+	storeFloat32(args+32,press);
+	storeFloat32(args+36,xvel);
+	storeFloat32(args+40,yvel);
+	storeFloat32(args+44,pvel);
+	storeFloat32(args+48,maccel);
+	storeFloat32(args+52,paccel);
+}
+
+void TuioEncoder::addBoundsMessage(int32 s_id, float xpos, float ypos, float angle, float width, float height, float area, float xvel, float yvel, float rvel, float maccel, float raccel) {
+	
+	unsigned int header = componentHeaderSize[TUIO2_BND];
+	char *dest = reserve(4+header+48);
+	storeInt32(dest,header+48);
+	memcpy(dest+4,componentHeader[TUIO2_BND],header);
+	
+	char *args = dest+4+header;
+	storeInt32(args,(uint32)s_id);
+	storeFloat32(args+4,xpos);
+	storeFloat32(args+8,ypos);
+	storeFloat32(args+12,angle);
+	storeFloat32(args+16,width);
+	storeFloat32(args+20,height);
+	storeFloat32(args+24,area);
+	storeFloat32(args+28,xvel);
+	storeFloat32(args+32,yvel);
+	storeFloat32(args+36,rvel);
+	storeFloat32(args+40,maccel);
+	storeFloat32(args+44,raccel);
+}
+
+void TuioEncoder::addFrameAliveMessage(const std::vector<int32> &aliveList) {
+	
+	unsigned int count = (unsigned int)aliveList.size();
+	unsigned int types = (count + 5) & ~3;
+	unsigned int length = 12 + types + 4*count;
+	
+	char *dest = reserve(4+length);
+	storeInt32(dest,length);
+	writeString(dest+4,"/tuio2/alv");
+	
+	char *tags = dest+16;
+	tags[0] = ',';
+	memset(tags+1,'i',count);
+	memset(tags+1+count,0,types-count-1);
+	
+	char *args = tags+types;
+	for (unsigned int i=0;i<count;i++,args+=4) storeInt32(args,(uint32)aliveList[i]);
+}
@@ -0,0 +1,191 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOENCODER_H
+#define INCLUDED_TUIOENCODER_H
+
+#include "LibExport.h"
+#include "osc/OscTypes.h"
+#include "osc/OscOutboundPacketStream.h"
+#include "TuioTime.h"
+#include <vector>
+
+#define TUIO_2DOBJ 0
+#define TUIO_2DCUR 1
+#define TUIO_2DBLB 2
+
+#define TUIO2_TOK 0
+#define TUIO2_PTR 1
+#define TUIO2_BND 2
+
+#define TOK_MESSAGE_SIZE 76
+#define PTR_MESSAGE_SIZE 88
+#define BND_MESSAGE_SIZE 80
+
+#define MAX_SOURCE_SIZE 256
+
+namespace TUIO {
+	
+	/**
+	 * The TuioEncoder class writes the TUIO 1.1 /tuio/2Dobj, /tuio/2Dcur and /tuio/2Dblb bundles
+	 * as well as the TUIO 2.0 frame bundles directly into a reusable packet buffer. The address patterns and type tag strings of all
+	 * messages are serialized in advance, the message arguments are stored in big-endian byte order
+	 * without any further OSC stream processing. The resulting bundles are identical to the
+	 * bundles produced by the osc::OutboundPacketStream.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */ 
+	class LIBDECL TuioEncoder {
+		
+	public:
+		/**
+		 * This constructor allocates a packet buffer of the provided size
+		 *
+		 * @param	size	the maximum bundle size in bytes
+		 */
+		TuioEncoder(unsigned int size);
+		
+		/**
+		 * The destructor releases the packet buffer
+		 */
+		~TuioEncoder();
+		
+		/**
+		 * Limits the maximum bundle size, the packet buffer grows if necessary
+		 *
+		 * @param	size	the maximum bundle size in bytes
+		 */
+		void setCapacity(unsigned int size);
+		
+		/**
+		 * Defines the source name that is added to each bundle, or no source message if NULL
+		 *
+		 * @param	name	the source name
+		 */
+		void setSourceName(const char *name);
+		
+		/**
+		 * Clears the packet buffer and starts a new bundle of the provided profile,
+		 * including the source message if defined.
+		 *
+		 * @param	profile	the TUIO profile (TUIO_2DOBJ, TUIO_2DCUR or TUIO_2DBLB)
+		 */
+		void startBundle(int profile);
+		
+		/**
+		 * Adds an alive message with the provided session IDs
+		 *
+		 * @param	profile	the TUIO profile
+		 * @param	aliveList	the session IDs of all active components
+		 */
+		void addAliveMessage(int profile, const std::vector<osc::int32> &aliveList);
+		
+		void addObjectMessage(osc::int32 s_id, osc::int32 sym, float xpos, float ypos, float angle, float xvel, float yvel, float rvel, float maccel, float raccel);
+		void addCursorMessage(osc::int32 s_id, float xpos, float ypos, float xvel, float yvel, float maccel);
+		void addBlobMessage(osc::int32 s_id, float xpos, float ypos, float angle, float width, float height, float area, float xvel, float yvel, float rvel, float maccel, float raccel);
+		
+		/**
+		 * Adds the final fseq message to the current bundle
+		 *
+		 * @param	profile	the TUIO profile
+		 * @param	fseq	the frame sequence ID
+		 */
+		void addFseqMessage(int profile, osc::int32 fseq);
+		
+		/**
+		 * Defines the sensor dimension that is added to each TUIO 2.0 frame message
+		 *
+		 * @param	width	the sensor width in pixels
+		 * @param	height	the sensor height in pixels
+		 */
+		void setDimension(int width, int height);
+		
+		/**
+		 * Clears the packet buffer and starts a new TUIO 2.0 frame bundle,
+		 * including the /tuio2/frm message with the source name and dimension.
+		 *
+		 * @param	fseq	the frame sequence ID
+		 * @param	ttime	the absolute frame time
+		 */
+		void startFrameBundle(osc::int32 fseq, TuioTime ttime);
+		
+		void addTokenMessage(osc::int32 s_id, osc::int32 tu_id, osc::int32 c_id, float xpos, float ypos, float angle, float xvel, float yvel, float rvel, float maccel, float raccel);
+		void addPointerMessage(osc::int32 s_id, osc::int32 tu_id, osc::int32 c_id, float xpos, float ypos, float angle, float shear, float radius, float press, float xvel, float yvel, float pvel, float maccel, float paccel);
+		void addBoundsMessage(osc::int32 s_id, float xpos, float ypos, float angle, float width, float height, float area, float xvel, float yvel, float rvel, float maccel, float raccel);
+		
+		/**
+		 * Adds the final /tuio2/alv message with the session IDs of all components to the current frame bundle
+		 *
+		 * @param	aliveList	the session IDs of all active components
+		 */
+		void addFrameAliveMessage(const std::vector<osc::int32> &aliveList);
+		
+		/**
+		 * Returns the size of the /tuio2/alv message for the provided number of session IDs
+		 *
+		 * @param	count	the number of session IDs
+		 * @return	the message size in bytes
+		 */
+		static unsigned int getFrameAliveSize(unsigned int count) { return 4+12+((count+5)&~3)+4*count; };
+		
+		const char* getData() const { return buffer; };
+		unsigned int getSize() const { return size; };
+		unsigned int getCapacity() const { return capacity; };
+		unsigned int getFreeSpace() const { return capacity-size; };
+		
+	private:
+		char* reserve(unsigned int length);
+		
+		static unsigned int writeString(char *dest, const char *str);
+		
+		static inline void storeInt32(char *dest, osc::uint32 value) {
+			dest[0] = (char)(value>>24);
+			dest[1] = (char)(value>>16);
+			dest[2] = (char)(value>>8);
+			dest[3] = (char)(value);
+		}
+		
+		static inline void storeFloat32(char *dest, float value) {
+			union { float f; osc::uint32 i; } u;
+			u.f = value;
+			storeInt32(dest,u.i);
+		}
+		
+		char *buffer;
+		unsigned int allocated;
+		unsigned int capacity;
+		unsigned int size;
+		
+		char address[3][12];
+		char setHeader[3][32];
+		unsigned int setHeaderSize[3];
+		char fseqHeader[3][24];
+		char aliveHeader[3][20];
+		char sourceMessage[3][32+MAX_SOURCE_SIZE];
+		unsigned int sourceSize;
+		
+		char componentHeader[3][32];
+		unsigned int componentHeaderSize[3];
+		char frameHeader[24];
+		char frameSource[MAX_SOURCE_SIZE+4];
+		unsigned int frameSourceSize;
+		osc::uint32 dimension;
+	};
+}
+#endif /* INCLUDED_TUIOENCODER_H */
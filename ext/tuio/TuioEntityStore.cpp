@@ -0,0 +1,205 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioEntityStore.h"
+
+using namespace TUIO;
+
+TuioHandle TuioEntityStore::add(TuioContainer *tcon) {
+	
+	TuioHandle handle;
+	if (tcon==NULL) return handle;
+	
+	if (freeSlots.size()>0) {
+		handle.slot = freeSlots.back();
+		freeSlots.pop_back();
+	} else {
+		handle.slot = (int)slotIndex.size();
+		slotIndex.push_back(-1);
+		slotGeneration.push_back(0);
+	}
+	
+	handle.generation = slotGeneration[handle.slot];
+	slotIndex[handle.slot] = (int)entityList.size();
+	
+	entityList.push_back(tcon);
+	sessionList.push_back(tcon->getSessionID());
+	xposList.push_back(tcon->getX());
+	yposList.push_back(tcon->getY());
+	timeList.push_back(tcon->getTuioTime());
+	indexSlot.push_back(handle.slot);
+	
+	sessionMap[tcon->getSessionID()] = handle.slot;
+	return handle;
+}
+
+int TuioEntityStore::findIndex(TuioContainer *tcon) {
+	
+	std::map<long,int>::iterator iter = sessionMap.find(tcon->getSessionID());
+	if (iter!=sessionMap.end()) {
+		int index = slotIndex[iter->second];
+		if (entityList[index]==tcon) return index;
+	}
+	
+	// the session ID has been changed externally
+	for (int i=0;i<(int)entityList.size();i++) {
+		if (entityList[i]==tcon) return i;
+	}
+	
+	return -1;
+}
+
+void TuioEntityStore::update(TuioContainer *tcon) {
+	
+	if (tcon==NULL) return;
+	int index = findIndex(tcon);
+	if (index<0) return;
+	
+	long s_id = tcon->getSessionID();
+	if (sessionList[index]!=s_id) {
+		std::map<long,int>::iterator iter = sessionMap.find(sessionList[index]);
+		if ((iter!=sessionMap.end()) && (iter->second==indexSlot[index])) sessionMap.erase(iter);
+		sessionMap[s_id] = indexSlot[index];
+		sessionList[index] = s_id;
+	}
+	
+	xposList[index] = tcon->getX();
+	yposList[index] = tcon->getY();
+	timeList[index] = tcon->getTuioTime();
+}
+
+void TuioEntityStore::remove(TuioContainer *tcon) {
+	
+	if (tcon==NULL) return;
+	int index = findIndex(tcon);
+	if (index<0) return;
+	
+	int slot = indexSlot[index];
+	std::map<long,int>::iterator iter = sessionMap.find(sessionList[index]);
+	if ((iter!=sessionMap.end()) && (iter->second==slot)) sessionMap.erase(iter);
+	
+	// move the last entity into the freed position
+	int last = (int)entityList.size()-1;
+	if (index!=last) {
+		entityList[index] = entityList[last];
+		sessionList[index] = sessionList[last];
+		xposList[index] = xposList[last];
+		yposList[index] = yposList[last];
+		timeList[index] = timeList[last];
+		indexSlot[index] = indexSlot[last];
+		slotIndex[indexSlot[index]] = index;
+	}
+	
+	entityList.pop_back();
+	sessionList.pop_back();
+	xposList.pop_back();
+	yposList.pop_back();
+	timeList.pop_back();
+	indexSlot.pop_back();
+	
+	slotIndex[slot] = -1;
+	slotGeneration[slot]++;
+	freeSlots.push_back(slot);
+}
+
+void TuioEntityStore::clear() {
+	
+	for (int i=0;i<(int)indexSlot.size();i++) {
+		int slot = indexSlot[i];
+		slotIndex[slot] = -1;
+		slotGeneration[slot]++;
+		freeSlots.push_back(slot);
+	}
+	
+	entityList.clear();
+	sessionList.clear();
+	xposList.clear();
+	yposList.clear();
+	timeList.clear();
+	indexSlot.clear();
+	sessionMap.clear();
+}
+
+TuioContainer* TuioEntityStore::get(TuioHandle handle) const {
+	
+	if ((handle.slot<0) || (handle.slot>=(int)slotIndex.size())) return NULL;
+	if (slotGeneration[handle.slot]!=handle.generation) return NULL;
+	int index = slotIndex[handle.slot];
+	if (index<0) return NULL;
+	return entityList[index];
+}
+
+TuioHandle TuioEntityStore::getHandle(long s_id) {
+	
+	TuioHandle handle;
+	TuioContainer *tcon = find(s_id);
+	if (tcon==NULL) return handle;
+	
+	handle.slot = sessionMap[s_id];
+	handle.generation = slotGeneration[handle.slot];
+	return handle;
+}
+
+TuioContainer* TuioEntityStore::find(long s_id) {
+	
+	std::map<long,int>::iterator iter = sessionMap.find(s_id);
+	if (iter!=sessionMap.end()) {
+		TuioContainer *tcon = entityList[slotIndex[iter->second]];
+		if (tcon->getSessionID()==s_id) return tcon;
+	}
+	
+	// the session ID has been changed externally
+	for (int i=0;i<(int)entityList.size();i++) {
+		if (entityList[i]->getSessionID()==s_id) {
+			update(entityList[i]);
+			return entityList[i];
+		}
+	}
+	
+	return NULL;
+}
+
+int TuioEntityStore::getClosest(float xp, float yp, float distance) const {
+	
+	int closest = -1;
+	float closestDistance = distance*distance;
+	
+	int count = (int)entityList.size();
+	for (int i=0;i<count;i++) {
+		float dx = xposList[i]-xp;
+		float dy = yposList[i]-yp;
+		float d = dx*dx+dy*dy;
+		if (d<closestDistance) {
+			closest = i;
+			closestDistance = d;
+		}
+	}
+	
+	return closest;
+}
+
+int TuioEntityStore::getUntouched(TuioTime ttime, std::vector<int> &untouched) const {
+	
+	untouched.clear();
+	int count = (int)entityList.size();
+	for (int i=0;i<count;i++) {
+		if (ttime!=timeList[i]) untouched.push_back(i);
+	}
+	
+	return (int)untouched.size();
+}
@@ -0,0 +1,168 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOENTITYSTORE_H
+#define INCLUDED_TUIOENTITYSTORE_H
+
+#include "TuioContainer.h"
+#include <vector>
+#include <map>
+
+namespace TUIO {
+	
+	/**
+	 * The TuioHandle refers to an entity within a TuioEntityStore.
+	 * The generation allows to detect handles that refer to an entity which has been removed meanwhile.
+	 */
+	struct TuioHandle {
+		int slot;
+		unsigned int generation;
+		TuioHandle():slot(-1),generation(0) {};
+	};
+	
+	/**
+	 * The TuioEntityStore class keeps the currently active TuioContainers of one type 
+	 * together with their session ID, position and update time in contiguous arrays.
+	 * This allows to iterate, filter and search the active components without
+	 * dereferencing each individual TuioContainer. The entities are indexed by their
+	 * session ID and can be referred to by generation checked TuioHandles.
+	 * The stored attributes are refreshed with each call to the update method.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */ 
+	class LIBDECL TuioEntityStore {
+		
+	public:
+		/**
+		 * The default constructor creates an empty TuioEntityStore
+		 */
+		TuioEntityStore() {};
+		
+		/**
+		 * Adds the provided TuioContainer to this TuioEntityStore.
+		 *
+		 * @param	tcon	the TuioContainer to add
+		 * @return	the TuioHandle referring to the added TuioContainer
+		 */
+		TuioHandle add(TuioContainer *tcon);
+		
+		/**
+		 * Refreshes the stored attributes of the provided TuioContainer.
+		 *
+		 * @param	tcon	the TuioContainer to update
+		 */
+		void update(TuioContainer *tcon);
+		
+		/**
+		 * Removes the provided TuioContainer from this TuioEntityStore.
+		 * All TuioHandles referring to the removed TuioContainer become invalid.
+		 *
+		 * @param	tcon	the TuioContainer to remove
+		 */
+		void remove(TuioContainer *tcon);
+		
+		/**
+		 * Removes all TuioContainers from this TuioEntityStore.
+		 */
+		void clear();
+		
+		/**
+		 * Returns the TuioContainer referred to by the provided TuioHandle
+		 * or NULL if the TuioHandle is no longer valid.
+		 *
+		 * @param	handle	the TuioHandle of the TuioContainer
+		 * @return	the referred TuioContainer or NULL
+		 */
+		TuioContainer* get(TuioHandle handle) const;
+		
+		/**
+		 * Returns the TuioHandle of the TuioContainer with the provided session ID.
+		 * The slot of the returned TuioHandle is -1 if no such TuioContainer is present.
+		 *
+		 * @param	s_id	the session ID of the TuioContainer
+		 * @return	the TuioHandle of the TuioContainer
+		 */
+		TuioHandle getHandle(long s_id);
+		
+		/**
+		 * Returns the TuioContainer with the provided session ID or NULL if not present.
+		 *
+		 * @param	s_id	the session ID of the TuioContainer
+		 * @return	the TuioContainer with the provided session ID or NULL
+		 */
+		TuioContainer* find(long s_id);
+		
+		/**
+		 * Returns the index of the TuioContainer closest to the provided coordinates
+		 * within the provided distance, or -1 if there is no such TuioContainer.
+		 *
+		 * @param	xp	the X coordinate
+		 * @param	yp	the Y coordinate
+		 * @param	distance	the maximum distance
+		 * @return	the index of the closest TuioContainer or -1
+		 */
+		int getClosest(float xp, float yp, float distance) const;
+		
+		/**
+		 * Collects the indices of all TuioContainers that were not updated at the provided TuioTime.
+		 *
+		 * @param	ttime	the current frame time
+		 * @param	untouched	the vector receiving the indices
+		 * @return	the number of untouched TuioContainers
+		 */
+		int getUntouched(TuioTime ttime, std::vector<int> &untouched) const;
+		
+		/**
+		 * Returns the number of TuioContainers within this TuioEntityStore.
+		 * @return	the number of TuioContainers
+		 */
+		int size() const { return (int)entityList.size(); };
+		
+		/**
+		 * Returns the TuioContainer at the provided index.
+		 * The indices are only valid until the next add or remove call.
+		 *
+		 * @param	i	the index of the TuioContainer
+		 * @return	the TuioContainer at the provided index
+		 */
+		TuioContainer* getEntity(int i) const { return entityList[i]; };
+		
+		long getSessionID(int i) const { return sessionList[i]; };
+		float getX(int i) const { return xposList[i]; };
+		float getY(int i) const { return yposList[i]; };
+		const TuioTime& getTuioTime(int i) const { return timeList[i]; };
+		
+	private:
+		int findIndex(TuioContainer *tcon);
+		
+		std::vector<TuioContainer*> entityList;
+		std::vector<long> sessionList;
+		std::vector<float> xposList;
+		std::vector<float> yposList;
+		std::vector<TuioTime> timeList;
+		std::vector<int> indexSlot;
+		
+		std::vector<int> slotIndex;
+		std::vector<unsigned int> slotGeneration;
+		std::vector<int> freeSlots;
+		
+		std::map<long,int> sessionMap;
+	};
+}
+#endif /* INCLUDED_TUIOENTITYSTORE_H */
@@ -33,6 +33,8 @@ TuioManager::TuioManager()
 	, invert_x(false)
 	, invert_y(false)
 	, invert_a(false)
+	, sensor_width(0)
+	, sensor_height(0)
 {
 
 }
@@ -45,6 +47,7 @@ TuioObject* TuioManager::addTuioObject(int f_id, float x, float y, float a) {
 	sessionID++;
 	TuioObject *tobj = new TuioObject(currentFrameTime, sessionID, f_id, x, y, a);
 	objectList.push_back(tobj);
+	objectStore.add(tobj);
 	updateObject = true;
 
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -60,6 +63,7 @@ void TuioManager::addExternalTuioObject(TuioObject *tobj) {
 	if (tobj==NULL) return;
 	tobj->setSessionID(++sessionID);
 	objectList.push_back(tobj);
+	objectStore.add(tobj);
 	updateObject = true;
 
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -73,6 +77,7 @@ void TuioManager::updateTuioObject(TuioObject *tobj, float x, float y, float a)
 	if (tobj==NULL) return;
 	if (tobj->getTuioTime()==currentFrameTime) return;
 	tobj->update(currentFrameTime,x,y,a);
+	objectStore.update(tobj);
 	updateObject = true;
 
 	if (tobj->isMoving()) {
@@ -87,6 +92,7 @@ void TuioManager::updateTuioObject(TuioObject *tobj, float x, float y, float a)
 
 void TuioManager::updateExternalTuioObject(TuioObject *tobj) {
 	if (tobj==NULL) return;
+	objectStore.update(tobj);
 	updateObject = true;
 
 	if (tobj->isMoving()) {
@@ -109,6 +115,8 @@ void TuioManager::removeTuioObject(TuioObject *tobj) {
 		std::cout << "del obj " << tobj->getSymbolID() << " (" << tobj->getSessionID() << ")" << std::endl;
     
     objectList.remove(tobj);
+    
+    objectStore.remove(tobj);
     delete tobj;
     updateObject = true;
 }
@@ -116,6 +124,7 @@ void TuioManager::removeTuioObject(TuioObject *tobj) {
 void TuioManager::removeExternalTuioObject(TuioObject *tobj) {
 	if (tobj==NULL) return;
 	objectList.remove(tobj);
+	objectStore.remove(tobj);
 	updateObject = true;
 
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -144,6 +153,7 @@ TuioCursor* TuioManager::addTuioCursor(float x, float y) {
 	
 	TuioCursor *tcur = new TuioCursor(currentFrameTime, sessionID, cursorID, x, y);
 	cursorList.push_back(tcur);
+	cursorStore.add(tcur);
 	updateCursor = true;
 
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -159,6 +169,7 @@ void TuioManager::addExternalTuioCursor(TuioCursor *tcur) {
 	if (tcur==NULL) return;
 	tcur->setSessionID(++sessionID);
 	cursorList.push_back(tcur);
+	cursorStore.add(tcur);
 	updateCursor = true;
 
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -172,6 +183,7 @@ void TuioManager::updateTuioCursor(TuioCursor *tcur,float x, float y) {
 	if (tcur==NULL) return;
 	//if (tcur->getTuioTime()==currentFrameTime) return;
 	tcur->update(currentFrameTime,x,y);
+	cursorStore.update(tcur);
 	updateCursor = true;
 
 	if (tcur->isMoving()) {	
@@ -186,6 +198,7 @@ void TuioManager::updateTuioCursor(TuioCursor *tcur,float x, float y) {
 
 void TuioManager::updateExternalTuioCursor(TuioCursor *tcur) {
 	if (tcur==NULL) return;
+	cursorStore.update(tcur);
 	updateCursor = true;
 	
 	if (tcur->isMoving()) {	
@@ -205,6 +218,8 @@ void TuioManager::removeTuioCursor(TuioCursor *tcur) {
 		std::cout << "del cur " << tcur->getCursorID() << " (" <<  tcur->getSessionID() << ")" << std::endl;
 	
 	cursorList.remove(tcur);
+	
+	cursorStore.remove(tcur);
 	tcur->remove(currentFrameTime);
 	updateCursor = true;
 
@@ -250,6 +265,8 @@ void TuioManager::removeExternalTuioCursor(TuioCursor *tcur) {
 		std::cout << "del cur " << tcur->getCursorID() << " (" <<  tcur->getSessionID() << ")" << std::endl;
 	
 	cursorList.remove(tcur);
+	
+	cursorStore.remove(tcur);
 	updateCursor = true;
 
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -275,6 +292,7 @@ TuioBlob* TuioManager::addTuioBlob(float x, float y, float a, float w, float h,
 	
 	TuioBlob *tblb = new TuioBlob(currentFrameTime, sessionID, blobID, x, y, a, w, h, f);
 	blobList.push_back(tblb);
+	blobStore.add(tblb);
 	updateBlob = true;
 	
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -307,6 +325,7 @@ void TuioManager::addExternalTuioBlob(TuioBlob *tblb) {
 	tblb->setBlobID(blobID);
 	
 	blobList.push_back(tblb);
+	blobStore.add(tblb);
 	updateBlob = true;
 	
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -320,6 +339,7 @@ void TuioManager::updateTuioBlob(TuioBlob *tblb,float x, float y, float a, float
 	if (tblb==NULL) return;
 	if (tblb->getTuioTime()==currentFrameTime) return;
 	tblb->update(currentFrameTime,x,y,a,w,h,f);
+	blobStore.update(tblb);
 	updateBlob = true;
 	
 	if (tblb->isMoving()) {	
@@ -334,6 +354,7 @@ void TuioManager::updateTuioBlob(TuioBlob *tblb,float x, float y, float a, float
 
 void TuioManager::updateExternalTuioBlob(TuioBlob *tblb) {
 	if (tblb==NULL) return;
+	blobStore.update(tblb);
 	updateBlob = true;
 	
 	if (tblb->isMoving()) {	
@@ -353,6 +374,8 @@ void TuioManager::removeTuioBlob(TuioBlob *tblb) {
 		std::cout << "del blb " << tblb->getBlobID() << " (" <<  tblb->getSessionID() << ")" << std::endl;
 	
 	blobList.remove(tblb);
+	
+	blobStore.remove(tblb);
 	tblb->remove(currentFrameTime);
 	updateBlob = true;
 
@@ -399,6 +422,8 @@ void TuioManager::removeExternalTuioBlob(TuioBlob *tblb) {
 		std::cout << "del blb " << tblb->getBlobID() << " (" <<  tblb->getSessionID() << ")" << std::endl;
 	
 	blobList.remove(tblb);
+	
+	blobStore.remove(tblb);
 	updateBlob = true;
 	
 	for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
@@ -430,70 +455,43 @@ void TuioManager::commitFrame() {
 
 TuioObject* TuioManager::getClosestTuioObject(float xp, float yp) {
 	
-	TuioObject *closestObject = NULL;
-	float closestDistance = 1.0f;
-	
-	for (std::list<TuioObject*>::iterator iter=objectList.begin(); iter != objectList.end(); iter++) {
-		float distance = (*iter)->getDistance(xp,yp);
-		if(distance<closestDistance) {
-			closestObject = (*iter);
-			closestDistance = distance;
-		}
-	}
-	
-	return closestObject;
+	int closest = objectStore.getClosest(xp,yp,1.0f);
+	if (closest<0) return NULL;
+	return static_cast<TuioObject*>(objectStore.getEntity(closest));
 }
 
 TuioCursor* TuioManager::getClosestTuioCursor(float xp, float yp) {
-
-	TuioCursor *closestCursor = NULL;
-	float closestDistance = 1.0f;
-
-	for (std::list<TuioCursor*>::iterator iter=cursorList.begin(); iter != cursorList.end(); iter++) {
-		float distance = (*iter)->getDistance(xp,yp);
-		if(distance<closestDistance) {
-			closestCursor = (*iter);
-			closestDistance = distance;
-		}
-	}
 	
-	return closestCursor;
+	int closest = cursorStore.getClosest(xp,yp,1.0f);
+	if (closest<0) return NULL;
+	return static_cast<TuioCursor*>(cursorStore.getEntity(closest));
 }
 
 TuioBlob* TuioManager::getClosestTuioBlob(float xp, float yp) {
 	
-	TuioBlob *closestBlob = NULL;
-	float closestDistance = 1.0f;
-	
-	for (std::list<TuioBlob*>::iterator iter=blobList.begin(); iter != blobList.end(); iter++) {
-		float distance = (*iter)->getDistance(xp,yp);
-		if(distance<closestDistance) {
-			closestBlob = (*iter);
-			closestDistance = distance;
-		}
-	}
-	
-	return closestBlob;
+	int closest = blobStore.getClosest(xp,yp,1.0f);
+	if (closest<0) return NULL;
+	return static_cast<TuioBlob*>(blobStore.getEntity(closest));
 }
 
 std::list<TuioObject*> TuioManager::getUntouchedObjects() {
 	
 	std::list<TuioObject*> untouched;
-	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
-		TuioObject *tobj = (*tuioObject);
-		if (tobj->getTuioTime()!=currentFrameTime) untouched.push_back(tobj);
-	}	
+	objectStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::iterator index = untouchedIndex.begin(); index!=untouchedIndex.end(); index++) {
+		untouched.push_back(static_cast<TuioObject*>(objectStore.getEntity(*index)));
+	}
 	return untouched;
 }
 
 void TuioManager::stopUntouchedMovingObjects() {
 	
-	std::list<TuioObject*> untouched;
-	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
-		
-		TuioObject *tobj = (*tuioObject);
-		if ((tobj->getTuioTime()!=currentFrameTime) && (tobj->isMoving())) {
+	objectStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::iterator index = untouchedIndex.begin(); index!=untouchedIndex.end(); index++) {
+		TuioObject *tobj = static_cast<TuioObject*>(objectStore.getEntity(*index));
+		if (tobj->isMoving()) {
 			tobj->stop(currentFrameTime);
+			objectStore.update(tobj);
 			updateObject = true;
 			if (verbose)		
 				std::cout << "set obj " << tobj->getSymbolID() << " (" << tobj->getSessionID() << ") "<< tobj->getX() << " " << tobj->getY() << " " << tobj->getAngle() 
@@ -504,13 +502,11 @@ void TuioManager::stopUntouchedMovingObjects() {
 
 void TuioManager::removeUntouchedStoppedObjects() {
 	
-	std::list<TuioObject*>::iterator tuioObject = objectList.begin();
-	while (tuioObject!=objectList.end()) {
-		TuioObject *tobj = (*tuioObject);
-		if ((tobj->getTuioTime()!=currentFrameTime) && (!tobj->isMoving())) {
-			removeTuioObject(tobj);
-			tuioObject = objectList.begin();
-		} else tuioObject++;
+	// the removal reorders the store, therefore the untouched entities are processed in reverse order
+	objectStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::reverse_iterator index = untouchedIndex.rbegin(); index!=untouchedIndex.rend(); index++) {
+		TuioObject *tobj = static_cast<TuioObject*>(objectStore.getEntity(*index));
+		if (!tobj->isMoving()) removeTuioObject(tobj);
 	}
 }
 
@@ -526,39 +522,37 @@ void TuioManager::resetTuioObjects() {
 std::list<TuioCursor*> TuioManager::getUntouchedCursors() {
 	
 	std::list<TuioCursor*> untouched;
-	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
-		TuioCursor *tcur = (*tuioCursor);
-		if (tcur->getTuioTime()!=currentFrameTime) untouched.push_back(tcur);
-	}	
+	cursorStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::iterator index = untouchedIndex.begin(); index!=untouchedIndex.end(); index++) {
+		untouched.push_back(static_cast<TuioCursor*>(cursorStore.getEntity(*index)));
+	}
 	return untouched;
 }
 
 void TuioManager::stopUntouchedMovingCursors() {
 	
-	std::list<TuioCursor*> untouched;
-	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
-		TuioCursor *tcur = (*tuioCursor);
-		if ((tcur->getTuioTime()!=currentFrameTime) && (tcur->isMoving())) {
+	cursorStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::iterator index = untouchedIndex.begin(); index!=untouchedIndex.end(); index++) {
+		TuioCursor *tcur = static_cast<TuioCursor*>(cursorStore.getEntity(*index));
+		if (tcur->isMoving()) {
 			tcur->stop(currentFrameTime);
+			cursorStore.update(tcur);
 			updateCursor = true;
 			if (verbose) 	
 				std::cout << "set cur " << tcur->getCursorID() << " (" <<  tcur->getSessionID() << ") " << tcur->getX() << " " << tcur->getY() 
-				<< " " << tcur->getXSpeed() << " " << tcur->getYSpeed()<< " " << tcur->getMotionAccel() << " " << std::endl;							
+				<< " " << tcur->getXSpeed() << " " << tcur->getYSpeed()<< " " << tcur->getMotionAccel() << " " << std::endl;
 		}
-	}	
+	}
 }
 
 void TuioManager::removeUntouchedStoppedCursors() {
 	
-	if (cursorList.size()==0) return;
-	std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin();
-	while (tuioCursor!=cursorList.end()) {
-		TuioCursor *tcur = (*tuioCursor);
-		if ((tcur->getTuioTime()!=currentFrameTime) && (!tcur->isMoving())) {
-			removeTuioCursor(tcur);
-			tuioCursor = cursorList.begin();
-		} else tuioCursor++;
-	}	
+	// the removal reorders the store, therefore the untouched entities are processed in reverse order
+	cursorStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::reverse_iterator index = untouchedIndex.rbegin(); index!=untouchedIndex.rend(); index++) {
+		TuioCursor *tcur = static_cast<TuioCursor*>(cursorStore.getEntity(*index));
+		if (!tcur->isMoving()) removeTuioCursor(tcur);
+	}
 }
 
 void TuioManager::resetTuioCursors() {
@@ -573,38 +567,37 @@ void TuioManager::resetTuioCursors() {
 std::list<TuioBlob*> TuioManager::getUntouchedBlobs() {
 	
 	std::list<TuioBlob*> untouched;
-	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
-		TuioBlob *tblb = (*tuioBlob);
-		if (tblb->getTuioTime()!=currentFrameTime) untouched.push_back(tblb);
-	}	
+	blobStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::iterator index = untouchedIndex.begin(); index!=untouchedIndex.end(); index++) {
+		untouched.push_back(static_cast<TuioBlob*>(blobStore.getEntity(*index)));
+	}
 	return untouched;
 }
 
 void TuioManager::stopUntouchedMovingBlobs() {
 	
-	std::list<TuioBlob*> untouched;
-	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
-		TuioBlob *tblb = (*tuioBlob);
-		if ((tblb->getTuioTime()!=currentFrameTime) && (tblb->isMoving())) {
+	blobStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::iterator index = untouchedIndex.begin(); index!=untouchedIndex.end(); index++) {
+		TuioBlob *tblb = static_cast<TuioBlob*>(blobStore.getEntity(*index));
+		if (tblb->isMoving()) {
 			tblb->stop(currentFrameTime);
+			blobStore.update(tblb);
 			updateBlob = true;
 			if (verbose) 	
 				std::cout << "set blb " << tblb->getBlobID() << " (" <<  tblb->getSessionID() << ") " << tblb->getX() << " " << tblb->getY()  << " " << tblb->getAngle() << " " << tblb->getWidth()  << " " << tblb->getHeight() << " " << tblb->getArea()
 				<< " " << tblb->getXSpeed() << " " << tblb->getYSpeed()  << " " << tblb->getRotationSpeed() << " " << tblb->getMotionAccel()<< " " << tblb->getRotationAccel() << " " << std::endl;
 		}
-	}	
+	}
 }
 
 void TuioManager::removeUntouchedStoppedBlobs() {
 	
-	std::list<TuioBlob*>::iterator tuioBlob = blobList.begin();
-	while (tuioBlob!=blobList.end()) {
-		TuioBlob *tblb = (*tuioBlob);
-		if ((tblb->getTuioTime()!=currentFrameTime) && (!tblb->isMoving())) {
-			removeTuioBlob(tblb);
-			tuioBlob = blobList.begin();
-		} else tuioBlob++;
-	}	
+	// the removal reorders the store, therefore the untouched entities are processed in reverse order
+	blobStore.getUntouched(currentFrameTime,untouchedIndex);
+	for (std::vector<int>::reverse_iterator index = untouchedIndex.rbegin(); index!=untouchedIndex.rend(); index++) {
+		TuioBlob *tblb = static_cast<TuioBlob*>(blobStore.getEntity(*index));
+		if (!tblb->isMoving()) removeTuioBlob(tblb);
+	}
 }
 
 void TuioManager::resetTuioBlobs() {
@@ -615,3 +608,39 @@ void TuioManager::resetTuioBlobs() {
 		tuioBlob = blobList.begin();
 	}
 }
+
+TuioObject* TuioManager::getTuioObject(long s_id) {
+	return static_cast<TuioObject*>(objectStore.find(s_id));
+}
+
+TuioHandle TuioManager::getTuioObjectHandle(long s_id) {
+	return objectStore.getHandle(s_id);
+}
+
+TuioObject* TuioManager::getTuioObject(TuioHandle handle) {
+	return static_cast<TuioObject*>(objectStore.get(handle));
+}
+
+TuioCursor* TuioManager::getTuioCursor(long s_id) {
+	return static_cast<TuioCursor*>(cursorStore.find(s_id));
+}
+
+TuioHandle TuioManager::getTuioCursorHandle(long s_id) {
+	return cursorStore.getHandle(s_id);
+}
+
+TuioCursor* TuioManager::getTuioCursor(TuioHandle handle) {
+	return static_cast<TuioCursor*>(cursorStore.get(handle));
+}
+
+TuioBlob* TuioManager::getTuioBlob(long s_id) {
+	return static_cast<TuioBlob*>(blobStore.find(s_id));
+}
+
+TuioHandle TuioManager::getTuioBlobHandle(long s_id) {
+	return blobStore.getHandle(s_id);
+}
+
+TuioBlob* TuioManager::getTuioBlob(TuioHandle handle) {
+	return static_cast<TuioBlob*>(blobStore.get(handle));
+}
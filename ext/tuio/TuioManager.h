@@ -20,10 +20,12 @@
 #define INCLUDED_TUIOMANAGER_H
 
 #include "TuioDispatcher.h"
+#include "TuioEntityStore.h"
 
 #include <iostream>
 #include <list>
 #include <algorithm>
+#include <vector>
 
 #define OBJ_MESSAGE_SIZE 108	// setMessage + fseqMessage size
 #define CUR_MESSAGE_SIZE 88
@@ -37,19 +39,19 @@ namespace TUIO {
 	 * <p><code>
 	 * TuioManager *manager = new TuioManager();<br/>
 	 * ...<br/>
-	 * server->initFrame(TuioTime::getSessionTime());<br/>
+	 * server->initFrame(TuioTime::getSystemTime());<br/>
 	 * TuioObject *tobj = server->addTuioObject(xpos,ypos, angle);<br/>
 	 * TuioCursor *tcur = server->addTuioCursor(xpos,ypos);<br/>
 	 * TuioBlob *tblb = server->addTuioBlob(xpos,ypos,width,height,angle);<br/>
 	 * server->commitFrame();<br/>
 	 * ...<br/>
-	 * server->initFrame(TuioTime::getSessionTime());<br/>
+	 * server->initFrame(TuioTime::getSystemTime());<br/>
 	 * server->updateTuioObject(tobj, xpos,ypos, angle);<br/>
 	 * server->updateTuioCursor(tcur, xpos,ypos);<br/>
 	 * server->updateTuioBlob(tblb, xpos,ypos,width,height,angle);<br/>
 	 * server->commitFrame();<br/>
 	 * ...<br/>
-	 * server->initFrame(TuioTime::getSessionTime());<br/>
+	 * server->initFrame(TuioTime::getSystemTime());<br/>
 	 * server->removeTuioObject(tobj);<br/>
 	 * server->removeTuioCursor(tcur);<br/>
 	 * server->removeTuioBlob(tblb);<br/>
@@ -237,7 +239,7 @@ namespace TUIO {
 		/**
 		 * Initializes a new frame with the given TuioTime
 		 *
-		 * @param	ttime	the frame time
+		 * @param	ttime	the absolute frame time, which is also sent as the TUIO 2.0 frame time
 		 */
 		void initFrame(TuioTime ttime);
 		
@@ -340,6 +342,87 @@ namespace TUIO {
 		 */
 		TuioBlob* getClosestTuioBlob(float xp, float yp);
 		
+		/**
+		 * Returns the active TuioObject corresponding to the provided Session ID
+		 * or NULL if the Session ID does not refer to an active TuioObject
+		 *
+		 * @param	s_id	the Session ID of the TuioObject
+		 * @return	an active TuioObject corresponding to the provided Session ID or NULL
+		 */
+		TuioObject* getTuioObject(long s_id);
+		
+		/**
+		 * Returns a TuioHandle referring to the active TuioObject with the provided Session ID.
+		 * The TuioHandle remains safe to use after the removal of the TuioObject.
+		 *
+		 * @param	s_id	the Session ID of the TuioObject
+		 * @return	the TuioHandle referring to the TuioObject
+		 */
+		TuioHandle getTuioObjectHandle(long s_id);
+		
+		/**
+		 * Returns the active TuioObject referred to by the provided TuioHandle
+		 * or NULL if the TuioObject has been removed meanwhile
+		 *
+		 * @param	handle	the TuioHandle of the TuioObject
+		 * @return	the referred TuioObject or NULL
+		 */
+		TuioObject* getTuioObject(TuioHandle handle);
+		
+		/**
+		 * Returns the active TuioCursor corresponding to the provided Session ID
+		 * or NULL if the Session ID does not refer to an active TuioCursor
+		 *
+		 * @param	s_id	the Session ID of the TuioCursor
+		 * @return	an active TuioCursor corresponding to the provided Session ID or NULL
+		 */
+		TuioCursor* getTuioCursor(long s_id);
+		
+		/**
+		 * Returns a TuioHandle referring to the active TuioCursor with the provided Session ID.
+		 * The TuioHandle remains safe to use after the removal of the TuioCursor.
+		 *
+		 * @param	s_id	the Session ID of the TuioCursor
+		 * @return	the TuioHandle referring to the TuioCursor
+		 */
+		TuioHandle getTuioCursorHandle(long s_id);
+		
+		/**
+		 * Returns the active TuioCursor referred to by the provided TuioHandle
+		 * or NULL if the TuioCursor has been removed meanwhile
+		 *
+		 * @param	handle	the TuioHandle of the TuioCursor
+		 * @return	the referred TuioCursor or NULL
+		 */
+		TuioCursor* getTuioCursor(TuioHandle handle);
+		
+		/**
+		 * Returns the active TuioBlob corresponding to the provided Session ID
+		 * or NULL if the Session ID does not refer to an active TuioBlob
+		 *
+		 * @param	s_id	the Session ID of the TuioBlob
+		 * @return	an active TuioBlob corresponding to the provided Session ID or NULL
+		 */
+		TuioBlob* getTuioBlob(long s_id);
+		
+		/**
+		 * Returns a TuioHandle referring to the active TuioBlob with the provided Session ID.
+		 * The TuioHandle remains safe to use after the removal of the TuioBlob.
+		 *
+		 * @param	s_id	the Session ID of the TuioBlob
+		 * @return	the TuioHandle referring to the TuioBlob
+		 */
+		TuioHandle getTuioBlobHandle(long s_id);
+		
+		/**
+		 * Returns the active TuioBlob referred to by the provided TuioHandle
+		 * or NULL if the TuioBlob has been removed meanwhile
+		 *
+		 * @param	handle	the TuioHandle of the TuioBlob
+		 * @return	the referred TuioBlob or NULL
+		 */
+		TuioBlob* getTuioBlob(TuioHandle handle);
+		
 		/**
 		 * The TuioServer prints verbose TUIO event messages to the console if set to true.
 		 * @param	verbose	print verbose messages if set to true
@@ -359,11 +442,26 @@ namespace TUIO {
 		bool getInvertXpos() { return invert_x; };
 		bool getInvertYpos() { return invert_y; };
 		bool getInvertAngle() { return invert_a; };
+		
+		/**
+		 * Defines the sensor dimension in pixels, which is provided to TUIO 2.0 clients
+		 * @param	width	the sensor width
+		 * @param	height	the sensor height
+		 */
+		void setDimension(int width, int height) {
+			sensor_width = width;
+			sensor_height = height;
+		};
 		void resetTuioObjects();
 		void resetTuioCursors();		
 		void resetTuioBlobs();		
 		
 	protected:
+		TuioEntityStore objectStore;
+		TuioEntityStore cursorStore;
+		TuioEntityStore blobStore;
+		std::vector<int> untouchedIndex;
+		
 		std::list<TuioCursor*> freeCursorList;
 		std::list<TuioCursor*> freeCursorBuffer;
 
@@ -384,6 +482,9 @@ namespace TUIO {
 		bool invert_x;
 		bool invert_y;
 		bool invert_a;
+		
+		int sensor_width;
+		int sensor_height;
 	};
 }
 #endif /* INCLUDED_TUIOMANAGER_H */
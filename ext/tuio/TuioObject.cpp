@@ -69,10 +69,10 @@ void TuioObject::update (float xp, float yp, float a, float xs, float ys, float
 }
 
 void TuioObject::update (TuioTime ttime, float xp, float yp, float a) {
-	TuioPoint lastPoint = path.back();
+	TuioTime lastTime = path.getTuioTime(path.size()-1);
 	TuioContainer::update(ttime,xp,yp);
 	
-	TuioTime diffTime = currentTime - lastPoint.getTuioTime();
+	TuioTime diffTime = currentTime - lastTime;
 	float dt = diffTime.getTotalMilliseconds()/1000.0f;
 	float last_rotation_speed = rotation_speed;
 	
@@ -0,0 +1,48 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioPath.h"
+
+using namespace TUIO;
+
+void TuioPath::add(TuioTime ttime, float xp, float yp) {
+	
+	int last;
+	if (count<MAX_PATH_SIZE) {
+		last = (first+count)%MAX_PATH_SIZE;
+		count++;
+	} else {
+		last = first;
+		first = (first+1)%MAX_PATH_SIZE;
+	}
+	
+	pathTime[last] = ttime;
+	pathX[last] = xp;
+	pathY[last] = yp;
+}
+
+TuioPoint TuioPath::getPoint(int i) const {
+	int pos = (first+i)%MAX_PATH_SIZE;
+	return TuioPoint(pathTime[pos],pathX[pos],pathY[pos]);
+}
+
+std::list<TuioPoint> TuioPath::getPointList() const {
+	std::list<TuioPoint> pointList;
+	for (int i=0;i<count;i++) pointList.push_back(getPoint(i));
+	return pointList;
+}
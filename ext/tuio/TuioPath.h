@@ -0,0 +1,128 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOPATH_H
+#define INCLUDED_TUIOPATH_H
+
+#include "TuioPoint.h"
+#include <list>
+
+#define MAX_PATH_SIZE 128
+
+namespace TUIO {
+	
+	/**
+	 * The TuioPath class stores the most recent MAX_PATH_SIZE positions of a TUIO component
+	 * within a fixed-capacity ring buffer. The positions are kept inline without any further
+	 * memory allocation, once the capacity is reached the oldest position is overwritten.
+	 * The path positions are accessed by their index from the oldest (0) to the latest (size-1) position.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */ 
+	class LIBDECL TuioPath {
+		
+	private:
+		TuioTime pathTime[MAX_PATH_SIZE];
+		float pathX[MAX_PATH_SIZE];
+		float pathY[MAX_PATH_SIZE];
+		int first;
+		int count;
+		
+	public:
+		/**
+		 * The default constructor creates an empty TuioPath.
+		 */
+		TuioPath ():first(0),count(0) {};
+		
+		/**
+		 * Appends the provided position to this TuioPath.
+		 * The oldest position is dropped if the path is already full.
+		 *
+		 * @param	ttime	the TuioTime of the position
+		 * @param	xp	the X coordinate of the position
+		 * @param	yp	the Y coordinate of the position
+		 */
+		void add(TuioTime ttime, float xp, float yp);
+		
+		/**
+		 * Removes all positions from this TuioPath.
+		 */
+		void clear() {
+			first = 0;
+			count = 0;
+		};
+		
+		/**
+		 * Returns the number of positions within this TuioPath.
+		 * @return	the number of positions within this TuioPath
+		 */
+		int size() const {
+			return count;
+		};
+		
+		/**
+		 * Returns the X coordinate of the position at the provided index.
+		 * @param	i	the index of the position
+		 * @return	the X coordinate of the position at the provided index
+		 */
+		float getX(int i) const {
+			return pathX[(first+i)%MAX_PATH_SIZE];
+		};
+		
+		/**
+		 * Returns the Y coordinate of the position at the provided index.
+		 * @param	i	the index of the position
+		 * @return	the Y coordinate of the position at the provided index
+		 */
+		float getY(int i) const {
+			return pathY[(first+i)%MAX_PATH_SIZE];
+		};
+		
+		/**
+		 * Returns the TuioTime of the position at the provided index.
+		 * @param	i	the index of the position
+		 * @return	the TuioTime of the position at the provided index
+		 */
+		const TuioTime& getTuioTime(int i) const {
+			return pathTime[(first+i)%MAX_PATH_SIZE];
+		};
+		
+		/**
+		 * Returns the position at the provided index as TuioPoint.
+		 * @param	i	the index of the position
+		 * @return	the position at the provided index
+		 */
+		TuioPoint getPoint(int i) const;
+		
+		/**
+		 * Returns the latest position of this TuioPath as TuioPoint.
+		 * @return	the latest position of this TuioPath
+		 */
+		TuioPoint back() const {
+			return getPoint(count-1);
+		};
+		
+		/**
+		 * Returns a copy of all positions of this TuioPath as a list of TuioPoints.
+		 * @return	a list of all positions of this TuioPath
+		 */
+		std::list<TuioPoint> getPointList() const;
+	};
+}
+#endif
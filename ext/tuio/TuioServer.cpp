@@ -18,12 +18,14 @@
 
 #include "TuioServer.h"
 #include "UdpSender.h"
+#include <algorithm>
 
 using namespace TUIO;
 using namespace osc;
 
 TuioServer::TuioServer() 
-	:full_update			(false)
+	:update_interval		(1.0f)
+	,full_update			(false)
 	,periodic_update		(false)	
 	,objectProfileEnabled	(true)
 	,cursorProfileEnabled	(true)
@@ -35,7 +37,8 @@ TuioServer::TuioServer()
 }
 
 TuioServer::TuioServer(const char *host, int port) 
-:full_update			(false)
+:update_interval		(1.0f)
+,full_update			(false)
 ,periodic_update		(false)	
 ,objectProfileEnabled	(true)
 ,cursorProfileEnabled	(true)
@@ -47,7 +50,8 @@ TuioServer::TuioServer(const char *host, int port)
 }
 
 TuioServer::TuioServer(OscSender *oscsend)
-	:full_update			(false)
+	:update_interval		(1.0f)
+	,full_update			(false)
 	,periodic_update		(false)	
 	,objectProfileEnabled	(true)
 	,cursorProfileEnabled	(true)
@@ -59,20 +63,15 @@ TuioServer::TuioServer(OscSender *oscsend)
 
 void TuioServer::initialize(OscSender *oscsend) {
 	
-	senderList.push_back(oscsend);
-	int size = oscsend->getBufferSize();
-	oscBuffer = new char[size];
-	oscPacket = new osc::OutboundPacketStream(oscBuffer,size);
-	fullBuffer = new char[size];
-	fullPacket = new osc::OutboundPacketStream(oscBuffer,size);
+	if (oscsend!=NULL) {
+		senderList.push_back(oscsend);
+		senderGroup.push_back(addOutputGroup(oscsend));
+		encoder = new TuioEncoder(oscsend->getBufferSize());
+	} else encoder = new TuioEncoder(MAX_UDP_SIZE);
+	startDeliveryThread();
 	
-	objectUpdateTime = TuioTime(currentFrameTime);
-	cursorUpdateTime = TuioTime(currentFrameTime);
-	blobUpdateTime = TuioTime(currentFrameTime);
-	
-	if (cursorProfileEnabled) sendEmptyCursorBundle();
-	if (objectProfileEnabled) sendEmptyObjectBundle();
-	if (blobProfileEnabled) sendEmptyBlobBundle();
+	sendEmptyProfileBundles();
+	deliverFrameEnd();
 	
 	invert_x = false;
 	invert_y = false;
@@ -81,26 +80,26 @@ void TuioServer::initialize(OscSender *oscsend) {
 
 TuioServer::~TuioServer() {
 
-	initFrame(TuioTime::getSessionTime());
+	initFrame(TuioTime::getSystemTime());
 	stopUntouchedMovingCursors();
 	stopUntouchedMovingObjects();
 	stopUntouchedMovingBlobs();
 	
-	initFrame(TuioTime::getSessionTime());
+	initFrame(TuioTime::getSystemTime());
 	removeUntouchedStoppedCursors();
 	removeUntouchedStoppedObjects();
 	removeUntouchedStoppedBlobs();
 	
-	if (cursorProfileEnabled) sendEmptyCursorBundle();
-	if (objectProfileEnabled) sendEmptyObjectBundle();
-	if (blobProfileEnabled) sendEmptyBlobBundle();
+	sendEmptyProfileBundles();
+	deliverFrameEnd();
+	publishFrame();
 	
-	delete []oscBuffer;
-	delete oscPacket;
-	delete []fullBuffer;
-	delete fullPacket;
+	stopDeliveryThread();
+	delete encoder;
 	
 	if (source_name) delete[] source_name;
+	for (unsigned int i=0;i<frameSenderList.size();i++)
+		delete frameSenderList[i];
 	for (unsigned int i=0;i<senderList.size();i++)
 		delete senderList[i];
 }
@@ -113,30 +112,305 @@ void TuioServer::addOscSender(OscSender *sender) {
 		setSourceName(source_name);
 	}*/ 
 	
-	// resize packets to smallest transport method
+	// limit packets to smallest transport method
 	unsigned int size = sender->getBufferSize();
-	if (size<oscPacket->Capacity()) {
-		osc::OutboundPacketStream *temp = oscPacket;
-		oscPacket = new osc::OutboundPacketStream(oscBuffer,size);
-		delete temp;
-		temp = fullPacket;
-		fullPacket = new osc::OutboundPacketStream(oscBuffer,size);
-		delete temp;
+	if (size<encoder->getCapacity()) encoder->setCapacity(size);
+	int group = addOutputGroup(sender);
+	
+#ifdef WIN32
+	WaitForSingleObject(senderMutex, INFINITE);
+	senderList.push_back(sender);
+	senderGroup.push_back(group);
+	ReleaseMutex(senderMutex);
+#else
+	pthread_mutex_lock(&senderMutex);
+	senderList.push_back(sender);
+	senderGroup.push_back(group);
+	pthread_mutex_unlock(&senderMutex);
+#endif
+}
+
+int TuioServer::addOutputGroup(OscSender *sender) {
+	
+	// the packets are only encoded once for all senders with the same output settings
+	float interval = (sender->getUpdateRate()>0.0f) ? 1.0f/sender->getUpdateRate() : 0.0f;
+	for (unsigned int i=0;i<groupList.size();i++) {
+		if ((groupList[i].version==sender->getTuioVersion()) && (groupList[i].update_interval==interval) && (groupList[i].heartbeat==sender->getHeartbeat())) return i;
+	}
+	
+	TuioOutputGroup group;
+	group.version = sender->getTuioVersion();
+	group.update_interval = interval;
+	group.heartbeat = sender->getHeartbeat();
+	group.updateObject = false;
+	group.updateCursor = false;
+	group.updateBlob = false;
+	group.resync = false;
+	group.updateTime = TuioTime(currentFrameTime);
+	group.objectUpdateTime = TuioTime(currentFrameTime);
+	group.cursorUpdateTime = TuioTime(currentFrameTime);
+	group.blobUpdateTime = TuioTime(currentFrameTime);
+	groupList.push_back(group);
+	return (int)groupList.size()-1;
+}
+
+bool TuioServer::intervalElapsed(TuioTime since, float interval) {
+	// a frame time before the reference time (after a session reset) also restarts the interval
+	TuioTime timeCheck = currentFrameTime - since;
+	double elapsed = timeCheck.getSeconds() + timeCheck.getMicroseconds()/1000000.0;
+	return ((elapsed>=interval) || (elapsed<0.0));
+}
+
+void TuioServer::scheduleUpdate(TuioOutputGroup &group) {
+	
+	// keep the average update rate, unless the group already fell behind by a whole interval
+	group.updateTime = group.updateTime + (long)(group.update_interval*1000000.0f);
+	if (intervalElapsed(group.updateTime, group.update_interval)) group.updateTime = TuioTime(currentFrameTime);
+}
+
+float TuioServer::getHeartbeat(TuioOutputGroup &group) {
+	if (group.heartbeat>0.0f) return group.heartbeat;
+	else if (periodic_update) return update_interval;
+	else return 0.0f;
+}
+
+void TuioServer::addFrameSender(FrameSender *sender) {
+	frameSenderList.push_back(sender);
+}
+
+void TuioServer::publishFrame() {
+	if (frameSenderList.size()==0) return;
+	
+	for (unsigned int i=0;i<frameSenderList.size();i++)
+		frameSenderList[i]->startFrame(currentFrame, currentFrameTime);
+	
+	float sx = invert_x ? -1.0f : 1.0f;
+	float sy = invert_y ? -1.0f : 1.0f;
+	float sa = invert_a ? -1.0f : 1.0f;
+	
+	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
+		TuioObject *tobj = (*tuioObject);
+		float xpos = invert_x ? 1 - tobj->getX() : tobj->getX();
+		float ypos = invert_y ? 1 - tobj->getY() : tobj->getY();
+		float angle = invert_a ? 2.0f*(float)M_PI - tobj->getAngle() : tobj->getAngle();
+		for (unsigned int i=0;i<frameSenderList.size();i++)
+			frameSenderList[i]->addObject((int)tobj->getSessionID(), tobj->getSymbolID(), xpos, ypos, angle, sx*tobj->getXSpeed(), sy*tobj->getYSpeed(), sa*tobj->getRotationSpeed(), tobj->getMotionAccel(), tobj->getRotationAccel());
+	}
+	
+	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
+		TuioCursor *tcur = (*tuioCursor);
+		if (tcur->getTuioState()==TUIO_ADDED) continue;
+		float xpos = invert_x ? 1 - tcur->getX() : tcur->getX();
+		float ypos = invert_y ? 1 - tcur->getY() : tcur->getY();
+		for (unsigned int i=0;i<frameSenderList.size();i++)
+			frameSenderList[i]->addCursor((int)tcur->getSessionID(), tcur->getCursorID(), xpos, ypos, sx*tcur->getXSpeed(), sy*tcur->getYSpeed(), tcur->getMotionAccel());
+	}
+	
+	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
+		TuioBlob *tblb = (*tuioBlob);
+		if (tblb->getTuioState()==TUIO_ADDED) continue;
+		float xpos = invert_x ? 1 - tblb->getX() : tblb->getX();
+		float ypos = invert_y ? 1 - tblb->getY() : tblb->getY();
+		float angle = invert_a ? 2.0f*(float)M_PI - tblb->getAngle() : tblb->getAngle();
+		for (unsigned int i=0;i<frameSenderList.size();i++)
+			frameSenderList[i]->addBlob((int)tblb->getSessionID(), tblb->getBlobID(), xpos, ypos, angle, tblb->getWidth(), tblb->getHeight(), tblb->getArea(), sx*tblb->getXSpeed(), sy*tblb->getYSpeed(), sa*tblb->getRotationSpeed(), tblb->getMotionAccel(), tblb->getRotationAccel());
+	}
+	
+	for (unsigned int i=0;i<frameSenderList.size();i++)
+		frameSenderList[i]->commitFrame();
+}
+
+void TuioServer::startDeliveryThread() {
+
+	// the encoder capacity can only decrease, so the initial size fits all packets
+	packetQueue = new OscPacketQueue(encoder->getCapacity());
+	droppedFrames = 0;
+	droppingFrame = false;
+	partialFrame = false;
+	waitingForSpace = false;
+	delivering = true;
+	
+#ifdef WIN32
+	senderMutex = CreateMutex(NULL,FALSE,NULL);
+	deliveryEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+	spaceEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+	DWORD threadId;
+	deliveryThread = CreateThread( 0, 0, DeliveryThreadFunc, this, 0, &threadId );
+#else
+	pthread_mutex_init(&senderMutex,NULL);
+	pthread_mutex_init(&deliveryMutex,NULL);
+	pthread_cond_init(&deliveryCond,NULL);
+	pthread_cond_init(&spaceCond,NULL);
+	pthread_create(&deliveryThread , NULL, DeliveryThreadFunc, this);
+#endif
+}
+
+void TuioServer::stopDeliveryThread() {
+
+	// the delivery thread sends all remaining packets before it terminates
+#ifdef WIN32
+	delivering = false;
+	SetEvent(deliveryEvent);
+	WaitForSingleObject(deliveryThread, INFINITE);
+	CloseHandle(deliveryThread);
+	CloseHandle(deliveryEvent);
+	CloseHandle(spaceEvent);
+	CloseHandle(senderMutex);
+#else
+	pthread_mutex_lock(&deliveryMutex);
+	delivering = false;
+	pthread_cond_signal(&deliveryCond);
+	pthread_mutex_unlock(&deliveryMutex);
+	pthread_join(deliveryThread, NULL);
+	pthread_cond_destroy(&deliveryCond);
+	pthread_cond_destroy(&spaceCond);
+	pthread_mutex_destroy(&deliveryMutex);
+	pthread_mutex_destroy(&senderMutex);
+#endif
+
+	if (droppedFrames>0) std::cout << "TUIO delivery dropped " << droppedFrames << " frames" << std::endl;
+	delete packetQueue;
+}
+
+#ifdef WIN32
+DWORD WINAPI TuioServer::DeliveryThreadFunc( LPVOID obj )
+#else
+void* TuioServer::DeliveryThreadFunc( void *obj )
+#endif
+{
+	TuioServer *server = static_cast<TuioServer*>(obj);
+	
+	for (;;) {
+#ifdef WIN32
+		if (server->packetQueue->isEmpty() && server->delivering) WaitForSingleObject(server->deliveryEvent, INFINITE);
+#else
+		pthread_mutex_lock(&server->deliveryMutex);
+		while (server->packetQueue->isEmpty() && server->delivering)
+			pthread_cond_wait(&server->deliveryCond, &server->deliveryMutex);
+		pthread_mutex_unlock(&server->deliveryMutex);
+#endif
 		
+		server->deliverQueuedPackets();
+		if (!server->delivering && server->packetQueue->isEmpty()) break;
 	}
 	
-	senderList.push_back(sender);
+	return 0;
 }
 
-void TuioServer::deliverOscPacket(osc::OutboundPacketStream  *packet) {
+void TuioServer::deliverQueuedPackets() {
 
-	for (unsigned int i=0;i<senderList.size();i++)
-		senderList[i]->sendOscPacket(packet);
+	unsigned int size = 0;
+	int group = 0;
+	const char *data = NULL;
+	while ((data = packetQueue->getNextPacketToRead(size,group))!=NULL) {
+#ifdef WIN32
+		WaitForSingleObject(senderMutex, INFINITE);
+#else
+		pthread_mutex_lock(&senderMutex);
+#endif
+		// an empty packet marks the end of a frame
+		for (unsigned int i=0;i<senderList.size();i++) {
+			if (size==0) senderList[i]->flushOscData();
+			else if (senderGroup[i]==group) senderList[i]->sendOscData(data,size);
+		}
+#ifdef WIN32
+		ReleaseMutex(senderMutex);
+#else
+		pthread_mutex_unlock(&senderMutex);
+#endif
+		packetQueue->readFinished();
+		
+		// the tracking thread may be waiting for the remaining packets of a frame larger than the queue
+#ifdef WIN32
+		if (waitingForSpace) SetEvent(spaceEvent);
+#else
+		pthread_mutex_lock(&deliveryMutex);
+		if (waitingForSpace) pthread_cond_signal(&spaceCond);
+		pthread_mutex_unlock(&deliveryMutex);
+#endif
+	}
+}
+
+void TuioServer::deliverOscPacket() {
+	queueOscPacket(encoder->getData(),encoder->getSize(),currentGroup);
+}
+
+void TuioServer::deliverFrameEnd() {
+	queueOscPacket(NULL,0,-1);
+	partialFrame = false;
+	
+	// a frame is only delivered with all of its packets and the final empty packet,
+	// all groups lost the incremental changes of a dropped frame though
+	if (droppingFrame) {
+		droppingFrame = false;
+		droppedFrames++;
+		for (unsigned int i=0;i<groupList.size();i++)
+			groupList[i].resync = true;
+		return;
+	}
+	
+	commitQueuedPackets();
+}
+
+void TuioServer::commitQueuedPackets() {
+	
+	packetQueue->commitPackets();
+	
+#ifdef WIN32
+	SetEvent(deliveryEvent);
+#else
+	pthread_mutex_lock(&deliveryMutex);
+	pthread_cond_signal(&deliveryCond);
+	pthread_mutex_unlock(&deliveryMutex);
+#endif
+}
+
+char* TuioServer::waitForQueueSpace() {
+	
+	char *packet = NULL;
+#ifdef WIN32
+	waitingForSpace = true;
+	while ((packet = packetQueue->getNextPacketToWrite())==NULL) WaitForSingleObject(spaceEvent, INFINITE);
+	waitingForSpace = false;
+#else
+	pthread_mutex_lock(&deliveryMutex);
+	waitingForSpace = true;
+	while ((packet = packetQueue->getNextPacketToWrite())==NULL)
+		pthread_cond_wait(&spaceCond, &deliveryMutex);
+	waitingForSpace = false;
+	pthread_mutex_unlock(&deliveryMutex);
+#endif
+	return packet;
+}
+
+void TuioServer::queueOscPacket(const char *data, unsigned int size, int group) {
+
+	// the senders are never called from the tracking thread,
+	// a stalled delivery thread causes the latest frames to be dropped
+	if (droppingFrame) return;
+	char *packet = packetQueue->getNextPacketToWrite();
+	if (packet==NULL) {
+		// a frame which alone fills the whole queue can never be committed at once,
+		// its packets are therefore passed to the delivery thread in parts as they are written
+		if (partialFrame || packetQueue->isEmpty()) {
+			partialFrame = true;
+			commitQueuedPackets();
+			packet = waitForQueueSpace();
+		} else {
+			packetQueue->discardPackets();
+			droppingFrame = true;
+			return;
+		}
+	}
+	
+	if (size>0) memcpy(packet,data,size);
+	packetQueue->writeFinished(size,group);
 }
 
 void TuioServer::setSourceName(const char *name, const char *ip) {
 	if (!source_name) source_name = new char[256];
 	snprintf(source_name,256,"%s@%s",name,ip);
+	encoder->setSourceName(source_name);
 }
 
 
@@ -175,37 +449,86 @@ void TuioServer::setSourceName(const char *src) {
 		}
 		snprintf(source_name,256,"%s@%s",src,source_addr);
 	//}
+	encoder->setSourceName(source_name);
 	
 	std::cout << "tuio/src " << source_name << std::endl;
 }
 
 void TuioServer::commitFrame() {
 	TuioManager::commitFrame();
+	
+	// senders which had to drop a frame receive the full state with their next update
+	for (unsigned int i=0;i<senderList.size();i++) {
+		if (senderList[i]->fullUpdateRequested()) groupList[senderGroup[i]].resync = true;
+	}
+	
+	// the changes are collected until each group is due for its next update
+	for (unsigned int i=0;i<groupList.size();i++) {
+		TuioOutputGroup &group = groupList[i];
+		if (updateObject || (group.resync && objectProfileEnabled)) group.updateObject = true;
+		if (updateCursor || (group.resync && cursorProfileEnabled)) group.updateCursor = true;
+		if (updateBlob || (group.resync && blobProfileEnabled)) group.updateBlob = true;
 		
-	if(updateObject) {
+		currentGroup = i;
+		if (group.version==TUIO_VERSION_20) commitFrameBundle(group);
+		else sendProfileBundles(group);
+	}
+	
+	updateObject = false;
+	updateCursor = false;
+	updateBlob = false;
+	deliverFrameEnd();
+	publishFrame();
+}
+
+void TuioServer::sendEmptyProfileBundles() {
+	
+	for (unsigned int i=0;i<groupList.size();i++) {
+		currentGroup = i;
+		if (groupList[i].version==TUIO_VERSION_20) sendEmptyFrameBundle();
+		else {
+			if (cursorProfileEnabled) sendEmptyCursorBundle();
+			if (objectProfileEnabled) sendEmptyObjectBundle();
+			if (blobProfileEnabled) sendEmptyBlobBundle();
+		}
+	}
+}
+
+void TuioServer::sendProfileBundles(TuioOutputGroup &group) {
+	
+	// rate limited and resynchronized groups receive the full state of all profiles changed since their last update
+	bool full = full_update || group.resync || (group.update_interval>0.0f);
+	float heartbeat = getHeartbeat(group);
+	bool update = (group.updateObject || group.updateCursor || group.updateBlob) && intervalElapsed(group.updateTime, group.update_interval);
+	if (update) {
+		scheduleUpdate(group);
+		group.resync = false;
+	}
+	
+	if(update && group.updateObject) {
 		startObjectBundle();
 		for (std::list<TuioObject*>::iterator  tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
 			
 			// start a new packet if we exceed the packet capacity
-			if ((oscPacket->Capacity()-oscPacket->Size())<OBJ_MESSAGE_SIZE) {
+			if (encoder->getFreeSpace()<OBJ_MESSAGE_SIZE) {
 				sendObjectBundle(currentFrame);
 				startObjectBundle();
 			}
 			TuioObject *tobj = (*tuioObject);
-			if  ((full_update) || (tobj->getTuioTime()==currentFrameTime)) addObjectMessage(tobj);
+			if ((full) || (tobj->getTuioTime()==currentFrameTime)) addObjectMessage(tobj);
 		}
-		objectUpdateTime = TuioTime(currentFrameTime);
+		group.objectUpdateTime = TuioTime(currentFrameTime);
+		group.updateObject = false;
 		sendObjectBundle(currentFrame);
-	} else if (objectProfileEnabled && periodic_update) {
+	} else if (objectProfileEnabled && (heartbeat>0.0f) && !group.updateObject) {
 		
-		TuioTime timeCheck = currentFrameTime - objectUpdateTime;
-		if(timeCheck.getSeconds()>=update_interval) {
-			objectUpdateTime = TuioTime(currentFrameTime);
+		if(intervalElapsed(group.objectUpdateTime, heartbeat)) {
+			group.objectUpdateTime = TuioTime(currentFrameTime);
 			startObjectBundle();
 			if  (full_update) {
 				for (std::list<TuioObject*>::iterator  tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
 					// start a new packet if we exceed the packet capacity
-					if ((oscPacket->Capacity()-oscPacket->Size())<OBJ_MESSAGE_SIZE) {
+					if (encoder->getFreeSpace()<OBJ_MESSAGE_SIZE) {
 						sendObjectBundle(currentFrame);
 						startObjectBundle();
 					}
@@ -215,31 +538,30 @@ void TuioServer::commitFrame() {
 			sendObjectBundle(currentFrame);
 		}
 	}
-	updateObject = false;
 
-	if(updateCursor) {
+	if(update && group.updateCursor) {
 		startCursorBundle();
 		for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
 			
 			// start a new packet if we exceed the packet capacity
-			if ((oscPacket->Capacity()-oscPacket->Size())<CUR_MESSAGE_SIZE) {
+			if (encoder->getFreeSpace()<CUR_MESSAGE_SIZE) {
 				sendCursorBundle(currentFrame);
 				startCursorBundle();
 			}
 			TuioCursor *tcur = (*tuioCursor);
-			if ((full_update) || (tcur->getTuioTime()==currentFrameTime)) addCursorMessage(tcur);				
+			if ((full) || (tcur->getTuioTime()==currentFrameTime)) addCursorMessage(tcur);				
 		}
-		cursorUpdateTime = TuioTime(currentFrameTime);
+		group.cursorUpdateTime = TuioTime(currentFrameTime);
+		group.updateCursor = false;
 		sendCursorBundle(currentFrame);
-	} else if (cursorProfileEnabled && periodic_update) {
-		TuioTime timeCheck = currentFrameTime - cursorUpdateTime;
-		if(timeCheck.getSeconds()>=update_interval) {
-			cursorUpdateTime = TuioTime(currentFrameTime);
+	} else if (cursorProfileEnabled && (heartbeat>0.0f) && !group.updateCursor) {
+		if(intervalElapsed(group.cursorUpdateTime, heartbeat)) {
+			group.cursorUpdateTime = TuioTime(currentFrameTime);
 			startCursorBundle();
 			if (full_update) {
 				for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
 					// start a new packet if we exceed the packet capacity
-					if ((oscPacket->Capacity()-oscPacket->Size())<CUR_MESSAGE_SIZE) {
+					if (encoder->getFreeSpace()<CUR_MESSAGE_SIZE) {
 						sendCursorBundle(currentFrame);
 						startCursorBundle();
 					}
@@ -249,31 +571,30 @@ void TuioServer::commitFrame() {
 			sendCursorBundle(currentFrame);
 		}
 	}
-	updateCursor = false;
 	
-	if(updateBlob) {
+	if(update && group.updateBlob) {
 		startBlobBundle();
 		for (std::list<TuioBlob*>::iterator tuioBlob =blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
 			// start a new packet if we exceed the packet capacity
-			if ((oscPacket->Capacity()-oscPacket->Size())<BLB_MESSAGE_SIZE) {
+			if (encoder->getFreeSpace()<BLB_MESSAGE_SIZE) {
 				sendBlobBundle(currentFrame);
 				startBlobBundle();
 			}
 			TuioBlob *tblb = (*tuioBlob);
-			if ((full_update) || (tblb->getTuioTime()==currentFrameTime)) addBlobMessage(tblb);		
+			if ((full) || (tblb->getTuioTime()==currentFrameTime)) addBlobMessage(tblb);		
 		}
-		blobUpdateTime = TuioTime(currentFrameTime);
+		group.blobUpdateTime = TuioTime(currentFrameTime);
+		group.updateBlob = false;
 		sendBlobBundle(currentFrame);
-	} else if (blobProfileEnabled && periodic_update) {
-		TuioTime timeCheck = currentFrameTime - blobUpdateTime;
-		if(timeCheck.getSeconds()>=update_interval) {
-			blobUpdateTime = TuioTime(currentFrameTime);
+	} else if (blobProfileEnabled && (heartbeat>0.0f) && !group.updateBlob) {
+		if(intervalElapsed(group.blobUpdateTime, heartbeat)) {
+			group.blobUpdateTime = TuioTime(currentFrameTime);
 			startBlobBundle();
 			if (full_update) {
 				for (std::list<TuioBlob*>::iterator tuioBlob =blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
 				
 					// start a new packet if we exceed the packet capacity
-					if ((oscPacket->Capacity()-oscPacket->Size())<BLB_MESSAGE_SIZE) {
+					if (encoder->getFreeSpace()<BLB_MESSAGE_SIZE) {
 						sendBlobBundle(currentFrame);
 						startBlobBundle();
 					}
@@ -283,28 +604,23 @@ void TuioServer::commitFrame() {
 			sendBlobBundle(currentFrame);
 		}
 	}
-	updateBlob = false;
 }
 
 void TuioServer::sendEmptyCursorBundle() {
-	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive" << osc::EndMessage;	
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
-	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	aliveList.clear();
+	encoder->startBundle(TUIO_2DCUR);
+	encoder->addAliveMessage(TUIO_2DCUR,aliveList);
+	encoder->addFseqMessage(TUIO_2DCUR,-1);
+	deliverOscPacket();
 }
 
 void TuioServer::startCursorBundle() {	
-	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
+	aliveList.clear();
 	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
-		if ((*tuioCursor)->getTuioState()!=TUIO_ADDED) (*oscPacket) << (int32)((*tuioCursor)->getSessionID());
+		if ((*tuioCursor)->getTuioState()!=TUIO_ADDED) aliveList.push_back((int32)((*tuioCursor)->getSessionID()));
 	}
-	(*oscPacket) << osc::EndMessage;	
+	encoder->startBundle(TUIO_2DCUR);
+	encoder->addAliveMessage(TUIO_2DCUR,aliveList);
 }
 
 void TuioServer::addCursorMessage(TuioCursor *tcur) {
@@ -324,37 +640,29 @@ void TuioServer::addCursorMessage(TuioCursor *tcur) {
 		yvel = -1 * yvel;
 	}
 
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "set";
-	(*oscPacket) << (int32)(tcur->getSessionID()) << xpos << ypos;
-	(*oscPacket) << xvel << yvel << tcur->getMotionAccel();	
-	(*oscPacket) << osc::EndMessage;
+	encoder->addCursorMessage((int32)(tcur->getSessionID()), xpos, ypos, xvel, yvel, tcur->getMotionAccel());
 }
 
 void TuioServer::sendCursorBundle(long fseq) {
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << (int32)fseq << osc::EndMessage;
-	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	encoder->addFseqMessage(TUIO_2DCUR,(int32)fseq);
+	deliverOscPacket();
 }
 
 void TuioServer::sendEmptyObjectBundle() {
-	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive" << osc::EndMessage;	
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
-	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	aliveList.clear();
+	encoder->startBundle(TUIO_2DOBJ);
+	encoder->addAliveMessage(TUIO_2DOBJ,aliveList);
+	encoder->addFseqMessage(TUIO_2DOBJ,-1);
+	deliverOscPacket();
 }
 
 void TuioServer::startObjectBundle() {
-	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
+	aliveList.clear();
 	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
-		(*oscPacket) << (int32)((*tuioObject)->getSessionID());	
+		aliveList.push_back((int32)((*tuioObject)->getSessionID()));
 	}
-	(*oscPacket) << osc::EndMessage;
+	encoder->startBundle(TUIO_2DOBJ);
+	encoder->addAliveMessage(TUIO_2DOBJ,aliveList);
 }
 
 void TuioServer::addObjectMessage(TuioObject *tobj) {
@@ -378,38 +686,30 @@ void TuioServer::addObjectMessage(TuioObject *tobj) {
 		rvel = -1 * rvel;
 	}
 	
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "set";
-	(*oscPacket) << (int32)(tobj->getSessionID()) << tobj->getSymbolID() << xpos << ypos << angle;
-	(*oscPacket) << xvel << yvel << rvel << tobj->getMotionAccel() << tobj->getRotationAccel();	
-	(*oscPacket) << osc::EndMessage;
+	encoder->addObjectMessage((int32)(tobj->getSessionID()), tobj->getSymbolID(), xpos, ypos, angle, xvel, yvel, rvel, tobj->getMotionAccel(), tobj->getRotationAccel());
 }
 
 void TuioServer::sendObjectBundle(long fseq) {
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << (int32)fseq << osc::EndMessage;
-	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	encoder->addFseqMessage(TUIO_2DOBJ,(int32)fseq);
+	deliverOscPacket();
 }
 
 
 void TuioServer::sendEmptyBlobBundle() {
-	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive" << osc::EndMessage;	
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
-	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	aliveList.clear();
+	encoder->startBundle(TUIO_2DBLB);
+	encoder->addAliveMessage(TUIO_2DBLB,aliveList);
+	encoder->addFseqMessage(TUIO_2DBLB,-1);
+	deliverOscPacket();
 }
 
 void TuioServer::startBlobBundle() {	
-	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
+	aliveList.clear();
 	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
-		if ((*tuioBlob)->getTuioState()!=TUIO_ADDED) (*oscPacket) << (int32)((*tuioBlob)->getSessionID());
+		if ((*tuioBlob)->getTuioState()!=TUIO_ADDED) aliveList.push_back((int32)((*tuioBlob)->getSessionID()));
 	}
-	(*oscPacket) << osc::EndMessage;	
+	encoder->startBundle(TUIO_2DBLB);
+	encoder->addAliveMessage(TUIO_2DBLB,aliveList);
 }
 
 void TuioServer::addBlobMessage(TuioBlob *tblb) {
@@ -435,51 +735,46 @@ void TuioServer::addBlobMessage(TuioBlob *tblb) {
 		rvel = -1 * rvel;
 	}
 	
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "set";
-	(*oscPacket) << (int32)(tblb->getSessionID()) << xpos << ypos << angle << tblb->getWidth() << tblb->getHeight() << tblb->getArea();
-	(*oscPacket) << xvel << yvel  << rvel << tblb->getMotionAccel()  << tblb->getRotationAccel();	
-	(*oscPacket) << osc::EndMessage;
+	encoder->addBlobMessage((int32)(tblb->getSessionID()), xpos, ypos, angle, tblb->getWidth(), tblb->getHeight(), tblb->getArea(), xvel, yvel, rvel, tblb->getMotionAccel(), tblb->getRotationAccel());
 }
 
 void TuioServer::sendBlobBundle(long fseq) {
-	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << (int32)fseq << osc::EndMessage;
-	(*oscPacket) << osc::EndBundle;
-
-	deliverOscPacket( oscPacket );
+	encoder->addFseqMessage(TUIO_2DBLB,(int32)fseq);
+	deliverOscPacket();
 }
 
 void TuioServer::sendFullMessages() {
 	
-	// prepare the cursor packet
-	fullPacket->Clear();
-	(*fullPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
-	// add the cursor alive message
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
+	for (unsigned int i=0;i<groupList.size();i++) {
+		currentGroup = i;
+		if (groupList[i].version==TUIO_VERSION_20) sendFrameBundle(currentFrame,true);
+		else sendFullProfileBundles();
+	}
+	deliverFrameEnd();
+}
+
+void TuioServer::sendFullProfileBundles() {
+	
+	// prepare the cursor packet with all current cursors
+	aliveList.clear();
 	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++)
-		(*fullPacket) << (int32)((*tuioCursor)->getSessionID());	
-	(*fullPacket) << osc::EndMessage;	
+		aliveList.push_back((int32)((*tuioCursor)->getSessionID()));
+	encoder->startBundle(TUIO_2DCUR);
+	encoder->addAliveMessage(TUIO_2DCUR,aliveList);
 	
 	// add all current cursor set messages
 	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
 		
 		// start a new packet if we exceed the packet capacity
-		if ((fullPacket->Capacity()-fullPacket->Size())<CUR_MESSAGE_SIZE) {
+		if (encoder->getFreeSpace()<CUR_MESSAGE_SIZE) {
 			
 			// add the immediate fseq message and send the cursor packet
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
-			(*fullPacket) << osc::EndBundle;
-			deliverOscPacket( fullPacket );
+			encoder->addFseqMessage(TUIO_2DCUR,-1);
+			deliverOscPacket();
 			
 			// prepare the new cursor packet
-			fullPacket->Clear();	
-			(*fullPacket) << osc::BeginBundleImmediate;
-			if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
-			// add the cursor alive message
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
-			for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++)
-				(*fullPacket) << (int32)((*tuioCursor)->getSessionID());	
-			(*fullPacket) << osc::EndMessage;				
+			encoder->startBundle(TUIO_2DCUR);
+			encoder->addAliveMessage(TUIO_2DCUR,aliveList);
 		}
 		
 		float xpos = (*tuioCursor)->getX();
@@ -496,45 +791,31 @@ void TuioServer::sendFullMessages() {
 		}
 		
 		// add the actual cursor set message
-		(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "set";
-		(*fullPacket) << (int32)((*tuioCursor)->getSessionID()) << xpos << ypos;
-		(*fullPacket) << xvel << yvel <<(*tuioCursor)->getMotionAccel();	
-		(*fullPacket) << osc::EndMessage;	
+		encoder->addCursorMessage((int32)((*tuioCursor)->getSessionID()), xpos, ypos, xvel, yvel, (*tuioCursor)->getMotionAccel());
 	}
 	
 	// add the immediate fseq message and send the cursor packet
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
-	(*fullPacket) << osc::EndBundle;
-	deliverOscPacket( fullPacket );
-	
-	// prepare the object packet
-	fullPacket->Clear();
-	(*fullPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
-	// add the object alive message
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
+	encoder->addFseqMessage(TUIO_2DCUR,-1);
+	deliverOscPacket();
+	
+	// prepare the object packet with all current objects
+	aliveList.clear();
 	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++)
-		(*fullPacket) << (int32)((*tuioObject)->getSessionID());	
-	(*fullPacket) << osc::EndMessage;	
+		aliveList.push_back((int32)((*tuioObject)->getSessionID()));
+	encoder->startBundle(TUIO_2DOBJ);
+	encoder->addAliveMessage(TUIO_2DOBJ,aliveList);
 	
 	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
 		
 		// start a new packet if we exceed the packet capacity
-		if ((fullPacket->Capacity()-fullPacket->Size())<OBJ_MESSAGE_SIZE) {
+		if (encoder->getFreeSpace()<OBJ_MESSAGE_SIZE) {
 			// add the immediate fseq message and send the object packet
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
-			(*fullPacket) << osc::EndBundle;
-			deliverOscPacket( fullPacket );
+			encoder->addFseqMessage(TUIO_2DOBJ,-1);
+			deliverOscPacket();
 			
 			// prepare the new object packet
-			fullPacket->Clear();	
-			(*fullPacket) << osc::BeginBundleImmediate;
-			if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
-			// add the object alive message
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
-			for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++)
-				(*fullPacket) << (int32)((*tuioObject)->getSessionID());	
-			(*fullPacket) << osc::EndMessage;	
+			encoder->startBundle(TUIO_2DOBJ);
+			encoder->addAliveMessage(TUIO_2DOBJ,aliveList);
 		}
 		
 		float xpos = (*tuioObject)->getX();
@@ -557,45 +838,30 @@ void TuioServer::sendFullMessages() {
 		}
 		
 		// add the actual object set message
-		(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "set";
-		(*fullPacket) << (int32)((*tuioObject)->getSessionID()) << (*tuioObject)->getSymbolID() << xpos << ypos << angle;
-		(*fullPacket) << xvel << yvel << rvel << (*tuioObject)->getMotionAccel() << (*tuioObject)->getRotationAccel();	
-		(*fullPacket) << osc::EndMessage;
-		
+		encoder->addObjectMessage((int32)((*tuioObject)->getSessionID()), (*tuioObject)->getSymbolID(), xpos, ypos, angle, xvel, yvel, rvel, (*tuioObject)->getMotionAccel(), (*tuioObject)->getRotationAccel());
 	}
 	// add the immediate fseq message and send the object packet
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
-	(*fullPacket) << osc::EndBundle;
-	deliverOscPacket( fullPacket );
-	
-	// prepare the blob packet
-	fullPacket->Clear();
-	(*fullPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
-	// add the object alive message
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
+	encoder->addFseqMessage(TUIO_2DOBJ,-1);
+	deliverOscPacket();
+	
+	// prepare the blob packet with all current blobs
+	aliveList.clear();
 	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++)
-		(*fullPacket) << (int32)((*tuioBlob)->getSessionID());	
-	(*fullPacket) << osc::EndMessage;	
+		aliveList.push_back((int32)((*tuioBlob)->getSessionID()));
+	encoder->startBundle(TUIO_2DBLB);
+	encoder->addAliveMessage(TUIO_2DBLB,aliveList);
 	
 	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
 		
 		// start a new packet if we exceed the packet capacity
-		if ((fullPacket->Capacity()-fullPacket->Size())<BLB_MESSAGE_SIZE) {
-			// add the immediate fseq message and send the object packet
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
-			(*fullPacket) << osc::EndBundle;
-			deliverOscPacket( fullPacket );
+		if (encoder->getFreeSpace()<BLB_MESSAGE_SIZE) {
+			// add the immediate fseq message and send the blob packet
+			encoder->addFseqMessage(TUIO_2DBLB,-1);
+			deliverOscPacket();
 			
 			// prepare the new blob packet
-			fullPacket->Clear();	
-			(*fullPacket) << osc::BeginBundleImmediate;
-			if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
-			// add the blob alive message
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
-			for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++)
-				(*fullPacket) << (int32)((*tuioBlob)->getSessionID());	
-			(*fullPacket) << osc::EndMessage;	
+			encoder->startBundle(TUIO_2DBLB);
+			encoder->addAliveMessage(TUIO_2DBLB,aliveList);
 		}
 		
 		float xpos = (*tuioBlob)->getX();
@@ -618,17 +884,183 @@ void TuioServer::sendFullMessages() {
 		}		
 		
 		// add the actual blob set message
-		(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "set";
-		(*fullPacket) << (int32)((*tuioBlob)->getSessionID()) << xpos << ypos  << angle << (*tuioBlob)->getWidth() << (*tuioBlob)->getHeight() << (*tuioBlob)->getArea();
-		(*fullPacket) << xvel << yvel << rvel << (*tuioBlob)->getMotionAccel() << (*tuioBlob)->getRotationAccel();	
-		(*fullPacket) << osc::EndMessage;
-		
+		encoder->addBlobMessage((int32)((*tuioBlob)->getSessionID()), xpos, ypos, angle, (*tuioBlob)->getWidth(), (*tuioBlob)->getHeight(), (*tuioBlob)->getArea(), xvel, yvel, rvel, (*tuioBlob)->getMotionAccel(), (*tuioBlob)->getRotationAccel());
 	}
 	// add the immediate fseq message and send the blob packet
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
-	(*fullPacket) << osc::EndBundle;
-	deliverOscPacket( fullPacket );
+	encoder->addFseqMessage(TUIO_2DBLB,-1);
+	deliverOscPacket();
 }
 
+void TuioServer::commitFrameBundle(TuioOutputGroup &group) {
+	
+	// the TUIO 2.0 frame is sent whenever any profile was updated
+	if (group.updateObject || group.updateCursor || group.updateBlob) {
+		if (!intervalElapsed(group.updateTime, group.update_interval)) return;
+		scheduleUpdate(group);
+		group.updateObject = false;
+		group.updateCursor = false;
+		group.updateBlob = false;
+		sendFrameBundle(currentFrame, full_update || group.resync || (group.update_interval>0.0f));
+		group.resync = false;
+	} else {
+		float heartbeat = getHeartbeat(group);
+		if ((heartbeat<=0.0f) || !intervalElapsed(group.updateTime, heartbeat)) return;
+		group.updateTime = TuioTime(currentFrameTime);
+		sendFrameBundle(currentFrame, full_update);
+	}
+}
+
+void TuioServer::startFrameBundle(long fseq) {
+	encoder->setDimension(sensor_width,sensor_height);
+	encoder->startFrameBundle((int32)fseq,currentFrameTime);
+}
+
+void TuioServer::sendFrameBundle(long fseq, bool full) {
+	
+	// all profiles share a single alive list, which is repeated in each bundle of the frame
+	aliveList.clear();
+	if (objectProfileEnabled) {
+		for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++)
+			aliveList.push_back((int32)((*tuioObject)->getSessionID()));
+	}
+	if (cursorProfileEnabled) {
+		for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++)
+			if ((*tuioCursor)->getTuioState()!=TUIO_ADDED) aliveList.push_back((int32)((*tuioCursor)->getSessionID()));
+	}
+	if (blobProfileEnabled) {
+		for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++)
+			if ((*tuioBlob)->getTuioState()!=TUIO_ADDED) aliveList.push_back((int32)((*tuioBlob)->getSessionID()));
+	}
+	
+	// components of the same entity may share their session ID
+	std::sort(aliveList.begin(),aliveList.end());
+	aliveList.erase(std::unique(aliveList.begin(),aliveList.end()),aliveList.end());
+	unsigned int aliveSize = TuioEncoder::getFrameAliveSize((unsigned int)aliveList.size());
+	
+	startFrameBundle(fseq);
+	
+	if (objectProfileEnabled) {
+		for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
+			TuioObject *tobj = (*tuioObject);
+			if (!full && (tobj->getTuioTime()!=currentFrameTime)) continue;
+			
+			// start a new packet if we exceed the packet capacity
+			if (encoder->getFreeSpace()<TOK_MESSAGE_SIZE+aliveSize) {
+				encoder->addFrameAliveMessage(aliveList);
+				deliverOscPacket();
+				startFrameBundle(fseq);
+			}
+			addTokenMessage(tobj);
+		}
+	}
+	
+	if (cursorProfileEnabled) {
+		for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
+			TuioCursor *tcur = (*tuioCursor);
+			if (tcur->getTuioState()==TUIO_ADDED) continue;
+			if (!full && (tcur->getTuioTime()!=currentFrameTime)) continue;
+			
+			// start a new packet if we exceed the packet capacity
+			if (encoder->getFreeSpace()<PTR_MESSAGE_SIZE+aliveSize) {
+				encoder->addFrameAliveMessage(aliveList);
+				deliverOscPacket();
+				startFrameBundle(fseq);
+			}
+			addPointerMessage(tcur);
+		}
+	}
+	
+	if (blobProfileEnabled) {
+		for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
+			TuioBlob *tblb = (*tuioBlob);
+			if (tblb->getTuioState()==TUIO_ADDED) continue;
+			if (!full && (tblb->getTuioTime()!=currentFrameTime)) continue;
+			
+			// start a new packet if we exceed the packet capacity
+			if (encoder->getFreeSpace()<BND_MESSAGE_SIZE+aliveSize) {
+				encoder->addFrameAliveMessage(aliveList);
+				deliverOscPacket();
+				startFrameBundle(fseq);
+			}
+			addBoundsMessage(tblb);
+		}
+	}
+	
+	encoder->addFrameAliveMessage(aliveList);
+	deliverOscPacket();
+}
+
+void TuioServer::sendEmptyFrameBundle() {
+	aliveList.clear();
+	encoder->setDimension(sensor_width,sensor_height);
+	encoder->startFrameBundle((int32)currentFrame,currentFrameTime);
+	encoder->addFrameAliveMessage(aliveList);
+	deliverOscPacket();
+}
+
+void TuioServer::addTokenMessage(TuioObject *tobj) {
+	
+	float xpos = tobj->getX();
+	float xvel = tobj->getXSpeed();
+	if (invert_x) {
+		xpos = 1 - xpos;
+		xvel = -1 * xvel;
+	}
+	float ypos = tobj->getY();
+	float yvel = tobj->getYSpeed();
+	if (invert_y) {
+		ypos = 1 - ypos;
+		yvel = -1 * yvel;
+	}
+	float angle = tobj->getAngle();
+	float rvel = tobj->getRotationSpeed();
+	if (invert_a) {
+		angle = 2.0f*(float)M_PI - angle;
+		rvel = -1 * rvel;
+	}
+	
+	encoder->addTokenMessage((int32)(tobj->getSessionID()), 0, tobj->getSymbolID(), xpos, ypos, angle, xvel, yvel, rvel, tobj->getMotionAccel(), tobj->getRotationAccel());
+}
 
+void TuioServer::addPointerMessage(TuioCursor *tcur) {
+	
+	float xpos = tcur->getX();
+	float xvel = tcur->getXSpeed();
+	if (invert_x) {
+		xpos = 1 - xpos;
+		xvel = -1 * xvel;
+	}
+	float ypos = tcur->getY();
+	float yvel = tcur->getYSpeed();
+	if (invert_y) {
+		ypos = 1 - ypos;
+		yvel = -1 * yvel;
+	}
+	
+	// the cursors are touching pointers without shape or pressure information
+	encoder->addPointerMessage((int32)(tcur->getSessionID()), 0, tcur->getCursorID(), xpos, ypos, 0.0f, 0.0f, 0.0f, 1.0f, xvel, yvel, 0.0f, tcur->getMotionAccel(), 0.0f);
+}
 
+void TuioServer::addBoundsMessage(TuioBlob *tblb) {
+	
+	float xpos = tblb->getX();
+	float xvel = tblb->getXSpeed();
+	if (invert_x) {
+		xpos = 1 - xpos;
+		xvel = -1 * xvel;
+	}
+	float ypos = tblb->getY();
+	float yvel = tblb->getYSpeed();
+	if (invert_y) {
+		ypos = 1 - ypos;
+		yvel = -1 * yvel;
+	}
+	float angle = tblb->getAngle();
+	float rvel = tblb->getRotationSpeed();
+	if (invert_a) {
+		angle = 2.0f*(float)M_PI - angle;
+		rvel = -1 * rvel;
+	}
+	
+	encoder->addBoundsMessage((int32)(tblb->getSessionID()), xpos, ypos, angle, tblb->getWidth(), tblb->getHeight(), tblb->getArea(), xvel, yvel, rvel, tblb->getMotionAccel(), tblb->getRotationAccel());
+}
@@ -23,6 +23,10 @@
 #include "UdpSender.h"
 #include "TcpSender.h"
 #include "WebSockSender.h"
+#include "TuioEncoder.h"
+#include "OscPacketQueue.h"
+#include "SharedMemorySender.h"
+#include "DeltaSender.h"
 #include <iostream>
 #include <vector>
 #include <stdio.h>
@@ -33,6 +37,20 @@
 #endif
 
 namespace TUIO {
+	
+	/**
+	 * The output state of all OscSenders which share the same TUIO version, update rate and heartbeat interval.
+	 * The update flags collect the profile changes of all frames which have not been delivered to the group yet.
+	 */
+	struct TuioOutputGroup {
+		int version;
+		float update_interval;
+		float heartbeat;
+		bool updateObject, updateCursor, updateBlob;
+		bool resync;
+		TuioTime updateTime, objectUpdateTime, cursorUpdateTime, blobUpdateTime;
+	};
+	
 	/**
 	 * <p>The TuioServer class is the central TUIO protocol encoder component.
 	 * In order to encode and send TUIO messages an instance of TuioServer needs to be created. The TuioServer instance then generates TUIO messages
@@ -45,19 +63,19 @@ namespace TUIO {
 	 * TuioServer *server = new TuioServer(sender);<br/>
 	 * server->setSourceName("MyTuioSource"); // optional for TUIO 1.1<br/>
 	 * ...<br/>
-	 * server->initFrame(TuioTime::getSessionTime());<br/>
+	 * server->initFrame(TuioTime::getSystemTime());<br/>
 	 * TuioObject *tobj = server->addTuioObject(xpos,ypos,angle);<br/>
 	 * TuioCursor *tcur = server->addTuiCursor(xpos,ypos);<br/>
 	 * TuioBlob *tblb = server->addTuioBlob(xpos,ypos,angle,width,height, area);<br/>
 	 * server->commitFrame();<br/>
 	 * ...<br/>
-	 * server->initFrame(TuioTime::getSessionTime());<br/>
+	 * server->initFrame(TuioTime::getSystemTime());<br/>
 	 * server->updateTuioObject(tobj,xpos,ypos,angle);<br/>
 	 * server->updateTuioCursor(tcur,xpos,ypos);<br/>
 	 * server->updateTuioBlob(tblb,xpos,ypos,angle,width,height,area);<br/>
 	 * server->commitFrame();<br/>
 	 * ...<br/>
-	 * server->initFrame(TuioTime::getSessionTime());<br/>
+	 * server->initFrame(TuioTime::getSystemTime());<br/>
 	 * server->removeTuioObject(tobj);<br/>
 	 * server->removeTuioCursor(tcur);<br/>
 	 * server->removeTuioBlob(tblb);<br/>
@@ -85,7 +103,8 @@ namespace TUIO {
 		TuioServer(const char *host, int port);
 
 		/**
-		 * This constructor creates a TuioServer that sends OSC data using the provided OscSender
+		 * This constructor creates a TuioServer that sends OSC data using the provided OscSender,
+		 * or a TuioServer that only feeds its FrameSenders if the sender is NULL
 		 *
 		 * @param  sender  the OscSender used for OSC data delivery
 		 */
@@ -127,9 +146,9 @@ namespace TUIO {
 		/**
 		 * Enables the periodic full update of all currently active TuioObjects TuioObjects, TuioCursors and TuioBlobs
 		 *
-		 * @param	interval	update interval in seconds, defaults to one second
+		 * @param	interval	update interval in seconds, fractions of a second are supported, defaults to one second
 		 */
-		void enablePeriodicMessages(int interval=1) {
+		void enablePeriodicMessages(float interval=1.0f) {
 			periodic_update =  true;
 			update_interval = interval;
 		}
@@ -153,7 +172,7 @@ namespace TUIO {
 		 * Returns the periodic update interval in seconds.
 		 * @return	the periodic update interval in seconds
 		 */
-		int getUpdateInterval() {
+		float getUpdateInterval() {
 			return update_interval;
 		}
 
@@ -183,8 +202,22 @@ namespace TUIO {
 		 */
 		void setSourceName(const char *name, const char *ip);
 
+		/**
+		 * Adds a further OscSender, which receives the TUIO version and update rate it has been configured for.
+		 * OscSenders with the same version, update rate and heartbeat share their encoded packets.
+		 *
+		 * @param	sender	the OscSender to add
+		 */
 		void addOscSender(OscSender *sender);
 
+		/**
+		 * Publishes the state of each committed frame to the provided FrameSender
+		 * in addition to the OSC output. The TuioServer takes the ownership of the sender.
+		 *
+		 * @param	sender	the FrameSender to publish to
+		 */
+		void addFrameSender(FrameSender *sender);
+
 		void enableObjectProfile(bool flag) { objectProfileEnabled = flag; };
 		void enableCursorProfile(bool flag) { cursorProfileEnabled = flag; };
 		void enableBlobProfile(bool flag) { blobProfileEnabled = flag; };
@@ -193,17 +226,63 @@ namespace TUIO {
 		bool hasCursorProfile() { return cursorProfileEnabled; };
 		bool hasBlobProfile() { return blobProfileEnabled; };
 
+		/**
+		 * Returns the number of frames which were dropped because the delivery thread was still busy with earlier frames.
+		 * @return	the number of dropped frames
+		 */
+		unsigned long getDroppedFrames() { return droppedFrames; };
+
 	private:
 
 		void initialize(OscSender *oscsend);
 
 		std::vector<OscSender*> senderList;
-		void deliverOscPacket(osc::OutboundPacketStream  *packet);
+		std::vector<int> senderGroup;
+		std::vector<TuioOutputGroup> groupList;
+		int currentGroup;
+		int addOutputGroup(OscSender *sender);
+		bool intervalElapsed(TuioTime since, float interval);
+		void scheduleUpdate(TuioOutputGroup &group);
+		float getHeartbeat(TuioOutputGroup &group);
+		
+		void deliverOscPacket();
+		void publishFrame();
+		std::vector<FrameSender*> frameSenderList;
+		void deliverFrameEnd();
+		void queueOscPacket(const char *data, unsigned int size, int group);
+		void commitQueuedPackets();
+		char* waitForQueueSpace();
+
+		void startDeliveryThread();
+		void stopDeliveryThread();
+		void deliverQueuedPackets();
+#ifdef WIN32
+		static DWORD WINAPI DeliveryThreadFunc( LPVOID obj );
+#else
+		static void* DeliveryThreadFunc( void *obj );
+#endif
+
+		OscPacketQueue *packetQueue;
+		volatile bool delivering;
+		unsigned long droppedFrames;
+		bool droppingFrame;
+		bool partialFrame;
+		volatile bool waitingForSpace;
+#ifdef WIN32
+		HANDLE deliveryThread;
+		HANDLE deliveryEvent;
+		HANDLE spaceEvent;
+		HANDLE senderMutex;
+#else
+		pthread_t deliveryThread;
+		pthread_mutex_t deliveryMutex;
+		pthread_cond_t deliveryCond;
+		pthread_cond_t spaceCond;
+		pthread_mutex_t senderMutex;
+#endif
 
-		osc::OutboundPacketStream  *oscPacket;
-		char *oscBuffer;
-		osc::OutboundPacketStream  *fullPacket;
-		char *fullBuffer;
+		TuioEncoder *encoder;
+		std::vector<osc::int32> aliveList;
 
 		void startObjectBundle();
 		void addObjectMessage(TuioObject *tobj);
@@ -219,10 +298,21 @@ namespace TUIO {
 		void addBlobMessage(TuioBlob *tblb);
 		void sendBlobBundle(long fseq);
 		void sendEmptyBlobBundle();
+		
+		void sendProfileBundles(TuioOutputGroup &group);
+		void sendEmptyProfileBundles();
+		void sendFullProfileBundles();
+		
+		void commitFrameBundle(TuioOutputGroup &group);
+		void startFrameBundle(long fseq);
+		void addTokenMessage(TuioObject *tobj);
+		void addPointerMessage(TuioCursor *tcur);
+		void addBoundsMessage(TuioBlob *tblb);
+		void sendFrameBundle(long fseq, bool full);
+		void sendEmptyFrameBundle();
 
-		int update_interval;
+		float update_interval;
 		bool full_update, periodic_update;
-		TuioTime objectUpdateTime, cursorUpdateTime, blobUpdateTime ;
 		bool objectProfileEnabled, cursorProfileEnabled, blobProfileEnabled;
 		char *source_name;
 	};
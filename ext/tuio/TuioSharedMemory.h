@@ -0,0 +1,183 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOSHAREDMEMORY_H
+#define INCLUDED_TUIOSHAREDMEMORY_H
+
+/*
+ This header defines the layout of the TUIO shared memory segment and provides
+ a minimal C/C++ reader, it can be used standalone without the TUIO library.
+ The segment contains a single frame that is published with a sequence lock:
+ the sequence number is odd while the frame is being written, readers copy the
+ frame and retry if the sequence number has changed in the meantime.
+ 
+ TuioShmFrame *shm = tuio_shm_open(TUIO_SHM_DEFAULT_NAME);
+ TuioShmFrame frame;
+ uint32_t last = 0;
+ ...
+ uint32_t sequence = tuio_shm_read(shm, &frame);
+ if (sequence!=last) { last = sequence; ... frame.cursors[i].x ... }
+ ...
+ tuio_shm_close(shm);
+*/
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#define TUIO_SHM_MAGIC 0x4F495554
+#define TUIO_SHM_VERSION 1
+#define TUIO_SHM_DEFAULT_NAME "tuio"
+#define TUIO_SHM_MAX_OBJECTS 256
+#define TUIO_SHM_MAX_CURSORS 256
+#define TUIO_SHM_MAX_BLOBS 1024
+/* a writer that died while publishing leaves the sequence odd forever */
+#define TUIO_SHM_READ_RETRIES 4096
+
+typedef struct {
+	int32_t session_id;
+	int32_t symbol_id;
+	float x, y, angle;
+	float x_speed, y_speed, rotation_speed;
+	float motion_accel, rotation_accel;
+} TuioShmObject;
+
+typedef struct {
+	int32_t session_id;
+	int32_t cursor_id;
+	float x, y;
+	float x_speed, y_speed;
+	float motion_accel;
+} TuioShmCursor;
+
+typedef struct {
+	int32_t session_id;
+	int32_t blob_id;
+	float x, y, angle;
+	float width, height, area;
+	float x_speed, y_speed, rotation_speed;
+	float motion_accel, rotation_accel;
+} TuioShmBlob;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	volatile uint32_t sequence;
+	int32_t frame_id;
+	int32_t seconds;
+	int32_t micro_seconds;
+	uint32_t object_count;
+	uint32_t cursor_count;
+	uint32_t blob_count;
+	uint32_t reserved[7];
+	TuioShmObject objects[TUIO_SHM_MAX_OBJECTS];
+	TuioShmCursor cursors[TUIO_SHM_MAX_CURSORS];
+	TuioShmBlob blobs[TUIO_SHM_MAX_BLOBS];
+} TuioShmFrame;
+
+static inline void tuio_shm_barrier(void) {
+#ifdef WIN32
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+static inline TuioShmFrame* tuio_shm_open(const char *name) {
+
+	TuioShmFrame *shm = NULL;
+#ifdef WIN32
+	HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+	if (mapping==NULL) return NULL;
+	shm = (TuioShmFrame*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(TuioShmFrame));
+	CloseHandle(mapping);
+	if (shm==NULL) return NULL;
+#else
+	char path[256];
+	snprintf(path, sizeof(path), "/%s", name);
+	int fd = shm_open(path, O_RDONLY, 0);
+	if (fd<0) return NULL;
+	void *map = mmap(NULL, sizeof(TuioShmFrame), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map==MAP_FAILED) return NULL;
+	shm = (TuioShmFrame*)map;
+#endif
+
+	if ((shm->magic!=TUIO_SHM_MAGIC) || (shm->version!=TUIO_SHM_VERSION)) {
+#ifdef WIN32
+		UnmapViewOfFile(shm);
+#else
+		munmap(shm, sizeof(TuioShmFrame));
+#endif
+		return NULL;
+	}
+	
+	return shm;
+}
+
+static inline void tuio_shm_close(TuioShmFrame *shm) {
+	if (shm==NULL) return;
+#ifdef WIN32
+	UnmapViewOfFile(shm);
+#else
+	munmap(shm, sizeof(TuioShmFrame));
+#endif
+}
+
+/* copies a consistent snapshot of the current frame and returns its sequence number,
+   only the used part of the entity arrays is copied, zero means no frame has been published yet
+   or no consistent frame could be read, so that the caller can time out a stalled writer */
+static inline uint32_t tuio_shm_read(const TuioShmFrame *shm, TuioShmFrame *frame) {
+
+	for (int retry=0;retry<TUIO_SHM_READ_RETRIES;retry++) {
+		uint32_t sequence = shm->sequence;
+		if (sequence & 1) continue;
+		tuio_shm_barrier();
+		
+		memcpy(frame, (const void*)shm, offsetof(TuioShmFrame, objects));
+		uint32_t objects = frame->object_count;
+		uint32_t cursors = frame->cursor_count;
+		uint32_t blobs = frame->blob_count;
+		if (objects>TUIO_SHM_MAX_OBJECTS) objects = TUIO_SHM_MAX_OBJECTS;
+		if (cursors>TUIO_SHM_MAX_CURSORS) cursors = TUIO_SHM_MAX_CURSORS;
+		if (blobs>TUIO_SHM_MAX_BLOBS) blobs = TUIO_SHM_MAX_BLOBS;
+		memcpy(frame->objects, shm->objects, objects*sizeof(TuioShmObject));
+		memcpy(frame->cursors, shm->cursors, cursors*sizeof(TuioShmCursor));
+		memcpy(frame->blobs, shm->blobs, blobs*sizeof(TuioShmBlob));
+		
+		tuio_shm_barrier();
+		if (shm->sequence==sequence) {
+			frame->object_count = objects;
+			frame->cursor_count = cursors;
+			frame->blob_count = blobs;
+			return sequence/2;
+		}
+	}
+	return 0;
+}
+
+#endif
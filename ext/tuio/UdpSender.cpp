@@ -17,73 +17,164 @@
 */
 
 #include "UdpSender.h"
+#ifdef LINUX
+#define MAX_UDP_MESSAGES 256
+#endif
 
 using namespace TUIO;
 
 UdpSender::UdpSender() {
-	try {
-		local = true;
-		long unsigned int ip = GetHostByName("localhost");
-		socket = new UdpTransmitSocket(IpEndpointName(ip, 3333));
-		buffer_size = MAX_UDP_SIZE;
-		std::cout << "TUIO/UDP messages to " << "127.0.0.1@3333" << std::endl;
-	} catch (std::exception &e) { 
-		std::cout << "could not create UDP socket" << std::endl;
-		socket = NULL;
-		throw std::exception();
-	}
+	local = true;
+	fixed_size = false;
+	buffer_size = MAX_UDP_SIZE;
+	openSocket();
+	if (!addHost("localhost",3333)) throw std::exception();
 }
 
 UdpSender::UdpSender(const char *host, int port) {
-	try {
-		if ((strcmp(host,"127.0.0.1")==0) || (strcmp(host,"localhost")==0)) {
-			local = true;
-			buffer_size = MAX_UDP_SIZE;
-		} else {
-			local = false;
-			buffer_size = IP_MTU_SIZE;
-		}
-		long unsigned int ip = GetHostByName(host);
-		socket = new UdpTransmitSocket(IpEndpointName(ip, port));
-		std::cout << "TUIO/UDP messages to " << host << "@" << port << std::endl;
-	} catch (std::exception &e) { 
+	local = true;
+	fixed_size = false;
+	buffer_size = MAX_UDP_SIZE;
+	openSocket();
+	if (!addHost(host,port)) throw std::exception();
+}
+
+UdpSender::UdpSender(const char *host, int port, int size) {
+	local = true;
+	fixed_size = true;
+	if (size>MAX_UDP_SIZE) buffer_size = MAX_UDP_SIZE;
+	else if (size<MIN_UDP_SIZE) buffer_size = MIN_UDP_SIZE;
+	else buffer_size = size;
+	openSocket();
+	if (!addHost(host,port)) throw std::exception();
+}
+
+void UdpSender::openSocket() {
+
+	multicast = false;
+	batch_count = 0;
+	batch_buffer = NULL;
+	
+	udp_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (udp_socket < 0) {
 		std::cout << "could not create UDP socket" << std::endl;
-		socket = NULL;
 		throw std::exception();
 	}
+	
+	batch_buffer = new char[MAX_UDP_BATCH*MAX_UDP_SIZE];
 }
 
-UdpSender::UdpSender(const char *host, int port, int size) {
-	try {
-		if ((strcmp(host,"127.0.0.1")==0) || (strcmp(host,"localhost")==0)) {
-			local = true;
-		} else local = false;
-		long unsigned int ip = GetHostByName(host);
-		socket = new UdpTransmitSocket(IpEndpointName(ip, port));
-		if (buffer_size>MAX_UDP_SIZE) buffer_size = MAX_UDP_SIZE;
-		else if (buffer_size<MIN_UDP_SIZE) buffer_size = MIN_UDP_SIZE;
+bool UdpSender::addHost(const char *host, int port) {
+
+	unsigned long ip = GetHostByName(host);
+	if ((ip==0) || (ip==INADDR_NONE)) {
+		std::cout << "unknown host name: " << host << std::endl;
+		return false;
+	}
+	
+	struct sockaddr_in destination;
+	memset(&destination, 0, sizeof(destination));
+	destination.sin_family = AF_INET;
+	destination.sin_addr.s_addr = htonl(ip);
+	destination.sin_port = htons(port);
+	
+	if (IN_MULTICAST(ip)) {
+		// multicast packets are limited to the local network by default
+		if (!multicast) {
+#ifdef WIN32
+			int ttl = MULTICAST_TTL;
+			setsockopt(udp_socket, IPPROTO_IP, IP_MULTICAST_TTL, (const char *)&ttl, sizeof(ttl));
+#else
+			unsigned char ttl = MULTICAST_TTL;
+			unsigned char loop = 1;
+			setsockopt(udp_socket, IPPROTO_IP, IP_MULTICAST_TTL, (const void *)&ttl, sizeof(ttl));
+			setsockopt(udp_socket, IPPROTO_IP, IP_MULTICAST_LOOP, (const void *)&loop, sizeof(loop));
+#endif
+			multicast = true;
+		}
+		local = false;
+		std::cout << "TUIO/UDP multicast to " << host << "@" << port << std::endl;
+	} else {
+		if ((ip>>24)!=127) local = false;
 		std::cout << "TUIO/UDP messages to " << host << "@" << port << std::endl;
-	} catch (std::exception &e) { 
-		std::cout << "could not create UDP socket" << std::endl;
-		socket = NULL;
-		throw std::exception();
 	}
+	
+	if (!local && !fixed_size && (buffer_size>IP_MTU_SIZE)) buffer_size = IP_MTU_SIZE;
+	destinations.push_back(destination);
+	return true;
+}
+
+void UdpSender::addDestination(const char *host, int port) {
+	if (!addHost(host,port)) throw std::exception();
 }
 
 UdpSender::~UdpSender() {
-	delete socket;		
+	flushOscData();
+#ifdef WIN32
+	closesocket(udp_socket);
+#else
+	close(udp_socket);
+#endif
+	delete[] batch_buffer;
 }
 
 bool UdpSender::isConnected() { 
-	if (socket==NULL) return false; 
+	if (udp_socket<0) return false; 
 	return true;
 }
 
-bool UdpSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
-	if (socket==NULL) return false; 
-	if ( bundle->Size() > buffer_size ) return false;
-	if ( bundle->Size() == 0 ) return false;
+bool UdpSender::sendOscData (const char *data, unsigned int size) {
+	if (udp_socket<0) return false; 
+	if ( size > buffer_size ) return false;
+	if ( size == 0 ) return false;
 
-	socket->Send( bundle->Data(), bundle->Size() );
+	if (batch_count==MAX_UDP_BATCH) flushOscData();
+	memcpy(&batch_buffer[batch_count*MAX_UDP_SIZE], data, size);
+	batch_size[batch_count] = size;
+	batch_count++;
 	return true;
 }
+
+void UdpSender::flushOscData () {
+	if (batch_count==0) return;
+	
+#ifdef LINUX
+	// send all packets to all destinations with as few system calls as possible
+	struct mmsghdr messages[MAX_UDP_MESSAGES];
+	struct iovec vectors[MAX_UDP_BATCH];
+	memset(messages, 0, sizeof(messages));
+	
+	for (int i=0;i<batch_count;i++) {
+		vectors[i].iov_base = &batch_buffer[i*MAX_UDP_SIZE];
+		vectors[i].iov_len = batch_size[i];
+	}
+	
+	unsigned int count = 0;
+	unsigned int total = batch_count*(unsigned int)destinations.size();
+	for (unsigned int i=0;i<total;i++) {
+		struct msghdr *header = &messages[count].msg_hdr;
+		header->msg_name = &destinations[i/batch_count];
+		header->msg_namelen = sizeof(struct sockaddr_in);
+		header->msg_iov = &vectors[i%batch_count];
+		header->msg_iovlen = 1;
+		count++;
+		
+		if ((count==MAX_UDP_MESSAGES) || (i==total-1)) {
+			unsigned int sent = 0;
+			while (sent<count) {
+				int ret = sendmmsg(udp_socket, &messages[sent], count-sent, 0);
+				if (ret<=0) break;
+				sent += ret;
+			}
+			count = 0;
+		}
+	}
+#else
+	for (unsigned int d=0;d<destinations.size();d++) {
+		for (int i=0;i<batch_count;i++)
+			sendto(udp_socket, &batch_buffer[i*MAX_UDP_SIZE], batch_size[i], 0, (struct sockaddr*)&destinations[d], sizeof(struct sockaddr_in));
+	}
+#endif
+
+	batch_count = 0;
+}
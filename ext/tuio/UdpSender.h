@@ -20,16 +20,31 @@
 #define INCLUDED_UDPSENDER_H
 
 #include "OscSender.h"
-#include "ip/UdpSocket.h"
+
+#ifdef WIN32
+#include <winsock.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
 
 #define IP_MTU_SIZE 1500
 #define MAX_UDP_SIZE 4096
 #define MIN_UDP_SIZE 576
+#define MAX_UDP_BATCH 64
+#define MULTICAST_TTL 1
 
 namespace TUIO {
 	
 	/**
-	 * The UdpSender implements the UDP transport method for OSC
+	 * The UdpSender implements the UDP transport method for OSC.
+	 * All packets of a frame are collected and delivered to all destinations at once,
+	 * using a single sendmmsg call on Linux. Multicast group addresses are supported as destinations.
 	 *
 	 * @author Martin Kaltenbrunner
 	 * @version 1.1.6
@@ -40,7 +55,7 @@ namespace TUIO {
 
 		/**
 		 * The default constructor creates a UdpSender that sends to the default UDP port 3333 on localhost
-		 * using the maximum packet size of 65536 bytes for single packets on the loopback device
+		 * using the maximum packet size of 4096 bytes for single packets on the loopback device
 		 */
 		UdpSender();
 		
@@ -48,16 +63,16 @@ namespace TUIO {
 		 * This constructor creates a UdpSender that sends to the provided port on the the given host
 		 * using the default MTU size of 1500 bytes to deliver unfragmented UDP packets on a LAN
 		 *
-		 * @param  host  the receiving host name
+		 * @param  host  the receiving host name or multicast group
 		 * @param  port  the outgoing UDP port number
 		 */
 		
 		UdpSender(const char *host, int port);		
 		/**
 		 * This constructor creates a UdpSender that sends to the provided port on the the given host
-		 * the UDP packet size can be set to a value between 576 and 65536 bytes
+		 * the UDP packet size can be set to a value between 576 and 4096 bytes
 		 *
-		 * @param  host  the receiving host name
+		 * @param  host  the receiving host name or multicast group
 		 * @param  port  the outgoing UDP port number
 		 * @param  size  the maximum UDP packet size
 		 */
@@ -69,13 +84,28 @@ namespace TUIO {
 		virtual ~UdpSender();
 		
 		/**
-		 * This method delivers the provided OSC data
+		 * This method adds a further destination, which receives the same packets.
+		 * The packet size is limited to the MTU size if the destination is not local,
+		 * therefore all destinations need to be added before the sender is attached to the TuioServer.
 		 *
-		 * @param *bundle  the OSC stream to deliver
+		 * @param  host  the receiving host name or multicast group
+		 * @param  port  the outgoing UDP port number
+		 */
+		void addDestination(const char *host, int port);
+		
+		/**
+		 * This method queues the provided OSC bundle data until the end of the frame
+		 *
+		 * @param *data  the OSC bundle data to deliver
+		 * @param size  the size of the OSC bundle data in bytes
 		 * @return true if the data was delivered successfully
 		 */
+		bool sendOscData (const char *data, unsigned int size);
 		
-		bool sendOscPacket (osc::OutboundPacketStream *bundle);
+		/**
+		 * This method delivers all queued packets to all destinations
+		 */
+		void flushOscData ();
 
 		/**
 		 * This method returns the connection state
@@ -87,7 +117,22 @@ namespace TUIO {
 		 const char* tuio_type() { return "TUIO/UDP"; }
 		
 	private:
-		UdpTransmitSocket *socket;
+		void openSocket();
+		bool addHost(const char *host, int port);
+		
+		NetworkInitializer networkInitializer;
+#ifdef WIN32
+		SOCKET udp_socket;
+#else
+		int udp_socket;
+#endif
+		bool fixed_size;
+		bool multicast;
+		std::vector<struct sockaddr_in> destinations;
+		
+		char *batch_buffer;
+		unsigned int batch_size[MAX_UDP_BATCH];
+		int batch_count;
 	};
 }
 #endif /* INCLUDED_UDPSENDER_H */
@@ -22,96 +22,196 @@
 using namespace TUIO;
 
 WebSockSender::WebSockSender()
-	:TcpSender( 8080 )
+	:TcpSender( 8080, false )
 {
 	local = true;
 	buffer_size = MAX_TCP_SIZE;
 	port_no = 8080;
+	initialize();
+	startEventLoop();
 }
 
 WebSockSender::WebSockSender(int port)
-	:TcpSender( port )
+	:TcpSender( port, false )
 {
 	local = true;
 	buffer_size = MAX_TCP_SIZE;
 	port_no = port;
+	initialize();
+	startEventLoop();
 }
 
-bool WebSockSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
-	if (!connected) return false; 
-	if ( bundle->Size() > buffer_size ) return false;
-	if ( bundle->Size() == 0 ) return false;
-	
-#ifdef OSC_HOST_LITTLE_ENDIAN             
-	data_size[0] =  bundle->Size()>>24;
-	data_size[1] = (bundle->Size()>>16) & 255;
-	data_size[2] = (bundle->Size()>>8) & 255;
-	data_size[3] = (bundle->Size()) & 255;
-#else
-	*((int32_t*)data_size) = bundle->Size();
+void WebSockSender::initialize() {
+	batch.reserve(MAX_WEBSOCK_HEADER+MAX_TCP_SIZE);
+#ifdef WEBSOCK_COMPRESSION
+	memset(&deflater, 0, sizeof(deflater));
+	deflater_ready = (deflateInit2(&deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY)==Z_OK);
 #endif
+}
 
-#ifdef WIN32
-	std::list<SOCKET>::iterator client;
-#else
-	std::list<int>::iterator client;
+WebSockSender::~WebSockSender() {
+#ifdef WEBSOCK_COMPRESSION
+	if (deflater_ready) deflateEnd(&deflater);
 #endif
+}
+
+bool WebSockSender::sendOscData (const char *data, unsigned int size) {
+	if (!connected) return false;
+	if ( size == 0 ) return false;
 	
-	for (client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++) {
-		size_t len = bundle->Size();
-		// add WebSocket header on top
-		uint8_t header[4] = {
-			0x82,
-			(uint8_t)( len & 0xFF), 
-			(uint8_t)((len >>8) & 0xFF),
-			(uint8_t)( len & 0xFF)
-		};
-		int hs = 2;
-		if (len > 125) { hs = 4; header[1] = 126; }
-		memcpy(&data_buffer[0], &header, hs);
-		memcpy(&data_buffer[hs], bundle->Data(), bundle->Size());
-		send((*client),data_buffer, hs+bundle->Size(),0);
+	// the space for the WebSocket header is reserved in front of the enclosing bundle
+	if (batch.size()==0) {
+		static const char bundle[16] = { '#','b','u','n','d','l','e',0, 0,0,0,0,0,0,0,1 };
+		batch.resize(MAX_WEBSOCK_HEADER);
+		batch.insert(batch.end(), bundle, bundle+16);
 	}
-
+	
+	char element_size[4] = { (char)(size>>24), (char)((size>>16) & 255), (char)((size>>8) & 255), (char)(size & 255) };
+	batch.insert(batch.end(), element_size, element_size+4);
+	batch.insert(batch.end(), data, data+size);
+	
+	if (batch.size()>=MAX_WEBSOCK_BATCH) deliverBatch();
 	return true;
 }
 
-void WebSockSender::newClient( int tcp_client ) {
+void WebSockSender::flushOscData () {
+	if (batch.size()>0) deliverBatch();
+	TcpSender::flushOscData();
+}
 
-	// socket -> file descriptor
-#ifdef WIN32
-	FILE* conn = _fdopen( tcp_client, "r+" );
-#else
-	FILE* conn = fdopen( tcp_client, "r+" );
+void WebSockSender::deliverBatch () {
+	
+	size_t size = batch.size()-MAX_WEBSOCK_HEADER;
+	unsigned int hs = frameHeader(&batch[0], size, false);
+	
+	const char *frame[MAX_CLIENT_FORMATS];
+	unsigned int length[MAX_CLIENT_FORMATS];
+	frame[WEBSOCK_PLAIN] = frame[WEBSOCK_DEFLATE] = &batch[MAX_WEBSOCK_HEADER-hs];
+	length[WEBSOCK_PLAIN] = length[WEBSOCK_DEFLATE] = (unsigned int)(hs+size);
+	
+#ifdef WEBSOCK_COMPRESSION
+	// uncompressed messages are also valid for deflate clients
+	unsigned int compressed = compressBatch();
+	if ((compressed>0) && (compressed<size)) {
+		hs = frameHeader(&deflate_buffer[0], compressed, true);
+		frame[WEBSOCK_DEFLATE] = &deflate_buffer[MAX_WEBSOCK_HEADER-hs];
+		length[WEBSOCK_DEFLATE] = hs+compressed;
+	}
 #endif
+	
+	deliverFrames(frame, length);
+	batch.clear();
+}
 
-	// websocket challenge-response
-	uint8_t digest[SHA1_HASH_SIZE];
-	char buf[1024] = "...";
-	char key[1024];
+unsigned int WebSockSender::frameHeader( char *message, size_t size, bool compressed ) {
+	
+	// the header is written right in front of the payload at MAX_WEBSOCK_HEADER
+	unsigned char header[MAX_WEBSOCK_HEADER];
+	unsigned int hs;
+	header[0] = compressed ? 0xC2 : 0x82;
+	if (size<126) {
+		header[1] = (unsigned char)size;
+		hs = 2;
+	} else if (size<65536) {
+		header[1] = 126;
+		header[2] = (unsigned char)(size>>8);
+		header[3] = (unsigned char)size;
+		hs = 4;
+	} else {
+		header[1] = 127;
+		uint64_t len = size;
+		for (int i=0;i<8;i++) header[2+i] = (unsigned char)(len>>(56-8*i));
+		hs = 10;
+	}
+	
+	memcpy(&message[MAX_WEBSOCK_HEADER-hs], header, hs);
+	return hs;
+}
+
+#ifdef WEBSOCK_COMPRESSION
+unsigned int WebSockSender::compressBatch() {
+	if (!deflater_ready) return 0;
+	if (deflateReset(&deflater)!=Z_OK) return 0;
+	
+	uLong size = (uLong)(batch.size()-MAX_WEBSOCK_HEADER);
+	uLong bound = deflateBound(&deflater, size) + 16;
+	if (deflate_buffer.size()<MAX_WEBSOCK_HEADER+bound) deflate_buffer.resize(MAX_WEBSOCK_HEADER+bound);
+	
+	deflater.next_in = (Bytef*)&batch[MAX_WEBSOCK_HEADER];
+	deflater.avail_in = (uInt)size;
+	deflater.next_out = (Bytef*)&deflate_buffer[MAX_WEBSOCK_HEADER];
+	deflater.avail_out = (uInt)bound;
+	
+	if (deflate(&deflater, Z_SYNC_FLUSH)!=Z_OK) return 0;
+	if ((deflater.avail_in>0) || (deflater.avail_out==0)) return 0;
+	
+	// the empty block of the sync flush is removed from the end of each message
+	unsigned int compressed = (unsigned int)(bound-deflater.avail_out);
+	if (compressed<4) return 0;
+	const unsigned char *tail = (const unsigned char*)&deflate_buffer[MAX_WEBSOCK_HEADER+compressed-4];
+	if ((tail[0]!=0x00) || (tail[1]!=0x00) || (tail[2]!=0xFF) || (tail[3]!=0xFF)) return 0;
+	return compressed-4;
+}
+#endif
 
-	// read client handshake challenge
-	while ((buf[0] != 0) && (buf[0] != '\r')) {
-		fgets( buf, sizeof(buf), conn );
-		if (strncmp(buf,"Sec-WebSocket-Key: ",19) == 0) {
-			strncpy(key,buf+19,sizeof(key));
-			key[strlen(buf)-21] = 0;
+int WebSockSender::clientHandshake( const std::string &request, std::string &response, int &format ) {
+
+	// wait for the complete client handshake request
+	size_t end = request.find("\r\n\r\n");
+	if (end==std::string::npos) {
+		if (request.size()>MAX_HANDSHAKE_SIZE) return -1;
+		return 0;
+	}
+	
+	size_t pos = request.find("Sec-WebSocket-Key: ");
+	if ((pos==std::string::npos) || (pos>end)) return -1;
+	pos += 19;
+	std::string key = request.substr(pos,request.find("\r\n",pos)-pos);
+
+	// permessage-deflate is only accepted without server context takeover,
+	// so that all clients can share the same compressed messages
+	format = WEBSOCK_PLAIN;
+	std::string extension;
+#ifdef WEBSOCK_COMPRESSION
+	pos = request.find("Sec-WebSocket-Extensions: ");
+	if (deflater_ready && (pos!=std::string::npos) && (pos<end)) {
+		pos += 26;
+		std::string offers = request.substr(pos,request.find("\r\n",pos)-pos);
+		size_t start = 0;
+		while (start<offers.size()) {
+			size_t next = offers.find(',',start);
+			if (next==std::string::npos) next = offers.size();
+			std::string offer = offers.substr(start,next-start);
+			start = next+1;
+			
+			if (offer.find("permessage-deflate")==std::string::npos) continue;
+			if (offer.find("server_max_window_bits")!=std::string::npos) continue;
+			extension = "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover\r\n";
+			format = WEBSOCK_DEFLATE;
 			break;
 		}
 	}
+#endif
 
-	strncat(key,"258EAFA5-E914-47DA-95CA-C5AB0DC85B11",sizeof(key)-strlen(key)-1);
-	sha1(digest,(uint8_t*)key,strlen(key));
+	// websocket challenge-response
+	uint8_t digest[SHA1_HASH_SIZE];
+	char buf[1024];
+	
+	key += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+	sha1(digest,(uint8_t*)key.c_str(),key.size());
 
 	snprintf(buf, sizeof(buf),
 		"HTTP/1.1 101 Switching Protocols\r\n"
 		"Upgrade: websocket\r\n"
 		"Connection: Upgrade\r\n"
 		"Access-Control-Allow-Origin: *\r\n"
+		"%s"
 		"Sec-WebSocket-Accept: %s\r\n\r\n",
+		extension.c_str(),
 		base64( digest, SHA1_HASH_SIZE ).c_str() ); 
 
-	send(tcp_client,buf, strlen(buf),0);
+	response = buf;
+	return 1;
 }
 
 
@@ -17,10 +17,12 @@ BuildRequires: gcc
 BuildRequires: gcc-c++
 BuildRequires: SDL2-devel >= 2.0
 BuildRequires: libdc1394-devel >= 2.0
-BuildRequires: turbojpeg-devel >= 1.3
+BuildRequires: libjpeg-turbo-devel >= 1.5
+BuildRequires: libusb1-devel >= 1.0.16
 Requires: SDL2 >= 2.0
 Requires: libdc1394 >= 2.0
-Requires: turbojpeg >= 1.3
+Requires: libjpeg-turbo >= 1.5
+Requires: libusb1 >= 1.0.16
 
 %description
 reacTIVision is an open source, cross-platform computer vision
@@ -0,0 +1,188 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+// Sends a moving blob scene through the DeltaSender to a DeltaDecoder over the loopback interface.
+// Each completed frame must match the sent state within the 16 bit quantization, including blobs
+// which are added, removed or moved beyond the range of a small delta. A lost part of a delta frame
+// must only drop that frame, while a lost part of a keyframe drops all frames until the next keyframe.
+
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#include "DeltaSender.h"
+#include "DeltaDecoder.h"
+
+#define KEYFRAME_INTERVAL 10
+#define TEST_FRAMES 50
+#define TEST_BLOBS 400
+
+// the frames of which a single part is lost on its way to the decoder
+#define LOST_DELTA_FRAME 25
+#define LOST_KEYFRAME 30
+
+using namespace TUIO;
+
+struct test_blob {
+	unsigned int session_id;
+	float x, y, angle, width, height, area;
+	bool operator<(const test_blob &other) const { return session_id < other.session_id; }
+};
+
+static bool expectComplete(int frame) {
+	if (frame==LOST_DELTA_FRAME) return false;
+	if ((frame>=LOST_KEYFRAME) && (frame<LOST_KEYFRAME+KEYFRAME_INTERVAL)) return false;
+	return true;
+}
+
+static bool compareFrame(int frame, std::vector<test_blob> sent, const std::vector<DeltaBlob> &received) {
+
+	std::sort(sent.begin(), sent.end());
+	if (sent.size()!=received.size()) {
+		printf("  frame %d: %d blobs sent, %d blobs received\n", frame, (int)sent.size(), (int)received.size());
+		return false;
+	}
+
+	// the values are quantized to 16 bit, the angle wraps around at 2PI
+	const float step = 1.0f/65535.0f;
+	for (unsigned int i=0;i<sent.size();i++) {
+		const test_blob &s = sent[i];
+		const DeltaBlob &r = received[i];
+		float da = fabsf(fmodf(s.angle,2.0f*(float)M_PI) - r.angle);
+		if (da>(float)M_PI) da = 2.0f*(float)M_PI - da;
+		if ((s.session_id!=r.session_id) || (fabsf(s.x-r.x)>step) || (fabsf(s.y-r.y)>step) || (da>2.0f*(float)M_PI*step)
+			|| (fabsf(s.width-r.width)>step) || (fabsf(s.height-r.height)>step) || (fabsf(s.area-r.area)>step)) {
+			printf("  frame %d: blob %u differs from the received blob %u\n", frame, s.session_id, r.session_id);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+
+	// the receiving socket is bound to any free port on the loopback interface
+	int receiver = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+	socklen_t length = sizeof(address);
+	int buffer_size = 1<<20;
+	setsockopt(receiver, SOL_SOCKET, SO_RCVBUF, (const char*)&buffer_size, sizeof(buffer_size));
+	if ((bind(receiver, (struct sockaddr*)&address, sizeof(address))<0) || (getsockname(receiver, (struct sockaddr*)&address, &length)<0)) {
+		printf("could not bind the receiving socket\n");
+		return 1;
+	}
+
+	DeltaSender *sender = new DeltaSender("127.0.0.1", ntohs(address.sin_port), KEYFRAME_INTERVAL);
+	DeltaDecoder decoder;
+
+	std::vector<test_blob> scene;
+	unsigned int next_session = 1;
+	for (int i=0;i<TEST_BLOBS;i++) {
+		test_blob blob = { next_session++, 0.05f+0.9f*(i%20)/20.0f, 0.05f+0.9f*(i/20)/20.0f, i*0.1f, 0.02f, 0.03f, 0.0005f };
+		scene.push_back(blob);
+	}
+
+	int errors = 0;
+	unsigned int lost_packets = 0;
+	unsigned int dropped_frames = 0;
+	for (int frame=0;frame<TEST_FRAMES;frame++) {
+
+		if (frame>0) {
+			for (unsigned int i=0;i<scene.size();i++) {
+				scene[i].x += ((int)(i%5)-2)*0.0003f;
+				scene[i].y += ((int)(i%3)-1)*0.0002f;
+				scene[i].angle += 0.01f;
+			}
+			// a jump across most of the range, whose delta against the keyframe wraps around
+			if (frame%7==0) scene[0].x = (scene[0].x>0.5f) ? 0.01f : 0.99f;
+			scene[1].width = 0.02f + frame*0.001f;
+		}
+
+		// blobs which appear between two keyframes are sent with their absolute state
+		if (frame==13) {
+			for (int i=0;i<20;i++) {
+				test_blob blob = { next_session++, 0.5f, 0.1f+i*0.04f, 0.0f, 0.01f, 0.01f, 0.0001f };
+				scene.push_back(blob);
+			}
+		}
+		if (frame==17) scene.erase(scene.begin()+100, scene.begin()+130);
+
+		sender->startFrame(frame, TuioTime(frame,0));
+		for (unsigned int i=0;i<scene.size();i++) {
+			const test_blob &b = scene[i];
+			sender->addBlob((int)b.session_id, 0, b.x, b.y, b.angle, b.width, b.height, b.area, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+		}
+		sender->commitFrame();
+
+		// all parts of the frame are already queued on the loopback interface
+		bool complete = false;
+		char packet[TUIO_DELTA_PACKET_SIZE];
+		int size = 0;
+		while ((size = (int)recv(receiver, packet, sizeof(packet), MSG_DONTWAIT))>0) {
+			unsigned int part = ((unsigned char)packet[24]<<8) | (unsigned char)packet[25];
+			unsigned int parts = ((unsigned char)packet[26]<<8) | (unsigned char)packet[27];
+			if (((frame==LOST_DELTA_FRAME) && (part==0)) || ((frame==LOST_KEYFRAME) && (part==1))) {
+				if (parts<2) {
+					printf("  frame %d: the lost packet must not be the only part of its frame\n", frame);
+					errors++;
+				}
+				lost_packets++;
+				dropped_frames++;
+				continue;
+			}
+			if (decoder.decodePacket(packet, size)) complete = true;
+		}
+
+		if (complete!=expectComplete(frame)) {
+			printf("  frame %d: %s\n", frame, complete ? "completed without all of its parts" : "not completed");
+			errors++;
+		} else if (complete) {
+			if (decoder.getFrameID()!=frame) {
+				printf("  frame %d: completed as frame %ld\n", frame, decoder.getFrameID());
+				errors++;
+			} else if (!compareFrame(frame, scene, decoder.getBlobs())) errors++;
+		}
+	}
+
+	// the delta frames which refer to the lost keyframe are dropped as well
+	dropped_frames += KEYFRAME_INTERVAL-1;
+	if ((decoder.getLostPackets()!=lost_packets) || (decoder.getDroppedFrames()!=dropped_frames)) {
+		printf("  %u lost packets and %u dropped frames, expected %u and %u\n", decoder.getLostPackets(), decoder.getDroppedFrames(), lost_packets, dropped_frames);
+		errors++;
+	}
+
+	delete sender;
+#ifdef WIN32
+	closesocket(receiver);
+#else
+	close(receiver);
+#endif
+
+	if (errors>0) {
+		printf("delta stream: %d errors\n", errors);
+		return 1;
+	}
+	printf("delta stream: %d frames with %u lost packets decoded\n", TEST_FRAMES, lost_packets);
+	return 0;
+}
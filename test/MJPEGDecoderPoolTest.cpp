@@ -0,0 +1,175 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Submits a stream of MJPEG frames to MJPEGDecoderPool with several thread counts and checks that
+// getFrame() delivers them in submission order with their sequence number, time and pixels, while
+// the corrupt frames in between are skipped. Noisy frames that decode slowly alternate with flat
+// frames and corrupt frames that fail right away, so the decoder threads finish out of order.
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <poll.h>
+#include <time.h>
+
+#include "MJPEGDecoderPool.h"
+
+#define FRAME_WIDTH 320
+#define FRAME_HEIGHT 240
+#define FRAME_COUNT 300
+#define JPEG_FRAMES 4
+#define TIMEOUT 20
+
+static unsigned char* encodeFrame(int index, unsigned long *size) {
+
+	unsigned char *image = new unsigned char[FRAME_WIDTH*FRAME_HEIGHT];
+	for (int i=0;i<FRAME_WIDTH*FRAME_HEIGHT;i++) {
+		if (index%2==0) image[i] = (unsigned char)(rand() & 0xFF);
+		else image[i] = (unsigned char)(index*50);
+	}
+
+	struct jpeg_compress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_compress(&cinfo);
+
+	unsigned char *jpeg = NULL;
+	jpeg_mem_dest(&cinfo, &jpeg, size);
+
+	cinfo.image_width = FRAME_WIDTH;
+	cinfo.image_height = FRAME_HEIGHT;
+	cinfo.input_components = 1;
+	cinfo.in_color_space = JCS_GRAYSCALE;
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, 95, TRUE);
+
+	jpeg_start_compress(&cinfo, TRUE);
+	while (cinfo.next_scanline < cinfo.image_height) {
+		JSAMPROW row = image + cinfo.next_scanline*FRAME_WIDTH;
+		jpeg_write_scanlines(&cinfo, &row, 1);
+	}
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+
+	delete[] image;
+	return jpeg;
+}
+
+// every seventh frame and a few random ones are corrupt, but never the first one
+static bool isCorrupt(unsigned int sequence) {
+	return (sequence%7==3) || ((sequence*2654435761u)>>28)==5;
+}
+
+static int testPool(int threads, unsigned char **jpeg, unsigned long *size, unsigned char **expected, const unsigned char *corrupt, unsigned long corrupt_size) {
+
+	MJPEGDecoderPool pool(threads, 0, 0, FRAME_WIDTH, FRAME_HEIGHT, 1, false);
+	int frame_size = FRAME_WIDTH*FRAME_HEIGHT;
+
+	unsigned int submitted = 0;
+	unsigned int next = 0;
+	int delivered = 0, skipped = 0, errors = 0;
+	time_t start = time(NULL);
+
+	while (next<FRAME_COUNT) {
+
+		// fill all free slots before the oldest frame is taken
+		while (submitted<FRAME_COUNT && pool.canSubmit()) {
+			if (isCorrupt(submitted)) pool.submit(corrupt, corrupt_size, 1000LL*submitted, submitted);
+			else pool.submit(jpeg[submitted%JPEG_FRAMES], size[submitted%JPEG_FRAMES], 1000LL*submitted, submitted);
+			submitted++;
+		}
+
+		unsigned char *frame = pool.getFrame();
+		if (frame==NULL) {
+			if (time(NULL)-start > TIMEOUT) {
+				printf("  %d threads: timeout waiting for frame %d\n", threads, next);
+				return errors+1;
+			}
+
+			struct pollfd pfd = { pool.getEventHandle(), POLLIN, 0 };
+			poll(&pfd, 1, 100);
+			pool.clearEvent();
+			continue;
+		}
+
+		unsigned int sequence = pool.getFrameSequence();
+		if (sequence!=next || pool.getFrameTime()!=1000LL*next) {
+			if (errors++<10) printf("  %d threads: got frame %u at time %lld instead of frame %u\n", threads, sequence, pool.getFrameTime(), next);
+		} else if (memcmp(frame, expected[next%JPEG_FRAMES], frame_size)!=0) {
+			if (errors++<10) printf("  %d threads: frame %u has the wrong pixels\n", threads, sequence);
+		} else if (pool.getFrame()!=frame) {
+			if (errors++<10) printf("  %d threads: frame %u changed before it was released\n", threads, sequence);
+		}
+
+		pool.releaseFrame();
+		delivered++;
+		next = sequence+1;
+
+		// the corrupt frames after it are skipped, including the trailing ones
+		while (next<FRAME_COUNT && isCorrupt(next)) {
+			next++;
+			skipped++;
+		}
+	}
+
+	if (pool.getFrame()!=NULL) {
+		if (errors++<10) printf("  %d threads: delivered a frame after the last one\n", threads);
+	}
+
+	if (errors==0) printf("  %d threads: %d frames delivered in order, %d corrupt frames skipped\n", threads, delivered, skipped);
+	return errors;
+}
+
+int main(int argc, char* argv[]) {
+
+	printf("checking the frame order of the MJPEG decoder pool\n");
+	srand(1);
+
+	unsigned char *jpeg[JPEG_FRAMES];
+	unsigned long size[JPEG_FRAMES];
+	unsigned char *expected[JPEG_FRAMES];
+
+	MJPEGDecoder decoder;
+	decoder.setRegion(0, 0, FRAME_WIDTH, FRAME_HEIGHT, 1);
+	for (int i=0;i<JPEG_FRAMES;i++) {
+		jpeg[i] = encodeFrame(i, &size[i]);
+		expected[i] = new unsigned char[FRAME_WIDTH*FRAME_HEIGHT];
+		decoder.decode(jpeg[i], size[i], expected[i], false);
+	}
+
+	// no JPEG header at all, so that the decoder fails before touching the frame
+	unsigned char corrupt[256];
+	memset(corrupt, 0x55, sizeof(corrupt));
+
+	int failed = 0;
+	int thread_counts[] = { 1, 2, 4, 8 };
+	for (unsigned int i=0;i<sizeof(thread_counts)/sizeof(int);i++) {
+		if (testPool(thread_counts[i], jpeg, size, expected, corrupt, sizeof(corrupt))>0) failed++;
+	}
+
+	for (int i=0;i<JPEG_FRAMES;i++) {
+		free(jpeg[i]);
+		delete[] expected[i];
+	}
+
+	if (failed>0) {
+		printf("%d of %d decoder pools delivered wrong frames\n", failed, (int)(sizeof(thread_counts)/sizeof(int)));
+		return 1;
+	}
+	return 0;
+}
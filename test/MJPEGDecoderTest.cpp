@@ -0,0 +1,229 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Compares the regions decoded by MJPEGDecoder with the same region cut from a plain libjpeg
+// decode of the full frame, for random regions and scales, grayscale and RGB output and the
+// chroma subsampling of common MJPEG cameras. The decoder only decodes the iMCU columns and
+// rows around the region, so any mistake in the margin or the cropping shows up as a mismatch
+// at the region border. Frame sizes that are no multiple of the iMCU size cover partial iMCUs.
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "MJPEGDecoder.h"
+
+#define REGION_TESTS 250
+#define GUARD_SIZE 64
+
+struct frame_test {
+	const char *name;
+	int width;
+	int height;
+	int h_samp;
+	int v_samp;
+};
+
+static const frame_test frame_tests[] = {
+	{ "4:2:2", 640, 480, 2, 1 },
+	{ "4:2:0", 640, 480, 2, 2 },
+	{ "4:4:4", 320, 240, 1, 1 },
+	{ "4:2:2", 350, 262, 2, 1 },
+	{ "4:2:0", 350, 262, 2, 2 }
+};
+
+static unsigned char* encodeFrame(const frame_test *test, unsigned long *size) {
+
+	// smooth gradients with sharp edges, so that the chroma upsampling matters at any border
+	int width = test->width;
+	int height = test->height;
+	unsigned char *image = new unsigned char[width*height*3];
+	for (int y=0;y<height;y++) {
+		for (int x=0;x<width;x++) {
+			unsigned char *pixel = image + 3*(y*width+x);
+			pixel[0] = (unsigned char)((x*7+y*3) & 0xFF);
+			pixel[1] = (unsigned char)(128+100*sin(x*0.05)*cos(y*0.07));
+			pixel[2] = ((x/5+y/7) & 1) ? 220 : 30;
+		}
+	}
+
+	struct jpeg_compress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_compress(&cinfo);
+
+	unsigned char *jpeg = NULL;
+	jpeg_mem_dest(&cinfo, &jpeg, size);
+
+	cinfo.image_width = width;
+	cinfo.image_height = height;
+	cinfo.input_components = 3;
+	cinfo.in_color_space = JCS_RGB;
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, 85, TRUE);
+	cinfo.comp_info[0].h_samp_factor = test->h_samp;
+	cinfo.comp_info[0].v_samp_factor = test->v_samp;
+
+	jpeg_start_compress(&cinfo, TRUE);
+	while (cinfo.next_scanline < cinfo.image_height) {
+		JSAMPROW row = image + 3*cinfo.next_scanline*width;
+		jpeg_write_scanlines(&cinfo, &row, 1);
+	}
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+
+	delete[] image;
+	return jpeg;
+}
+
+static void decodeFrame(const unsigned char *jpeg, unsigned long size, unsigned char *dest, bool color, int scale, int *width, int *height) {
+
+	// the same decoder settings as MJPEGDecoder, without any cropping or skipping
+	struct jpeg_decompress_struct cinfo;
+	struct jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr);
+	jpeg_create_decompress(&cinfo);
+
+	jpeg_mem_src(&cinfo, (unsigned char*)jpeg, size);
+	jpeg_read_header(&cinfo, TRUE);
+	cinfo.out_color_space = color ? JCS_RGB : JCS_GRAYSCALE;
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = scale;
+	cinfo.dct_method = JDCT_IFAST;
+	jpeg_start_decompress(&cinfo);
+
+	*width = cinfo.output_width;
+	*height = cinfo.output_height;
+	int bytes = cinfo.output_components;
+	while (cinfo.output_scanline < cinfo.output_height) {
+		JSAMPROW row = dest + bytes*cinfo.output_scanline*cinfo.output_width;
+		jpeg_read_scanlines(&cinfo, &row, 1);
+	}
+
+	jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+}
+
+int main(int argc, char* argv[]) {
+
+	printf("comparing decoded MJPEG regions with full frame decodes\n");
+	srand(1);
+	MJPEGDecoder decoder;
+
+	int failed = 0;
+	for (unsigned int i=0;i<sizeof(frame_tests)/sizeof(frame_test);i++) {
+		const frame_test *test = &frame_tests[i];
+		int frame_width = test->width;
+		int frame_height = test->height;
+
+		unsigned long size = 0;
+		unsigned char *jpeg = encodeFrame(test, &size);
+
+		// the full frame decodes for all scales and both output formats
+		unsigned char *frames[4][2];
+		int frame_widths[4], frame_heights[4];
+		for (int s=0;s<4;s++) {
+			for (int c=0;c<2;c++) {
+				frames[s][c] = new unsigned char[frame_width*frame_height*3];
+				decodeFrame(jpeg, size, frames[s][c], c==1, 1<<s, &frame_widths[s], &frame_heights[s]);
+			}
+		}
+
+		int result_size = frame_width*frame_height*3 + GUARD_SIZE;
+		unsigned char *result = new unsigned char[result_size];
+
+		int mismatches = 0;
+		for (int j=0;j<REGION_TESTS;j++) {
+
+			// the first tests cover the full frame, followed by random regions of even size
+			int s = rand()%4;
+			int scale = 1<<s;
+			bool color = (rand()%2)==1;
+			int xoff = 0, yoff = 0;
+			int width = frame_width, height = frame_height;
+			if (j>=8) {
+				width = 2*(1+rand()%(frame_width/2));
+				height = 2*(1+rand()%(frame_height/2));
+				xoff = rand()%(frame_width-width+1);
+				yoff = rand()%(frame_height-height+1);
+			} else {
+				scale = 1<<(j/2);
+				s = j/2;
+				color = (j%2)==1;
+			}
+
+			decoder.setRegion(xoff, yoff, width, height, scale);
+			int region_width = decoder.getWidth();
+			int region_height = decoder.getHeight();
+			if (region_width==0 || region_height==0) continue;
+
+			memset(result, 0xA5, result_size);
+			if (!decoder.decode(jpeg, size, result, color)) {
+				printf("  %s %dx%d failed to decode %dx%d at %d,%d, scale %d\n", test->name, frame_width, frame_height, width, height, xoff, yoff, scale);
+				mismatches++;
+				continue;
+			}
+
+			// the scaled region is limited to the scaled frame like in the decoder
+			int bytes = color ? 3 : 1;
+			int x = xoff/scale;
+			int y = yoff/scale;
+			if (x+region_width > frame_widths[s]) x = frame_widths[s]-region_width;
+			if (y+region_height > frame_heights[s]) y = frame_heights[s]-region_height;
+
+			const unsigned char *expected = frames[s][color ? 1 : 0];
+			int row_size = region_width*bytes;
+			int row = 0;
+			while (row<region_height) {
+				if (memcmp(result+row*row_size, expected+((y+row)*frame_widths[s]+x)*bytes, row_size)!=0) break;
+				row++;
+			}
+
+			bool untouched = true;
+			for (int k=region_height*row_size;k<result_size;k++) {
+				if (result[k]!=0xA5) untouched = false;
+			}
+
+			if (row==region_height && untouched) continue;
+			if (mismatches<10) {
+				if (row<region_height) printf("  %s %dx%d %s region %dx%d at %d,%d, scale %d differs in row %d\n", test->name, frame_width, frame_height,
+					color ? "rgb" : "gray", width, height, xoff, yoff, scale, row);
+				else printf("  %s %dx%d %s region %dx%d at %d,%d, scale %d writes beyond the region\n", test->name, frame_width, frame_height,
+					color ? "rgb" : "gray", width, height, xoff, yoff, scale);
+			}
+			mismatches++;
+		}
+
+		if (mismatches>0) failed++;
+		else printf("  %s %dx%d ok\n", test->name, frame_width, frame_height);
+
+		for (int s=0;s<4;s++) {
+			delete[] frames[s][0];
+			delete[] frames[s][1];
+		}
+		delete[] result;
+		free(jpeg);
+	}
+
+	if (failed>0) {
+		printf("%d of %d frames decoded wrong regions\n", failed, (int)(sizeof(frame_tests)/sizeof(frame_test)));
+		return 1;
+	}
+	return 0;
+}
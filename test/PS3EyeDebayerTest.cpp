@@ -0,0 +1,218 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Compares the grayscale Bayer conversion of the PS3Eye driver, which converts any region of the
+// frame, with the original full frame conversion that is kept below as the reference. The full
+// frame and random regions are compared, as well as regions touching the first and last rows and
+// columns, which the original filled by copying their inner neighbours.
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// FrameQueue is local to the driver source, so the driver is compiled into the test
+#include "ps3eye.cpp"
+
+#define REGION_TESTS 500
+#define GUARD_SIZE 64
+
+// the original FrameQueue::DebayerGray of the driver
+static void baseline_DebayerGray(int frame_width, int frame_height, const uint8_t* inBayer, uint8_t* outBuffer)
+{
+	int				source_stride	= frame_width;
+	const uint8_t*	source_row		= inBayer;						// Start at first bayer pixel
+	int				dest_stride		= frame_width;
+	uint8_t*		dest_row		= outBuffer + dest_stride + 1; 	// We start outputting at the second pixel of the second row's G component
+	uint32_t R,G,B;
+
+	// Fill rows 1 to height-1 of the destination buffer. First and last row are filled separately (they are copied from the second row and second-to-last rows respectively)
+	for (int y = 0; y < frame_height-1; source_row += source_stride, dest_row += dest_stride, ++y)
+	{
+		const uint8_t* source		= source_row;
+		const uint8_t* source_end	= source + (source_stride-2);								// -2 to deal with the fact that we're starting at the second pixel of the row and should end at the second-to-last pixel of the row (first and last are filled separately)
+		uint8_t* dest				= dest_row;
+
+		// Row starting with Green
+		if (y % 2 == 0)
+		{
+			// Fill first pixel (green)
+			B = (source[source_stride] + source[source_stride + 2] + 1) >> 1;
+			G = source[source_stride + 1];
+			R = (source[1] + source[source_stride * 2 + 1] + 1) >> 1;
+			*dest = (uint8_t)((R*77 + G*151 + B*28)>>8);
+
+			source++;
+			dest++;
+
+			// Fill remaining pixel
+			for (; source <= source_end - 2; source += 2, dest += 2)
+			{
+				// Blue pixel
+				B = source[source_stride + 1];
+				G = (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;
+				R = (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;
+				dest[0] = (uint8_t)((R*77 + G*151 + B*28)>>8);
+
+				//  Green pixel
+				B = (source[source_stride + 1] + source[source_stride + 3] + 1) >> 1;
+				G = source[source_stride + 2];
+				R = (source[2] + source[source_stride * 2 + 2] + 1) >> 1;
+				dest[1] = (uint8_t)((R*77 + G*151 + B*28)>>8);
+
+			}
+		}
+		else
+		{
+			for (; source <= source_end - 2; source += 2, dest += 2)
+			{
+				// Red pixel
+				B = (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;;
+				G = (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;;
+				R = source[source_stride + 1];
+				dest[0] = (uint8_t)((R*77 + G*151 + B*28)>>8);
+
+				// Green pixel
+				B = (source[2] + source[source_stride * 2 + 2] + 1) >> 1;
+				G = source[source_stride + 2];
+				R = (source[source_stride + 1] + source[source_stride + 3] + 1) >> 1;
+				dest[1] = (uint8_t)((R*77 + G*151 + B*28)>>8);
+			}
+		}
+
+		if (source < source_end)
+		{
+			B = source[source_stride + 1];
+			G = (source[1] + source[source_stride] + source[source_stride + 2] + source[source_stride * 2 + 1] + 2) >> 2;
+			R = (source[0] + source[2] + source[source_stride * 2] + source[source_stride * 2 + 2] + 2) >> 2;;
+			dest[0] = (uint8_t)((R*77 + G*151 + B*28)>>8);
+
+			source++;
+			dest++;
+		}
+
+		// Fill first pixel of row (copy second pixel)
+		uint8_t* first_pixel	= dest_row-1;
+		first_pixel[0]			= dest_row[0];
+
+		// Fill last pixel of row (copy second-to-last pixel). Note: dest row starts at the *second* pixel of the row, so dest_row + (width-2) * num_output_channels puts us at the last pixel of the row
+		uint8_t* last_pixel				= dest_row + (frame_width - 2);
+		uint8_t* second_to_last_pixel	= last_pixel - 1;
+		last_pixel[0]					= second_to_last_pixel[0];
+	}
+
+	// Fill first & last row
+	for (int i = 0; i < dest_stride; i++)
+	{
+		outBuffer[i]									= outBuffer[i + dest_stride];
+		outBuffer[i + (frame_height - 1)*dest_stride]	= outBuffer[i + (frame_height - 2)*dest_stride];
+	}
+}
+
+struct frame_size {
+	int width;
+	int height;
+};
+
+static const frame_size frame_sizes[] = {
+	{ 640, 480 },
+	{ 320, 240 },
+	{ 36, 18 },
+	{ 8, 6 },
+	{ 4, 4 }
+};
+
+int main(int argc, char* argv[]) {
+
+	printf("comparing the PS3Eye gray conversion with the original conversion\n");
+	srand(1);
+
+	int failed = 0;
+	for (unsigned int i=0;i<sizeof(frame_sizes)/sizeof(frame_size);i++) {
+		int frame_width = frame_sizes[i].width;
+		int frame_height = frame_sizes[i].height;
+
+		// the original also reads the row below the last one, which holds the next frame in the camera
+		int bayer_size = frame_width*(frame_height+1);
+		uint8_t *bayer = new uint8_t[bayer_size];
+		for (int j=0;j<bayer_size;j++) bayer[j] = (uint8_t)(rand() & 0xFF);
+
+		uint8_t *expected = new uint8_t[frame_width*frame_height];
+		baseline_DebayerGray(frame_width, frame_height, bayer, expected);
+
+		int result_size = frame_width*frame_height + GUARD_SIZE;
+		uint8_t *result = new uint8_t[result_size];
+
+		ps3eye::FrameQueue queue(frame_width*frame_height);
+
+		int mismatches = 0;
+		for (int j=0;j<REGION_TESTS;j++) {
+
+			// the full frame and the regions in its corners come first, followed by random regions
+			int x = 0, y = 0;
+			int width = frame_width, height = frame_height;
+			if (j>0 && j<5) {
+				width = 1 + rand()%frame_width;
+				height = 1 + rand()%frame_height;
+				if (j%2==0) x = frame_width-width;
+				if (j>2) y = frame_height-height;
+			} else if (j>=5) {
+				width = 1 + rand()%frame_width;
+				height = 1 + rand()%frame_height;
+				x = rand()%(frame_width-width+1);
+				y = rand()%(frame_height-height+1);
+			}
+
+			memset(result, 0xA5, result_size);
+			queue.DebayerGray(frame_width, frame_height, bayer, result, x, y, width, height);
+
+			int row = 0;
+			while (row<height) {
+				if (memcmp(result+row*width, expected+(y+row)*frame_width+x, width)!=0) break;
+				row++;
+			}
+
+			bool untouched = true;
+			for (int k=width*height;k<result_size;k++) {
+				if (result[k]!=0xA5) untouched = false;
+			}
+
+			if (row==height && untouched) continue;
+			if (mismatches<10) {
+				if (row<height) {
+					int col = 0;
+					while (result[row*width+col]==expected[(y+row)*frame_width+x+col]) col++;
+					printf("  %dx%d region %dx%d at %d,%d differs at pixel %d,%d\n", frame_width, frame_height, width, height, x, y, x+col, y+row);
+				} else printf("  %dx%d region %dx%d at %d,%d writes beyond the region\n", frame_width, frame_height, width, height, x, y);
+			}
+			mismatches++;
+		}
+
+		if (mismatches>0) failed++;
+		else printf("  %dx%d ok\n", frame_width, frame_height);
+
+		delete[] bayer;
+		delete[] expected;
+		delete[] result;
+	}
+
+	if (failed>0) {
+		printf("%d of %d frame sizes differ from the original conversion\n", failed, (int)(sizeof(frame_sizes)/sizeof(frame_size)));
+		return 1;
+	}
+	return 0;
+}
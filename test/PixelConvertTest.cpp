@@ -0,0 +1,709 @@
+/*  portVideo, a cross platform camera framework
+ Copyright (C) 2005-2016 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Compares the scalar kernels and the kernels selected for this CPU with the original
+// CameraEngine conversion loops, which are kept below as the reference. The kernels must
+// produce exactly the same output for any width including the odd tails of the vector loops,
+// from unaligned sources and without writing outside of their destination. The crop and flip
+// methods of CameraEngine, which run the kernels row by row, are compared with the original
+// loops as well for random camera sizes and frame regions.
+
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "PixelConvert.h"
+#include "FileCamera.h"
+
+#define MAX_WIDTH 300
+#define GUARD_SIZE 64
+
+#define MAX_CAMERA_WIDTH 200
+#define MAX_CAMERA_HEIGHT 120
+#define CROP_TESTS 200
+
+// the original CameraEngine conversions, copied unchanged apart from taking the frame
+// configuration as a parameter
+
+static void yuv2rgb_conv(int Y, int U, int V, unsigned char *dest) {
+
+	int C = 298*(Y - 16);
+	int R = (C + 409*V + 128) >> 8;
+	int G = (C - 100*U - 208*V + 128) >> 8;
+	int B = (C + 516*U + 128) >> 8;
+
+	SAT(R);
+	SAT(G);
+	SAT(B);
+
+	*dest++ = R;
+	*dest++ = G;
+	*dest++ = B;
+}
+
+static void baseline_uyvy2gray(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	for (int i=height*width/2;i>0;i--) {
+		src++;
+		*dest++ = *src++;
+		src++;
+		*dest++ = *src++;
+	}
+}
+
+static void baseline_yuyv2gray(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	for (int i=height*width/2;i>0;i--) {
+		*dest++ = *src++;
+		src++;
+		*dest++ = *src++;
+		src++;
+	}
+}
+
+static void baseline_uyvy2rgb(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	int Y1,Y2,U,V;
+
+	for(int i=width*height/2;i>0;i--) {
+		U  = *src++ - 128;
+		Y1 = *src++;
+		V  = *src++ - 128;
+		Y2 = *src++;
+
+		yuv2rgb_conv(Y1,U,V,dest);
+		yuv2rgb_conv(Y2,U,V,dest+=3);
+		dest+=3;
+	}
+}
+
+static void baseline_yuyv2rgb(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	int Y1,Y2,U,V;
+
+	for(int i=width*height/2;i>0;i--) {
+		Y1 = *src++;
+		U  = *src++ - 128;
+		Y2 = *src++;
+		V  = *src++ - 128;
+
+		yuv2rgb_conv(Y1,U,V,dest);
+		yuv2rgb_conv(Y2,U,V,dest+=3);
+		dest+=3;
+	}
+}
+
+static void baseline_gray2rgb(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	int size = width*height;
+	for (int i=size;i>0;i--) {
+		unsigned char pixel = *src++;
+		*dest++ = pixel;
+		*dest++ = pixel;
+		*dest++ = pixel;
+	}
+}
+
+static void baseline_grayw2rgb(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	unsigned short src_pixel;
+	unsigned char dest_pixel;
+	unsigned char pixel;
+
+	for(int i=width*height;i>0;i--) {
+		pixel = *src++ ;
+		src_pixel = pixel | (*src++ << 8);
+		dest_pixel = (unsigned char)(src_pixel/4);
+		*dest++ = dest_pixel;
+		*dest++ = dest_pixel;
+		*dest++ = dest_pixel;
+	}
+}
+
+static void baseline_grayw2gray(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	unsigned short value;
+	unsigned char pixel;
+
+	for(int i=width*height;i>0;i--) {
+		pixel = *src++;
+		value = pixel | (*src++ << 8);
+		*dest++ = (unsigned char)(value/4);
+	}
+}
+
+static void baseline_rgb2gray(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	int R,G,B;
+	for (int i=width*height;i>0;i--) {
+
+		R = *src++;
+		G = *src++;
+		B = *src++;
+		*dest++ = HBT(R*77 + G*151 + B*28);
+	}
+}
+
+static void baseline_flip_rgb2gray(int width, int height, unsigned char *src, unsigned char *dest) {
+
+	int size = width*height;
+	dest += size-1;
+
+	int R,G,B;
+	for (int i=size;i>0;i--) {
+
+		R = *src++;
+		G = *src++;
+		B = *src++;
+		*dest-- = HBT(R*77 + G*151 + B*28);
+	}
+}
+
+static void baseline_flip(int width, int height, unsigned char *src, unsigned char *dest, int b) {
+
+	int size = b*width*height;
+	dest += size-1;
+	for(int i=size;i>0;i--) {
+		*dest-- = *src++;
+	}
+}
+
+static void baseline_reverse(int width, int height, unsigned char *src, unsigned char *dest) {
+	baseline_flip(width, height, src, dest, 1);
+}
+
+static void baseline_crop_uyvy2gray(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	cam_buf += 2*y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+
+	for (int i=frm_h;i>0;i--) {
+
+		cam_buf += 2*x_off;
+		for (int j=frm_w/2;j>0;j--) {
+			cam_buf++;
+			*frm_buf++ = *cam_buf++;
+			cam_buf++;
+			*frm_buf++ = *cam_buf++;
+		}
+		cam_buf +=  2*x_end;
+	}
+}
+
+static void baseline_crop_yuyv2gray(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	cam_buf += 2*y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+
+	for (int i=frm_h;i>0;i--) {
+
+		cam_buf +=  2*x_off;
+		for (int j=frm_w/2;j>0;j--) {
+			*frm_buf++ = *cam_buf++;
+			cam_buf++;
+			*frm_buf++ = *cam_buf++;
+			cam_buf++;
+		}
+		cam_buf +=  2*x_end;
+	}
+}
+
+static void baseline_crop_uyvy2rgb(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	int Y1,Y2,U,V;
+
+	cam_buf += 2*y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+
+	for (int i=frm_h;i>0;i--) {
+
+		cam_buf +=  2*x_off;
+		for (int j=frm_w/2;j>0;j--) {
+			U  = *cam_buf++ - 128;
+			Y1 = *cam_buf++;
+			V  = *cam_buf++ - 128;
+			Y2 = *cam_buf++;
+
+			yuv2rgb_conv(Y1,U,V,frm_buf);
+			yuv2rgb_conv(Y2,U,V,frm_buf+=3);
+			frm_buf+=3;
+		}
+		cam_buf += 2*x_end;
+	}
+}
+
+static void baseline_crop_yuyv2rgb(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	int Y1,Y2,U,V;
+
+	cam_buf += 2*y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+
+	for (int i=frm_h;i>0;i--) {
+
+		cam_buf +=  2*x_off;
+		for (int j=frm_w/2;j>0;j--) {
+			Y1 = *cam_buf++;
+			U  = *cam_buf++ - 128;
+			Y2 = *cam_buf++;
+			V  = *cam_buf++ - 128;
+
+			yuv2rgb_conv(Y1,U,V,frm_buf);
+			yuv2rgb_conv(Y2,U,V,frm_buf+=3);
+			frm_buf+=3;
+		}
+		cam_buf += 2*x_end;
+	}
+}
+
+static void baseline_crop_gray2rgb(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	cam_buf += y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+
+	for (int i=frm_h;i>0;i--) {
+
+		cam_buf += x_off;
+		for (int j=frm_w;j>0;j--) {
+			unsigned char pixel = *cam_buf++;
+			*frm_buf++ = pixel;
+			*frm_buf++ = pixel;
+			*frm_buf++ = pixel;
+		}
+		cam_buf +=  x_end;
+	}
+}
+
+static void baseline_crop_grayw2rgb(CameraConfig *cfg, int cam_w, unsigned char *src, unsigned char *dest) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	unsigned short src_pixel;
+	unsigned char dest_pixel;
+	unsigned char pixel;
+
+	src += 2*y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+
+	for (int i=frm_h;i>0;i--) {
+
+		src += 2*x_off;
+		for (int j=frm_w;j>0;j--) {
+			pixel = *src++;
+			src_pixel = pixel | (*src++ << 8);
+			dest_pixel = (unsigned char)(src_pixel/4);
+
+			*dest++ = dest_pixel;
+			*dest++ = dest_pixel;
+			*dest++ = dest_pixel;
+		}
+		src +=  2*x_end;
+	}
+}
+
+static void baseline_crop_grayw2gray(CameraConfig *cfg, int cam_w, unsigned char *src, unsigned char *dest) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	unsigned short src_pixel;
+	unsigned char pixel;
+
+	src += 2*y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+
+	for (int i=frm_h;i>0;i--) {
+
+		src += 2*x_off;
+		for (int j=frm_w;j>0;j--) {
+			pixel = *src++;
+			src_pixel = pixel | (*src++ << 8);
+			*dest++ = (unsigned char)(src_pixel/4);
+		}
+		src +=  2*x_end;
+	}
+}
+
+// the original copied b*cam_w bytes per row, which ran past the end of both buffers in the
+// last row, while only the first b*frm_w bytes of each row remained in the frame
+static void baseline_crop(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf, int b) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	cam_buf += b*(y_off*cam_w + x_off);
+
+	for (int i=frm_h;i>0;i--) {
+		memcpy(frm_buf, cam_buf, b*frm_w);
+
+		cam_buf += b*cam_w;
+		frm_buf += b*frm_w;
+	}
+}
+
+static void baseline_flip_crop(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf, int b) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	cam_buf += b*y_off*cam_w;
+	frm_buf += b*frm_w*frm_h-1;
+	int xend = (cam_w-(frm_w+x_off));
+
+	for (int i=frm_h;i>0;i--) {
+
+		cam_buf +=  b*x_off;
+		for (int j=b*frm_w;j>0;j--) {
+			*frm_buf-- = *cam_buf++;
+		}
+		cam_buf +=  b*xend;
+	}
+}
+
+static void baseline_crop_rgb2gray(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	cam_buf += 3*y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+
+	int R,G,B;
+	for (int i=frm_h;i>0;i--) {
+
+		cam_buf += 3*x_off;
+		for (int j=frm_w;j>0;j--) {
+			R = *cam_buf++;
+			G = *cam_buf++;
+			B = *cam_buf++;
+			*frm_buf++ = HBT(R*77 + G*151 + B*28);
+		}
+		cam_buf += 3*x_end;
+	}
+}
+
+static void baseline_flip_crop_rgb2gray(CameraConfig *cfg, int cam_w, unsigned char *cam_buf, unsigned char *frm_buf) {
+
+	int x_off = cfg->frame_xoff;
+	int y_off = cfg->frame_yoff;
+	int frm_w = cfg->frame_width;
+	int frm_h = cfg->frame_height;
+
+	cam_buf += 3*y_off*cam_w;
+	int x_end = cam_w-(frm_w+x_off);
+	frm_buf += frm_w*frm_h-1;
+
+	int R,G,B;
+	for (int i=frm_h;i>0;i--) {
+
+		cam_buf += 3*x_off;
+		for (int j=frm_w;j>0;j--) {
+			R = *cam_buf++;
+			G = *cam_buf++;
+			B = *cam_buf++;
+			*frm_buf-- = HBT(R*77 + G*151 + B*28);
+		}
+		cam_buf += 3*x_end;
+	}
+}
+
+typedef void (*baseline_convert)(int width, int height, unsigned char *src, unsigned char *dest);
+
+struct kernel_test {
+	const char *name;
+	size_t offset;
+	int src_bytes;
+	int dest_bytes;
+	bool reverse;
+	baseline_convert baseline;
+};
+
+#define KERNEL(name, src, dest, reverse, baseline) { #name, offsetof(ConvertKernels, name), src, dest, reverse, baseline }
+
+static const kernel_test kernel_tests[] = {
+	KERNEL(yuyv2gray, 2, 1, false, baseline_yuyv2gray),
+	KERNEL(uyvy2gray, 2, 1, false, baseline_uyvy2gray),
+	KERNEL(grayw2gray, 2, 1, false, baseline_grayw2gray),
+	KERNEL(rgb2gray, 3, 1, false, baseline_rgb2gray),
+	KERNEL(rgb2gray_reverse, 3, 1, true, baseline_flip_rgb2gray),
+	KERNEL(gray2rgb, 1, 3, false, baseline_gray2rgb),
+	KERNEL(grayw2rgb, 2, 3, false, baseline_grayw2rgb),
+	KERNEL(yuyv2rgb, 2, 3, false, baseline_yuyv2rgb),
+	KERNEL(uyvy2rgb, 2, 3, false, baseline_uyvy2rgb),
+	KERNEL(reverse, 1, 1, true, baseline_reverse)
+};
+
+// exposes the crop and flip methods, which every camera driver inherits from CameraEngine
+class CropCamera : public FileCamera {
+public:
+	CropCamera(CameraConfig *cam_cfg) : FileCamera(cam_cfg) {}
+
+	void run(int path, int cam_w, int cam_h, unsigned char *cam_buf, unsigned char *frm_buf) {
+		switch (path) {
+			case 0: crop_uyvy2gray(cam_w, cam_buf, frm_buf); break;
+			case 1: crop_yuyv2gray(cam_w, cam_buf, frm_buf); break;
+			case 2: crop_uyvy2rgb(cam_w, cam_buf, frm_buf); break;
+			case 3: crop_yuyv2rgb(cam_w, cam_buf, frm_buf); break;
+			case 4: crop_gray2rgb(cam_w, cam_buf, frm_buf); break;
+			case 5: crop_grayw2rgb(cam_w, cam_buf, frm_buf); break;
+			case 6: crop_grayw2gray(cam_w, cam_buf, frm_buf); break;
+			case 7: crop_rgb2gray(cam_w, cam_buf, frm_buf); break;
+			case 8: flip_crop_rgb2gray(cam_w, cam_buf, frm_buf); break;
+			case 9: crop(cam_w, cam_h, cam_buf, frm_buf, 1); break;
+			case 10: crop(cam_w, cam_h, cam_buf, frm_buf, 3); break;
+			case 11: flip_crop(cam_w, cam_h, cam_buf, frm_buf, 1); break;
+			case 12: flip_crop(cam_w, cam_h, cam_buf, frm_buf, 3); break;
+			case 13: flip(cam_w, cam_h, cam_buf, frm_buf, 1); break;
+			case 14: flip(cam_w, cam_h, cam_buf, frm_buf, 3); break;
+			case 15: flip_rgb2gray(cam_w, cam_h, cam_buf, frm_buf); break;
+		}
+	}
+};
+
+static void runBaseline(int path, CameraConfig *cfg, int cam_w, int cam_h, unsigned char *cam_buf, unsigned char *frm_buf) {
+	switch (path) {
+		case 0: baseline_crop_uyvy2gray(cfg, cam_w, cam_buf, frm_buf); break;
+		case 1: baseline_crop_yuyv2gray(cfg, cam_w, cam_buf, frm_buf); break;
+		case 2: baseline_crop_uyvy2rgb(cfg, cam_w, cam_buf, frm_buf); break;
+		case 3: baseline_crop_yuyv2rgb(cfg, cam_w, cam_buf, frm_buf); break;
+		case 4: baseline_crop_gray2rgb(cfg, cam_w, cam_buf, frm_buf); break;
+		case 5: baseline_crop_grayw2rgb(cfg, cam_w, cam_buf, frm_buf); break;
+		case 6: baseline_crop_grayw2gray(cfg, cam_w, cam_buf, frm_buf); break;
+		case 7: baseline_crop_rgb2gray(cfg, cam_w, cam_buf, frm_buf); break;
+		case 8: baseline_flip_crop_rgb2gray(cfg, cam_w, cam_buf, frm_buf); break;
+		case 9: baseline_crop(cfg, cam_w, cam_buf, frm_buf, 1); break;
+		case 10: baseline_crop(cfg, cam_w, cam_buf, frm_buf, 3); break;
+		case 11: baseline_flip_crop(cfg, cam_w, cam_buf, frm_buf, 1); break;
+		case 12: baseline_flip_crop(cfg, cam_w, cam_buf, frm_buf, 3); break;
+		case 13: baseline_flip(cam_w, cam_h, cam_buf, frm_buf, 1); break;
+		case 14: baseline_flip(cam_w, cam_h, cam_buf, frm_buf, 3); break;
+		case 15: baseline_flip_rgb2gray(cam_w, cam_h, cam_buf, frm_buf); break;
+	}
+}
+
+struct crop_test {
+	const char *name;
+	int src_bytes;
+	int dest_bytes;
+	bool full_frame;
+};
+
+static const crop_test crop_tests[] = {
+	{ "crop_uyvy2gray", 2, 1, false },
+	{ "crop_yuyv2gray", 2, 1, false },
+	{ "crop_uyvy2rgb", 2, 3, false },
+	{ "crop_yuyv2rgb", 2, 3, false },
+	{ "crop_gray2rgb", 1, 3, false },
+	{ "crop_grayw2rgb", 2, 3, false },
+	{ "crop_grayw2gray", 2, 1, false },
+	{ "crop_rgb2gray", 3, 1, false },
+	{ "flip_crop_rgb2gray", 3, 1, false },
+	{ "crop(1)", 1, 1, false },
+	{ "crop(3)", 3, 3, false },
+	{ "flip_crop(1)", 1, 1, false },
+	{ "flip_crop(3)", 3, 3, false },
+	{ "flip(1)", 1, 1, true },
+	{ "flip(3)", 3, 3, true },
+	{ "flip_rgb2gray", 3, 1, true }
+};
+
+static convert_kernel getKernel(const ConvertKernels *kernels, const kernel_test *test) {
+	return *(const convert_kernel*)((const char*)kernels + test->offset);
+}
+
+static void convert(convert_kernel kernel, const kernel_test *test, const unsigned char *src, unsigned char *dest, int width) {
+
+	// the destination is surrounded by guard bytes, which must remain untouched
+	memset(dest, 0xA5, 2*GUARD_SIZE + MAX_WIDTH*3);
+	unsigned char *start = dest + GUARD_SIZE;
+	if (test->reverse) start += width*test->dest_bytes - 1;
+	kernel(src, start, width);
+}
+
+static void convertBaseline(const kernel_test *test, const unsigned char *src, unsigned char *dest, int width) {
+
+	// the original loops start flipped frames at the end of the destination themselves
+	memset(dest, 0xA5, 2*GUARD_SIZE + MAX_WIDTH*3);
+	test->baseline(width, 1, (unsigned char*)src, dest + GUARD_SIZE);
+}
+
+static int testKernels(const ConvertKernels *kernels, const unsigned char *src, unsigned char *expected, unsigned char *result) {
+
+	int dest_size = 2*GUARD_SIZE + MAX_WIDTH*3;
+	int failed = 0;
+
+	for (unsigned int i=0;i<sizeof(kernel_tests)/sizeof(kernel_test);i++) {
+		const kernel_test *test = &kernel_tests[i];
+		convert_kernel kernel = getKernel(kernels, test);
+
+		int mismatches = 0;
+		for (int align=0;align<4;align++) {
+			for (int width=0;width<=MAX_WIDTH;width++) {
+				convertBaseline(test, src+align, expected, width);
+				convert(kernel, test, src+align, result, width);
+				if (memcmp(expected, result, dest_size)==0) continue;
+
+				if (mismatches==0) {
+					int byte = 0;
+					while (expected[byte]==result[byte]) byte++;
+					printf("  %-6s %-16s differs at width %d, alignment %d, byte %d\n", kernels->name, test->name, width, align, byte-GUARD_SIZE);
+				}
+				mismatches++;
+			}
+		}
+
+		if (mismatches>0) failed++;
+		else printf("  %-6s %-16s ok\n", kernels->name, test->name);
+	}
+
+	return failed;
+}
+
+static int testCropping(const unsigned char *src) {
+
+	CameraConfig cfg;
+	memset(&cfg, 0, sizeof(CameraConfig));
+	CropCamera camera(&cfg);
+
+	int cam_size = MAX_CAMERA_WIDTH*MAX_CAMERA_HEIGHT*3;
+	unsigned char *cam_buf = new unsigned char[cam_size];
+	memcpy(cam_buf, src, cam_size);
+
+	int frm_size = 2*GUARD_SIZE + cam_size;
+	unsigned char *expected = new unsigned char[frm_size];
+	unsigned char *result = new unsigned char[frm_size];
+
+	int failed = 0;
+	for (unsigned int i=0;i<sizeof(crop_tests)/sizeof(crop_test);i++) {
+		const crop_test *test = &crop_tests[i];
+
+		int mismatches = 0;
+		for (int j=0;j<CROP_TESTS;j++) {
+
+			// random camera sizes and frame regions, which setupFrame() limits to even frame sizes
+			int cam_w = 2 + rand()%(MAX_CAMERA_WIDTH-1);
+			int cam_h = 2 + rand()%(MAX_CAMERA_HEIGHT-1);
+
+			if (test->full_frame) {
+				cfg.frame = false;
+				cfg.frame_width = cam_w;
+				cfg.frame_height = cam_h;
+				cfg.frame_xoff = cfg.frame_yoff = 0;
+			} else {
+				cfg.frame = true;
+				cfg.frame_width = 2 + 2*(rand()%(cam_w/2));
+				cfg.frame_height = 2 + 2*(rand()%(cam_h/2));
+				cfg.frame_xoff = rand()%(cam_w-cfg.frame_width+1);
+				cfg.frame_yoff = rand()%(cam_h-cfg.frame_height+1);
+			}
+
+			memset(expected, 0xA5, frm_size);
+			memset(result, 0xA5, frm_size);
+			runBaseline(i, &cfg, cam_w, cam_h, cam_buf, expected+GUARD_SIZE);
+			camera.run(i, cam_w, cam_h, cam_buf, result+GUARD_SIZE);
+			if (memcmp(expected, result, frm_size)==0) continue;
+
+			if (mismatches==0) {
+				int byte = 0;
+				while (expected[byte]==result[byte]) byte++;
+				printf("  %-18s differs for %dx%d at %d,%d of %dx%d, byte %d\n", test->name, cfg.frame_width, cfg.frame_height,
+					cfg.frame_xoff, cfg.frame_yoff, cam_w, cam_h, byte-GUARD_SIZE);
+			}
+			mismatches++;
+		}
+
+		if (mismatches>0) failed++;
+		else printf("  %-18s ok\n", test->name);
+	}
+
+	delete[] cam_buf;
+	delete[] expected;
+	delete[] result;
+	return failed;
+}
+
+int main(int argc, char* argv[]) {
+
+	const ConvertKernels *scalar = getScalarKernels();
+	const ConvertKernels *kernels = getConvertKernels();
+	printf("comparing %s and %s kernels with the original conversions\n", scalar->name, kernels->name);
+
+	// random sources cover the full range of each channel, including the clamped YUV conversions
+	int src_size = MAX_CAMERA_WIDTH*MAX_CAMERA_HEIGHT*3 + 16;
+	unsigned char *src = new unsigned char[src_size];
+	srand(1);
+	for (int i=0;i<src_size;i++) src[i] = (unsigned char)(rand() & 0xFF);
+
+	int dest_size = 2*GUARD_SIZE + MAX_WIDTH*3;
+	unsigned char *expected = new unsigned char[dest_size];
+	unsigned char *result = new unsigned char[dest_size];
+
+	int kernel_count = sizeof(kernel_tests)/sizeof(kernel_test);
+	int failed = testKernels(scalar, src, expected, result);
+	if (kernels!=scalar) failed += testKernels(kernels, src, expected, result);
+	else kernel_count = 0;
+	int failed_crops = testCropping(src);
+
+	delete[] src;
+	delete[] expected;
+	delete[] result;
+
+	if (failed>0 || failed_crops>0) {
+		printf("%d of %d kernels and %d of %d crop and flip methods differ from the original conversions\n", failed,
+			kernel_count + (int)(sizeof(kernel_tests)/sizeof(kernel_test)), failed_crops, (int)(sizeof(crop_tests)/sizeof(crop_test)));
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,667 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+// Encodes a changing scene of objects, cursors and blobs with the TuioServer and compares each TUIO 1.1
+// packet byte by byte with the packets of the original OutboundPacketStream encoder, which is kept below
+// as the reference. The scene covers the source message, the coordinate inversion, full updates and
+// full messages, and the small packet size splits each profile bundle into several packets.
+
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <pthread.h>
+#include <vector>
+#include <list>
+#include <string>
+
+#include "TuioServer.h"
+
+#define TEST_PACKET_SIZE 1024
+#define TEST_FRAMES 40
+#define TEST_OBJECTS 30
+#define TEST_CURSORS 25
+#define TEST_BLOBS 20
+
+using namespace TUIO;
+using namespace osc;
+
+// the packets delivered by the TuioServer, which deletes its sender along with itself
+struct CaptureBuffer {
+	std::vector<std::string> packets;
+	unsigned long frames;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+class CaptureSender : public OscSender {
+public:
+	CaptureSender(CaptureBuffer *capture):capture(capture) {
+		local = true;
+		buffer_size = TEST_PACKET_SIZE;
+	};
+
+	bool sendOscData(const char *data, unsigned int size) {
+		pthread_mutex_lock(&capture->mutex);
+		capture->packets.push_back(std::string(data, size));
+		pthread_mutex_unlock(&capture->mutex);
+		return true;
+	};
+
+	void flushOscData() {
+		pthread_mutex_lock(&capture->mutex);
+		capture->frames++;
+		pthread_cond_signal(&capture->cond);
+		pthread_mutex_unlock(&capture->mutex);
+	};
+
+	bool isConnected() { return true; };
+	const char* tuio_type() { return "TUIO/CAPTURE"; };
+
+private:
+	CaptureBuffer *capture;
+};
+
+// waits until the given number of frames has been delivered, and takes their packets
+static std::vector<std::string> waitFrames(CaptureBuffer *capture, unsigned long frames) {
+	std::vector<std::string> packets;
+	pthread_mutex_lock(&capture->mutex);
+	while (capture->frames<frames) pthread_cond_wait(&capture->cond, &capture->mutex);
+	packets.swap(capture->packets);
+	pthread_mutex_unlock(&capture->mutex);
+	return packets;
+}
+
+// The TUIO 1.1 bundles as they were encoded by the TuioServer with an OutboundPacketStream.
+// Only the periodic messages are left out, which are not part of this test.
+class ReferenceServer {
+public:
+	ReferenceServer(unsigned int size)
+		:source_name(NULL),invert_x(false),invert_y(false),invert_a(false),full_update(false) {
+		oscBuffer = new char[size];
+		oscPacket = new osc::OutboundPacketStream(oscBuffer,size);
+		fullPacket = oscPacket;
+	};
+
+	~ReferenceServer() {
+		delete oscPacket;
+		delete[] oscBuffer;
+	};
+
+	void setScene(TuioServer *server) {
+		objectList = server->getTuioObjects();
+		cursorList = server->getTuioCursors();
+		blobList = server->getTuioBlobs();
+		currentFrameTime = server->getFrameTime();
+		currentFrame = server->getFrameID();
+	};
+
+	void commitFrame(bool updateObject, bool updateCursor, bool updateBlob) {
+
+		if(updateObject) {
+			startObjectBundle();
+			for (std::list<TuioObject*>::iterator  tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
+
+				// start a new packet if we exceed the packet capacity
+				if ((oscPacket->Capacity()-oscPacket->Size())<OBJ_MESSAGE_SIZE) {
+					sendObjectBundle(currentFrame);
+					startObjectBundle();
+				}
+				TuioObject *tobj = (*tuioObject);
+				if  ((full_update) || (tobj->getTuioTime()==currentFrameTime)) addObjectMessage(tobj);
+			}
+			sendObjectBundle(currentFrame);
+		}
+
+		if(updateCursor) {
+			startCursorBundle();
+			for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
+
+				// start a new packet if we exceed the packet capacity
+				if ((oscPacket->Capacity()-oscPacket->Size())<CUR_MESSAGE_SIZE) {
+					sendCursorBundle(currentFrame);
+					startCursorBundle();
+				}
+				TuioCursor *tcur = (*tuioCursor);
+				if ((full_update) || (tcur->getTuioTime()==currentFrameTime)) addCursorMessage(tcur);
+			}
+			sendCursorBundle(currentFrame);
+		}
+
+		if(updateBlob) {
+			startBlobBundle();
+			for (std::list<TuioBlob*>::iterator tuioBlob =blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
+				// start a new packet if we exceed the packet capacity
+				if ((oscPacket->Capacity()-oscPacket->Size())<BLB_MESSAGE_SIZE) {
+					sendBlobBundle(currentFrame);
+					startBlobBundle();
+				}
+				TuioBlob *tblb = (*tuioBlob);
+				if ((full_update) || (tblb->getTuioTime()==currentFrameTime)) addBlobMessage(tblb);
+			}
+			sendBlobBundle(currentFrame);
+		}
+	};
+
+	void sendEmptyCursorBundle() {
+		oscPacket->Clear();
+		(*oscPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive" << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
+		(*oscPacket) << osc::EndBundle;
+		deliverOscPacket( oscPacket );
+	};
+
+	void startCursorBundle() {
+		oscPacket->Clear();
+		(*oscPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
+		for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
+			if ((*tuioCursor)->getTuioState()!=TUIO_ADDED) (*oscPacket) << (int32)((*tuioCursor)->getSessionID());
+		}
+		(*oscPacket) << osc::EndMessage;
+	};
+
+	void addCursorMessage(TuioCursor *tcur) {
+
+		if (tcur->getTuioState()==TUIO_ADDED) return;
+
+		float xpos = tcur->getX();
+		float xvel = tcur->getXSpeed();
+		if (invert_x) {
+			xpos = 1 - xpos;
+			xvel = -1 * xvel;
+		}
+		float ypos = tcur->getY();
+		float yvel = tcur->getYSpeed();
+		if (invert_y) {
+			ypos = 1 - ypos;
+			yvel = -1 * yvel;
+		}
+
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "set";
+		(*oscPacket) << (int32)(tcur->getSessionID()) << xpos << ypos;
+		(*oscPacket) << xvel << yvel << tcur->getMotionAccel();
+		(*oscPacket) << osc::EndMessage;
+	};
+
+	void sendCursorBundle(long fseq) {
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << (int32)fseq << osc::EndMessage;
+		(*oscPacket) << osc::EndBundle;
+		deliverOscPacket( oscPacket );
+	};
+
+	void sendEmptyObjectBundle() {
+		oscPacket->Clear();
+		(*oscPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive" << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
+		(*oscPacket) << osc::EndBundle;
+		deliverOscPacket( oscPacket );
+	};
+
+	void startObjectBundle() {
+		oscPacket->Clear();
+		(*oscPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
+		for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
+			(*oscPacket) << (int32)((*tuioObject)->getSessionID());
+		}
+		(*oscPacket) << osc::EndMessage;
+	};
+
+	void addObjectMessage(TuioObject *tobj) {
+
+		float xpos = tobj->getX();
+		float xvel = tobj->getXSpeed();
+		if (invert_x) {
+			xpos = 1 - xpos;
+			xvel = -1 * xvel;
+		}
+		float ypos = tobj->getY();
+		float yvel = tobj->getYSpeed();
+		if (invert_y) {
+			ypos = 1 - ypos;
+			yvel = -1 * yvel;
+		}
+		float angle = tobj->getAngle();
+		float rvel = tobj->getRotationSpeed();
+		if (invert_a) {
+			angle = 2.0f*(float)M_PI - angle;
+			rvel = -1 * rvel;
+		}
+
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "set";
+		(*oscPacket) << (int32)(tobj->getSessionID()) << tobj->getSymbolID() << xpos << ypos << angle;
+		(*oscPacket) << xvel << yvel << rvel << tobj->getMotionAccel() << tobj->getRotationAccel();
+		(*oscPacket) << osc::EndMessage;
+	};
+
+	void sendObjectBundle(long fseq) {
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << (int32)fseq << osc::EndMessage;
+		(*oscPacket) << osc::EndBundle;
+		deliverOscPacket( oscPacket );
+	};
+
+	void sendEmptyBlobBundle() {
+		oscPacket->Clear();
+		(*oscPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive" << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
+		(*oscPacket) << osc::EndBundle;
+		deliverOscPacket( oscPacket );
+	};
+
+	void startBlobBundle() {
+		oscPacket->Clear();
+		(*oscPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
+		for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
+			if ((*tuioBlob)->getTuioState()!=TUIO_ADDED) (*oscPacket) << (int32)((*tuioBlob)->getSessionID());
+		}
+		(*oscPacket) << osc::EndMessage;
+	};
+
+	void addBlobMessage(TuioBlob *tblb) {
+
+		if (tblb->getTuioState()==TUIO_ADDED) return;
+
+		float xpos = tblb->getX();
+		float xvel = tblb->getXSpeed();
+		if (invert_x) {
+			xpos = 1 - xpos;
+			xvel = -1 * xvel;
+		}
+		float ypos = tblb->getY();
+		float yvel = tblb->getYSpeed();
+		if (invert_y) {
+			ypos = 1 - ypos;
+			yvel = -1 * yvel;
+		}
+		float angle = tblb->getAngle();
+		float rvel = tblb->getRotationSpeed();
+		if (invert_a) {
+			angle = 2.0f*(float)M_PI - angle;
+			rvel = -1 * rvel;
+		}
+
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "set";
+		(*oscPacket) << (int32)(tblb->getSessionID()) << xpos << ypos << angle << tblb->getWidth() << tblb->getHeight() << tblb->getArea();
+		(*oscPacket) << xvel << yvel  << rvel << tblb->getMotionAccel()  << tblb->getRotationAccel();
+		(*oscPacket) << osc::EndMessage;
+	};
+
+	void sendBlobBundle(long fseq) {
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << (int32)fseq << osc::EndMessage;
+		(*oscPacket) << osc::EndBundle;
+		deliverOscPacket( oscPacket );
+	};
+
+	void sendFullMessages() {
+
+		// prepare the cursor packet
+		fullPacket->Clear();
+		(*fullPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
+		// add the cursor alive message
+		(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
+		for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++)
+			(*fullPacket) << (int32)((*tuioCursor)->getSessionID());
+		(*fullPacket) << osc::EndMessage;
+
+		// add all current cursor set messages
+		for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
+
+			// start a new packet if we exceed the packet capacity
+			if ((fullPacket->Capacity()-fullPacket->Size())<CUR_MESSAGE_SIZE) {
+
+				// add the immediate fseq message and send the cursor packet
+				(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
+				(*fullPacket) << osc::EndBundle;
+				deliverOscPacket( fullPacket );
+
+				// prepare the new cursor packet
+				fullPacket->Clear();
+				(*fullPacket) << osc::BeginBundleImmediate;
+				if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
+				// add the cursor alive message
+				(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
+				for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++)
+					(*fullPacket) << (int32)((*tuioCursor)->getSessionID());
+				(*fullPacket) << osc::EndMessage;
+			}
+
+			float xpos = (*tuioCursor)->getX();
+			float xvel = (*tuioCursor)->getXSpeed();
+			if (invert_x) {
+				xpos = 1 - xpos;
+				xvel = -1 * xvel;
+			}
+			float ypos = (*tuioCursor)->getY();
+			float yvel = (*tuioCursor)->getYSpeed();
+			if (invert_y) {
+				ypos = 1 - ypos;
+				yvel = -1 * yvel;
+			}
+
+			// add the actual cursor set message
+			(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "set";
+			(*fullPacket) << (int32)((*tuioCursor)->getSessionID()) << xpos << ypos;
+			(*fullPacket) << xvel << yvel <<(*tuioCursor)->getMotionAccel();
+			(*fullPacket) << osc::EndMessage;
+		}
+
+		// add the immediate fseq message and send the cursor packet
+		(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
+		(*fullPacket) << osc::EndBundle;
+		deliverOscPacket( fullPacket );
+
+		// prepare the object packet
+		fullPacket->Clear();
+		(*fullPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
+		// add the object alive message
+		(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
+		for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++)
+			(*fullPacket) << (int32)((*tuioObject)->getSessionID());
+		(*fullPacket) << osc::EndMessage;
+
+		for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
+
+			// start a new packet if we exceed the packet capacity
+			if ((fullPacket->Capacity()-fullPacket->Size())<OBJ_MESSAGE_SIZE) {
+				// add the immediate fseq message and send the object packet
+				(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
+				(*fullPacket) << osc::EndBundle;
+				deliverOscPacket( fullPacket );
+
+				// prepare the new object packet
+				fullPacket->Clear();
+				(*fullPacket) << osc::BeginBundleImmediate;
+				if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
+				// add the object alive message
+				(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
+				for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++)
+					(*fullPacket) << (int32)((*tuioObject)->getSessionID());
+				(*fullPacket) << osc::EndMessage;
+			}
+
+			float xpos = (*tuioObject)->getX();
+			float xvel = (*tuioObject)->getXSpeed();
+			if (invert_x) {
+				xpos = 1 - xpos;
+				xvel = -1 * xvel;
+			}
+			float ypos = (*tuioObject)->getY();
+			float yvel = (*tuioObject)->getYSpeed();
+			if (invert_y) {
+				ypos = 1 - ypos;
+				yvel = -1 * yvel;
+			}
+			float angle = (*tuioObject)->getAngle();
+			float rvel = (*tuioObject)->getRotationSpeed();
+			if (invert_a) {
+				angle =  2.0f*(float)M_PI - angle;
+				rvel = -1 * rvel;
+			}
+
+			// add the actual object set message
+			(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "set";
+			(*fullPacket) << (int32)((*tuioObject)->getSessionID()) << (*tuioObject)->getSymbolID() << xpos << ypos << angle;
+			(*fullPacket) << xvel << yvel << rvel << (*tuioObject)->getMotionAccel() << (*tuioObject)->getRotationAccel();
+			(*fullPacket) << osc::EndMessage;
+
+		}
+		// add the immediate fseq message and send the object packet
+		(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
+		(*fullPacket) << osc::EndBundle;
+		deliverOscPacket( fullPacket );
+
+		// prepare the blob packet
+		fullPacket->Clear();
+		(*fullPacket) << osc::BeginBundleImmediate;
+		if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
+		// add the object alive message
+		(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
+		for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++)
+			(*fullPacket) << (int32)((*tuioBlob)->getSessionID());
+		(*fullPacket) << osc::EndMessage;
+
+		for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
+
+			// start a new packet if we exceed the packet capacity
+			if ((fullPacket->Capacity()-fullPacket->Size())<BLB_MESSAGE_SIZE) {
+				// add the immediate fseq message and send the object packet
+				(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
+				(*fullPacket) << osc::EndBundle;
+				deliverOscPacket( fullPacket );
+
+				// prepare the new blob packet
+				fullPacket->Clear();
+				(*fullPacket) << osc::BeginBundleImmediate;
+				if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
+				// add the blob alive message
+				(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
+				for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++)
+					(*fullPacket) << (int32)((*tuioBlob)->getSessionID());
+				(*fullPacket) << osc::EndMessage;
+			}
+
+			float xpos = (*tuioBlob)->getX();
+			float xvel = (*tuioBlob)->getXSpeed();
+			if (invert_x) {
+				xpos = 1 - xpos;
+				xvel = -1 * xvel;
+			}
+			float ypos = (*tuioBlob)->getY();
+			float yvel = (*tuioBlob)->getYSpeed();
+			if (invert_y) {
+				ypos = 1 - ypos;
+				yvel = -1 * yvel;
+			}
+			float angle = (*tuioBlob)->getAngle();
+			float rvel = (*tuioBlob)->getRotationSpeed();
+			if (invert_a) {
+				angle = 2.0f*(float)M_PI - angle;
+				rvel = -1 * rvel;
+			}
+
+			// add the actual blob set message
+			(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "set";
+			(*fullPacket) << (int32)((*tuioBlob)->getSessionID()) << xpos << ypos  << angle << (*tuioBlob)->getWidth() << (*tuioBlob)->getHeight() << (*tuioBlob)->getArea();
+			(*fullPacket) << xvel << yvel << rvel << (*tuioBlob)->getMotionAccel() << (*tuioBlob)->getRotationAccel();
+			(*fullPacket) << osc::EndMessage;
+
+		}
+		// add the immediate fseq message and send the blob packet
+		(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
+		(*fullPacket) << osc::EndBundle;
+		deliverOscPacket( fullPacket );
+	};
+
+	std::vector<std::string> packets;
+	const char *source_name;
+	bool invert_x, invert_y, invert_a;
+	bool full_update;
+
+private:
+	void deliverOscPacket(osc::OutboundPacketStream *packet) {
+		packets.push_back(std::string(packet->Data(), packet->Size()));
+	};
+
+	char *oscBuffer;
+	osc::OutboundPacketStream *oscPacket;
+	osc::OutboundPacketStream *fullPacket;
+
+	std::list<TuioObject*> objectList;
+	std::list<TuioCursor*> cursorList;
+	std::list<TuioBlob*> blobList;
+	TuioTime currentFrameTime;
+	long currentFrame;
+};
+
+static int comparePackets(const char *step, std::vector<std::string> &expected, const std::vector<std::string> &received) {
+
+	int errors = 0;
+	if (expected.size()!=received.size()) {
+		printf("  %s: %d packets expected, %d packets received\n", step, (int)expected.size(), (int)received.size());
+		errors++;
+	}
+
+	for (unsigned int i=0;(i<expected.size()) && (i<received.size());i++) {
+		if (expected[i]==received[i]) continue;
+		unsigned int byte = 0;
+		while ((byte<expected[i].size()) && (byte<received[i].size()) && (expected[i][byte]==received[i][byte])) byte++;
+		printf("  %s: packet %d of %d bytes differs at byte %d\n", step, i, (int)expected[i].size(), byte);
+		errors++;
+		break;
+	}
+
+	expected.clear();
+	return errors;
+}
+
+int main(int argc, char* argv[]) {
+
+	CaptureBuffer capture;
+	capture.frames = 0;
+	pthread_mutex_init(&capture.mutex, NULL);
+	pthread_cond_init(&capture.cond, NULL);
+
+	ReferenceServer reference(TEST_PACKET_SIZE);
+	TuioServer *server = new TuioServer(new CaptureSender(&capture));
+	unsigned long frames = 1;
+	int errors = 0;
+
+	reference.sendEmptyCursorBundle();
+	reference.sendEmptyObjectBundle();
+	reference.sendEmptyBlobBundle();
+	errors += comparePackets("empty bundles", reference.packets, waitFrames(&capture, frames));
+
+	const char *source_name = "tuiotest@127.0.0.1";
+	server->setSourceName("tuiotest", "127.0.0.1");
+	reference.source_name = source_name;
+
+	std::vector<TuioObject*> objects;
+	std::vector<TuioCursor*> cursors;
+	std::vector<TuioBlob*> blobs;
+	unsigned int packets = 0;
+
+	for (int frame=0;frame<TEST_FRAMES;frame++) {
+
+		// a distinct frame time identifies the components updated within each frame
+		server->initFrame(TuioTime(1000+frame/30, (frame%30)*33333));
+		bool updateObject = false;
+		bool updateCursor = false;
+		bool updateBlob = false;
+		float t = frame*0.05f;
+
+		if (frame==8) {
+			server->setInvertXpos(true);
+			reference.invert_x = true;
+		} else if (frame==14) {
+			server->setInvertYpos(true);
+			server->setInvertAngle(true);
+			reference.invert_y = true;
+			reference.invert_a = true;
+		} else if (frame==20) {
+			server->enableFullUpdate();
+			reference.full_update = true;
+		} else if (frame==26) {
+			server->disableFullUpdate();
+			reference.full_update = false;
+		}
+
+		// the objects are all updated in every third frame, and only partially in between
+		if (frame==0) {
+			for (int i=0;i<TEST_OBJECTS;i++) objects.push_back(server->addTuioObject(i, 0.5f+0.3f*cosf(i*0.7f), 0.5f+0.3f*sinf(i*0.7f), fmodf(i*0.7f, 2.0f*(float)M_PI)));
+			updateObject = true;
+		} else if (frame%4!=3) {
+			for (int i=frame%3;i<TEST_OBJECTS;i+=3) {
+				float phase = i*0.7f+t;
+				server->updateTuioObject(objects[i], 0.5f+0.3f*cosf(phase), 0.5f+0.3f*sinf(phase), fmodf(phase, 2.0f*(float)M_PI));
+			}
+			updateObject = true;
+		}
+
+		// the cursors are added and removed, and do not change within some frames
+		if (frame==0) {
+			for (int i=0;i<TEST_CURSORS;i++) cursors.push_back(server->addTuioCursor(0.1f+i*0.03f, 0.2f));
+			updateCursor = true;
+		} else if (frame==17) {
+			for (int i=0;i<5;i++) server->removeTuioCursor(cursors[i]);
+			cursors.erase(cursors.begin(), cursors.begin()+5);
+			for (int i=0;i<5;i++) cursors.push_back(server->addTuioCursor(0.8f, 0.1f+i*0.1f));
+			updateCursor = true;
+		} else if (frame%5!=4) {
+			for (unsigned int i=frame%2;i<cursors.size();i+=2) server->updateTuioCursor(cursors[i], 0.1f+i*0.03f+0.1f*sinf(t), 0.2f+0.1f*cosf(t+i));
+			updateCursor = true;
+		}
+
+		// the blobs are moved and resized in every second frame
+		if (frame==0) {
+			for (int i=0;i<TEST_BLOBS;i++) blobs.push_back(server->addTuioBlob(0.3f+i*0.02f, 0.7f, i*0.3f, 0.1f, 0.05f, 0.004f));
+			updateBlob = true;
+		} else if (frame==31) {
+			server->removeTuioBlob(blobs.back());
+			blobs.pop_back();
+			updateBlob = true;
+		} else if (frame%2==1) {
+			for (unsigned int i=0;i<blobs.size();i++) server->updateTuioBlob(blobs[i], 0.3f+i*0.02f+0.05f*cosf(t), 0.7f-0.05f*sinf(t), fmodf(i*0.3f+t, 2.0f*(float)M_PI), 0.1f+0.01f*i, 0.05f+0.02f*sinf(t), 0.004f);
+			updateBlob = true;
+		}
+
+		server->commitFrame();
+		reference.setScene(server);
+		reference.commitFrame(updateObject, updateCursor, updateBlob);
+		packets += (unsigned int)reference.packets.size();
+		char step[32];
+		snprintf(step, 32, "frame %d", frame);
+		errors += comparePackets(step, reference.packets, waitFrames(&capture, ++frames));
+
+		if ((frame==12) || (frame==22)) {
+			server->sendFullMessages();
+			reference.sendFullMessages();
+			packets += (unsigned int)reference.packets.size();
+			snprintf(step, 32, "full messages %d", frame);
+			errors += comparePackets(step, reference.packets, waitFrames(&capture, ++frames));
+		}
+	}
+
+	// the destructor stops and removes all components without committing a frame
+	delete server;
+	reference.sendEmptyCursorBundle();
+	reference.sendEmptyObjectBundle();
+	reference.sendEmptyBlobBundle();
+	errors += comparePackets("final bundles", reference.packets, waitFrames(&capture, ++frames));
+
+	pthread_cond_destroy(&capture.cond);
+	pthread_mutex_destroy(&capture.mutex);
+
+	if (errors>0) {
+		printf("tuio encoder: %d errors\n", errors);
+		return 1;
+	}
+	printf("tuio encoder: %u packets identical to the reference encoder\n", packets);
+	return 0;
+}